@@ -100,6 +100,38 @@ else()
 endif()
 message(STATUS "Found Blas Lib: " ${BLAS_LIBRARIES})
 
+# mkl can pack a gemm operand once and reuse the panels, see CpuGemmPackCache
+include(CheckFunctionExists)
+set(CMAKE_REQUIRED_LIBRARIES ${BLAS_LIBRARIES} ${CMAKE_THREAD_LIBS_INIT} ${CMAKE_DL_LIBS} m)
+check_function_exists(cblas_sgemm_compute BLAS_HAS_PACKED_GEMM)
+# the thread count of the blas library, see ForEachBatchedGemm
+check_function_exists(mkl_set_num_threads_local BLAS_HAS_MKL_THREAD_NUM)
+check_function_exists(openblas_get_num_threads BLAS_HAS_OPENBLAS_THREAD_NUM)
+check_function_exists(openblas_set_num_threads_local BLAS_HAS_OPENBLAS_LOCAL_THREAD_NUM)
+unset(CMAKE_REQUIRED_LIBRARIES)
+if (BLAS_HAS_PACKED_GEMM)
+  add_definitions(-DWITH_BLAS_PACKED_GEMM)
+endif()
+if (BLAS_HAS_MKL_THREAD_NUM)
+  add_definitions(-DWITH_MKL_THREAD_NUM)
+elseif (BLAS_HAS_OPENBLAS_THREAD_NUM)
+  add_definitions(-DWITH_OPENBLAS_THREAD_NUM)
+  # openblas before 0.3.27 can only set the thread count of the whole process
+  if (BLAS_HAS_OPENBLAS_LOCAL_THREAD_NUM)
+    add_definitions(-DWITH_OPENBLAS_LOCAL_THREAD_NUM)
+  endif()
+endif()
+
+# IoUringFileSystem talks to io_uring through the raw syscalls and needs only the kernel headers
+if (NOT WIN32)
+  include(CheckSymbolExists)
+  check_symbol_exists(__NR_io_uring_setup "sys/syscall.h" HAVE_IO_URING_SYSCALLS)
+  check_symbol_exists(IORING_OFF_SQ_RING "linux/io_uring.h" HAVE_LINUX_IO_URING_H)
+  if (HAVE_IO_URING_SYSCALLS AND HAVE_LINUX_IO_URING_H)
+    add_definitions(-DWITH_IO_URING)
+  endif()
+endif()
+
 # libraries only a top level .so or exe should be linked to
 set(oneflow_exe_third_party_libs
     ${GLOG_STATIC_LIBRARIES}
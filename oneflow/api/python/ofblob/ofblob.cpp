@@ -26,6 +26,7 @@ ONEFLOW_API_PYBIND11_MODULE("", m) {
   m.def("Ofblob_GetDataType", &Ofblob_GetDataType);
   m.def("OfBlob_NumAxes", &OfBlob_NumAxes);
   m.def("OfBlob_IsDynamic", &OfBlob_IsDynamic);
+  m.def("OfBlob_IsHostMemory", &OfBlob_IsHostMemory);
 
   m.def("OfBlob_IsTensorList", &OfBlob_IsTensorList);
   m.def("OfBlob_TotalNumOfTensors", &OfBlob_TotalNumOfTensors);
@@ -54,13 +55,21 @@ ONEFLOW_API_PYBIND11_MODULE("", m) {
         &Dtype_GetOfBlobCurMutTensorCopyFromBufferFuncName);
   m.def("Dtype_GetOfBlobStaticTensorCopyFromBufferFuncName",
         &Dtype_GetOfBlobStaticTensorCopyFromBufferFuncName);
+  m.def("Dtype_GetOfBlobCurTensorAsNumpyFuncName", &Dtype_GetOfBlobCurTensorAsNumpyFuncName);
+  m.def("Dtype_GetOfBlobCurMutTensorAsNumpyFuncName",
+        &Dtype_GetOfBlobCurMutTensorAsNumpyFuncName);
+  m.def("Dtype_GetOfBlobStaticTensorAsNumpyFuncName",
+        &Dtype_GetOfBlobStaticTensorAsNumpyFuncName);
 
 #define EXPORT_COPY_DATA_API(T, type_proto)                                                     \
   m.def("OfBlob_CurTensorCopyToBuffer_" OF_PP_STRINGIZE(T), &OfBlob_CurTensorCopyToBuffer_##T); \
   m.def("OfBlob_CurMutTensorCopyFromBuffer_" OF_PP_STRINGIZE(T),                                \
         &OfBlob_CurMutTensorCopyFromBuffer_##T);                                                \
   m.def("OfBlob_StaticTensorCopyFromBuffer_" OF_PP_STRINGIZE(T),                                \
-        &OfBlob_StaticTensorCopyFromBuffer_##T);
+        &OfBlob_StaticTensorCopyFromBuffer_##T);                                                \
+  m.def("OfBlob_CurTensorAsNumpy_" OF_PP_STRINGIZE(T), &OfBlob_CurTensorAsNumpy_##T);           \
+  m.def("OfBlob_CurMutTensorAsNumpy_" OF_PP_STRINGIZE(T), &OfBlob_CurMutTensorAsNumpy_##T);     \
+  m.def("OfBlob_StaticTensorAsNumpy_" OF_PP_STRINGIZE(T), &OfBlob_StaticTensorAsNumpy_##T);
 
   OF_PP_FOR_EACH_TUPLE(EXPORT_COPY_DATA_API, POD_DATA_TYPE_SEQ);
 
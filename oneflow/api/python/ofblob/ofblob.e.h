@@ -55,6 +55,42 @@ OF_PP_FOR_EACH_TUPLE(DEFINE_COPIER, POD_DATA_TYPE_SEQ);
 
 #undef DEFINE_COPIER
 
+// The arrays below alias the regst memory of the blob instead of owning a copy. A dummy capsule is
+// set as their base so that numpy never frees the memory, and they must not be used after the
+// foreign callback receiving the OfBlob returns.
+#define DEFINE_NUMPY_VIEW(T, type_proto)                                             \
+  inline py::array_t<T> OfBlob_CurTensorAsNumpy_##T(uint64_t of_blob_ptr) {          \
+    using namespace oneflow;                                                         \
+    auto* of_blob = reinterpret_cast<OfBlob*>(of_blob_ptr);                          \
+    std::vector<int64_t> shape(of_blob->NumAxes());                                  \
+    of_blob->CurTensorCopyShapeTo(shape.data(), shape.size());                       \
+    const T* dptr = of_blob->CurTensorHostDptr<T>();                                 \
+    return py::array_t<T>(shape, dptr, py::capsule(dptr, [](void*) {}));             \
+  }                                                                                  \
+  inline py::array_t<T> OfBlob_CurMutTensorAsNumpy_##T(uint64_t of_blob_ptr,         \
+                                                       py::array_t<int64_t> shape) { \
+    using namespace oneflow;                                                         \
+    auto* of_blob = reinterpret_cast<OfBlob*>(of_blob_ptr);                          \
+    py::buffer_info buf = shape.request();                                           \
+    const int64_t* shape_ptr = (int64_t*)buf.ptr;                                    \
+    of_blob->CurMutTensorCopyShapeFrom(shape_ptr, buf.size);                         \
+    T* dptr = of_blob->CurMutTensorHostDptr<T>();                                    \
+    std::vector<int64_t> dims(shape_ptr, shape_ptr + buf.size);                      \
+    return py::array_t<T>(dims, dptr, py::capsule(dptr, [](void*) {}));              \
+  }                                                                                  \
+  inline py::array_t<T> OfBlob_StaticTensorAsNumpy_##T(uint64_t of_blob_ptr) {       \
+    using namespace oneflow;                                                         \
+    auto* of_blob = reinterpret_cast<OfBlob*>(of_blob_ptr);                          \
+    std::vector<int64_t> shape(of_blob->NumAxes());                                  \
+    of_blob->CopyStaticShapeTo(shape.data(), shape.size());                          \
+    T* dptr = of_blob->StaticTensorHostDptr<T>();                                    \
+    return py::array_t<T>(shape, dptr, py::capsule(dptr, [](void*) {}));             \
+  }
+
+OF_PP_FOR_EACH_TUPLE(DEFINE_NUMPY_VIEW, POD_DATA_TYPE_SEQ);
+
+#undef DEFINE_NUMPY_VIEW
+
 inline std::string Dtype_GetOfBlobCurTensorCopyToBufferFuncName(int64_t dtype) {
   using namespace oneflow;
   static const HashMap<int64_t, std::string> data_type2func_name{
@@ -88,4 +124,37 @@ inline std::string Dtype_GetOfBlobStaticTensorCopyFromBufferFuncName(int64_t dty
   return data_type2func_name.at(dtype);
 }
 
+inline std::string Dtype_GetOfBlobCurTensorAsNumpyFuncName(int64_t dtype) {
+  using namespace oneflow;
+  static const HashMap<int64_t, std::string> data_type2func_name{
+#define DATA_TYPE_FUNC_NAME_PAIR(type_cpp, type_proto) \
+  {type_proto, "OfBlob_CurTensorAsNumpy_" #type_cpp},
+      OF_PP_FOR_EACH_TUPLE(DATA_TYPE_FUNC_NAME_PAIR, POD_DATA_TYPE_SEQ)
+#undef DATA_TYPE_FUNC_NAME_PAIR
+  };
+  return data_type2func_name.at(dtype);
+}
+
+inline std::string Dtype_GetOfBlobCurMutTensorAsNumpyFuncName(int64_t dtype) {
+  using namespace oneflow;
+  static const HashMap<int64_t, std::string> data_type2func_name{
+#define DATA_TYPE_FUNC_NAME_PAIR(type_cpp, type_proto) \
+  {type_proto, "OfBlob_CurMutTensorAsNumpy_" #type_cpp},
+      OF_PP_FOR_EACH_TUPLE(DATA_TYPE_FUNC_NAME_PAIR, POD_DATA_TYPE_SEQ)
+#undef DATA_TYPE_FUNC_NAME_PAIR
+  };
+  return data_type2func_name.at(dtype);
+}
+
+inline std::string Dtype_GetOfBlobStaticTensorAsNumpyFuncName(int64_t dtype) {
+  using namespace oneflow;
+  static const HashMap<int64_t, std::string> data_type2func_name{
+#define DATA_TYPE_FUNC_NAME_PAIR(type_cpp, type_proto) \
+  {type_proto, "OfBlob_StaticTensorAsNumpy_" #type_cpp},
+      OF_PP_FOR_EACH_TUPLE(DATA_TYPE_FUNC_NAME_PAIR, POD_DATA_TYPE_SEQ)
+#undef DATA_TYPE_FUNC_NAME_PAIR
+  };
+  return data_type2func_name.at(dtype);
+}
+
 #endif  // ONEFLOW_API_PYTHON_OFBLOB_OFBLOB_E_H_
@@ -41,6 +41,12 @@ inline bool OfBlob_IsDynamic(uint64_t of_blob_ptr) {
   return of_blob->is_dynamic();
 }
 
+inline bool OfBlob_IsHostMemory(uint64_t of_blob_ptr) {
+  using namespace oneflow;
+  auto* of_blob = reinterpret_cast<OfBlob*>(of_blob_ptr);
+  return of_blob->IsHostMemory();
+}
+
 inline bool OfBlob_IsTensorList(uint64_t of_blob_ptr) {
   using namespace oneflow;
   auto* of_blob = reinterpret_cast<OfBlob*>(of_blob_ptr);
@@ -0,0 +1,95 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/common/data_type.h"
+#include "oneflow/core/serving/inference_runtime.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+namespace {
+
+// `inputs` maps input op names to (contiguous ndarray, data type in proto), the returned dict
+// maps output op names to (flat uint8 ndarray owning the output, shape, data type in proto).
+// Malformed inputs of a client raise ValueError instead of aborting the serving process.
+// `timeout_us` is passed to InferenceRuntime::Predict.
+py::dict Predict(InferenceRuntime* runtime, const py::dict& inputs, int64_t timeout_us) {
+  HashMap<std::string, ServingTensor> input_tensors;
+  for (const auto& pair : inputs) {
+    const std::string name = pair.first.cast<std::string>();
+    const py::tuple value = pair.second.cast<py::tuple>();
+    if (value.size() != 2) {
+      throw py::value_error("input " + name + " should be a tuple of (ndarray, data type)");
+    }
+    const py::array array = value[0].cast<py::array>();
+    const int data_type_value = value[1].cast<int>();
+    if (!DataType_IsValid(data_type_value)
+        || !IsPODDataType(static_cast<DataType>(data_type_value))) {
+      throw py::value_error("input " + name + " has an unsupported data type "
+                            + std::to_string(data_type_value));
+    }
+    const DataType data_type = static_cast<DataType>(data_type_value);
+    if (!(array.flags() & py::array::c_style)) {
+      throw py::value_error("input " + name + " should be contiguous");
+    }
+    if (static_cast<size_t>(array.itemsize()) != GetSizeOfDataType(data_type)) {
+      throw py::value_error("input " + name + " has items of " + std::to_string(array.itemsize())
+                            + " bytes, which does not match its data type");
+    }
+    DimVector dims(array.shape(), array.shape() + array.ndim());
+    ServingTensor tensor(Shape(dims), data_type);
+    if (tensor.ByteSize() != static_cast<size_t>(array.nbytes())) {
+      throw py::value_error("input " + name + " has " + std::to_string(array.nbytes())
+                            + " bytes instead of " + std::to_string(tensor.ByteSize()));
+    }
+    std::memcpy(tensor.mut_data(), array.data(), tensor.ByteSize());
+    input_tensors.emplace(name, std::move(tensor));
+  }
+  HashMap<std::string, ServingTensor> output_tensors;
+  {
+    py::gil_scoped_release release;
+    runtime->Predict(input_tensors, &output_tensors, timeout_us).GetOrThrow();
+  }
+  py::dict outputs;
+  for (auto& pair : output_tensors) {
+    auto* tensor = new ServingTensor(std::move(pair.second));
+    py::capsule owner(tensor, [](void* ptr) { delete reinterpret_cast<ServingTensor*>(ptr); });
+    py::array_t<uint8_t> bytes(tensor->ByteSize(), reinterpret_cast<uint8_t*>(tensor->mut_data()),
+                               owner);
+    py::tuple shape(tensor->shape().NumAxes());
+    for (int64_t i = 0; i < tensor->shape().NumAxes(); ++i) { shape[i] = tensor->shape().At(i); }
+    outputs[py::str(pair.first)] =
+        py::make_tuple(bytes, shape, static_cast<int>(tensor->data_type()));
+  }
+  return outputs;
+}
+
+}  // namespace
+
+ONEFLOW_API_PYBIND11_MODULE("", m) {
+  py::class_<InferenceRuntime, std::shared_ptr<InferenceRuntime>>(m, "InferenceRuntime")
+      .def(py::init<const std::string&, const std::vector<std::string>&,
+                    const std::vector<std::string>&, int64_t, int64_t>())
+      .def("input_op_names", &InferenceRuntime::input_op_names)
+      .def("output_op_names", &InferenceRuntime::output_op_names)
+      .def("Predict", &Predict, py::arg("inputs"), py::arg("timeout_us") = 0);
+}
+
+}  // namespace oneflow
@@ -17,6 +17,8 @@ limitations under the License.
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/job/runtime_job_descs.h"
 #include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/cost_db.h"
+#include "oneflow/core/profiler/timeline.h"
 
 namespace oneflow {
 
@@ -34,6 +36,29 @@ void CheckInplaceRegstDescId(const TaskProto& task_proto) {
   }
 }
 
+// acts of one stall statistics window
+const int64_t kAdaptiveRegstWindowActNum = 64;
+// grow if the actor is stalled on writing more than this ratio of the window
+const double kAdaptiveRegstGrowStallRatio = 0.05;
+// shrink after so many windows stalled on writing less than this ratio
+const double kAdaptiveRegstShrinkStallRatio = 0.005;
+const int64_t kAdaptiveRegstShrinkCalmWindowNum = 4;
+
+bool IsAdaptiveRegstDesc(const RegstDescProto& regst_desc) {
+  if (regst_desc.regst_desc_type().has_data_regst_desc() == false) { return false; }
+  // regsts sharing mem blocks with others, including the inplace ones, can not be added alone
+  if (regst_desc.enable_reuse_mem()) { return false; }
+  if (regst_desc.register_num() >= regst_desc.max_register_num()) { return false; }
+  if (regst_desc.consumer_task_id_size() == 0) { return false; }
+  const MemoryCase& mem_case = regst_desc.mem_case();
+  if (mem_case.has_host_mem() && mem_case.host_mem().used_by_network()) { return false; }
+  for (const LbiBlobDescPair& pair :
+       regst_desc.regst_desc_type().data_regst_desc().lbi2blob_desc()) {
+    if (IsPODDataType(pair.blob_desc().body().data_type()) == false) { return false; }
+  }
+  return true;
+}
+
 }  // namespace
 
 void Actor::Init(const JobDesc* job_desc, const TaskProto& task_proto,
@@ -50,6 +75,15 @@ void Actor::Init(const JobDesc* job_desc, const TaskProto& task_proto,
     ek.kernel = ConstructKernel(job_desc_, node.kernel_conf(), device_ctx_.get());
     exec_kernel_vec_.push_back(std::move(ek));
   }
+  std::string timeline_name = TaskType_Name(task_proto.task_type());
+  for (const ExecNodeProto& node : task_proto.exec_sequence().exec_node()) {
+    timeline_name.append(":" + node.kernel_conf().op_attribute().op_conf().name());
+  }
+  timeline_name_id_ = profiler::TimelineNameId(profiler::kTimelineActorAct, timeline_name);
+  wait_timeline_name_id_ = profiler::TimelineNameId(profiler::kTimelineActorWait, timeline_name);
+  ready_timeline_name_id_ = profiler::TimelineNameId(profiler::kTimelineActorReady, timeline_name);
+  last_msg_enqueue_ns_ = -1;
+  last_act_end_ns_ = -1;
 
   is_kernel_launch_synchronized_ =
       std::all_of(exec_kernel_vec_.cbegin(), exec_kernel_vec_.cend(),
@@ -96,6 +130,7 @@ void Actor::Init(const JobDesc* job_desc, const TaskProto& task_proto,
   TakeOverNaiveProduced(task_proto.produced_regst_desc());
   InitBnInOp2BlobInfo(task_proto);
   VirtualActorInit(task_proto);
+  InitAdaptiveRegstNum(task_proto);
 }
 
 void Actor::TakeOverInplaceConsumedAndProduced(
@@ -412,10 +447,162 @@ void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
   }
 }
 
+void Actor::InitAdaptiveRegstNum(const TaskProto& task_proto) {
+  is_write_stalled_ = false;
+  stall_begin_time_ = -1;
+  window_begin_time_ = GetCurTime();
+  window_act_cnt_ = 0;
+  if (Global<RegstMgr>::Get()->IsAdaptiveRegstNumEnabled() == false) { return; }
+  if (task_proto.task_type() != TaskType::kNormalForward) { return; }
+  for (const auto& pair : task_proto.produced_regst_desc()) {
+    const RegstDescProto& regst_desc = pair.second;
+    const int64_t regst_desc_id = regst_desc.regst_desc_id();
+    if (naive_produced_rs_.HasRegstDescId(regst_desc_id) == false) { continue; }
+    if (IsAdaptiveRegstDesc(regst_desc) == false) { continue; }
+    AdaptiveRegstDescState state;
+    state.planned_num = regst_desc.register_num();
+    state.live_num = regst_desc.register_num();
+    state.max_num = regst_desc.max_register_num();
+    state.retiring_cnt = 0;
+    state.write_starved_time = 0;
+    state.calm_window_cnt = 0;
+    CHECK(adaptive_regst_desc_id2state_.emplace(regst_desc_id, state).second);
+    Global<RegstMgr>::Get()->RegisterAdaptiveRegstDesc(
+        regst_desc_id, CostDB::RegstKey(task_proto, pair.first), regst_desc.register_num());
+  }
+  if (adaptive_regst_desc_id2state_.empty()) { return; }
+  for (const auto& pair : task_proto.consumed_regst_desc_id()) {
+    if (pair.first == "in_ctrl") { continue; }
+    for (int64_t regst_desc_id : pair.second.regst_desc_id()) {
+      if (naive_consumed_rs_.HasRegstDescId(regst_desc_id) == false) { continue; }
+      consumed_regst_desc_id2read_starved_time_[regst_desc_id] = 0;
+    }
+  }
+}
+
+void Actor::UpdtStallStatOnWakeUp() {
+  if (stall_begin_time_ < 0) { return; }
+  const double stall_time = GetCurTime() - stall_begin_time_;
+  for (int64_t regst_desc_id : stalled_regst_desc_ids_) {
+    if (is_write_stalled_) {
+      adaptive_regst_desc_id2state_.at(regst_desc_id).write_starved_time += stall_time;
+    } else {
+      consumed_regst_desc_id2read_starved_time_.at(regst_desc_id) += stall_time;
+    }
+  }
+  stalled_regst_desc_ids_.clear();
+  stall_begin_time_ = -1;
+}
+
+void Actor::UpdtStallStatOnSleep() {
+  const bool is_read_ready = IsReadReady();
+  const bool is_write_ready = IsWriteReady();
+  // only the stalls caused by one side are attributed to regst descs
+  if (is_read_ready && !is_write_ready) {
+    is_write_stalled_ = true;
+    for (const auto& pair : adaptive_regst_desc_id2state_) {
+      if (naive_produced_rs_.RegstDeq4RegstDescId(pair.first).empty()) {
+        stalled_regst_desc_ids_.push_back(pair.first);
+      }
+    }
+  } else if (!is_read_ready && is_write_ready) {
+    is_write_stalled_ = false;
+    for (const auto& pair : consumed_regst_desc_id2read_starved_time_) {
+      if (naive_consumed_rs_.RegstDeq4RegstDescId(pair.first).empty()) {
+        stalled_regst_desc_ids_.push_back(pair.first);
+      }
+    }
+  }
+  if (stalled_regst_desc_ids_.empty() == false) { stall_begin_time_ = GetCurTime(); }
+}
+
+void Actor::TryAdaptRegstNum() {
+  window_act_cnt_ += 1;
+  if (window_act_cnt_ < kAdaptiveRegstWindowActNum) { return; }
+  const double cur_time = GetCurTime();
+  const double window_time = cur_time - window_begin_time_;
+  double read_starved_time = 0;
+  for (auto& pair : consumed_regst_desc_id2read_starved_time_) {
+    read_starved_time += pair.second;
+    pair.second = 0;
+  }
+  for (auto& pair : adaptive_regst_desc_id2state_) {
+    const int64_t regst_desc_id = pair.first;
+    AdaptiveRegstDescState* state = &pair.second;
+    const double write_stall_ratio = window_time > 0 ? state->write_starved_time / window_time : 0;
+    const int64_t last_live_num = state->live_num;
+    // consumers slower than producers keep the producer waiting whatever the regst num is, so
+    // grow only if the actor waits more on writing than on reading
+    if (write_stall_ratio > kAdaptiveRegstGrowStallRatio
+        && state->write_starved_time > read_starved_time) {
+      state->calm_window_cnt = 0;
+      if (state->retiring_cnt > 0) {
+        state->retiring_cnt -= 1;
+        state->live_num += 1;
+      } else if (state->live_num < state->max_num) {
+        Regst* regst = Global<RegstMgr>::Get()->TryNewAdaptiveRegst(regst_desc_id);
+        if (regst != nullptr) {
+          produced_regsts_.at(regst_desc_id).emplace_back(regst);
+          produced_regst2reading_cnt_[regst] = 0;
+          adaptive_regsts_.insert(regst);
+          CHECK_EQ(0, naive_produced_rs_.TryPushBackRegst(regst));
+          state->live_num += 1;
+        }
+      }
+    } else if (write_stall_ratio < kAdaptiveRegstShrinkStallRatio) {
+      state->calm_window_cnt += 1;
+      if (state->calm_window_cnt >= kAdaptiveRegstShrinkCalmWindowNum
+          && state->live_num > state->planned_num) {
+        // the regst is deleted when it comes back from consumers
+        state->retiring_cnt += 1;
+        state->live_num -= 1;
+        state->calm_window_cnt = 0;
+      }
+    } else {
+      state->calm_window_cnt = 0;
+    }
+    state->write_starved_time = 0;
+    if (state->live_num != last_live_num) {
+      Global<RegstMgr>::Get()->UpdateAdaptiveRegstNum(regst_desc_id, state->live_num);
+      LOG(INFO) << "actor " << actor_id_ << " adapt register_num of regst_desc " << regst_desc_id
+                << " from " << last_live_num << " to " << state->live_num;
+    }
+  }
+  window_begin_time_ = cur_time;
+  window_act_cnt_ = 0;
+}
+
+int Actor::TryRetireAdaptiveRegst(Regst* regst) {
+  auto state_it = adaptive_regst_desc_id2state_.find(regst->regst_desc_id());
+  if (state_it == adaptive_regst_desc_id2state_.end() || state_it->second.retiring_cnt == 0) {
+    return -1;
+  }
+  if (adaptive_regsts_.erase(regst) == 0) { return -1; }
+  std::vector<std::unique_ptr<Regst>>& regsts = produced_regsts_.at(regst->regst_desc_id());
+  auto regst_it = std::find_if(regsts.begin(), regsts.end(),
+                               [&](const std::unique_ptr<Regst>& ptr) {
+                                 return ptr.get() == regst;
+                               });
+  CHECK(regst_it != regsts.end());
+  regst_it->release();
+  regsts.erase(regst_it);
+  produced_regst2reading_cnt_.erase(regst);
+  state_it->second.retiring_cnt -= 1;
+  Global<RegstMgr>::Get()->DeleteAdaptiveRegst(regst);
+  return 0;
+}
+
 void Actor::ActUntilFail() {
+  const bool is_adaptive_regst_num = adaptive_regst_desc_id2state_.empty() == false;
+  if (is_adaptive_regst_num) { UpdtStallStatOnWakeUp(); }
   while (IsReadReady() && IsWriteReady()) {
     act_id_ += 1;
-    TryLogActEvent([&] { Act(); });
+    RecordTimelineBeforeAct();
+    {
+      profiler::TimelineEventGuard timeline_event_guard(timeline_name_id_);
+      TryLogActEvent([&] { Act(); });
+    }
+    if (profiler::IsTimelineEnabled()) { last_act_end_ns_ = profiler::TimelineNow(); }
 
     AsyncSendCustomizedProducedRegstMsgToConsumer();
     AsyncSendNaiveProducedRegstMsgToConsumer();
@@ -426,7 +613,23 @@ void Actor::ActUntilFail() {
     AsyncRetInplaceConsumedRegstIfNoConsumer();
 
     AsyncSendQueuedMsg();
+    if (is_adaptive_regst_num) { TryAdaptRegstNum(); }
+  }
+  if (is_adaptive_regst_num) { UpdtStallStatOnSleep(); }
+}
+
+void Actor::RecordTimelineBeforeAct() {
+  // the first act after a msg is the one the msg made ready, the acts that follow it in the same
+  // ActUntilFail were made ready by the acts before them
+  if (last_msg_enqueue_ns_ < 0 || !profiler::IsTimelineEnabled()) { return; }
+  const int64_t now = profiler::TimelineNow();
+  // a msg queued while the actor was acting did not make it ready before that act ended
+  const int64_t ready_ns = std::max(last_msg_enqueue_ns_, last_act_end_ns_);
+  if (last_act_end_ns_ >= 0 && last_act_end_ns_ < ready_ns) {
+    profiler::RecordTimelineStatistic(wait_timeline_name_id_, last_act_end_ns_, ready_ns);
   }
+  profiler::RecordTimelineStatistic(ready_timeline_name_id_, ready_ns, now);
+  last_msg_enqueue_ns_ = -1;
 }
 
 void Actor::AsyncSendNaiveProducedRegstMsgToConsumer() {
@@ -681,6 +884,13 @@ int Actor::TryUpdtStateAsProducedRegst(Regst* regst) {
   total_reading_cnt_ -= 1;
   if (reading_cnt_it->second != 0) { return 0; }
 
+  int64_t& expected_act_id = produced_regst2expected_act_id_[regst->regst_desc_id()];
+  if (expected_act_id >= 0 && CheckOutputActId(regst->regst_desc_id())) {
+    CHECK_EQ(regst->act_id(), expected_act_id);
+  }
+  expected_act_id = regst->act_id() + ActNumForEachOutput(regst->regst_desc_id());
+
+  if (TryRetireAdaptiveRegst(regst) == 0) { return 0; }
   if (inplace_produced_rs_.TryPushBackRegst(regst) == 0) {
     int64_t in_regst_desc_id = inplace_regst_desc_id_out2in_.at(regst->regst_desc_id());
     Regst* in_regst = inplace_consumed_rs_.Front(in_regst_desc_id);
@@ -690,12 +900,6 @@ int Actor::TryUpdtStateAsProducedRegst(Regst* regst) {
   } else if (naive_produced_rs_.TryPushBackRegst(regst) != 0) {
     UpdtStateAsCustomizedProducedRegst(regst);
   }
-
-  int64_t& expected_act_id = produced_regst2expected_act_id_[regst->regst_desc_id()];
-  if (expected_act_id >= 0 && CheckOutputActId(regst->regst_desc_id())) {
-    CHECK_EQ(regst->act_id(), expected_act_id);
-  }
-  expected_act_id = regst->act_id() + ActNumForEachOutput(regst->regst_desc_id());
   return 0;
 }
 
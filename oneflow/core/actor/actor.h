@@ -41,7 +41,10 @@ class Actor {
 
   // 1: success, and actor finish
   // 0: success, and actor not finish
-  int ProcessMsg(const ActorMsg& msg) { return (this->*msg_handler_)(msg); }
+  int ProcessMsg(const ActorMsg& msg) {
+    last_msg_enqueue_ns_ = msg.enqueue_ns();
+    return (this->*msg_handler_)(msg);
+  }
 
   int64_t machine_id() const { return Global<IDMgr>::Get()->MachineId4ActorId(actor_id_); }
   int64_t thrd_id() const { return Global<IDMgr>::Get()->ThrdId4ActorId(actor_id_); }
@@ -166,6 +169,8 @@ class Actor {
 
   // Act
   void ActUntilFail();
+  // records the wait and ready spans that end with this act
+  void RecordTimelineBeforeAct();
   virtual void Act() { UNIMPLEMENTED(); }
   virtual int64_t ActNumForEachOutput(int64_t regst_desc_id) const { return 1; }
   virtual bool CheckOutputActId(int64_t regst_desc_id) const {
@@ -185,6 +190,14 @@ class Actor {
   void TakeOverNaiveProduced(const PbMap<std::string, RegstDescProto>& produced_ids);
   void InitBnInOp2BlobInfo(const TaskProto& task_proto);
 
+  // Adaptive Regst Num
+  void InitAdaptiveRegstNum(const TaskProto& task_proto);
+  void UpdtStallStatOnWakeUp();
+  void UpdtStallStatOnSleep();
+  void TryAdaptRegstNum();
+  // 0: the regst is retired and deleted, -1: the regst is kept
+  int TryRetireAdaptiveRegst(Regst* regst);
+
   // Send Msgs
   void AsyncSendNaiveProducedRegstMsgToConsumer();
   virtual void VirtualAsyncSendNaiveProducedRegstMsgToConsumer();
@@ -221,6 +234,11 @@ class Actor {
   const JobDesc* job_desc_;
   int64_t actor_id_;
   int64_t act_id_;
+  int32_t timeline_name_id_;
+  int32_t wait_timeline_name_id_;
+  int32_t ready_timeline_name_id_;
+  int64_t last_msg_enqueue_ns_;
+  int64_t last_act_end_ns_;
   std::unique_ptr<ParallelContext> parallel_ctx_;
   std::vector<ExecKernel> exec_kernel_vec_;
   HashMap<std::string, std::vector<int64_t>> name2regst_desc_id_;
@@ -251,6 +269,23 @@ class Actor {
   std::deque<ActorMsg> async_msg_queue_;
   bool is_kernel_launch_synchronized_;
   std::vector<int64_t> tmp_regst_desc_id_vec_;
+
+  struct AdaptiveRegstDescState {
+    int64_t planned_num;
+    int64_t live_num;
+    int64_t max_num;
+    int64_t retiring_cnt;
+    double write_starved_time;
+    int64_t calm_window_cnt;
+  };
+  HashMap<int64_t, AdaptiveRegstDescState> adaptive_regst_desc_id2state_;
+  HashMap<int64_t, double> consumed_regst_desc_id2read_starved_time_;
+  HashSet<Regst*> adaptive_regsts_;
+  std::vector<int64_t> stalled_regst_desc_ids_;
+  bool is_write_stalled_;
+  double stall_begin_time_;
+  double window_begin_time_;
+  int64_t window_act_cnt_;
 };
 
 std::unique_ptr<Actor> NewActor(const TaskProto&, const ThreadCtx&);
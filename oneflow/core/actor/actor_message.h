@@ -56,6 +56,11 @@ class ActorMsg final {
   void* comm_net_token() const;
   bool has_sole_empty_tensor_in_sole_tensor_list() const;
   int64_t eord_regst_desc_id() const;
+  // when the msg was queued to the thread of dst actor, -1 unless the timeline is enabled
+  int64_t enqueue_ns() const { return enqueue_ns_; }
+
+  // Setters
+  void set_enqueue_ns(int64_t val) { enqueue_ns_ = val; }
 
   // Serialize
   template<typename StreamT>
@@ -77,6 +82,7 @@ class ActorMsg final {
 
   int64_t src_actor_id_;
   int64_t dst_actor_id_;
+  int64_t enqueue_ns_ = -1;
   ActorMsgType msg_type_;
   union {
     ActorCmd actor_cmd_;
@@ -0,0 +1,154 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/actor/actor.h"
+#include "oneflow/core/register/adaptive_regst_test_util.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+const int64_t kRegstDescId = kAdaptiveRegstTestRegstDescId;
+
+class AdaptiveRegstTestActor final : public Actor {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(AdaptiveRegstTestActor);
+  AdaptiveRegstTestActor() = default;
+  ~AdaptiveRegstTestActor() override = default;
+
+  // runs the acts of one stall statistics window, stalled on writing the given ratio of it
+  void RunOneWindow(double write_stall_ratio) {
+    const double window_time = 1e9;
+    window_begin_time_ = GetCurTime() - window_time;
+    adaptive_regst_desc_id2state_.at(kRegstDescId).write_starved_time =
+        write_stall_ratio * window_time;
+    do { TryAdaptRegstNum(); } while (window_act_cnt_ != 0);
+  }
+  int Retire(Regst* regst) { return TryRetireAdaptiveRegst(regst); }
+
+  bool IsAdaptive() const { return adaptive_regst_desc_id2state_.empty() == false; }
+  int64_t LiveNum() const { return adaptive_regst_desc_id2state_.at(kRegstDescId).live_num; }
+  int64_t RetiringCnt() const {
+    return adaptive_regst_desc_id2state_.at(kRegstDescId).retiring_cnt;
+  }
+  size_t ProducedRegstNum() const { return produced_regsts_.at(kRegstDescId).size(); }
+  Regst* ProducedRegst(int64_t i) const { return produced_regsts_.at(kRegstDescId).at(i).get(); }
+  size_t WriteableRegstNum() const {
+    return naive_produced_rs_.RegstDeq4RegstDescId(kRegstDescId).size();
+  }
+  // pops the front writeable regst, as if it were sent to the consumers
+  Regst* SendWriteableRegst() {
+    Regst* regst = naive_produced_rs_.Front(kRegstDescId);
+    CHECK_EQ(0, naive_produced_rs_.TryPopFrontRegst(kRegstDescId));
+    return regst;
+  }
+
+ private:
+  void InitDeviceCtx(const ThreadCtx&) override {}
+};
+
+std::unique_ptr<AdaptiveRegstTestActor> NewAdaptiveRegstTestActor() {
+  std::unique_ptr<AdaptiveRegstTestActor> actor(new AdaptiveRegstTestActor());
+  actor->Init(nullptr, AdaptiveRegstTestTask(), ThreadCtx());
+  return actor;
+}
+
+}  // namespace
+
+TEST(Actor, adaptive_regst_num_disabled_without_budget) {
+  AdaptiveRegstTestScope scope(0);
+  std::unique_ptr<AdaptiveRegstTestActor> actor = NewAdaptiveRegstTestActor();
+  ASSERT_FALSE(actor->IsAdaptive());
+}
+
+TEST(Actor, try_adapt_regst_num_grows_on_write_stall) {
+  AdaptiveRegstTestScope scope(4);
+  std::unique_ptr<AdaptiveRegstTestActor> actor = NewAdaptiveRegstTestActor();
+  ASSERT_TRUE(actor->IsAdaptive());
+  ASSERT_EQ(actor->LiveNum(), 1);
+  actor->RunOneWindow(0.01);
+  ASSERT_EQ(actor->LiveNum(), 1);
+  actor->RunOneWindow(0.5);
+  ASSERT_EQ(actor->LiveNum(), 2);
+  ASSERT_EQ(actor->ProducedRegstNum(), 2);
+  ASSERT_EQ(actor->WriteableRegstNum(), 2);
+  // no more than max_register_num
+  FOR_RANGE(int64_t, i, 0, kAdaptiveRegstTestMaxRegisterNum) { actor->RunOneWindow(0.5); }
+  ASSERT_EQ(actor->LiveNum(), kAdaptiveRegstTestMaxRegisterNum);
+  ASSERT_EQ(actor->ProducedRegstNum(), kAdaptiveRegstTestMaxRegisterNum);
+}
+
+TEST(Actor, try_adapt_regst_num_stops_at_budget) {
+  AdaptiveRegstTestScope scope(1);
+  std::unique_ptr<AdaptiveRegstTestActor> actor = NewAdaptiveRegstTestActor();
+  actor->RunOneWindow(0.5);
+  actor->RunOneWindow(0.5);
+  ASSERT_EQ(actor->LiveNum(), 2);
+  ASSERT_EQ(actor->ProducedRegstNum(), 2);
+}
+
+TEST(Actor, try_retire_adaptive_regst) {
+  AdaptiveRegstTestScope scope(1);
+  std::unique_ptr<AdaptiveRegstTestActor> actor = NewAdaptiveRegstTestActor();
+  actor->RunOneWindow(0.5);
+  ASSERT_EQ(actor->LiveNum(), 2);
+  Regst* planned_regst = actor->ProducedRegst(0);
+  Regst* adaptive_regst = actor->ProducedRegst(1);
+  ASSERT_EQ(actor->SendWriteableRegst(), planned_regst);
+  ASSERT_EQ(actor->SendWriteableRegst(), adaptive_regst);
+  // regsts are kept unless retiring
+  ASSERT_EQ(actor->Retire(adaptive_regst), -1);
+  // shrink after enough calm windows, the regst is retired when it comes back
+  actor->RunOneWindow(0);
+  actor->RunOneWindow(0);
+  actor->RunOneWindow(0);
+  ASSERT_EQ(actor->LiveNum(), 2);
+  actor->RunOneWindow(0);
+  ASSERT_EQ(actor->LiveNum(), 1);
+  ASSERT_EQ(actor->RetiringCnt(), 1);
+  ASSERT_EQ(actor->ProducedRegstNum(), 2);
+  // planned regsts are never retired
+  ASSERT_EQ(actor->Retire(planned_regst), -1);
+  ASSERT_EQ(actor->Retire(adaptive_regst), 0);
+  ASSERT_EQ(actor->RetiringCnt(), 0);
+  ASSERT_EQ(actor->ProducedRegstNum(), 1);
+  ASSERT_EQ(actor->ProducedRegst(0), planned_regst);
+  // the budget of the retired regst is available again
+  actor->RunOneWindow(0.5);
+  ASSERT_EQ(actor->LiveNum(), 2);
+  ASSERT_EQ(actor->ProducedRegstNum(), 2);
+}
+
+TEST(Actor, write_stall_cancels_retiring) {
+  AdaptiveRegstTestScope scope(1);
+  std::unique_ptr<AdaptiveRegstTestActor> actor = NewAdaptiveRegstTestActor();
+  actor->RunOneWindow(0.5);
+  Regst* adaptive_regst = actor->ProducedRegst(1);
+  FOR_RANGE(int64_t, i, 0, 4) { actor->RunOneWindow(0); }
+  ASSERT_EQ(actor->LiveNum(), 1);
+  ASSERT_EQ(actor->RetiringCnt(), 1);
+  // the retiring regst is taken back instead of a new one
+  actor->RunOneWindow(0.5);
+  ASSERT_EQ(actor->LiveNum(), 2);
+  ASSERT_EQ(actor->RetiringCnt(), 0);
+  ASSERT_EQ(actor->ProducedRegstNum(), 2);
+  ASSERT_EQ(actor->Retire(adaptive_regst), -1);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/env_desc.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/profiler/timeline.h"
 
 namespace oneflow {
 
@@ -38,7 +39,14 @@ void CommNet::Read(void* actor_read_id, int64_t src_machine_id, void* src_token,
   auto actor_read_ctx = static_cast<ActorReadContext*>(actor_read_id);
   ReadContext* read_ctx = new ReadContext;
   read_ctx->actor_read_ctx = actor_read_ctx;
+  read_ctx->timeline_name_id = -1;
   auto do_read = [this, read_ctx, src_machine_id, src_token, dst_token]() {
+    if (profiler::IsTimelineEnabled()) {
+      read_ctx->timeline_name_id =
+          profiler::TimelineNameId(profiler::kTimelineCommNetRead,
+                                   "read from machine " + std::to_string(src_machine_id));
+      read_ctx->timeline_begin_ns = profiler::TimelineNow();
+    }
     DoRead(read_ctx, src_machine_id, src_token, dst_token);
   };
   AddWorkToStream(actor_read_id, do_read, true);
@@ -50,6 +58,10 @@ void CommNet::AddReadCallBack(void* actor_read_id, std::function<void()> callbac
 
 void CommNet::ReadDone(void* read_id) {
   ReadContext* read_ctx = static_cast<ReadContext*>(read_id);
+  if (read_ctx->timeline_name_id >= 0) {
+    profiler::RecordTimelineEvent(read_ctx->timeline_name_id, read_ctx->timeline_begin_ns,
+                                  profiler::TimelineNow());
+  }
   ActorReadContext* actor_read_ctx = read_ctx->actor_read_ctx;
   CommNetItem item;
   {
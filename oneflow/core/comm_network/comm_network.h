@@ -68,6 +68,8 @@ class CommNet {
   struct ActorReadContext;
   struct ReadContext {
     ActorReadContext* actor_read_ctx;
+    int32_t timeline_name_id;
+    int64_t timeline_begin_ns;
   };
   struct ActorReadContext {
     std::mutex waiting_list_mtx;
@@ -84,12 +84,19 @@ EpollCommNet::~EpollCommNet() {
     LOG(INFO) << "CommNet Thread " << i << " finish";
     pollers_[i]->Stop();
   }
+  // joins the compression workers, which send on the sockets
+  body_compressor_.reset();
   // TODO(chengcheng): change to OF_ENV_BARRIER
   OF_SESSION_BARRIER();
   for (IOEventPoller* poller : pollers_) { delete poller; }
   for (auto& pair : sockfd2helper_) { delete pair.second; }
 }
 
+void EpollCommNet::UnRegisterMemory(void* token) {
+  if (body_compressor_) { body_compressor_->EraseMemDesc(static_cast<SocketMemDesc*>(token)); }
+  CommNetIf<SocketMemDesc>::UnRegisterMemory(token);
+}
+
 void EpollCommNet::RegisterMemoryDone() {
   // do nothing
 }
@@ -122,6 +129,7 @@ SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
 EpollCommNet::EpollCommNet() {
   pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
+  InitBodyCompressor();
   InitSockets();
   for (IOEventPoller* poller : pollers_) { poller->Start(); }
 }
@@ -129,10 +137,19 @@ EpollCommNet::EpollCommNet() {
 EpollCommNet::EpollCommNet(const Plan& plan) : CommNetIf(plan) {
   pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
+  InitBodyCompressor();
   InitSockets();
   for (IOEventPoller* poller : pollers_) { poller->Start(); }
 }
 
+void EpollCommNet::InitBodyCompressor() {
+  const size_t threshold_byte =
+      Global<ResourceDesc, ForSession>::Get()->comm_net_compression_threshold_byte();
+  if (threshold_byte > 0) {
+    body_compressor_.reset(new SocketBodyCompressor(threshold_byte, pollers_.size()));
+  }
+}
+
 void EpollCommNet::InitSockets() {
   int64_t this_machine_id = Global<MachineCtx>::Get()->this_machine_id();
   auto this_machine = Global<ResourceDesc, ForSession>::Get()->machine(this_machine_id);
@@ -17,6 +17,7 @@ limitations under the License.
 #define ONEFLOW_CORE_COMM_NETWORK_EPOLL_EPOLL_COMM_NETWORK_H_
 
 #include "oneflow/core/comm_network/comm_network.h"
+#include "oneflow/core/comm_network/epoll/socket_body_compressor.h"
 #include "oneflow/core/comm_network/epoll/socket_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
 
@@ -33,12 +34,16 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
     Global<CommNet>::SetAllocated(new EpollCommNet(plan));
   }
 
+  void UnRegisterMemory(void* token) override;
   void RegisterMemoryDone() override;
 
   void SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg) override;
   void SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg);
   void SendTransportMsg(int64_t dst_machine_id, const TransportMsg& msg);
 
+  // nullptr if compression is disabled
+  SocketBodyCompressor* body_compressor() const { return body_compressor_.get(); }
+
  private:
   SocketMemDesc* NewMemDesc(void* ptr, size_t byte_size) override;
 
@@ -46,12 +51,14 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   EpollCommNet();
   DEPRECATED EpollCommNet(const Plan& plan);
   void InitSockets();
+  void InitBodyCompressor();
   SocketHelper* GetSocketHelper(int64_t machine_id);
   void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) override;
 
   std::vector<IOEventPoller*> pollers_;
   std::vector<int> machine_id2sockfd_;
   HashMap<int, SocketHelper*> sockfd2helper_;
+  std::unique_ptr<SocketBodyCompressor> body_compressor_;
 };
 
 }  // namespace oneflow
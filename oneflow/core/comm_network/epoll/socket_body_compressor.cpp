@@ -0,0 +1,114 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/socket_body_compressor.h"
+#include "oneflow/core/common/lz4_util.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace {
+
+constexpr size_t kCompressChunkSize = 256 * 1024;
+// bodies compressed to more than this ratio of their size are sent raw
+constexpr double kMaxCompressRatio = 0.8;
+constexpr int64_t kRawTransferNumAfterPoorRatio = 16;
+
+}  // namespace
+
+void SocketBodyCompressor::AsyncTryCompress(
+    const SocketMemDesc* mem_desc, const std::function<void(std::vector<char>*, size_t)>& Handler) {
+  if (mem_desc->byte_size < threshold_byte_) {
+    Handler(nullptr, 0);
+    return;
+  }
+  thread_pool_.AddWork([this, mem_desc, Handler]() {
+    size_t compressed_size = 0;
+    std::vector<char>* compressed_body = TryCompress(mem_desc, &compressed_size);
+    Handler(compressed_body, compressed_size);
+  });
+}
+
+std::vector<char>* SocketBodyCompressor::TryCompress(const SocketMemDesc* mem_desc,
+                                                     size_t* compressed_size) {
+  *compressed_size = 0;
+  std::unique_ptr<std::vector<char>> compressed_body;
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    auto it = mem_desc2remaining_raw_transfer_num_.find(mem_desc);
+    if (it != mem_desc2remaining_raw_transfer_num_.end()) {
+      if (it->second > 0) {
+        it->second -= 1;
+        return nullptr;
+      }
+      mem_desc2remaining_raw_transfer_num_.erase(it);
+    }
+  }
+  compressed_body.reset(
+      AcquireCompressedBody(Lz4ChunkedCompressBound(mem_desc->byte_size, kCompressChunkSize)));
+  const char* body = static_cast<const char*>(mem_desc->mem_ptr);
+  *compressed_size = Lz4ChunkedCompress(body, mem_desc->byte_size, kCompressChunkSize,
+                                        compressed_body->data(), &MultiThreadLoop);
+  if (*compressed_size > mem_desc->byte_size * kMaxCompressRatio) {
+    *compressed_size = 0;
+    std::unique_lock<std::mutex> lck(mutex_);
+    mem_desc2remaining_raw_transfer_num_[mem_desc] = kRawTransferNumAfterPoorRatio;
+    free_buffers_.push_back(std::move(compressed_body));
+    return nullptr;
+  }
+  return compressed_body.release();
+}
+
+void SocketBodyCompressor::ReleaseCompressedBody(std::vector<char>* compressed_body) {
+  std::unique_lock<std::mutex> lck(mutex_);
+  free_buffers_.emplace_back(compressed_body);
+}
+
+void SocketBodyCompressor::EraseMemDesc(const SocketMemDesc* mem_desc) {
+  std::unique_lock<std::mutex> lck(mutex_);
+  mem_desc2remaining_raw_transfer_num_.erase(mem_desc);
+}
+
+std::vector<char>* SocketBodyCompressor::AcquireCompressedBody(size_t size) {
+  std::unique_ptr<std::vector<char>> compressed_body;
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    if (!free_buffers_.empty()) {
+      compressed_body = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+    }
+  }
+  if (!compressed_body) { compressed_body.reset(new std::vector<char>()); }
+  if (compressed_body->size() < size) { compressed_body->resize(size); }
+  return compressed_body.release();
+}
+
+void SocketBodyCompressor::AsyncDecompress(std::vector<char>* compressed_body,
+                                           size_t compressed_size, const SocketMemDesc* mem_desc,
+                                           const std::function<void()>& Handler) {
+  thread_pool_.AddWork([this, compressed_body, compressed_size, mem_desc, Handler]() {
+    Lz4ChunkedDecompress(compressed_body->data(), compressed_size,
+                         static_cast<char*>(mem_desc->mem_ptr), mem_desc->byte_size,
+                         &MultiThreadLoop);
+    ReleaseCompressedBody(compressed_body);
+    Handler();
+  });
+}
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
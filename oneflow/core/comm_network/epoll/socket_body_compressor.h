@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMM_NETWORK_EPOLL_SOCKET_BODY_COMPRESSOR_H_
+#define ONEFLOW_CORE_COMM_NETWORK_EPOLL_SOCKET_BODY_COMPRESSOR_H_
+
+#include "oneflow/core/common/platform.h"
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+// Compresses the bodies of RequestRead msgs, i.e. the regsts read by other machines, with
+// chunked lz4 whose chunks are compressed and decompressed by the thread pool.
+//
+// A regst whose body does not shrink enough is sent raw for its next transfers before it is tried
+// again, as a regst holds similar contents from one piece to the next.
+//
+// Bodies are compressed and decompressed by workers of the compressor rather than by the pollers,
+// which would stop reading and writing their sockets for as long as that takes.
+class SocketBodyCompressor final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SocketBodyCompressor);
+  SocketBodyCompressor(size_t threshold_byte, int32_t thread_num)
+      : threshold_byte_(threshold_byte), thread_pool_(thread_num) {}
+  ~SocketBodyCompressor() = default;
+
+  // Calls Handler with the compressed body and its size, or with nullptr and 0 if the body is to
+  // be sent raw. Handler runs on a worker unless the body is below the threshold. The compressed
+  // body is handed back by ReleaseCompressedBody once it is written.
+  void AsyncTryCompress(const SocketMemDesc* mem_desc,
+                        const std::function<void(std::vector<char>*, size_t)>& Handler);
+  void ReleaseCompressedBody(std::vector<char>* compressed_body);
+  // Forgets mem_desc, which is about to be unregistered and freed
+  void EraseMemDesc(const SocketMemDesc* mem_desc);
+
+  // Returns a buffer of at least size bytes for a received compressed body
+  std::vector<char>* AcquireCompressedBody(size_t size);
+  // Decompresses the body into mem_desc on a worker, hands the buffer back and then calls Handler
+  void AsyncDecompress(std::vector<char>* compressed_body, size_t compressed_size,
+                       const SocketMemDesc* mem_desc, const std::function<void()>& Handler);
+
+ private:
+  std::vector<char>* TryCompress(const SocketMemDesc* mem_desc, size_t* compressed_size);
+
+  const size_t threshold_byte_;
+  std::mutex mutex_;
+  HashMap<const SocketMemDesc*, int64_t> mem_desc2remaining_raw_transfer_num_;
+  std::vector<std::unique_ptr<std::vector<char>>> free_buffers_;
+  ThreadPool thread_pool_;
+};
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
+
+#endif  // ONEFLOW_CORE_COMM_NETWORK_EPOLL_SOCKET_BODY_COMPRESSOR_H_
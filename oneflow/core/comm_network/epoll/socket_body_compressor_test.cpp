@@ -0,0 +1,105 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/socket_body_compressor.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+#include <random>
+
+namespace oneflow {
+
+namespace {
+
+constexpr size_t kBodySize = 1024 * 1024;
+
+// Returns the size of the compressed body, or 0 if the body is to be sent raw
+size_t CompressAndCopy(SocketBodyCompressor* compressor, const SocketMemDesc* mem_desc,
+                       std::vector<char>* copied) {
+  size_t ret = 0;
+  BlockingCounter bc(1);
+  compressor->AsyncTryCompress(
+      mem_desc, [&](std::vector<char>* compressed_body, size_t compressed_size) {
+        if (compressed_body != nullptr) {
+          copied->assign(compressed_body->data(), compressed_body->data() + compressed_size);
+          compressor->ReleaseCompressedBody(compressed_body);
+        }
+        ret = compressed_size;
+        bc.Decrease();
+      });
+  bc.WaitUntilCntEqualZero();
+  return ret;
+}
+
+void Decompress(SocketBodyCompressor* compressor, const std::vector<char>& compressed,
+                const SocketMemDesc* mem_desc) {
+  std::vector<char>* compressed_body = compressor->AcquireCompressedBody(compressed.size());
+  std::copy(compressed.begin(), compressed.end(), compressed_body->begin());
+  BlockingCounter bc(1);
+  compressor->AsyncDecompress(compressed_body, compressed.size(), mem_desc,
+                              [&bc]() { bc.Decrease(); });
+  bc.WaitUntilCntEqualZero();
+}
+
+}  // namespace
+
+TEST(SocketBodyCompressor, skip_after_poor_ratio) {
+  Global<ThreadPool>::New(2);
+  {
+    SocketBodyCompressor compressor(kBodySize / 2, 2);
+    std::vector<char> body(kBodySize);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> dis(0, 255);
+    for (char& c : body) { c = static_cast<char>(dis(gen)); }
+    SocketMemDesc mem_desc{body.data(), body.size()};
+    std::vector<char> compressed;
+    // random bytes do not shrink, so the body is sent raw
+    ASSERT_EQ(CompressAndCopy(&compressor, &mem_desc, &compressed), 0U);
+    // the body turns compressible but is not tried again for its next 16 transfers
+    std::fill(body.begin(), body.end(), 7);
+    FOR_RANGE(int64_t, i, 0, 16) {
+      ASSERT_EQ(CompressAndCopy(&compressor, &mem_desc, &compressed), 0U);
+    }
+    const size_t compressed_size = CompressAndCopy(&compressor, &mem_desc, &compressed);
+    ASSERT_GT(compressed_size, 0U);
+    ASSERT_LT(compressed_size, kBodySize / 2);
+    // and it keeps being compressed
+    ASSERT_GT(CompressAndCopy(&compressor, &mem_desc, &compressed), 0U);
+
+    std::vector<char> decompressed(kBodySize, 0);
+    SocketMemDesc dst_mem_desc{decompressed.data(), decompressed.size()};
+    Decompress(&compressor, compressed, &dst_mem_desc);
+    ASSERT_EQ(decompressed, body);
+  }
+  Global<ThreadPool>::Delete();
+}
+
+TEST(SocketBodyCompressor, small_body_is_sent_raw) {
+  Global<ThreadPool>::New(2);
+  {
+    SocketBodyCompressor compressor(kBodySize, 2);
+    std::vector<char> body(kBodySize / 2, 0);
+    SocketMemDesc mem_desc{body.data(), body.size()};
+    std::vector<char> compressed;
+    ASSERT_EQ(CompressAndCopy(&compressor, &mem_desc, &compressed), 0U);
+  }
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
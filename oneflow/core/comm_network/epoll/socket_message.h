@@ -58,6 +58,10 @@ struct RequestReadMsg {
   void* src_token;
   void* dst_token;
   void* read_id;
+  // the body is sent lz4 compressed to so many bytes unless it is 0
+  size_t compressed_body_size;
+  // only meaningful on the sending machine, which owns it until the body is written
+  std::vector<char>* compressed_body;
 };
 
 struct SocketMsg {
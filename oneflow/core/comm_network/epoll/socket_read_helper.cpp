@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/comm_network/epoll/socket_read_helper.h"
 #include "oneflow/core/actor/actor_message_bus.h"
 #include "oneflow/core/comm_network/epoll/epoll_comm_network.h"
+#include "oneflow/core/comm_network/epoll/socket_body_compressor.h"
 #include "oneflow/core/transport/transport.h"
 
 #ifdef OF_PLATFORM_POSIX
@@ -25,11 +26,13 @@ limitations under the License.
 namespace oneflow {
 
 SocketReadHelper::~SocketReadHelper() {
-  // do nothing
+  // the body compressor is gone by now, so a body cut off by the shutdown is not handed back
+  delete compressed_body_;
 }
 
 SocketReadHelper::SocketReadHelper(int sockfd) {
   sockfd_ = sockfd;
+  compressed_body_ = nullptr;
   SwitchToMsgHeadReadHandle();
 }
 
@@ -83,7 +86,19 @@ void SocketReadHelper::SetStatusWhenMsgHeadDone() {
 
 void SocketReadHelper::SetStatusWhenMsgBodyDone() {
   if (cur_msg_.msg_type == SocketMsgType::kRequestRead) {
-    Global<EpollCommNet>::Get()->ReadDone(cur_msg_.request_read_msg.read_id);
+    void* read_id = cur_msg_.request_read_msg.read_id;
+    if (cur_msg_.request_read_msg.compressed_body_size > 0) {
+      // the buffer goes with the body to the worker, the next body is read into another one
+      SocketBodyCompressor* compressor = Global<EpollCommNet>::Get()->body_compressor();
+      CHECK_NOTNULL(compressor);
+      compressor->AsyncDecompress(
+          compressed_body_, cur_msg_.request_read_msg.compressed_body_size,
+          static_cast<const SocketMemDesc*>(cur_msg_.request_read_msg.dst_token),
+          [read_id]() { Global<EpollCommNet>::Get()->ReadDone(read_id); });
+      compressed_body_ = nullptr;
+    } else {
+      Global<EpollCommNet>::Get()->ReadDone(read_id);
+    }
   }
   SwitchToMsgHeadReadHandle();
 }
@@ -94,15 +109,39 @@ void SocketReadHelper::SetStatusWhenRequestWriteMsgHeadDone() {
   msg_to_send.request_read_msg.src_token = cur_msg_.request_write_msg.src_token;
   msg_to_send.request_read_msg.dst_token = cur_msg_.request_write_msg.dst_token;
   msg_to_send.request_read_msg.read_id = cur_msg_.request_write_msg.read_id;
-  Global<EpollCommNet>::Get()->SendSocketMsg(cur_msg_.request_write_msg.dst_machine_id,
-                                             msg_to_send);
+  msg_to_send.request_read_msg.compressed_body_size = 0;
+  msg_to_send.request_read_msg.compressed_body = nullptr;
+  const int64_t dst_machine_id = cur_msg_.request_write_msg.dst_machine_id;
+  SocketBodyCompressor* compressor = Global<EpollCommNet>::Get()->body_compressor();
+  if (compressor == nullptr) {
+    Global<EpollCommNet>::Get()->SendSocketMsg(dst_machine_id, msg_to_send);
+  } else {
+    auto src_mem_desc = static_cast<const SocketMemDesc*>(msg_to_send.request_read_msg.src_token);
+    compressor->AsyncTryCompress(
+        src_mem_desc, [msg_to_send, dst_machine_id](std::vector<char>* compressed_body,
+                                                     size_t compressed_body_size) {
+          SocketMsg msg = msg_to_send;
+          msg.request_read_msg.compressed_body = compressed_body;
+          msg.request_read_msg.compressed_body_size = compressed_body_size;
+          Global<EpollCommNet>::Get()->SendSocketMsg(dst_machine_id, msg);
+        });
+  }
   SwitchToMsgHeadReadHandle();
 }
 
 void SocketReadHelper::SetStatusWhenRequestReadMsgHeadDone() {
-  auto mem_desc = static_cast<const SocketMemDesc*>(cur_msg_.request_read_msg.dst_token);
-  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr);
-  read_size_ = mem_desc->byte_size;
+  const size_t compressed_body_size = cur_msg_.request_read_msg.compressed_body_size;
+  if (compressed_body_size > 0) {
+    SocketBodyCompressor* compressor = Global<EpollCommNet>::Get()->body_compressor();
+    CHECK_NOTNULL(compressor);
+    compressed_body_ = compressor->AcquireCompressedBody(compressed_body_size);
+    read_ptr_ = compressed_body_->data();
+    read_size_ = compressed_body_size;
+  } else {
+    auto mem_desc = static_cast<const SocketMemDesc*>(cur_msg_.request_read_msg.dst_token);
+    read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr);
+    read_size_ = mem_desc->byte_size;
+  }
   cur_read_handle_ = &SocketReadHelper::MsgBodyReadHandle;
 }
 
@@ -53,6 +53,8 @@ class SocketReadHelper final {
   bool (SocketReadHelper::*cur_read_handle_)();
   char* read_ptr_;
   size_t read_size_;
+  // the buffer of the compressed body being read, acquired from the body compressor
+  std::vector<char>* compressed_body_;
 };
 
 }  // namespace oneflow
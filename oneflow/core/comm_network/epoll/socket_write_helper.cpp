@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/comm_network/epoll/socket_write_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/comm_network/epoll/epoll_comm_network.h"
 
 #ifdef OF_PLATFORM_POSIX
 
@@ -121,6 +122,11 @@ void SocketWriteHelper::SetStatusWhenMsgHeadDone() {
 }
 
 void SocketWriteHelper::SetStatusWhenMsgBodyDone() {
+  if (cur_msg_.msg_type == SocketMsgType::kRequestRead
+      && cur_msg_.request_read_msg.compressed_body != nullptr) {
+    Global<EpollCommNet>::Get()->body_compressor()->ReleaseCompressedBody(
+        cur_msg_.request_read_msg.compressed_body);
+  }
   cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
 }
 
@@ -131,8 +137,13 @@ void SocketWriteHelper::SetStatusWhenRequestWriteMsgHeadDone() {
 void SocketWriteHelper::SetStatusWhenRequestReadMsgHeadDone() {
   const void* src_token = cur_msg_.request_read_msg.src_token;
   auto src_mem_desc = static_cast<const SocketMemDesc*>(src_token);
-  write_ptr_ = reinterpret_cast<const char*>(src_mem_desc->mem_ptr);
-  write_size_ = src_mem_desc->byte_size;
+  if (cur_msg_.request_read_msg.compressed_body != nullptr) {
+    write_ptr_ = cur_msg_.request_read_msg.compressed_body->data();
+    write_size_ = cur_msg_.request_read_msg.compressed_body_size;
+  } else {
+    write_ptr_ = reinterpret_cast<const char*>(src_mem_desc->mem_ptr);
+    write_size_ = src_mem_desc->byte_size;
+  }
   cur_write_handle_ = &SocketWriteHelper::MsgBodyWriteHandle;
 }
 
@@ -38,6 +38,12 @@ class BlockingCounter final {
     std::unique_lock<std::mutex> lck(mtx_);
     cond_.wait(lck, [this]() { return cnt_val_ == 0; });
   }
+  // false if the count is not zero after timeout_us
+  bool WaitUntilCntEqualZero(int64_t timeout_us) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    return cond_.wait_for(lck, std::chrono::microseconds(timeout_us),
+                          [this]() { return cnt_val_ == 0; });
+  }
 
  private:
   std::mutex mtx_;
@@ -485,6 +485,50 @@ void cblas_zher2k(const enum CBLAS_ORDER Order, const enum CBLAS_UPLO Uplo,
 
 void cblas_xerbla(int p, const char *rout, const char *form, ...);
 
+#ifdef WITH_BLAS_PACKED_GEMM
+/*
+ * Packed gemm extension of mkl: an operand is packed once into the internal panel layout and
+ * reused by several gemm computations
+ */
+enum CBLAS_IDENTIFIER { CblasAMatrix = 161, CblasBMatrix = 162 };
+enum CBLAS_STORAGE { CblasPacked = 151 };
+
+size_t cblas_sgemm_pack_get_size(const enum CBLAS_IDENTIFIER identifier, const int M, const int N,
+                                 const int K);
+void cblas_sgemm_pack(const enum CBLAS_ORDER Order, const enum CBLAS_IDENTIFIER identifier,
+                      const enum CBLAS_TRANSPOSE Trans, const int M, const int N, const int K,
+                      const float alpha, const float *src, const int ld, float *dest);
+void cblas_sgemm_compute(const enum CBLAS_ORDER Order, const int TransA, const int TransB,
+                         const int M, const int N, const int K, const float *A, const int lda,
+                         const float *B, const int ldb, const float beta, float *C, const int ldc);
+size_t cblas_dgemm_pack_get_size(const enum CBLAS_IDENTIFIER identifier, const int M, const int N,
+                                 const int K);
+void cblas_dgemm_pack(const enum CBLAS_ORDER Order, const enum CBLAS_IDENTIFIER identifier,
+                      const enum CBLAS_TRANSPOSE Trans, const int M, const int N, const int K,
+                      const double alpha, const double *src, const int ld, double *dest);
+void cblas_dgemm_compute(const enum CBLAS_ORDER Order, const int TransA, const int TransB,
+                         const int M, const int N, const int K, const double *A, const int lda,
+                         const double *B, const int ldb, const double beta, double *C,
+                         const int ldc);
+#endif  // WITH_BLAS_PACKED_GEMM
+
+/*
+ * Thread count control of mkl and openblas, the *_local setters only apply to the calling thread
+ * and return the previous setting
+ */
+#ifdef WITH_MKL_THREAD_NUM
+int mkl_get_max_threads(void);
+int mkl_set_num_threads_local(int nt);
+#endif  // WITH_MKL_THREAD_NUM
+
+#ifdef WITH_OPENBLAS_THREAD_NUM
+int openblas_get_num_threads(void);
+#endif  // WITH_OPENBLAS_THREAD_NUM
+
+#ifdef WITH_OPENBLAS_LOCAL_THREAD_NUM
+int openblas_set_num_threads_local(int num_threads);
+#endif  // WITH_OPENBLAS_LOCAL_THREAD_NUM
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,135 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/lz4_util.h"
+#include "oneflow/core/common/util.h"
+#include <lz4.h>
+
+namespace oneflow {
+
+void Lz4CompressString(const std::string& src, std::string* dst) {
+  CHECK_LE(src.size(), LZ4_MAX_INPUT_SIZE);
+  const uint64_t src_size = src.size();
+  const int bound = LZ4_compressBound(static_cast<int>(src_size));
+  dst->resize(sizeof(uint64_t) + bound);
+  std::memcpy(&dst->at(0), &src_size, sizeof(uint64_t));
+  const int compressed_size = LZ4_compress_default(
+      src.data(), &dst->at(sizeof(uint64_t)), static_cast<int>(src_size), bound);
+  CHECK_GT(compressed_size, 0);
+  dst->resize(sizeof(uint64_t) + compressed_size);
+}
+
+void Lz4DecompressString(const std::string& src, std::string* dst) {
+  CHECK_GE(src.size(), sizeof(uint64_t));
+  uint64_t dst_size = 0;
+  std::memcpy(&dst_size, src.data(), sizeof(uint64_t));
+  dst->resize(dst_size);
+  if (dst_size == 0) { return; }
+  const int decompressed_size =
+      LZ4_decompress_safe(src.data() + sizeof(uint64_t), &dst->at(0),
+                          static_cast<int>(src.size() - sizeof(uint64_t)),
+                          static_cast<int>(dst_size));
+  CHECK_EQ(decompressed_size, static_cast<int>(dst_size));
+}
+
+namespace {
+
+struct Lz4ChunkedHeader {
+  uint64_t src_size;
+  uint64_t chunk_size;
+};
+
+size_t Lz4ChunkNum(size_t src_size, size_t chunk_size) {
+  return (src_size + chunk_size - 1) / chunk_size;
+}
+
+size_t Lz4ChunkedHeaderSize(size_t chunk_num) {
+  return sizeof(Lz4ChunkedHeader) + chunk_num * sizeof(uint32_t);
+}
+
+}  // namespace
+
+size_t Lz4ChunkedCompressBound(size_t src_size, size_t chunk_size) {
+  CHECK_GT(chunk_size, 0);
+  CHECK_LE(chunk_size, LZ4_MAX_INPUT_SIZE);
+  const size_t chunk_num = Lz4ChunkNum(src_size, chunk_size);
+  return Lz4ChunkedHeaderSize(chunk_num) + chunk_num * LZ4_compressBound(chunk_size);
+}
+
+size_t Lz4ChunkedCompress(const char* src, size_t src_size, size_t chunk_size, char* dst,
+                          const Lz4ChunkLoop& chunk_loop) {
+  const size_t chunk_num = Lz4ChunkNum(src_size, chunk_size);
+  const size_t header_size = Lz4ChunkedHeaderSize(chunk_num);
+  const size_t slot_size = LZ4_compressBound(chunk_size);
+  Lz4ChunkedHeader header{src_size, chunk_size};
+  std::memcpy(dst, &header, sizeof(header));
+  uint32_t* compressed_chunk_sizes = reinterpret_cast<uint32_t*>(dst + sizeof(header));
+  // every chunk is compressed into a slot of the bound size, then the slots are packed
+  chunk_loop(chunk_num, [&](size_t i) {
+    const char* chunk = src + i * chunk_size;
+    const int raw_size = static_cast<int>(std::min(chunk_size, src_size - i * chunk_size));
+    char* slot = dst + header_size + i * slot_size;
+    // a chunk of raw_size compressed bytes could not be told from a raw one
+    int compressed_size = LZ4_compress_default(chunk, slot, raw_size, raw_size - 1);
+    if (compressed_size <= 0) {
+      std::memcpy(slot, chunk, raw_size);
+      compressed_size = raw_size;
+    }
+    compressed_chunk_sizes[i] = compressed_size;
+  });
+  size_t offset = header_size;
+  FOR_RANGE(size_t, i, 0, chunk_num) {
+    const char* slot = dst + header_size + i * slot_size;
+    if (slot != dst + offset) { std::memmove(dst + offset, slot, compressed_chunk_sizes[i]); }
+    offset += compressed_chunk_sizes[i];
+  }
+  return offset;
+}
+
+void Lz4ChunkedDecompress(const char* src, size_t src_size, char* dst, size_t dst_size,
+                          const Lz4ChunkLoop& chunk_loop) {
+  CHECK_GE(src_size, sizeof(Lz4ChunkedHeader));
+  Lz4ChunkedHeader header{};
+  std::memcpy(&header, src, sizeof(header));
+  CHECK_EQ(header.src_size, dst_size);
+  CHECK_GT(header.chunk_size, 0);
+  const size_t chunk_num = Lz4ChunkNum(dst_size, header.chunk_size);
+  const size_t header_size = Lz4ChunkedHeaderSize(chunk_num);
+  CHECK_GE(src_size, header_size);
+  const uint32_t* compressed_chunk_sizes =
+      reinterpret_cast<const uint32_t*>(src + sizeof(header));
+  std::vector<size_t> chunk_offsets(chunk_num);
+  size_t offset = header_size;
+  FOR_RANGE(size_t, i, 0, chunk_num) {
+    chunk_offsets[i] = offset;
+    offset += compressed_chunk_sizes[i];
+  }
+  CHECK_EQ(offset, src_size);
+  chunk_loop(chunk_num, [&](size_t i) {
+    const char* compressed_chunk = src + chunk_offsets[i];
+    const int compressed_size = static_cast<int>(compressed_chunk_sizes[i]);
+    char* chunk = dst + i * header.chunk_size;
+    const int raw_size =
+        static_cast<int>(std::min<size_t>(header.chunk_size, dst_size - i * header.chunk_size));
+    if (compressed_size == raw_size) {
+      std::memcpy(chunk, compressed_chunk, raw_size);
+    } else {
+      CHECK_EQ(LZ4_decompress_safe(compressed_chunk, chunk, compressed_size, raw_size),
+               raw_size);
+    }
+  });
+}
+
+}  // namespace oneflow
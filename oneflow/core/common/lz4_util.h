@@ -0,0 +1,45 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMMON_LZ4_UTIL_H_
+#define ONEFLOW_CORE_COMMON_LZ4_UTIL_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace oneflow {
+
+// The compressed string begins with the size of the source as a fixed 64-bit integer
+void Lz4CompressString(const std::string& src, std::string* dst);
+void Lz4DecompressString(const std::string& src, std::string* dst);
+
+// Runs Callback(i) for every i in [0, num), e.g. MultiThreadLoop
+using Lz4ChunkLoop = std::function<void(size_t num, std::function<void(size_t i)> Callback)>;
+
+// A large buffer is compressed in chunks of chunk_size bytes, which chunk_loop compresses and
+// decompresses independently. The compressed buffer begins with the source size, the chunk size
+// and the compressed size of every chunk; a chunk that does not shrink is stored as is.
+size_t Lz4ChunkedCompressBound(size_t src_size, size_t chunk_size);
+// Returns the size of the compressed buffer written to dst, which holds at least
+// Lz4ChunkedCompressBound bytes
+size_t Lz4ChunkedCompress(const char* src, size_t src_size, size_t chunk_size, char* dst,
+                          const Lz4ChunkLoop& chunk_loop);
+void Lz4ChunkedDecompress(const char* src, size_t src_size, char* dst, size_t dst_size,
+                          const Lz4ChunkLoop& chunk_loop);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_COMMON_LZ4_UTIL_H_
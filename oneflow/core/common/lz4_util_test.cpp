@@ -0,0 +1,88 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/lz4_util.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+TEST(Lz4Util, compress_and_decompress) {
+  std::string src;
+  for (int64_t i = 0; i < 100000; ++i) { src += std::to_string(i % 97); }
+  std::string compressed;
+  Lz4CompressString(src, &compressed);
+  ASSERT_LT(compressed.size(), src.size());
+  std::string decompressed;
+  Lz4DecompressString(compressed, &decompressed);
+  ASSERT_EQ(decompressed, src);
+}
+
+TEST(Lz4Util, empty_string) {
+  std::string compressed;
+  Lz4CompressString("", &compressed);
+  std::string decompressed = "not empty";
+  Lz4DecompressString(compressed, &decompressed);
+  ASSERT_TRUE(decompressed.empty());
+}
+
+namespace {
+
+void SerialChunkLoop(size_t num, std::function<void(size_t i)> Callback) {
+  FOR_RANGE(size_t, i, 0, num) { Callback(i); }
+}
+
+void ThreadChunkLoop(size_t num, std::function<void(size_t i)> Callback) {
+  std::vector<std::thread> threads;
+  FOR_RANGE(size_t, i, 0, num) { threads.emplace_back(Callback, i); }
+  for (auto& thread : threads) { thread.join(); }
+}
+
+void TestChunkedCompressAndDecompress(const std::string& src, size_t chunk_size,
+                                      const Lz4ChunkLoop& chunk_loop) {
+  std::vector<char> compressed(Lz4ChunkedCompressBound(src.size(), chunk_size));
+  const size_t compressed_size =
+      Lz4ChunkedCompress(src.data(), src.size(), chunk_size, compressed.data(), chunk_loop);
+  ASSERT_LE(compressed_size, compressed.size());
+  std::string decompressed(src.size(), '\0');
+  Lz4ChunkedDecompress(compressed.data(), compressed_size, &decompressed[0], src.size(),
+                       chunk_loop);
+  ASSERT_EQ(decompressed, src);
+}
+
+}  // namespace
+
+TEST(Lz4Util, chunked_compress_and_decompress) {
+  std::string src;
+  for (int64_t i = 0; i < 100000; ++i) { src += std::to_string(i % 97); }
+  // random bytes which do not shrink are stored as is
+  std::mt19937 gen(0);
+  for (int64_t i = 0; i < 100000; ++i) { src.push_back(static_cast<char>(gen())); }
+  for (size_t chunk_size : {1, 1000, 4096, 65536, 1 << 20}) {
+    TestChunkedCompressAndDecompress(src, chunk_size, SerialChunkLoop);
+  }
+  TestChunkedCompressAndDecompress(src, 16384, ThreadChunkLoop);
+  std::vector<char> compressed(Lz4ChunkedCompressBound(src.size(), 65536));
+  ASSERT_LT(Lz4ChunkedCompress(src.data(), 100000, 65536, compressed.data(), SerialChunkLoop),
+            100000 / 2);
+  ASSERT_LE(Lz4ChunkedCompress(src.data() + 200000, src.size() - 200000, 65536,
+                               compressed.data(), SerialChunkLoop),
+            src.size() - 200000 + 64);
+}
+
+TEST(Lz4Util, chunked_empty_buffer) {
+  TestChunkedCompressAndDecompress("", 4096, SerialChunkLoop);
+}
+
+}  // namespace oneflow
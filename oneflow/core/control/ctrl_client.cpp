@@ -158,6 +158,44 @@ void CtrlClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   PullMasterKV(k, [&](const std::string& i) { msg->ParseFromString(i); });
 }
 
+void CtrlClient::PushKVs(int64_t machine_id,
+                         const std::vector<std::pair<std::string, std::string>>& kvs) {
+  size_t i = 0;
+  while (i < kvs.size()) {
+    ClientCall<CtrlMethod::kPushKVs> call;
+    size_t batch_byte = 0;
+    // every batch holds at least one kv
+    do {
+      const auto& pair = kvs.at(i);
+      CHECK_LT(pair.first.size() + pair.second.size(), static_cast<size_t>(kCtrlMaxMessageByte))
+          << "kv " << pair.first << " is too large for a ctrl rpc";
+      KV* kv = call.mut_request()->add_kv();
+      kv->set_key(pair.first);
+      kv->set_val(pair.second);
+      batch_byte += pair.first.size() + pair.second.size();
+      i += 1;
+    } while (i < kvs.size()
+             && batch_byte + kvs.at(i).first.size() + kvs.at(i).second.size()
+                    <= kCtrlKVsBatchByte);
+    call(stubs_.at(machine_id).get());
+  }
+}
+
+void CtrlClient::PullKVs(int64_t machine_id, const std::vector<std::string>& keys,
+                         std::vector<std::string>* vals) {
+  vals->clear();
+  vals->reserve(keys.size());
+  // every response holds the vals of a non-empty prefix of the requested keys
+  while (vals->size() < keys.size()) {
+    ClientCall<CtrlMethod::kPullKVs> call;
+    FOR_RANGE(size_t, i, vals->size(), keys.size()) { call.mut_request()->add_key(keys.at(i)); }
+    call(stubs_.at(machine_id).get());
+    CHECK_GT(call.response().val_size(), 0);
+    CHECK_LE(vals->size() + static_cast<size_t>(call.response().val_size()), keys.size());
+    for (const std::string& val : call.response().val()) { vals->push_back(val); }
+  }
+}
+
 void CtrlClient::PushActEvent(const ActEvent& act_event) {
   ClientCall<CtrlMethod::kPushActEvent> call;
   *(call.mut_request()->mutable_act_event()) = act_event;
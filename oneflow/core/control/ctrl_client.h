@@ -58,6 +58,12 @@ class CtrlClient final {
     *v = oneflow_cast<T>(v_str);
   }
 
+  // batched PushKV and PullKV on the ctrl server of machine_id, PullKVs waits for all the keys;
+  // kvs beyond kCtrlKVsBatchByte are sent in several rpcs
+  void PushKVs(int64_t machine_id, const std::vector<std::pair<std::string, std::string>>& kvs);
+  void PullKVs(int64_t machine_id, const std::vector<std::string>& keys,
+               std::vector<std::string>* vals);
+
   void PushActEvent(const ActEvent&);
   void Clear();
 
@@ -167,18 +167,8 @@ void CtrlServer::Init() {
   });
 
   Add([this](CtrlCall<CtrlMethod::kPushKV>* call) {
-    const std::string& k = call->request().key();
-    const std::string& v = call->request().val();
-    CHECK(kv_.emplace(k, v).second);
-
-    auto pending_kv_calls_it = pending_kv_calls_.find(k);
-    if (pending_kv_calls_it != pending_kv_calls_.end()) {
-      for (auto pending_call : pending_kv_calls_it->second) {
-        pending_call->mut_response()->set_val(v);
-        pending_call->SendResponse();
-      }
-      pending_kv_calls_.erase(pending_kv_calls_it);
-    }
+    PushKVAndRespondPendingPullKVCalls(call->request().key(), call->request().val());
+    RespondReadyPendingPullKVsCalls();
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kPushKV>();
   });
@@ -203,6 +193,20 @@ void CtrlServer::Init() {
     EnqueueRequest<CtrlMethod::kPullKV>();
   });
 
+  Add([this](CtrlCall<CtrlMethod::kPushKVs>* call) {
+    for (const KV& kv : call->request().kv()) {
+      PushKVAndRespondPendingPullKVCalls(kv.key(), kv.val());
+    }
+    RespondReadyPendingPullKVsCalls();
+    call->SendResponse();
+    EnqueueRequest<CtrlMethod::kPushKVs>();
+  });
+
+  Add([this](CtrlCall<CtrlMethod::kPullKVs>* call) {
+    if (!TryRespondPullKVsCall(call)) { pending_kvs_calls_.push_back(call); }
+    EnqueueRequest<CtrlMethod::kPullKVs>();
+  });
+
   Add([this](CtrlCall<CtrlMethod::kPushActEvent>* call) {
     ActEvent act_event = call->request().act_event();
     call->SendResponse();
@@ -215,6 +219,7 @@ void CtrlServer::Init() {
     kv_.clear();
     CHECK(pending_kv_calls_.empty()) << "size(): " << pending_kv_calls_.size()
                                      << ", begin()->key: " << pending_kv_calls_.begin()->first;
+    CHECK(pending_kvs_calls_.empty()) << "size(): " << pending_kvs_calls_.size();
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClear>();
   });
@@ -234,4 +239,42 @@ void CtrlServer::Init() {
   });
 }
 
+void CtrlServer::PushKVAndRespondPendingPullKVCalls(const std::string& k, const std::string& v) {
+  CHECK(kv_.emplace(k, v).second);
+  auto pending_kv_calls_it = pending_kv_calls_.find(k);
+  if (pending_kv_calls_it != pending_kv_calls_.end()) {
+    for (auto pending_call : pending_kv_calls_it->second) {
+      pending_call->mut_response()->set_val(v);
+      pending_call->SendResponse();
+    }
+    pending_kv_calls_.erase(pending_kv_calls_it);
+  }
+}
+
+void CtrlServer::RespondReadyPendingPullKVsCalls() {
+  for (auto it = pending_kvs_calls_.begin(); it != pending_kvs_calls_.end();) {
+    if (TryRespondPullKVsCall(*it)) {
+      it = pending_kvs_calls_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool CtrlServer::TryRespondPullKVsCall(CtrlCall<CtrlMethod::kPullKVs>* call) {
+  for (const std::string& k : call->request().key()) {
+    if (kv_.find(k) == kv_.end()) { return false; }
+  }
+  // the vals are answered up to kCtrlKVsBatchByte, the client pulls the rest again
+  size_t batch_byte = 0;
+  for (const std::string& k : call->request().key()) {
+    const std::string& v = kv_.at(k);
+    if (call->response().val_size() > 0 && batch_byte + v.size() > kCtrlKVsBatchByte) { break; }
+    call->mut_response()->add_val(v);
+    batch_byte += v.size();
+  }
+  call->SendResponse();
+  return true;
+}
+
 }  // namespace oneflow
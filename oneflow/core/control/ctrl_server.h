@@ -43,6 +43,10 @@ class CtrlServer final {
  private:
   void HandleRpcs();
   void Init();
+  void PushKVAndRespondPendingPullKVCalls(const std::string& k, const std::string& v);
+  void RespondReadyPendingPullKVsCalls();
+  // return false if not all the keys are pushed
+  bool TryRespondPullKVsCall(CtrlCall<CtrlMethod::kPullKVs>* call);
 
   void EnqueueRequests() {
     for_each_i(handlers_, helper{this}, std::make_index_sequence<kCtrlMethodNum>{});
@@ -91,6 +95,8 @@ class CtrlServer final {
   // PushKV, ClearKV, PullKV
   HashMap<std::string, std::string> kv_;
   HashMap<std::string, std::list<CtrlCall<CtrlMethod::kPullKV>*>> pending_kv_calls_;
+  // PushKVs, PullKVs
+  std::list<CtrlCall<CtrlMethod::kPullKVs>*> pending_kvs_calls_;
   // IncreaseCount, EraseCount
   HashMap<std::string, int32_t> count_;
 
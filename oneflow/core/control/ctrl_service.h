@@ -32,6 +32,12 @@ limitations under the License.
 
 namespace oneflow {
 
+// messages received by ctrl clients are limited to it
+const int kCtrlMaxMessageByte = 64 * 1024 * 1024;
+// PushKVs requests and PullKVs responses are split into batches of kvs not larger than it, leaving
+// the rest of kCtrlMaxMessageByte to keys and protobuf framing
+const size_t kCtrlKVsBatchByte = kCtrlMaxMessageByte / 2;
+
 #define CTRL_METHOD_SEQ               \
   OF_PP_MAKE_TUPLE_SEQ(LoadServer)    \
   OF_PP_MAKE_TUPLE_SEQ(Barrier)       \
@@ -41,6 +47,8 @@ namespace oneflow {
   OF_PP_MAKE_TUPLE_SEQ(PushKV)        \
   OF_PP_MAKE_TUPLE_SEQ(ClearKV)       \
   OF_PP_MAKE_TUPLE_SEQ(PullKV)        \
+  OF_PP_MAKE_TUPLE_SEQ(PushKVs)       \
+  OF_PP_MAKE_TUPLE_SEQ(PullKVs)       \
   OF_PP_MAKE_TUPLE_SEQ(PushActEvent)  \
   OF_PP_MAKE_TUPLE_SEQ(Clear)         \
   OF_PP_MAKE_TUPLE_SEQ(IncreaseCount) \
@@ -77,6 +77,36 @@ TEST(CtrlServer, new_delete) {
   Global<EnvDesc>::Delete();
 }
 
+TEST(CtrlClient, push_pull_kvs_beyond_batch_byte) {
+  int port = CtrlUtil().FindAvailablePort();
+  if (port == -1) { return; }
+  Global<EnvDesc>::New(GetEnvProto(port));
+  Global<CtrlServer>::New();
+  Global<CtrlClient>::New();
+  Global<MachineCtx>::New(0);
+
+  // more than kCtrlMaxMessageByte in total, so that both calls need several rpcs
+  const size_t val_size = kCtrlKVsBatchByte / 3 + 1;
+  std::vector<std::pair<std::string, std::string>> kvs;
+  std::vector<std::string> keys;
+  FOR_RANGE(int, i, 0, 8) {
+    keys.push_back("ctrl_test_kvs_" + std::to_string(i));
+    kvs.emplace_back(keys.back(), std::string(val_size, static_cast<char>('a' + i)));
+  }
+  kvs.emplace_back("ctrl_test_kvs_small", "small");
+  keys.push_back("ctrl_test_kvs_small");
+  Global<CtrlClient>::Get()->PushKVs(0, kvs);
+  std::vector<std::string> vals;
+  Global<CtrlClient>::Get()->PullKVs(0, keys, &vals);
+  ASSERT_EQ(vals.size(), kvs.size());
+  FOR_RANGE(size_t, i, 0, kvs.size()) { ASSERT_TRUE(vals.at(i) == kvs.at(i).second); }
+
+  Global<MachineCtx>::Delete();
+  Global<CtrlClient>::Delete();
+  Global<CtrlServer>::Delete();
+  Global<EnvDesc>::Delete();
+}
+
 }  // namespace oneflow
 
 #endif  // OF_PLATFORM_POSIX
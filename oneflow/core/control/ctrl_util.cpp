@@ -58,9 +58,33 @@ int CtrlUtil::FindAvailablePort() const {
   return -1;
 }
 
+std::vector<int> CtrlUtil::FindAvailablePorts(size_t num) const {
+  // the ports are kept bound until all of them are found, so that they differ
+  std::vector<int> ports;
+  std::vector<int> socks;
+  for (uint16_t port = 10000; port < GetMaxVal<uint16_t>() && ports.size() < num; ++port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sa = GetSockAddr("0.0.0.0", port);
+    if (bind(sock, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0) {
+      ports.push_back(port);
+      socks.push_back(sock);
+    } else {
+      close(sock);
+    }
+  }
+  for (int sock : socks) {
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+  }
+  if (ports.size() < num) { ports.clear(); }
+  return ports;
+}
+
 #else
 
 int CtrlUtil::FindAvailablePort() const { UNIMPLEMENTED(); }
 
+std::vector<int> CtrlUtil::FindAvailablePorts(size_t num) const { UNIMPLEMENTED(); }
+
 #endif  // OF_PLATFORM_POSIX
 }  // namespace oneflow
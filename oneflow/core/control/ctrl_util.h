@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_CONTROL_CTR_TEST_H_
 #define ONEFLOW_CORE_CONTROL_CTR_TEST_H_
 
+#include <vector>
+
 namespace oneflow {
 
 class CtrlUtil {
@@ -24,6 +26,8 @@ class CtrlUtil {
   ~CtrlUtil() = default;
 
   int FindAvailablePort() const;
+  // num different ports, empty if there are not enough
+  std::vector<int> FindAvailablePorts(size_t num) const;
 };
 
 }  // namespace oneflow
@@ -19,10 +19,36 @@ limitations under the License.
 #include <stack>
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/graph/node.h"
+#include "oneflow/core/graph/reachability_index.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
+// One thread per cpu unless ONEFLOW_GRAPH_TRAVERSAL_THREAD_NUM says otherwise, 1 makes all
+// traversals serial
+inline int32_t GraphTraversalThreadNum() {
+  const char* env_p = std::getenv("ONEFLOW_GRAPH_TRAVERSAL_THREAD_NUM");
+  if (env_p == nullptr) { return std::max<int32_t>(std::thread::hardware_concurrency(), 1); }
+  const int32_t thread_num = std::stoi(env_p);
+  CHECK_GT(thread_num, 0);
+  return thread_num;
+}
+
+// Shared by the parallel topo traversals of all graphs instead of a pool per traversal
+inline ThreadPool* GraphTraversalThreadPool() {
+  static ThreadPool thread_pool(GraphTraversalThreadNum());
+  return &thread_pool;
+}
+
+// Set on the workers of GraphTraversalThreadPool, whose nested traversals run serially so that
+// no worker waits for works queued behind it
+inline bool* MutIsGraphTraversalWorker() {
+  static thread_local bool is_graph_traversal_worker = false;
+  return &is_graph_traversal_worker;
+}
+
 template<typename NodeType, typename EdgeType>
 class Graph {
  public:
@@ -37,6 +63,15 @@ class Graph {
   Maybe<void> TopoForEachNodeWithErrorCaptured(
       std::function<Maybe<void>(NodeType*)> NodeHandler) const;
   void ReverseTopoForEachNode(std::function<void(NodeType*)> NodeHandler) const;
+  // Level-synchronous wavefront: a node's level is one past the deepest of its in-nodes, and the
+  // nodes of a level are handled concurrently once the previous level is done. Nodes for which
+  // IsSerialNode holds are handled after the others of their level, on the calling thread.
+  void ParallelTopoForEachNode(std::function<void(NodeType*)> NodeHandler) const;
+  Maybe<void> ParallelTopoForEachNodeWithErrorCaptured(
+      std::function<Maybe<void>(NodeType*)> NodeHandler) const;
+  Maybe<void> ParallelTopoForEachNodeWithErrorCaptured(
+      const std::function<bool(NodeType*)>& IsSerialNode,
+      const std::function<Maybe<void>(NodeType*)>& NodeHandler) const;
   void ForEachEdge(std::function<void(EdgeType*)> EdgeHandler) const;
 
   void SortedTopoForEachNode(std::function<bool(const EdgeType* lhs, const EdgeType* rhs)> LessThan,
@@ -223,6 +258,80 @@ Maybe<void> Graph<NodeType, EdgeType>::TopoForEachNodeWithErrorCaptured(
                                           &NodeType::ForEachNodeOnOutEdge, NodeHandler);
 }
 
+template<typename NodeType, typename EdgeType>
+void Graph<NodeType, EdgeType>::ParallelTopoForEachNode(
+    std::function<void(NodeType*)> NodeHandler) const {
+  CHECK_JUST(ParallelTopoForEachNodeWithErrorCaptured([&](NodeType* node) -> Maybe<void> {
+    NodeHandler(node);
+    return Maybe<void>::Ok();
+  }));
+}
+
+template<typename NodeType, typename EdgeType>
+Maybe<void> Graph<NodeType, EdgeType>::ParallelTopoForEachNodeWithErrorCaptured(
+    std::function<Maybe<void>(NodeType*)> NodeHandler) const {
+  return ParallelTopoForEachNodeWithErrorCaptured([](NodeType*) { return false; }, NodeHandler);
+}
+
+template<typename NodeType, typename EdgeType>
+Maybe<void> Graph<NodeType, EdgeType>::ParallelTopoForEachNodeWithErrorCaptured(
+    const std::function<bool(NodeType*)>& IsSerialNode,
+    const std::function<Maybe<void>(NodeType*)>& NodeHandler) const {
+  // Below this the levels are too narrow to pay for the threads
+  const size_t kMinParallelNodeNum = 256;
+  if (node_num() < kMinParallelNodeNum || *MutIsGraphTraversalWorker()) {
+    return TopoForEachNodeWithErrorCaptured(NodeHandler);
+  }
+  HashMap<NodeType*, size_t> node2level;
+  std::vector<std::vector<NodeType*>> level2nodes;
+  TopoForEachNode([&](NodeType* node) {
+    size_t level = 0;
+    node->ForEachNodeOnInEdge(
+        [&](NodeType* in_node) { level = std::max(level, node2level.at(in_node) + 1); });
+    node2level.emplace(node, level);
+    if (level2nodes.size() <= level) { level2nodes.resize(level + 1); }
+    level2nodes.at(level).push_back(node);
+  });
+  size_t max_level_width = 0;
+  for (const auto& nodes : level2nodes) {
+    max_level_width = std::max(max_level_width, nodes.size());
+  }
+  ThreadPool* thread_pool = GraphTraversalThreadPool();
+  if (std::min<size_t>(max_level_width, thread_pool->thread_num()) <= 1) {
+    return TopoForEachNodeWithErrorCaptured(NodeHandler);
+  }
+  std::vector<NodeType*> parallel_nodes;
+  std::vector<NodeType*> serial_nodes;
+  for (const auto& nodes : level2nodes) {
+    parallel_nodes.clear();
+    serial_nodes.clear();
+    for (NodeType* node : nodes) {
+      if (IsSerialNode(node)) {
+        serial_nodes.push_back(node);
+      } else {
+        parallel_nodes.push_back(node);
+      }
+    }
+    // errors are reported in level order, whichever thread finishes first
+    std::vector<std::shared_ptr<cfg::ErrorProto>> errors(parallel_nodes.size());
+    BlockingCounter counter(parallel_nodes.size());
+    FOR_RANGE(size_t, i, 0, parallel_nodes.size()) {
+      thread_pool->AddWork([&, i]() {
+        *MutIsGraphTraversalWorker() = true;
+        const auto& ret = NodeHandler(parallel_nodes.at(i));
+        if (!ret.IsOk()) { errors.at(i) = ret.error(); }
+        counter.Decrease();
+      });
+    }
+    counter.WaitUntilCntEqualZero();
+    for (const auto& error : errors) {
+      if (error) { return error; }
+    }
+    for (NodeType* node : serial_nodes) { JUST(NodeHandler(node)); }
+  }
+  return Maybe<void>::Ok();
+}
+
 template<typename NodeType, typename EdgeType>
 void Graph<NodeType, EdgeType>::SortedTopoForEachNode(
     std::function<bool(const EdgeType* lhs, const EdgeType* rhs)> LessThan,
@@ -614,19 +723,22 @@ Graph<NodeType, EdgeType>::MakePredicatorIsReachable(
     const std::function<void(NodeType*, const std::function<void(NodeType*)>&)>& ForEachInNode,
     const std::function<void(NodeType*, const std::function<void(NodeType*)>&)>& ForEachOutNode)
     const {
-  auto node2ancestor = std::make_shared<HashMap<const NodeType*, HashSet<const NodeType*>>>();
+  auto node2index = std::make_shared<HashMap<const NodeType*, int64_t>>();
+  std::vector<int64_t> in_offsets{0};
+  std::vector<int64_t> in_indices;
   TopoForEachNode(starts, ForEachInNode, ForEachOutNode, [&](NodeType* node) {
-    node2ancestor->emplace(node, HashSet<const NodeType*>());
-    ForEachInNode(node, [&](NodeType* in_node) {
-      node2ancestor->at(node).insert(in_node);
-      node2ancestor->at(node).insert(node2ancestor->at(in_node).begin(),
-                                     node2ancestor->at(in_node).end());
-    });
+    ForEachInNode(node, [&](NodeType* in_node) { in_indices.push_back(node2index->at(in_node)); });
+    in_offsets.push_back(in_indices.size());
+    const int64_t index = node2index->size();
+    node2index->emplace(node, index);
   });
-  return [node2ancestor](const NodeType* src, const NodeType* dst) -> bool {
-    const auto it = node2ancestor->find(dst);
-    if (it == node2ancestor->end()) { return false; }
-    return it->second.find(src) != it->second.end();
+  auto reachability_index = std::make_shared<ReachabilityIndex>(in_offsets, in_indices);
+  return [node2index, reachability_index](const NodeType* src, const NodeType* dst) -> bool {
+    const auto src_it = node2index->find(src);
+    if (src_it == node2index->end()) { return false; }
+    const auto dst_it = node2index->find(dst);
+    if (dst_it == node2index->end()) { return false; }
+    return reachability_index->IsReachable(src_it->second, dst_it->second);
   };
 }
 
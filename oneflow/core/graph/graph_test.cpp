@@ -0,0 +1,206 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "gtest/gtest.h"
+#include "oneflow/core/graph/graph.h"
+
+namespace oneflow {
+
+namespace {
+
+class TestEdge;
+
+class TestNode final : public Node<TestNode, TestEdge> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TestNode);
+  TestNode() = default;
+  ~TestNode() override = default;
+
+  int64_t index() const { return index_; }
+  int64_t level() const { return level_; }
+  void set_index(int64_t index) { index_ = index; }
+  void set_level(int64_t level) { level_ = level; }
+
+ private:
+  int64_t index_ = -1;
+  int64_t level_ = -1;
+};
+
+class TestEdge final : public Edge<TestNode, TestEdge> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TestEdge);
+  TestEdge() = default;
+  ~TestEdge() override = default;
+};
+
+// depth levels of width nodes, node j of a level reads nodes j and (j + 1) % width of the previous
+// level, so that every level is handled as a whole
+class TestGraph final : public Graph<TestNode, TestEdge> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TestGraph);
+  TestGraph(int64_t depth, int64_t width) : width_(width) {
+    FOR_RANGE(int64_t, level, 0, depth) {
+      FOR_RANGE(int64_t, j, 0, width) {
+        TestNode* node = NewNode();
+        node->set_index(nodes_.size());
+        node->set_level(level);
+        nodes_.push_back(node);
+        if (level == 0) { continue; }
+        Connect(Node4LevelAndIndex(level - 1, j), NewEdge(), node);
+        if (width > 1) { Connect(Node4LevelAndIndex(level - 1, (j + 1) % width), NewEdge(), node); }
+      }
+    }
+  }
+  ~TestGraph() override = default;
+
+  TestNode* Node4LevelAndIndex(int64_t level, int64_t j) const {
+    return nodes_.at(level * width_ + j);
+  }
+
+ private:
+  int64_t width_;
+  std::vector<TestNode*> nodes_;
+};
+
+}  // namespace
+
+TEST(Graph, parallel_topo_for_each_node_visits_in_nodes_first) {
+  TestGraph graph(8, 64);
+  std::atomic<int64_t> visited_cnt(0);
+  std::vector<int64_t> node_index2visit_order(graph.node_num(), -1);
+  std::mutex mutex;
+  HashSet<std::thread::id> thread_ids;
+  CHECK_JUST(graph.ParallelTopoForEachNodeWithErrorCaptured([&](TestNode* node) -> Maybe<void> {
+    node_index2visit_order.at(node->index()) = visited_cnt++;
+    std::unique_lock<std::mutex> lock(mutex);
+    thread_ids.insert(std::this_thread::get_id());
+    return Maybe<void>::Ok();
+  }));
+  ASSERT_EQ(visited_cnt, graph.node_num());
+  graph.ForEachNode([&](TestNode* node) {
+    ASSERT_GE(node_index2visit_order.at(node->index()), 0);
+    node->ForEachNodeOnInEdge([&](TestNode* in_node) {
+      ASSERT_LT(node_index2visit_order.at(in_node->index()),
+                node_index2visit_order.at(node->index()));
+    });
+  });
+  if (GraphTraversalThreadPool()->thread_num() > 1) { ASSERT_GT(thread_ids.size(), 1); }
+}
+
+TEST(Graph, parallel_topo_for_each_node_runs_serial_nodes_after_their_level) {
+  const int64_t depth = 8;
+  const int64_t width = 64;
+  TestGraph graph(depth, width);
+  auto IsSerialNode = [](TestNode* node) { return node->index() % 7 == 0; };
+  std::vector<int64_t> level2serial_num(depth, 0);
+  graph.ForEachNode([&](TestNode* node) {
+    if (IsSerialNode(node)) { level2serial_num.at(node->level()) += 1; }
+  });
+  std::vector<std::atomic<int64_t>> level2parallel_done_cnt(depth);
+  std::vector<std::atomic<int64_t>> level2serial_done_cnt(depth);
+  FOR_RANGE(int64_t, level, 0, depth) {
+    level2parallel_done_cnt.at(level) = 0;
+    level2serial_done_cnt.at(level) = 0;
+  }
+  const std::thread::id caller_thread_id = std::this_thread::get_id();
+  std::atomic<bool> is_order_kept(true);
+  CHECK_JUST(graph.ParallelTopoForEachNodeWithErrorCaptured(
+      IsSerialNode, [&](TestNode* node) -> Maybe<void> {
+        const int64_t level = node->level();
+        const int64_t serial_num = level2serial_num.at(level);
+        if (level > 0 && level2serial_done_cnt.at(level - 1) != level2serial_num.at(level - 1)) {
+          is_order_kept = false;
+        }
+        if (IsSerialNode(node)) {
+          if (std::this_thread::get_id() != caller_thread_id
+              || level2parallel_done_cnt.at(level) != width - serial_num) {
+            is_order_kept = false;
+          }
+          level2serial_done_cnt.at(level) += 1;
+        } else {
+          if (level2serial_done_cnt.at(level) != 0) { is_order_kept = false; }
+          level2parallel_done_cnt.at(level) += 1;
+        }
+        return Maybe<void>::Ok();
+      }));
+  ASSERT_TRUE(is_order_kept);
+  FOR_RANGE(int64_t, level, 0, depth) {
+    ASSERT_EQ(level2serial_done_cnt.at(level), level2serial_num.at(level));
+    ASSERT_EQ(level2parallel_done_cnt.at(level), width - level2serial_num.at(level));
+  }
+}
+
+TEST(Graph, parallel_topo_for_each_node_returns_error_of_first_level) {
+  const int64_t depth = 8;
+  const int64_t width = 64;
+  TestGraph graph(depth, width);
+  std::string first_error_msg;
+  FOR_RANGE(int64_t, run, 0, 8) {
+    std::atomic<int64_t> visited_cnt_after_error_level(0);
+    const auto& ret =
+        graph.ParallelTopoForEachNodeWithErrorCaptured([&](TestNode* node) -> Maybe<void> {
+          if (node->level() > 2) { visited_cnt_after_error_level += 1; }
+          if (node == graph.Node4LevelAndIndex(2, 50) || node == graph.Node4LevelAndIndex(2, 3)
+              || node == graph.Node4LevelAndIndex(5, 0)) {
+            return Error::CheckFailedError() << "node " << node->index();
+          }
+          return Maybe<void>::Ok();
+        });
+    ASSERT_FALSE(ret.IsOk());
+    ASSERT_EQ(visited_cnt_after_error_level, 0);
+    const std::string& error_msg = ret.error()->msg();
+    ASSERT_TRUE(error_msg == "node " + std::to_string(graph.Node4LevelAndIndex(2, 50)->index())
+                || error_msg == "node " + std::to_string(graph.Node4LevelAndIndex(2, 3)->index()));
+    // the reported error does not depend on which thread finishes first
+    if (run == 0) { first_error_msg = error_msg; }
+    ASSERT_EQ(error_msg, first_error_msg);
+  }
+}
+
+TEST(Graph, parallel_topo_for_each_node_falls_back_to_serial_below_256_nodes) {
+  TestGraph graph(4, 32);
+  ASSERT_LT(graph.node_num(), 256);
+  std::vector<int64_t> parallel_visit_order;
+  CHECK_JUST(graph.ParallelTopoForEachNodeWithErrorCaptured([&](TestNode* node) -> Maybe<void> {
+    // the vector is only safe to write without a lock if the nodes are handled serially
+    parallel_visit_order.push_back(node->index());
+    EXPECT_FALSE(*MutIsGraphTraversalWorker());
+    return Maybe<void>::Ok();
+  }));
+  std::vector<int64_t> serial_visit_order;
+  graph.TopoForEachNode([&](TestNode* node) { serial_visit_order.push_back(node->index()); });
+  ASSERT_EQ(parallel_visit_order, serial_visit_order);
+}
+
+TEST(Graph, parallel_topo_for_each_node_nested_traversal_is_serial) {
+  TestGraph graph(8, 64);
+  TestGraph inner_graph(8, 64);
+  std::atomic<int64_t> inner_visited_cnt(0);
+  CHECK_JUST(graph.ParallelTopoForEachNodeWithErrorCaptured([&](TestNode* node) -> Maybe<void> {
+    if (node->level() != 1 || node->index() % 16 != 0) { return Maybe<void>::Ok(); }
+    const std::thread::id thread_id = std::this_thread::get_id();
+    inner_graph.ParallelTopoForEachNode([&](TestNode* inner_node) {
+      EXPECT_EQ(std::this_thread::get_id(), thread_id);
+      inner_visited_cnt += 1;
+    });
+    return Maybe<void>::Ok();
+  }));
+  ASSERT_EQ(inner_visited_cnt, 4 * inner_graph.node_num());
+}
+
+}  // namespace oneflow
@@ -459,7 +459,7 @@ void OpGraph::InferBlobLastUsed() const {
 }
 
 void OpGraph::InferTimeShape() const {
-  TopoForEachNode([&](OpNode* op_node) {
+  ParallelTopoForEachNode([&](OpNode* op_node) {
     ParallelContext parallel_ctx;
     parallel_ctx.set_parallel_id(0);
     parallel_ctx.set_parallel_num(op_node->parallel_desc().parallel_num());
@@ -558,7 +558,16 @@ Maybe<void> OpGraph::InferLogicalBlobDesc(const Job& job) const {
     oba2sbp_identical_obas[pair.first()].push_back(pair.second());
     oba2sbp_identical_obas[pair.second()].push_back(pair.first());
   }
-  JUST(TopoForEachNodeWithErrorCaptured([&](OpNode* op_node) -> Maybe<void> {
+  // An op bound by identical sbp pairs writes sbp signature confs of other ops, so it is inferred
+  // serially, after the concurrently inferred ops of its level have read their confs
+  HashSet<std::string> sbp_identical_op_names;
+  for (const auto& pair : oba2sbp_identical_obas) {
+    sbp_identical_op_names.insert(pair.first.op_name());
+  }
+  const auto& IsSbpIdenticalOpNode = [&](OpNode* op_node) {
+    return sbp_identical_op_names.find(op_node->op().op_name()) != sbp_identical_op_names.end();
+  };
+  const auto& InferOpNode = [&](OpNode* op_node) -> Maybe<void> {
     auto LogicalBlobDesc4BnInOp = [&](const std::string& bn) -> const BlobDesc& {
       return op_node->LogicalBlobDesc4Lbi(op_node->op().BnInOp2Lbi(bn));
     };
@@ -591,13 +600,16 @@ Maybe<void> OpGraph::InferLogicalBlobDesc(const Job& job) const {
     }
     InferOpNodeSbpSignature(op_node, sbp_sig_conf);
     op_node->InferBlobParallelDesc();
-    UpdateJobParallelViewConf(*op_node, oba2sbp_identical_obas, &job_parallel_view_conf);
+    if (IsSbpIdenticalOpNode(op_node)) {
+      UpdateJobParallelViewConf(*op_node, oba2sbp_identical_obas, &job_parallel_view_conf);
+    }
     // Infer logical_blob_desc
     JUST(InferOpNodeLogicalBlobDesc(op_node));
     // Fill logical blob_desc signature.
     JUST(op_node->mut_op()->FillLogicalOutBlobDesc(LogicalBlobDesc4BnInOp));
     return Maybe<void>::Ok();
-  }));
+  };
+  JUST(ParallelTopoForEachNodeWithErrorCaptured(IsSbpIdenticalOpNode, InferOpNode));
   return Maybe<void>::Ok();
 }
 
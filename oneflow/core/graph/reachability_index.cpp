@@ -0,0 +1,91 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/graph/reachability_index.h"
+#include "oneflow/core/graph/graph.h"
+#include "oneflow/core/common/blocking_counter.h"
+
+namespace oneflow {
+
+namespace {
+
+constexpr int64_t kWordBitNum = sizeof(uint64_t) * 8;
+// 4096 source nodes per chunk, every row touches at most 512 contiguous bytes of a chunk
+constexpr int64_t kChunkWordNum = 64;
+
+int64_t RowWordNum(int64_t node) { return (node + kWordBitNum - 1) / kWordBitNum; }
+
+}  // namespace
+
+ReachabilityIndex::ReachabilityIndex(const std::vector<int64_t>& in_offsets,
+                                     const std::vector<int64_t>& in_indices) {
+  CHECK(!in_offsets.empty());
+  const int64_t node_num = in_offsets.size() - 1;
+  CHECK_EQ(in_offsets.back(), in_indices.size());
+  row_offsets_.resize(node_num + 1);
+  row_offsets_.at(0) = 0;
+  FOR_RANGE(int64_t, i, 0, node_num) {
+    FOR_RANGE(int64_t, e, in_offsets.at(i), in_offsets.at(i + 1)) {
+      CHECK_GE(in_indices.at(e), 0);
+      CHECK_LT(in_indices.at(e), i);
+    }
+    row_offsets_.at(i + 1) = row_offsets_.at(i) + RowWordNum(i);
+  }
+  words_.resize(row_offsets_.back(), 0);
+  const int64_t chunk_num = (RowWordNum(node_num) + kChunkWordNum - 1) / kChunkWordNum;
+  ThreadPool* thread_pool = GraphTraversalThreadPool();
+  if (chunk_num <= 1 || thread_pool->thread_num() <= 1 || *MutIsGraphTraversalWorker()) {
+    FOR_RANGE(int64_t, chunk_id, 0, chunk_num) {
+      BuildWords(in_offsets, in_indices, chunk_id * kChunkWordNum, (chunk_id + 1) * kChunkWordNum);
+    }
+    return;
+  }
+  BlockingCounter counter(chunk_num);
+  FOR_RANGE(int64_t, chunk_id, 0, chunk_num) {
+    thread_pool->AddWork([&, chunk_id]() {
+      *MutIsGraphTraversalWorker() = true;
+      BuildWords(in_offsets, in_indices, chunk_id * kChunkWordNum, (chunk_id + 1) * kChunkWordNum);
+      counter.Decrease();
+    });
+  }
+  counter.WaitUntilCntEqualZero();
+}
+
+bool ReachabilityIndex::IsReachable(int64_t src, int64_t dst) const {
+  if (src < 0 || src >= dst || dst >= node_num()) { return false; }
+  const uint64_t word = words_[row_offsets_[dst] + src / kWordBitNum];
+  return (word >> (src % kWordBitNum)) & 1;
+}
+
+void ReachabilityIndex::BuildWords(const std::vector<int64_t>& in_offsets,
+                                   const std::vector<int64_t>& in_indices, int64_t word_begin,
+                                   int64_t word_end) {
+  // rows up to word_begin * kWordBitNum end before this chunk
+  FOR_RANGE(int64_t, i, word_begin * kWordBitNum + 1, node_num()) {
+    uint64_t* row = words_.data() + row_offsets_[i];
+    FOR_RANGE(int64_t, e, in_offsets[i], in_offsets[i + 1]) {
+      const int64_t in = in_indices[e];
+      const uint64_t* in_row = words_.data() + row_offsets_[in];
+      const int64_t in_row_end = std::min(word_end, RowWordNum(in));
+      FOR_RANGE(int64_t, w, word_begin, in_row_end) { row[w] |= in_row[w]; }
+      const int64_t in_word = in / kWordBitNum;
+      if (in_word >= word_begin && in_word < word_end) {
+        row[in_word] |= static_cast<uint64_t>(1) << (in % kWordBitNum);
+      }
+    }
+  }
+}
+
+}  // namespace oneflow
@@ -0,0 +1,49 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_GRAPH_REACHABILITY_INDEX_H_
+#define ONEFLOW_CORE_GRAPH_REACHABILITY_INDEX_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// Answers whether a node is a strict ancestor of another one in a DAG whose nodes are numbered
+// in topological order. The ancestors of node i are among nodes [0, i), so row i keeps only i
+// bits packed into 64-bit words, half of a full bit matrix. Rows are built column chunk by column
+// chunk, and chunks are independent of each other, so they are built in parallel
+class ReachabilityIndex final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ReachabilityIndex);
+  ReachabilityIndex() = delete;
+  ~ReachabilityIndex() = default;
+
+  // The in-nodes of node i are in_indices[in_offsets[i], in_offsets[i + 1]), all less than i
+  ReachabilityIndex(const std::vector<int64_t>& in_offsets, const std::vector<int64_t>& in_indices);
+
+  int64_t node_num() const { return row_offsets_.size() - 1; }
+  bool IsReachable(int64_t src, int64_t dst) const;
+
+ private:
+  void BuildWords(const std::vector<int64_t>& in_offsets, const std::vector<int64_t>& in_indices,
+                  int64_t word_begin, int64_t word_end);
+
+  std::vector<int64_t> row_offsets_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_GRAPH_REACHABILITY_INDEX_H_
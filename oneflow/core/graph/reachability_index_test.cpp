@@ -0,0 +1,187 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <random>
+#include "oneflow/core/graph/reachability_index.h"
+
+namespace oneflow {
+
+namespace {
+
+// Every node i > 0 gets up to max_in_num in-nodes picked from the window of nodes before it
+void GenerateRandomDag(int64_t node_num, int64_t max_in_num, int64_t window,
+                       std::vector<int64_t>* in_offsets, std::vector<int64_t>* in_indices) {
+  std::mt19937 gen(node_num);
+  in_offsets->assign(1, 0);
+  in_indices->clear();
+  FOR_RANGE(int64_t, i, 0, node_num) {
+    if (i > 0) {
+      const int64_t first = std::max<int64_t>(0, i - window);
+      std::uniform_int_distribution<int64_t> dis(first, i - 1);
+      const int64_t in_num = std::uniform_int_distribution<int64_t>(0, max_in_num)(gen);
+      FOR_RANGE(int64_t, j, 0, in_num) { in_indices->push_back(dis(gen)); }
+    }
+    in_offsets->push_back(in_indices->size());
+  }
+}
+
+std::vector<bool> Ancestors(const std::vector<int64_t>& in_offsets,
+                            const std::vector<int64_t>& in_indices, int64_t node) {
+  std::vector<bool> is_ancestor(in_offsets.size() - 1, false);
+  std::vector<int64_t> stack{node};
+  while (!stack.empty()) {
+    const int64_t cur = stack.back();
+    stack.pop_back();
+    FOR_RANGE(int64_t, e, in_offsets.at(cur), in_offsets.at(cur + 1)) {
+      const int64_t in = in_indices.at(e);
+      if (!is_ancestor.at(in)) {
+        is_ancestor.at(in) = true;
+        stack.push_back(in);
+      }
+    }
+  }
+  return is_ancestor;
+}
+
+void TestReachabilityIndex(int64_t node_num, int64_t max_in_num, int64_t window,
+                           int64_t checked_dst_num) {
+  std::vector<int64_t> in_offsets;
+  std::vector<int64_t> in_indices;
+  GenerateRandomDag(node_num, max_in_num, window, &in_offsets, &in_indices);
+  ReachabilityIndex index(in_offsets, in_indices);
+  ASSERT_EQ(index.node_num(), node_num);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int64_t> dis(0, node_num - 1);
+  FOR_RANGE(int64_t, i, 0, checked_dst_num) {
+    const int64_t dst = i < node_num ? node_num - 1 - i : dis(gen);
+    const std::vector<bool> is_ancestor = Ancestors(in_offsets, in_indices, dst);
+    FOR_RANGE(int64_t, src, 0, node_num) {
+      ASSERT_EQ(index.IsReachable(src, dst), is_ancestor.at(src));
+    }
+  }
+}
+
+// Node i belongs to branch i % branch_num and gets up to max_in_num in-nodes among the previous
+// window nodes of its branch, so a node reaches about a branch_num-th of the nodes before it
+void GenerateBranchedDag(int64_t node_num, int64_t branch_num, int64_t max_in_num, int64_t window,
+                         std::vector<int64_t>* in_offsets, std::vector<int64_t>* in_indices) {
+  std::mt19937 gen(node_num);
+  in_offsets->assign(1, 0);
+  in_indices->clear();
+  FOR_RANGE(int64_t, i, 0, node_num) {
+    const int64_t prev_num = std::min(i / branch_num, window);
+    if (prev_num > 0) {
+      std::uniform_int_distribution<int64_t> dis(1, prev_num);
+      const int64_t in_num = std::uniform_int_distribution<int64_t>(1, max_in_num)(gen);
+      FOR_RANGE(int64_t, j, 0, in_num) { in_indices->push_back(i - dis(gen) * branch_num); }
+    }
+    in_offsets->push_back(in_indices->size());
+  }
+}
+
+double SecondsSince(const std::chrono::steady_clock::time_point& begin) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// The per node ancestor sets MakePredicatorIsReachable kept before the bit matrix
+std::vector<HashSet<int64_t>> BuildAncestorSets(const std::vector<int64_t>& in_offsets,
+                                                const std::vector<int64_t>& in_indices) {
+  std::vector<HashSet<int64_t>> node2ancestors(in_offsets.size() - 1);
+  FOR_RANGE(int64_t, i, 0, node2ancestors.size()) {
+    FOR_RANGE(int64_t, e, in_offsets.at(i), in_offsets.at(i + 1)) {
+      const int64_t in = in_indices.at(e);
+      node2ancestors.at(i).insert(in);
+      node2ancestors.at(i).insert(node2ancestors.at(in).begin(), node2ancestors.at(in).end());
+    }
+  }
+  return node2ancestors;
+}
+
+// Heap bytes of the sets: the bucket arrays plus a 32-byte malloc chunk per list node, which holds
+// the next pointer and the value. Counted rather than read from the allocator, which hands freed
+// memory of the previous case to the next one
+int64_t AncestorSetBytes(const std::vector<HashSet<int64_t>>& node2ancestors) {
+  int64_t bytes = node2ancestors.size() * sizeof(HashSet<int64_t>);
+  for (const auto& ancestors : node2ancestors) {
+    bytes += ancestors.bucket_count() * sizeof(void*) + ancestors.size() * 32;
+  }
+  return bytes;
+}
+
+void BenchmarkReachabilityIndex(int64_t node_num, int64_t branch_num) {
+  // the ancestor sets grow with the square of the branch length, larger ones would not fit
+  const int64_t kMaxAncestorSetEntryNum = 50 * 1000 * 1000;
+  std::vector<int64_t> in_offsets;
+  std::vector<int64_t> in_indices;
+  GenerateBranchedDag(node_num, branch_num, 2, 200, &in_offsets, &in_indices);
+  LOG(INFO) << "dag of " << node_num << " nodes in " << branch_num << " branches";
+  {
+    const auto begin = std::chrono::steady_clock::now();
+    ReachabilityIndex index(in_offsets, in_indices);
+    const double seconds = SecondsSince(begin);
+    // row i holds (i + 63) / 64 words
+    int64_t word_num = 0;
+    FOR_RANGE(int64_t, i, 0, node_num) { word_num += (i + 63) / 64; }
+    LOG(INFO) << "  ReachabilityIndex: " << seconds << " s, "
+              << word_num * sizeof(uint64_t) / (1024 * 1024) << " MiB";
+  }
+  const int64_t branch_length = node_num / branch_num;
+  const int64_t estimated_entry_num = branch_length * branch_length / 2 * branch_num;
+  if (estimated_entry_num > kMaxAncestorSetEntryNum) {
+    LOG(INFO) << "  ancestor HashSets: skipped, about " << estimated_entry_num << " entries";
+    return;
+  }
+  const auto begin = std::chrono::steady_clock::now();
+  const std::vector<HashSet<int64_t>> node2ancestors = BuildAncestorSets(in_offsets, in_indices);
+  const double seconds = SecondsSince(begin);
+  LOG(INFO) << "  ancestor HashSets: " << seconds << " s, "
+            << AncestorSetBytes(node2ancestors) / (1024 * 1024) << " MiB";
+}
+
+}  // namespace
+
+TEST(ReachabilityIndex, empty) {
+  ReachabilityIndex index({0}, {});
+  ASSERT_EQ(index.node_num(), 0);
+  ASSERT_FALSE(index.IsReachable(0, 0));
+}
+
+TEST(ReachabilityIndex, chain) {
+  ReachabilityIndex index({0, 0, 1, 2}, {0, 1});
+  ASSERT_TRUE(index.IsReachable(0, 1));
+  ASSERT_TRUE(index.IsReachable(0, 2));
+  ASSERT_TRUE(index.IsReachable(1, 2));
+  ASSERT_FALSE(index.IsReachable(1, 0));
+  ASSERT_FALSE(index.IsReachable(2, 2));
+}
+
+TEST(ReachabilityIndex, small_random_dag) { TestReachabilityIndex(300, 3, 50, 300); }
+
+TEST(ReachabilityIndex, large_random_dag) {
+  // spans several column chunks, so they are built by the thread pool
+  TestReachabilityIndex(20000, 2, 200, 64);
+}
+
+// Not run by default, run with --gtest_also_run_disabled_tests to compare build time and memory
+// with the HashSets
+TEST(ReachabilityIndex, DISABLED_benchmark) {
+  BenchmarkReachabilityIndex(8000, 1);
+  BenchmarkReachabilityIndex(50000, 1);
+  BenchmarkReachabilityIndex(50000, 64);
+  BenchmarkReachabilityIndex(100000, 256);
+}
+
+}  // namespace oneflow
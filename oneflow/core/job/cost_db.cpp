@@ -0,0 +1,331 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/cost_db.h"
+#include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/actor/act_event_logger.h"
+#include <iomanip>
+
+namespace oneflow {
+
+namespace {
+
+std::string OpTypeName4OpConf(const OperatorConf& op_conf) {
+  if (op_conf.has_user_conf()) { return op_conf.user_conf().op_type_name(); }
+  const auto* fd = op_conf.GetDescriptor()->FindFieldByNumber(op_conf.op_type_case());
+  return fd == nullptr ? "unknown" : fd->name();
+}
+
+void AppendOpSignature(const OpAttribute& op_attribute, std::string* sig) {
+  OperatorConf op_conf(op_attribute.op_conf());
+  op_conf.clear_name();
+  op_conf.clear_ctrl_in_op_name();
+  op_conf.clear_scope_symbol_id();
+  if (op_conf.has_user_conf()) {
+    // lbns refer to the names of producer ops
+    op_conf.mutable_user_conf()->clear_input();
+    op_conf.mutable_user_conf()->clear_output();
+  }
+  // maps are printed in key order by text format
+  sig->append(PbMessage2TxtString(op_conf));
+  sig->append(PbMessage2TxtString(op_attribute.sbp_signature()));
+  sig->append(PbMessage2TxtString(op_attribute.logical_blob_desc_signature()));
+}
+
+void AppendProducedBlobSignature(const TaskProto& task, std::string* sig) {
+  std::map<std::string, const RegstDescProto*> name2regst_desc;
+  for (const auto& pair : task.produced_regst_desc()) {
+    name2regst_desc.emplace(pair.first, &pair.second);
+  }
+  for (const auto& pair : name2regst_desc) {
+    const RegstDescTypeProto& regst_desc_type = pair.second->regst_desc_type();
+    if (!regst_desc_type.has_data_regst_desc()) { continue; }
+    sig->append(pair.first);
+    for (const auto& lbi_blob_desc : regst_desc_type.data_regst_desc().lbi2blob_desc()) {
+      sig->append(PbMessage2TxtString(lbi_blob_desc.blob_desc().body()));
+    }
+  }
+}
+
+std::string HexDigest(const std::string& str) {
+  // FNV-1a, stable across processes and builds
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : str) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return ss.str();
+}
+
+bool IsTaskToImprove(const TaskProto& task) {
+  // kMdUpdtArea regst num will always be 1
+  return task.task_set_info().area_id() != kMdUpdtArea;
+}
+
+}  // namespace
+
+std::string CostDB::TaskKey(const TaskProto& task) {
+  std::string sig = TaskType_Name(task.task_type());
+  if (task.has_parallel_ctx()) {
+    sig.append(":" + std::to_string(task.parallel_ctx().parallel_num()));
+  }
+  for (const auto& exec_node : task.exec_sequence().exec_node()) {
+    AppendOpSignature(exec_node.kernel_conf().op_attribute(), &sig);
+    sig.append(DataType_Name(exec_node.kernel_conf().data_type()));
+  }
+  AppendProducedBlobSignature(task, &sig);
+  return HexDigest(sig);
+}
+
+std::string CostDB::TaskDesc(const TaskProto& task) {
+  std::string desc = TaskType_Name(task.task_type());
+  std::string op_types;
+  for (const auto& exec_node : task.exec_sequence().exec_node()) {
+    const OperatorConf& op_conf = exec_node.kernel_conf().op_attribute().op_conf();
+    if (op_types.empty()) {
+      desc.append(":" + op_conf.device_tag());
+    } else {
+      op_types.append(",");
+    }
+    op_types.append(OpTypeName4OpConf(op_conf));
+  }
+  if (!op_types.empty()) { desc.append(":" + op_types); }
+  return desc;
+}
+
+std::string CostDB::RegstKey(const TaskProto& task, const std::string& regst_name) {
+  return TaskKey(task) + "/" + regst_name;
+}
+
+bool CostDB::Load(const std::string& path) {
+  std::ifstream in_stream(path);
+  if (!in_stream.good()) { return false; }
+  CostDBProto proto;
+  if (!TryParseProtoFromTextFile(path, &proto)) {
+    LOG(WARNING) << "failed to parse cost db " << path;
+    return false;
+  }
+  proto_.Swap(&proto);
+  return true;
+}
+
+void CostDB::Save(const std::string& path) const {
+  // write to a temporary file first so that a crash never leaves a truncated db behind
+  const std::string tmp_path = path + ".tmp";
+  PrintProtoToTextFile(proto_, tmp_path);
+  PCHECK(std::rename(tmp_path.c_str(), path.c_str()) == 0);
+}
+
+void CostDB::Merge(const CostDBProto& other) {
+  auto* key2record = proto_.mutable_key2record();
+  for (const auto& pair : other.key2record()) {
+    auto it = key2record->find(pair.first);
+    if (it == key2record->end()) {
+      (*key2record)[pair.first] = pair.second;
+    } else {
+      TaskCostRecord* record = &it->second;
+      if (!record->has_desc()) { record->set_desc(pair.second.desc()); }
+      record->set_act_cnt(record->act_cnt() + pair.second.act_cnt());
+      record->set_total_duration(record->total_duration() + pair.second.total_duration());
+    }
+  }
+  // regst nums of later runs win
+  for (const auto& pair : other.regst_key2register_num()) {
+    (*proto_.mutable_regst_key2register_num())[pair.first] = pair.second;
+  }
+}
+
+void CostDB::UpdateFromActEvents(const Plan& plan,
+                                 const std::list<std::unique_ptr<ActEvent>>& act_events) {
+  HashMap<int64_t, const TaskProto*> task_id2task;
+  for (const TaskProto& task : plan.task()) { task_id2task.emplace(task.task_id(), &task); }
+  HashMap<int64_t, TaskCostRecord> task_id2record;
+  for (const auto& act_event : act_events) {
+    // the first act of an actor usually pays for warming up, e.g. autotuning and lazy init
+    if (act_event->act_id() == 0) { continue; }
+    if (task_id2task.find(act_event->actor_id()) == task_id2task.end()) { continue; }
+    TaskCostRecord* record = &task_id2record[act_event->actor_id()];
+    record->set_act_cnt(record->act_cnt() + 1);
+    record->set_total_duration(record->total_duration() + act_event->stop_time()
+                               - act_event->start_time());
+  }
+  // replicas of a data parallel op share the same key
+  CostDBProto delta;
+  for (const auto& pair : task_id2record) {
+    const TaskProto& task = *task_id2task.at(pair.first);
+    TaskCostRecord* record = &(*delta.mutable_key2record())[TaskKey(task)];
+    record->set_desc(TaskDesc(task));
+    record->set_act_cnt(record->act_cnt() + pair.second.act_cnt());
+    record->set_total_duration(record->total_duration() + pair.second.total_duration());
+  }
+  Merge(delta);
+}
+
+bool CostDB::PredictDuration(const TaskProto& task, double* duration) const {
+  const auto& it = proto_.key2record().find(TaskKey(task));
+  if (it == proto_.key2record().end() || it->second.act_cnt() == 0) { return false; }
+  *duration = it->second.total_duration() / it->second.act_cnt();
+  return true;
+}
+
+double CostDB::Coverage(const Plan& plan) const {
+  int64_t task_cnt = 0;
+  int64_t covered_cnt = 0;
+  for (const TaskProto& task : plan.task()) {
+    if (!IsTaskToImprove(task)) { continue; }
+    task_cnt += 1;
+    double duration = 0;
+    if (PredictDuration(task, &duration)) { covered_cnt += 1; }
+  }
+  return task_cnt == 0 ? 0 : 1.0 * covered_cnt / task_cnt;
+}
+
+void CostDB::ApplyRegstNumHints(Plan* plan) const {
+  if (proto_.regst_key2register_num().empty()) { return; }
+  for (int64_t i = 0; i < plan->task_size(); ++i) {
+    TaskProto* task = plan->mutable_task(i);
+    std::string task_key;
+    for (auto& pair : *task->mutable_produced_regst_desc()) {
+      RegstDescProto* regst_desc = &pair.second;
+      if (regst_desc->enable_reuse_mem()) { continue; }
+      if (task_key.empty()) { task_key = TaskKey(*task); }
+      const auto& it = proto_.regst_key2register_num().find(task_key + "/" + pair.first);
+      if (it == proto_.regst_key2register_num().end()) { continue; }
+      const int32_t register_num = std::min<int64_t>(it->second, regst_desc->max_register_num());
+      if (register_num <= regst_desc->register_num()) { continue; }
+      regst_desc->set_min_register_num(std::max(regst_desc->min_register_num(), register_num));
+      regst_desc->set_register_num(register_num);
+    }
+  }
+}
+
+void CostDB::PredictActEvents(const Plan& plan, int64_t piece_num,
+                              std::list<std::unique_ptr<ActEvent>>* act_events) const {
+  HashMap<int64_t, int64_t> regst_desc_id2producer_task_id;
+  for (const TaskProto& task : plan.task()) {
+    for (const auto& pair : task.produced_regst_desc()) {
+      regst_desc_id2producer_task_id.emplace(pair.second.regst_desc_id(), task.task_id());
+    }
+  }
+  auto ForEachConsumedRegstDescId = [&](const TaskProto& task,
+                                        const std::function<void(int64_t, int64_t)>& Handler) {
+    for (const auto& pair : task.consumed_regst_desc_id()) {
+      for (int64_t regst_desc_id : pair.second.regst_desc_id()) {
+        const auto& it = regst_desc_id2producer_task_id.find(regst_desc_id);
+        if (it == regst_desc_id2producer_task_id.end() || it->second == task.task_id()) {
+          continue;
+        }
+        Handler(regst_desc_id, it->second);
+      }
+    }
+  };
+  // durations, uncovered tasks are assumed as cheap as the cheapest covered one
+  HashMap<int64_t, double> task_id2duration;
+  double min_duration = GetMaxVal<double>();
+  for (const TaskProto& task : plan.task()) {
+    double duration = 0;
+    if (PredictDuration(task, &duration)) {
+      task_id2duration.emplace(task.task_id(), duration);
+      min_duration = std::min(min_duration, duration);
+    }
+  }
+  if (task_id2duration.empty()) { min_duration = 1; }
+  // topological order within a piece, tasks on cycles keep their order in plan
+  HashMap<int64_t, int64_t> task_id2in_degree;
+  HashMap<int64_t, std::vector<const TaskProto*>> task_id2consumers;
+  HashMap<int64_t, const TaskProto*> task_id2task;
+  for (const TaskProto& task : plan.task()) {
+    task_id2task.emplace(task.task_id(), &task);
+    task_id2in_degree[task.task_id()];
+    HashSet<int64_t> producer_task_ids;
+    ForEachConsumedRegstDescId(task, [&](int64_t, int64_t producer_task_id) {
+      producer_task_ids.insert(producer_task_id);
+    });
+    for (int64_t producer_task_id : producer_task_ids) {
+      task_id2in_degree[task.task_id()] += 1;
+      task_id2consumers[producer_task_id].push_back(&task);
+    }
+  }
+  std::vector<const TaskProto*> ordered_tasks;
+  HashSet<int64_t> ordered_task_ids;
+  std::queue<const TaskProto*> ready_tasks;
+  for (const TaskProto& task : plan.task()) {
+    if (task_id2in_degree.at(task.task_id()) == 0) { ready_tasks.push(&task); }
+  }
+  while (!ready_tasks.empty()) {
+    const TaskProto* task = ready_tasks.front();
+    ready_tasks.pop();
+    ordered_tasks.push_back(task);
+    ordered_task_ids.insert(task->task_id());
+    for (const TaskProto* consumer : task_id2consumers[task->task_id()]) {
+      if (--task_id2in_degree.at(consumer->task_id()) == 0) { ready_tasks.push(consumer); }
+    }
+  }
+  for (const TaskProto& task : plan.task()) {
+    if (ordered_task_ids.find(task.task_id()) == ordered_task_ids.end()) {
+      ordered_tasks.push_back(&task);
+    }
+  }
+  // every stream executes one act at a time, regsts are not a limit
+  HashMap<int64_t, double> work_stream_id2free_time;
+  HashMap<int64_t, double> task_id2stop_time;
+  FOR_RANGE(int64_t, piece_id, 0, piece_num) {
+    task_id2stop_time.clear();
+    for (const TaskProto* task : ordered_tasks) {
+      auto act_event = std::make_unique<ActEvent>();
+      double ready_time = 0;
+      ForEachConsumedRegstDescId(*task, [&](int64_t regst_desc_id, int64_t producer_task_id) {
+        const auto& it = task_id2stop_time.find(producer_task_id);
+        if (it == task_id2stop_time.end()) { return; }
+        ready_time = std::max(ready_time, it->second);
+        ReadableRegstInfo* readable = act_event->add_readable_regst_infos();
+        readable->set_regst_desc_id(regst_desc_id);
+        readable->set_act_id(piece_id);
+      });
+      int64_t work_stream_id = Global<IDMgr>::Get()->GlobalWorkStreamId4TaskId(task->task_id());
+      double start_time = std::max(ready_time, work_stream_id2free_time[work_stream_id]);
+      const auto& duration_it = task_id2duration.find(task->task_id());
+      double duration = duration_it == task_id2duration.end() ? min_duration : duration_it->second;
+      double stop_time = start_time + duration;
+      work_stream_id2free_time[work_stream_id] = stop_time;
+      task_id2stop_time[task->task_id()] = stop_time;
+      act_event->set_is_experiment_phase(true);
+      act_event->set_actor_id(task->task_id());
+      act_event->set_work_stream_id(work_stream_id);
+      act_event->set_act_id(piece_id);
+      act_event->set_ready_time(ready_time);
+      act_event->set_start_time(start_time);
+      act_event->set_stop_time(stop_time);
+      act_events->push_back(std::move(act_event));
+    }
+  }
+}
+
+void UpdateCostDBFile(const std::string& cost_db_path, const Plan& plan,
+                      const std::string& act_event_filepath) {
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  ParseActEvents(act_event_filepath, &act_events);
+  CostDB cost_db;
+  cost_db.Load(cost_db_path);
+  cost_db.UpdateFromActEvents(plan, act_events);
+  cost_db.Save(cost_db_path);
+  LOG(INFO) << "cost db " << cost_db_path << " updated with " << act_events.size()
+            << " act events, " << cost_db.proto().key2record_size() << " records in total";
+}
+
+}  // namespace oneflow
@@ -0,0 +1,70 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_COST_DB_H_
+#define ONEFLOW_CORE_JOB_COST_DB_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/cost_db.pb.h"
+#include "oneflow/core/job/plan.pb.h"
+#include "oneflow/core/job/task.pb.h"
+#include "oneflow/core/actor/act_event.pb.h"
+
+namespace oneflow {
+
+// CostDB persists the mean act duration of tasks across runs. Tasks are keyed by a signature of
+// their task type, device, op types, op attributes, sbp and blob shapes, which does not depend
+// on op names or ids, so the durations measured by one job can be reused by the next one.
+class CostDB final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CostDB);
+  CostDB() = default;
+  explicit CostDB(const CostDBProto& proto) : proto_(proto) {}
+  ~CostDB() = default;
+
+  static std::string TaskKey(const TaskProto& task);
+  static std::string TaskDesc(const TaskProto& task);
+  static std::string RegstKey(const TaskProto& task, const std::string& regst_name);
+
+  // return false if the file does not exist or can not be parsed
+  bool Load(const std::string& path);
+  void Save(const std::string& path) const;
+  void Merge(const CostDBProto& other);
+  void UpdateFromActEvents(const Plan& plan,
+                           const std::list<std::unique_ptr<ActEvent>>& act_events);
+
+  bool PredictDuration(const TaskProto& task, double* duration) const;
+  // fraction of the tasks to be improved whose duration is recorded in db
+  double Coverage(const Plan& plan) const;
+  // simulate piece_num pieces of plan with predicted durations and unlimited regsts, the result
+  // can be used to improve plan instead of the act events of an experiment run
+  void PredictActEvents(const Plan& plan, int64_t piece_num,
+                        std::list<std::unique_ptr<ActEvent>>* act_events) const;
+
+  // raise register_num of the regst descs grown by adaptive regst num in former runs
+  void ApplyRegstNumHints(Plan* plan) const;
+
+  const CostDBProto& proto() const { return proto_; }
+
+ private:
+  CostDBProto proto_;
+};
+
+void UpdateCostDBFile(const std::string& cost_db_path, const Plan& plan,
+                      const std::string& act_event_filepath);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_COST_DB_H_
@@ -0,0 +1,93 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/cost_db.h"
+
+namespace oneflow {
+namespace test {
+
+namespace {
+
+TaskProto NewMatmulTask(int64_t task_id, const std::string& op_name, int64_t m) {
+  TaskProto task;
+  task.set_task_type(TaskType::kNormalForward);
+  task.set_task_id(task_id);
+  task.mutable_task_set_info()->set_area_id(AreaType::kDataForwardArea);
+  OpAttribute* op_attribute =
+      task.mutable_exec_sequence()->add_exec_node()->mutable_kernel_conf()->mutable_op_attribute();
+  OperatorConf* op_conf = op_attribute->mutable_op_conf();
+  op_conf->set_name(op_name);
+  op_conf->set_device_tag("gpu");
+  op_conf->mutable_user_conf()->set_op_type_name("matmul");
+  (*op_conf->mutable_user_conf()->mutable_input())["a"].add_s(op_name + "_input/out");
+  ShapeProto* shape = (*op_attribute->mutable_logical_blob_desc_signature()
+                            ->mutable_bn_in_op2blob_desc())["a_0"]
+                          .mutable_body()
+                          ->mutable_shape();
+  shape->add_dim(m);
+  shape->add_dim(64);
+  return task;
+}
+
+ActEvent NewActEvent(int64_t actor_id, int64_t act_id, double start_time, double stop_time) {
+  ActEvent act_event;
+  act_event.set_actor_id(actor_id);
+  act_event.set_act_id(act_id);
+  act_event.set_start_time(start_time);
+  act_event.set_stop_time(stop_time);
+  return act_event;
+}
+
+}  // namespace
+
+TEST(CostDB, task_key_ignores_names) {
+  TaskProto task = NewMatmulTask(0, "matmul_a", 32);
+  ASSERT_EQ(CostDB::TaskKey(task), CostDB::TaskKey(NewMatmulTask(1, "matmul_b", 32)));
+  ASSERT_NE(CostDB::TaskKey(task), CostDB::TaskKey(NewMatmulTask(0, "matmul_a", 16)));
+  ASSERT_EQ(CostDB::TaskDesc(task), "kNormalForward:gpu:matmul");
+}
+
+TEST(CostDB, update_and_merge) {
+  Plan plan;
+  *plan.add_task() = NewMatmulTask(0, "matmul_a", 32);
+  *plan.add_task() = NewMatmulTask(1, "matmul_b", 32);
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  // act 0 is warm up and ignored
+  act_events.emplace_back(new ActEvent(NewActEvent(0, 0, 0, 100)));
+  act_events.emplace_back(new ActEvent(NewActEvent(0, 1, 100, 102)));
+  act_events.emplace_back(new ActEvent(NewActEvent(1, 1, 100, 104)));
+  CostDB cost_db;
+  cost_db.UpdateFromActEvents(plan, act_events);
+  ASSERT_EQ(cost_db.proto().key2record_size(), 1);
+  double duration = 0;
+  ASSERT_TRUE(cost_db.PredictDuration(plan.task(0), &duration));
+  ASSERT_DOUBLE_EQ(duration, 3);
+  ASSERT_DOUBLE_EQ(cost_db.Coverage(plan), 1);
+
+  CostDB other;
+  other.Merge(cost_db.proto());
+  other.Merge(cost_db.proto());
+  ASSERT_TRUE(other.PredictDuration(plan.task(1), &duration));
+  ASSERT_DOUBLE_EQ(duration, 3);
+  ASSERT_EQ(other.proto().key2record().begin()->second.act_cnt(), 4);
+
+  Plan uncovered_plan;
+  *uncovered_plan.add_task() = NewMatmulTask(0, "matmul_a", 16);
+  ASSERT_DOUBLE_EQ(cost_db.Coverage(uncovered_plan), 0);
+}
+
+}  // namespace test
+}  // namespace oneflow
@@ -516,7 +516,7 @@ void GenMemBlockAndChunk4Plan(Plan* plan) {
 
 }  // namespace
 
-uint64_t Improver::AvailableMemSize(int64_t machine_id, int64_t memory_zone_id) const {
+Maybe<uint64_t> Improver::AvailableMemSize(int64_t machine_id, int64_t memory_zone_id) const {
   int64_t mem_size = amd_.machine_amd(machine_id).zone_size(memory_zone_id);
   const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
   if (memory_zone_id == resource_desc->GpuDeviceNum()) {
@@ -524,8 +524,14 @@ uint64_t Improver::AvailableMemSize(int64_t machine_id, int64_t memory_zone_id)
   } else {
     mem_size -= resource_desc->reserved_device_mem_byte();
   }
-  CHECK_GT(mem_size, 0);
-  return static_cast<uint64_t>(mem_size);
+  CHECK_GT_OR_RETURN(mem_size, 0);
+  const int64_t adaptive_regst_mem_budget =
+      static_cast<int64_t>(resource_desc->adaptive_regst_mem_budget_byte());
+  CHECK_LT_OR_RETURN(adaptive_regst_mem_budget, mem_size)
+      << "resource.adaptive_regst_mem_budget_mbyte (" << adaptive_regst_mem_budget
+      << " bytes) leaves no memory for the planned regsts of memory zone " << memory_zone_id
+      << " on machine " << machine_id << ", which has " << mem_size << " bytes available";
+  return static_cast<uint64_t>(mem_size - adaptive_regst_mem_budget);
 }
 
 int64_t Improver::GetMemoryZoneId(const MemoryCase& mem_case) const {
@@ -559,7 +565,7 @@ Maybe<void> Improver::CheckAllZoneNotOOM(
       const auto& regst_descs = mz_regst_descs[machine_id][mem_zone_id];
       const uint64_t calc =
           CalcMemoryConsumed(regst_descs, PathDurations4RegstDescId, PathIIScales4RegstDescId, ii);
-      const uint64_t available = AvailableMemSize(machine_id, mem_zone_id);
+      const uint64_t available = JUST(AvailableMemSize(machine_id, mem_zone_id));
       if (calc >= available) {
         const auto* id_mgr = Global<IDMgr>::Get();
         const char* device_tag = JUST(DeviceTag4DeviceType(
@@ -698,6 +704,19 @@ Maybe<Plan> Improver::Improve(const AvailableMemDesc& amd, const Plan& naive_pla
   Init(amd, naive_plan);
   std::list<std::unique_ptr<ActEvent>> act_events;
   ParseActEvents(act_event_filepath, &act_events);
+  return ImproveWithActEvents(naive_plan, std::move(act_events));
+}
+
+Maybe<Plan> Improver::Improve(const AvailableMemDesc& amd, const Plan& naive_plan,
+                              const CostDB& cost_db, int64_t piece_num) {
+  Init(amd, naive_plan);
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  cost_db.PredictActEvents(naive_plan, piece_num, &act_events);
+  return ImproveWithActEvents(naive_plan, std::move(act_events));
+}
+
+Maybe<Plan> Improver::ImproveWithActEvents(const Plan& naive_plan,
+                                           std::list<std::unique_ptr<ActEvent>>&& act_events) {
   ChainActGraph chain_act_graph(naive_plan, std::move(act_events));
 
   auto PathDurations4RegstDescId = MakeGetterPathDurations4RegstDescId(chain_act_graph);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/memory/memory_case.pb.h"
 #include "oneflow/core/job/available_memory_desc.pb.h"
 #include "oneflow/core/graph/chain_act_graph.h"
+#include "oneflow/core/job/cost_db.h"
 
 namespace oneflow {
 
@@ -32,9 +33,14 @@ class Improver final {
 
   Maybe<Plan> Improve(const AvailableMemDesc& amd, const Plan& naive_plan,
                       const std::string& act_event_filepath);
+  // improve with the act events predicted by cost_db instead of an experiment run
+  Maybe<Plan> Improve(const AvailableMemDesc& amd, const Plan& naive_plan, const CostDB& cost_db,
+                      int64_t piece_num);
   Maybe<Plan> GenAndInferMemBlockIdOnly(const AvailableMemDesc& amd, const Plan& naive_plan);
 
  private:
+  Maybe<Plan> ImproveWithActEvents(const Plan& naive_plan,
+                                   std::list<std::unique_ptr<ActEvent>>&& act_events);
   Plan GenAndInferMemBlockId(const Plan& naive_plan) const;
   void Init(const AvailableMemDesc& amd, const Plan& naive_plan);
   Maybe<void> ForEachImprovedRegstNum(
@@ -58,7 +64,7 @@ class Improver final {
       const std::function<const HashMap<int64_t, double>&(int64_t)>& Duration4RegstDescId,
       const std::function<const HashMap<int64_t, double>&(int64_t)>& Ratio4RegstDescId,
       const MemZoneRegstDescs& mz_regst_descs) const;
-  uint64_t AvailableMemSize(int64_t machine_id, int64_t memory_zone_id) const;
+  Maybe<uint64_t> AvailableMemSize(int64_t machine_id, int64_t memory_zone_id) const;
   int64_t GetMemoryZoneId(const MemoryCase& mem_case) const;
   void MakeMemZoneRegstDescs(const Plan& plan, MemZoneRegstDescs* mz2regst_desc) const;
   double CalcMaxRegstDescDuration(
@@ -20,12 +20,13 @@ limitations under the License.
 #include "oneflow/core/common/buffer_manager.h"
 #include "oneflow/core/job/compiler.h"
 #include "oneflow/core/job/improver.h"
+#include "oneflow/core/job/cost_db.h"
 #include "oneflow/core/job/job_desc.h"
 #include "oneflow/core/job/job_builder.h"
 #include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/core/job/machine_context.h"
 #include "oneflow/core/job/profiler.h"
-#include "oneflow/core/job/sub_plan.pb.h"
+#include "oneflow/core/job/plan_broadcast.h"
 #include "oneflow/core/job/plan.pb.h"
 #include "oneflow/core/job/available_memory_desc.pb.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
@@ -79,26 +80,6 @@ struct ReentrantLockBackEdge {
   LogicalBlobId critical_section_sink_lbi;  // back edge source.
 };
 
-std::string cluster_thrd_ids_key(const std::string& plan_name) {
-  return plan_name + "_cluster_thrd_ids";
-}
-
-std::string net_topo_key(const std::string& plan_name) { return plan_name + "_net_topo"; }
-
-std::string job_id2job_conf(const std::string& plan_name) { return plan_name + "_job_id2job_conf"; }
-
-std::string GetCollectiveBoxingPlanKey(const std::string& plan_name) {
-  return plan_name + "_collective_boxing_plan";
-}
-
-std::string sub_plan_key(const std::string& plan_name, int64_t machine_id, int64_t thrd_id) {
-  return plan_name + "_" + std::to_string(machine_id) + "_" + std::to_string(thrd_id);
-}
-
-std::string block7chunk_key(const std::string& plan_name, int64_t machine_id) {
-  return plan_name + "_" + std::to_string(machine_id) + "_block7chunk";
-}
-
 std::shared_ptr<OperatorConf> CreateSinkTickOpConf(const std::string& in_op_name) {
   auto tick_op = std::make_shared<OperatorConf>();
   tick_op->set_name("System-Main-CallbackNotifier_TmpSinkTick_" + NewUniqueId());
@@ -108,78 +89,6 @@ std::shared_ptr<OperatorConf> CreateSinkTickOpConf(const std::string& in_op_name
   return tick_op;
 }
 
-void PushPlan(const std::string& plan_name, const Plan& plan) {
-  HashMap<int64_t, std::set<int64_t>> machine_id2thrd_id_set;
-  HashMap<std::pair<int64_t, int64_t>, std::vector<TaskProto>> mchn_thrd_id2task_protos;
-  HashMap<int64_t, MemBlockAndChunkList> machine_id2block7chunk;
-
-  for (const auto& task : plan.task()) {
-    machine_id2thrd_id_set[task.machine_id()].insert(task.thrd_id());
-    mchn_thrd_id2task_protos[std::make_pair(task.machine_id(), task.thrd_id())].emplace_back(task);
-  }
-
-  HashMap<int64_t, ThrdIds> machine_id2thrd_ids;
-  for (const auto& pair : machine_id2thrd_id_set) {
-    CHECK(machine_id2thrd_ids.emplace(pair.first, ThrdIds()).second);
-    std::vector<int64_t> thrd_id_vec(pair.second.begin(), pair.second.end());
-    *(machine_id2thrd_ids.at(pair.first).mutable_thrd_id()) = StdVec2PbRf(thrd_id_vec);
-  }
-
-  ClusterThrdIds cluster_thrd_ids;
-  *(cluster_thrd_ids.mutable_machine_id2thrd_ids()) = HashMap2PbMap(machine_id2thrd_ids);
-  Global<CtrlClient>::Get()->PushKV(cluster_thrd_ids_key(plan_name), cluster_thrd_ids);
-
-  for (const auto& pair : mchn_thrd_id2task_protos) {
-    SubPlan sub_plan;
-    *(sub_plan.mutable_task()) = StdVec2PbRpf(pair.second);
-    Global<CtrlClient>::Get()->PushKV(sub_plan_key(plan_name, pair.first.first, pair.first.second),
-                                      sub_plan);
-  }
-
-  for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
-    *machine_id2block7chunk[mem_block.machine_id()].add_mem_block() = mem_block;
-  }
-  for (const auto& chunk : plan.block_chunk_list().chunk()) {
-    *machine_id2block7chunk[chunk.machine_id()].add_chunk() = chunk;
-  }
-  for (const auto& pair : machine_id2block7chunk) {
-    Global<CtrlClient>::Get()->PushKV(block7chunk_key(plan_name, pair.first), pair.second);
-  }
-
-  Global<CtrlClient>::Get()->PushKV(net_topo_key(plan_name), plan.net_topo());
-  Global<CtrlClient>::Get()->PushKV(job_id2job_conf(plan_name), plan.job_confs());
-  Global<CtrlClient>::Get()->PushKV(GetCollectiveBoxingPlanKey(plan_name),
-                                    plan.collective_boxing_plan());
-}
-
-void PullPlan(const std::string& plan_name, Plan* plan) {
-  ClusterThrdIds cluster_thrd_ids;
-  Global<CtrlClient>::Get()->PullKV(cluster_thrd_ids_key(plan_name), &cluster_thrd_ids);
-  PrintProtoToTextFile(cluster_thrd_ids, JoinPath(FLAGS_log_dir, cluster_thrd_ids_key(plan_name)));
-  HashMap<int64_t, ThrdIds> machine_id2thrd_ids;
-  machine_id2thrd_ids = PbMap2HashMap(cluster_thrd_ids.machine_id2thrd_ids());
-  int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
-  auto thrd_ids_it = machine_id2thrd_ids.find(machine_id);
-  CHECK(thrd_ids_it != machine_id2thrd_ids.end());
-  std::vector<int64_t> thrd_id_vec = PbRf2StdVec(thrd_ids_it->second.thrd_id());
-  for (auto thrd_id : thrd_id_vec) {
-    SubPlan sub_plan;
-    Global<CtrlClient>::Get()->PullKV(sub_plan_key(plan_name, machine_id, thrd_id), &sub_plan);
-    plan->mutable_task()->MergeFrom(sub_plan.task());
-  }
-  NetTopo net_topo;
-  Global<CtrlClient>::Get()->PullKV(net_topo_key(plan_name), &net_topo);
-  *(plan->mutable_net_topo()) = net_topo;
-  JobConfs job_confs;
-  Global<CtrlClient>::Get()->PullKV(job_id2job_conf(plan_name), &job_confs);
-  *(plan->mutable_job_confs()) = job_confs;
-  Global<CtrlClient>::Get()->PullKV(GetCollectiveBoxingPlanKey(plan_name),
-                                    plan->mutable_collective_boxing_plan());
-  MemBlockAndChunkList block7chunk;
-  Global<CtrlClient>::Get()->PullKV(block7chunk_key(plan_name, machine_id), &block7chunk);
-  plan->mutable_block_chunk_list()->CopyFrom(block7chunk);
-}
-
 bool IsCollectiveBoxingNode(const PlanTaskNode* node) {
   const TaskType task_type = node->task_proto()->task_type();
   return task_type == TaskType::kCollectiveBoxingGeneric;
@@ -318,14 +227,44 @@ void GenCollectiveBoxingPlan(Job* job, Plan* plan) {
   }
 }
 
+std::unique_ptr<CostDB> TryLoadCostDB() {
+  const std::string& cost_db_path = Global<const ProfilerConf>::Get()->cost_db_path();
+  if (cost_db_path.empty()) { return nullptr; }
+  std::unique_ptr<CostDB> cost_db(new CostDB());
+  if (!cost_db->Load(cost_db_path)) {
+    LOG(INFO) << "cost db " << cost_db_path << " not found";
+    return nullptr;
+  }
+  return cost_db;
+}
+
+Maybe<void> TryImprovePlanWithCostDB(const CostDB& cost_db, const Plan& naive_plan,
+                                     Plan* improved_plan) {
+  // improving with a partially covered plan would size regst_num by guesses
+  const double kMinCostDBCoverage = 0.9;
+  const int64_t kMinPredictedPieceNum = 8;
+  const double coverage = cost_db.Coverage(naive_plan);
+  LOG(INFO) << "cost db coverage: " << coverage;
+  if (coverage < kMinCostDBCoverage) { return Maybe<void>::Ok(); }
+  const int64_t piece_num =
+      std::max(GlobalJobDesc().piece_num_of_experiment_phase(), kMinPredictedPieceNum);
+  *improved_plan =
+      *JUST(Improver().Improve(*Global<AvailableMemDesc>::Get(), naive_plan, cost_db, piece_num));
+  TeePersistentLogStream::Create("improved_plan")->Write(*improved_plan);
+  return Maybe<void>::Ok();
+}
+
 Maybe<void> CompileCurJobOnMaster(Job* job, Plan* improved_plan, bool need_job_complete) {
   const JobDesc& job_desc = GlobalJobDesc();
   Plan naive_plan;
   Plan complete_plan;
   double start = GetCurTime();
+  std::unique_ptr<CostDB> cost_db;
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
     Compiler().Compile(job, &naive_plan, need_job_complete);
     LOG(INFO) << "compile time: " << GetCurTime() - start;
+    cost_db = TryLoadCostDB();
+    if (cost_db) { cost_db->ApplyRegstNumHints(&naive_plan); }
     complete_plan =
         *JUST(Improver().GenAndInferMemBlockIdOnly(*Global<AvailableMemDesc>::Get(), naive_plan));
     if (Global<ResourceDesc, ForSession>::Get()->enable_debug_mode()) {
@@ -355,6 +294,7 @@ Maybe<void> CompileCurJobOnMaster(Job* job, Plan* improved_plan, bool need_job_c
     }
   } else {
     *improved_plan = complete_plan;
+    if (cost_db) { JUST(TryImprovePlanWithCostDB(*cost_db, naive_plan, improved_plan)); }
   }
   GenCollectiveBoxingPlan(job, improved_plan);
   LOG(INFO) << "compile and improve time: " << GetCurTime() - start;
@@ -1104,14 +1044,17 @@ Maybe<void> CompileAndMergePlanOnMaster(const PbRpf<Job>& conf_jobs, Plan* plan)
       TeePersistentLogStream::Create("merged_plan")->Write(*plan);
       PlanUtil::ToDotFile(*plan, "/dot/merged_plan.dot");
     }
+    const double broadcast_start = GetCurTime();
     PushPlan("merged_plan", *plan);
+    OF_SESSION_BARRIER();
+    LOG(INFO) << "plan broadcast time: " << (GetCurTime() - broadcast_start) / 1e9 << "s";
   } else {
     PullPlan("merged_plan", plan);
     if (Global<ResourceDesc, ForSession>::Get()->enable_debug_mode()) {
       TeePersistentLogStream::Create("merged_plan")->Write(*plan);
     }
+    OF_SESSION_BARRIER();
   }
-  OF_SESSION_BARRIER();
   return Maybe<void>::Ok();
 }
 
@@ -1136,8 +1079,11 @@ Oneflow::~Oneflow() {
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()) { runtime_buffers_scope_.reset(); }
   runtime_.reset();
   if (Global<Profiler>::Get() != nullptr) {
-    Global<Profiler>::Get()->Profile(
-        plan_, JoinPath(FLAGS_log_dir, ActEventLogger::act_event_bin_filename()));
+    const std::string act_event_filepath =
+        JoinPath(FLAGS_log_dir, ActEventLogger::act_event_bin_filename());
+    Global<Profiler>::Get()->Profile(plan_, act_event_filepath);
+    const std::string& cost_db_path = Global<const ProfilerConf>::Get()->cost_db_path();
+    if (!cost_db_path.empty()) { UpdateCostDBFile(cost_db_path, plan_, act_event_filepath); }
   }
 }
 
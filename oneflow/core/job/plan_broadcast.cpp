@@ -0,0 +1,244 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/plan_broadcast.h"
+#include "oneflow/core/common/lz4_util.h"
+#include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/sub_plan.pb.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+namespace {
+
+// sub plans larger than it are compressed before being pushed
+const size_t kSubPlanCompressThreshold = 64 * 1024;
+const char kRawSubPlanTag = 0;
+const char kLz4SubPlanTag = 1;
+
+std::string cluster_thrd_ids_key(const std::string& plan_name) {
+  return plan_name + "_cluster_thrd_ids";
+}
+
+std::string net_topo_key(const std::string& plan_name) { return plan_name + "_net_topo"; }
+
+std::string job_id2job_conf(const std::string& plan_name) { return plan_name + "_job_id2job_conf"; }
+
+std::string GetCollectiveBoxingPlanKey(const std::string& plan_name) {
+  return plan_name + "_collective_boxing_plan";
+}
+
+std::string sub_plan_key(const std::string& plan_name, int64_t machine_id, int64_t thrd_id) {
+  return plan_name + "_" + std::to_string(machine_id) + "_" + std::to_string(thrd_id);
+}
+
+std::string block7chunk_key(const std::string& plan_name, int64_t machine_id) {
+  return plan_name + "_" + std::to_string(machine_id) + "_block7chunk";
+}
+
+std::vector<std::string> SharedKeys(const std::string& plan_name) {
+  return {cluster_thrd_ids_key(plan_name), net_topo_key(plan_name), job_id2job_conf(plan_name),
+          GetCollectiveBoxingPlanKey(plan_name)};
+}
+
+void SerializeSubPlan(const SubPlan& sub_plan, std::string* val) {
+  std::string serialized;
+  sub_plan.SerializeToString(&serialized);
+  if (serialized.size() > kSubPlanCompressThreshold) {
+    std::string compressed;
+    Lz4CompressString(serialized, &compressed);
+    val->assign(1, kLz4SubPlanTag);
+    val->append(compressed);
+  } else {
+    val->assign(1, kRawSubPlanTag);
+    val->append(serialized);
+  }
+}
+
+void ParseSubPlan(const std::string& val, SubPlan* sub_plan) {
+  CHECK(!val.empty());
+  if (val.front() == kLz4SubPlanTag) {
+    std::string serialized;
+    Lz4DecompressString(val.substr(1), &serialized);
+    CHECK(sub_plan->ParseFromString(serialized));
+  } else {
+    CHECK_EQ(val.front(), kRawSubPlanTag);
+    CHECK(sub_plan->ParseFromArray(val.data() + 1, val.size() - 1));
+  }
+}
+
+int64_t PlanBroadcastFanout() {
+  const int64_t fanout = Global<ResourceDesc, ForSession>::Get()->plan_broadcast_fanout();
+  CHECK_GE(fanout, 1);
+  return fanout;
+}
+
+}  // namespace
+
+PlanBroadcastTree::PlanBroadcastTree(int64_t machine_num, int64_t fanout)
+    : machine_num_(machine_num), fanout_(fanout) {
+  CHECK_GT(machine_num_, 0);
+  CHECK_GT(fanout_, 0);
+}
+
+int64_t PlanBroadcastTree::Parent(int64_t machine_id) const {
+  CHECK_GT(machine_id, 0);
+  CHECK_LT(machine_id, machine_num_);
+  return (machine_id - 1) / fanout_;
+}
+
+std::vector<int64_t> PlanBroadcastTree::Children(int64_t machine_id) const {
+  std::vector<int64_t> children;
+  FOR_RANGE(int64_t, i, 1, fanout_ + 1) {
+    const int64_t child = machine_id * fanout_ + i;
+    if (child >= machine_num_) { break; }
+    children.push_back(child);
+  }
+  return children;
+}
+
+std::vector<int64_t> PlanBroadcastTree::Subtree(int64_t machine_id) const {
+  std::vector<int64_t> subtree{machine_id};
+  for (size_t i = 0; i < subtree.size(); ++i) {
+    for (int64_t child : Children(subtree.at(i))) { subtree.push_back(child); }
+  }
+  return subtree;
+}
+
+void PushPlan(const std::string& plan_name, const Plan& plan) {
+  const double start = GetCurTime();
+  HashMap<int64_t, std::set<int64_t>> machine_id2thrd_id_set;
+  HashMap<std::pair<int64_t, int64_t>, std::vector<TaskProto>> mchn_thrd_id2task_protos;
+  HashMap<int64_t, MemBlockAndChunkList> machine_id2block7chunk;
+
+  for (const auto& task : plan.task()) {
+    machine_id2thrd_id_set[task.machine_id()].insert(task.thrd_id());
+    mchn_thrd_id2task_protos[std::make_pair(task.machine_id(), task.thrd_id())].emplace_back(task);
+  }
+
+  HashMap<int64_t, ThrdIds> machine_id2thrd_ids;
+  for (const auto& pair : machine_id2thrd_id_set) {
+    CHECK(machine_id2thrd_ids.emplace(pair.first, ThrdIds()).second);
+    std::vector<int64_t> thrd_id_vec(pair.second.begin(), pair.second.end());
+    *(machine_id2thrd_ids.at(pair.first).mutable_thrd_id()) = StdVec2PbRf(thrd_id_vec);
+  }
+
+  ClusterThrdIds cluster_thrd_ids;
+  *(cluster_thrd_ids.mutable_machine_id2thrd_ids()) = HashMap2PbMap(machine_id2thrd_ids);
+
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
+    *machine_id2block7chunk[mem_block.machine_id()].add_mem_block() = mem_block;
+  }
+  for (const auto& chunk : plan.block_chunk_list().chunk()) {
+    *machine_id2block7chunk[chunk.machine_id()].add_chunk() = chunk;
+  }
+
+  // the master keeps its own plan, pieces of other machines are served to its children
+  std::vector<std::pair<std::string, std::string>> kvs;
+  std::vector<const std::vector<TaskProto>*> sub_plan_task_protos;
+  for (const auto& pair : mchn_thrd_id2task_protos) {
+    if (pair.first.first == 0) { continue; }
+    kvs.emplace_back(sub_plan_key(plan_name, pair.first.first, pair.first.second), "");
+    sub_plan_task_protos.push_back(&pair.second);
+  }
+  MultiThreadLoop(sub_plan_task_protos.size(), [&](size_t i) {
+    SubPlan sub_plan;
+    *(sub_plan.mutable_task()) = StdVec2PbRpf(*sub_plan_task_protos.at(i));
+    SerializeSubPlan(sub_plan, &kvs.at(i).second);
+  });
+  auto PushBack = [&](const std::string& key, const PbMessage& msg) {
+    kvs.emplace_back(key, "");
+    msg.SerializeToString(&kvs.back().second);
+  };
+  FOR_RANGE(int64_t, machine_id, 1, machine_num) {
+    // machines without mem blocks get an empty list, so that the subtree keys are all pushed
+    PushBack(block7chunk_key(plan_name, machine_id), machine_id2block7chunk[machine_id]);
+  }
+  PushBack(cluster_thrd_ids_key(plan_name), cluster_thrd_ids);
+  PushBack(net_topo_key(plan_name), plan.net_topo());
+  PushBack(job_id2job_conf(plan_name), plan.job_confs());
+  PushBack(GetCollectiveBoxingPlanKey(plan_name), plan.collective_boxing_plan());
+  size_t total_size = 0;
+  for (const auto& pair : kvs) { total_size += pair.second.size(); }
+  Global<CtrlClient>::Get()->PushKVs(Global<MachineCtx>::Get()->this_machine_id(), kvs);
+  LOG(INFO) << "push plan " << plan_name << " of " << total_size << " bytes, time: "
+            << (GetCurTime() - start) / 1e9 << "s";
+}
+
+void PullPlan(const std::string& plan_name, Plan* plan) {
+  const double start = GetCurTime();
+  const int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  const PlanBroadcastTree tree(Global<ResourceDesc, ForSession>::Get()->TotalMachineNum(),
+                               PlanBroadcastFanout());
+  const int64_t parent = tree.Parent(machine_id);
+
+  const std::vector<std::string> shared_keys = SharedKeys(plan_name);
+  std::vector<std::string> shared_vals;
+  Global<CtrlClient>::Get()->PullKVs(parent, shared_keys, &shared_vals);
+  ClusterThrdIds cluster_thrd_ids;
+  CHECK(cluster_thrd_ids.ParseFromString(shared_vals.at(0)));
+  PrintProtoToTextFile(cluster_thrd_ids, JoinPath(FLAGS_log_dir, cluster_thrd_ids_key(plan_name)));
+  HashMap<int64_t, ThrdIds> machine_id2thrd_ids;
+  machine_id2thrd_ids = PbMap2HashMap(cluster_thrd_ids.machine_id2thrd_ids());
+  auto thrd_ids_it = machine_id2thrd_ids.find(machine_id);
+  CHECK(thrd_ids_it != machine_id2thrd_ids.end());
+
+  std::vector<std::string> subtree_keys;
+  for (int64_t subtree_machine_id : tree.Subtree(machine_id)) {
+    subtree_keys.push_back(block7chunk_key(plan_name, subtree_machine_id));
+    auto it = machine_id2thrd_ids.find(subtree_machine_id);
+    if (it == machine_id2thrd_ids.end()) { continue; }
+    for (int64_t thrd_id : it->second.thrd_id()) {
+      subtree_keys.push_back(sub_plan_key(plan_name, subtree_machine_id, thrd_id));
+    }
+  }
+  std::vector<std::string> subtree_vals;
+  Global<CtrlClient>::Get()->PullKVs(parent, subtree_keys, &subtree_vals);
+  const double pull_time = GetCurTime() - start;
+  if (!tree.Children(machine_id).empty()) {
+    std::vector<std::pair<std::string, std::string>> kvs;
+    FOR_RANGE(size_t, i, 0, shared_keys.size()) {
+      kvs.emplace_back(shared_keys.at(i), shared_vals.at(i));
+    }
+    FOR_RANGE(size_t, i, 0, subtree_keys.size()) {
+      kvs.emplace_back(subtree_keys.at(i), subtree_vals.at(i));
+    }
+    Global<CtrlClient>::Get()->PushKVs(machine_id, kvs);
+  }
+
+  // the keys of this machine are the first ones of its subtree
+  MemBlockAndChunkList block7chunk;
+  CHECK(block7chunk.ParseFromString(subtree_vals.at(0)));
+  plan->mutable_block_chunk_list()->CopyFrom(block7chunk);
+  FOR_RANGE(int64_t, i, 0, thrd_ids_it->second.thrd_id_size()) {
+    SubPlan sub_plan;
+    ParseSubPlan(subtree_vals.at(i + 1), &sub_plan);
+    plan->mutable_task()->MergeFrom(sub_plan.task());
+  }
+  CHECK(plan->mutable_net_topo()->ParseFromString(shared_vals.at(1)));
+  CHECK(plan->mutable_job_confs()->ParseFromString(shared_vals.at(2)));
+  CHECK(plan->mutable_collective_boxing_plan()->ParseFromString(shared_vals.at(3)));
+  LOG(INFO) << "pull plan " << plan_name << " from machine " << parent
+            << ", pull time: " << pull_time / 1e9
+            << "s, total time: " << (GetCurTime() - start) / 1e9 << "s";
+}
+
+}  // namespace oneflow
@@ -0,0 +1,48 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_PLAN_BROADCAST_H_
+#define ONEFLOW_CORE_JOB_PLAN_BROADCAST_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// The plan is broadcast from the master along a tree of machines with the given fanout. Every
+// worker pulls the pieces of the plan for its subtree from its parent in two batched calls, then
+// serves the pieces for its children on its own ctrl server.
+class PlanBroadcastTree final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(PlanBroadcastTree);
+  PlanBroadcastTree(int64_t machine_num, int64_t fanout);
+  ~PlanBroadcastTree() = default;
+
+  int64_t Parent(int64_t machine_id) const;
+  std::vector<int64_t> Children(int64_t machine_id) const;
+  // the machine itself is included
+  std::vector<int64_t> Subtree(int64_t machine_id) const;
+
+ private:
+  int64_t machine_num_;
+  int64_t fanout_;
+};
+
+void PushPlan(const std::string& plan_name, const Plan& plan);
+void PullPlan(const std::string& plan_name, Plan* plan);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_PLAN_BROADCAST_H_
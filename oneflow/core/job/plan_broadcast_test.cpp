@@ -0,0 +1,163 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/plan_broadcast.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/control/ctrl_server.h"
+#include "oneflow/core/control/ctrl_util.h"
+#include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+const int64_t kMachineNum = 5;
+const int64_t kThrdNumPerMachine = 3;
+
+EnvProto GetEnvProto(const std::vector<int>& ports, int64_t this_machine_id) {
+  EnvProto ret;
+  FOR_RANGE(int64_t, i, 0, kMachineNum) {
+    auto* machine = ret.add_machine();
+    machine->set_id(i);
+    machine->set_addr("127.0.0.1");
+    machine->set_ctrl_port_agent(ports.at(i));
+  }
+  ret.set_ctrl_port(ports.at(this_machine_id));
+  return ret;
+}
+
+Resource GetResource() {
+  Resource ret;
+  ret.set_machine_num(kMachineNum);
+  ret.set_gpu_device_num(0);
+  ret.set_cpu_device_num(1);
+  ret.set_comm_net_worker_num(1);
+  ret.set_plan_broadcast_fanout(2);
+  return ret;
+}
+
+Plan GetPlan() {
+  Plan plan;
+  FOR_RANGE(int64_t, machine_id, 0, kMachineNum) {
+    FOR_RANGE(int64_t, thrd_id, 0, kThrdNumPerMachine) {
+      TaskProto* task = plan.add_task();
+      task->set_task_type(TaskType::kNormalForward);
+      task->set_machine_id(machine_id);
+      task->set_thrd_id(thrd_id);
+      task->set_task_id(machine_id * kThrdNumPerMachine + thrd_id);
+      task->set_job_id(0);
+      task->mutable_task_set_info()->set_area_id(0);
+      task->mutable_task_set_info()->set_chain_id(0);
+      task->mutable_task_set_info()->set_order_in_graph(0);
+      task->mutable_exec_sequence();
+    }
+    MemBlockProto* mem_block = plan.mutable_block_chunk_list()->add_mem_block();
+    mem_block->set_mem_block_id(machine_id);
+    mem_block->set_machine_id(machine_id);
+    mem_block->mutable_mem_case()->mutable_host_mem();
+    mem_block->set_enable_reuse_mem(false);
+    mem_block->set_mem_size(0);
+  }
+  plan.mutable_net_topo();
+  plan.mutable_job_confs();
+  plan.mutable_collective_boxing_plan();
+  return plan;
+}
+
+// return true if this machine gets its pieces of the plan
+bool BroadcastPlan(const std::vector<int>& ports, int64_t this_machine_id) {
+  Global<EnvDesc>::New(GetEnvProto(ports, this_machine_id));
+  Global<CtrlServer>::New();
+  Global<CtrlClient>::New();
+  Global<MachineCtx>::New(this_machine_id);
+  Global<ResourceDesc, ForSession>::New(GetResource());
+  Global<ThreadPool>::New(2);
+
+  bool is_valid = true;
+  if (this_machine_id == 0) {
+    PushPlan("test_plan", GetPlan());
+  } else {
+    Plan plan;
+    PullPlan("test_plan", &plan);
+    is_valid = plan.task_size() == kThrdNumPerMachine
+               && plan.block_chunk_list().mem_block_size() == 1
+               && plan.block_chunk_list().mem_block(0).machine_id() == this_machine_id;
+    for (const TaskProto& task : plan.task()) {
+      is_valid = is_valid && task.machine_id() == this_machine_id;
+    }
+  }
+  // ctrl servers keep serving until all the machines get their plans
+  Global<CtrlClient>::Get()->Barrier("plan_broadcast_test", kMachineNum);
+
+  Global<ThreadPool>::Delete();
+  Global<ResourceDesc, ForSession>::Delete();
+  Global<MachineCtx>::Delete();
+  Global<CtrlClient>::Delete();
+  Global<CtrlServer>::Delete();
+  Global<EnvDesc>::Delete();
+  return is_valid;
+}
+
+}  // namespace
+
+TEST(PlanBroadcastTree, parent_children_subtree) {
+  PlanBroadcastTree tree(10, 3);
+  ASSERT_EQ(tree.Parent(1), 0);
+  ASSERT_EQ(tree.Parent(3), 0);
+  ASSERT_EQ(tree.Parent(4), 1);
+  ASSERT_EQ(tree.Parent(9), 2);
+  ASSERT_EQ(tree.Children(0), (std::vector<int64_t>{1, 2, 3}));
+  ASSERT_EQ(tree.Children(2), (std::vector<int64_t>{7, 8, 9}));
+  ASSERT_TRUE(tree.Children(3).empty());
+  ASSERT_EQ(tree.Subtree(1), (std::vector<int64_t>{1, 4, 5, 6}));
+  ASSERT_EQ(tree.Subtree(0).size(), 10);
+}
+
+TEST(PlanBroadcast, push_pull_in_local_processes) {
+  const std::vector<int> ports = CtrlUtil().FindAvailablePorts(kMachineNum);
+  if (ports.empty()) { return; }
+  std::vector<pid_t> pids;
+  FOR_RANGE(int64_t, machine_id, 1, kMachineNum) {
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) { _exit(BroadcastPlan(ports, machine_id) ? 0 : 1); }
+    pids.push_back(pid);
+  }
+  ASSERT_TRUE(BroadcastPlan(ports, 0));
+  for (pid_t pid : pids) {
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+  }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
@@ -41,10 +41,21 @@ class ResourceDesc final {
   int32_t MaxMdSaveWorkerNum() const { return resource_.max_mdsave_worker_num(); }
   size_t reserved_host_mem_byte() const { return resource_.reserved_host_mem_mbyte() * kMB; }
   size_t reserved_device_mem_byte() const { return resource_.reserved_device_mem_mbyte() * kMB; }
+  size_t adaptive_regst_mem_budget_byte() const {
+    return resource_.adaptive_regst_mem_budget_mbyte() * kMB;
+  }
+  int32_t plan_broadcast_fanout() const { return resource_.plan_broadcast_fanout(); }
   bool use_rdma() const { return resource_.use_rdma(); }
   bool enable_numa_aware_cuda_malloc_host() const {
     return resource_.enable_numa_aware_cuda_malloc_host();
   }
+  bool enable_numa_aware_cpu_placement() const {
+    return resource_.enable_numa_aware_cpu_placement();
+  }
+  int64_t host_regst_huge_page_kbyte() const { return resource_.host_regst_huge_page_kbyte(); }
+  size_t comm_net_compression_threshold_byte() const {
+    return resource_.comm_net_compression_threshold_kbyte() * 1024;
+  }
   bool thread_enable_local_message_queue() const {
     return resource_.thread_enable_local_message_queue();
   }
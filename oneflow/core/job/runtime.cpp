@@ -23,6 +23,8 @@ limitations under the License.
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/job/runtime_job_descs.h"
 #include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/thread/numa_topology.h"
 #include "oneflow/core/actor/act_event_logger.h"
 #include "oneflow/core/graph/task_node.h"
 #include "oneflow/core/device/cuda_util.h"
@@ -31,6 +33,8 @@ limitations under the License.
 #include "oneflow/user/summary/events_writer.h"
 #include "oneflow/core/job/collective_boxing_executor.h"
 #include "oneflow/core/job/collective_boxing_device_ctx_poller.h"
+#include "oneflow/core/persistence/persistent_out_stream.h"
+#include "oneflow/core/profiler/timeline.h"
 
 namespace oneflow {
 
@@ -58,9 +62,32 @@ bool HasNonCtrlConsumedRegstDescId(const TaskProto& task) {
   return false;
 }
 
+// Runtimes of a process are numbered in the order they are constructed
+int64_t NewRuntimeId() {
+  static std::atomic<int64_t> runtime_cnt(0);
+  return runtime_cnt++;
+}
+
+// A timeline enabled by env var ONEFLOW_TIMELINE_PROFILER is dumped when the runtime exits, to
+// files named by env var ONEFLOW_TIMELINE_PROFILER_OUTPUT, the runtime id and the machine id, so
+// that the runtimes of one process do not overwrite each other's files.
+void TryDumpTimeline(int64_t runtime_id) {
+  const char* output = std::getenv("ONEFLOW_TIMELINE_PROFILER_OUTPUT");
+  if (output == nullptr || !profiler::IsTimelineEnabled()) { return; }
+  const int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  const std::string path_prefix = std::string(output) + "-runtime" + std::to_string(runtime_id)
+                                  + "-" + std::to_string(machine_id);
+  profiler::DumpTimelineChromeTrace(path_prefix + ".json");
+  const std::string statistics = profiler::TimelineStatistics();
+  PersistentOutStream out_stream(LocalFS(), path_prefix + ".txt");
+  out_stream.Write(statistics.data(), statistics.size());
+  LOG(INFO) << "timeline dumped to " << path_prefix << ".json and " << path_prefix << ".txt";
+}
+
 }  // namespace
 
-Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_phase) {
+Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_phase)
+    : runtime_id_(NewRuntimeId()) {
   NewAllGlobal(plan, total_piece_num, is_experiment_phase);
   std::vector<const TaskProto*> source_tasks;
   std::vector<const TaskProto*> other_tasks;
@@ -91,7 +118,11 @@ Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_ph
 Runtime::~Runtime() {
   Global<RuntimeCtx>::Get()->WaitUntilCntEqualZero("running_actor_cnt");
   OF_SESSION_BARRIER();
+  Global<RegstMgr>::Get()->ExportAdaptiveRegstNum();
   DeleteAllGlobal();
+  TryDumpTimeline(runtime_id_);
+  const int64_t dtlb_miss_cnt = dtlb_miss_counter_->Read();
+  if (dtlb_miss_cnt >= 0) { LOG(INFO) << "dtlb load misses of actor threads: " << dtlb_miss_cnt; }
 }
 
 void Runtime::NewAllGlobal(const Plan& plan, size_t total_piece_num, bool is_experiment_phase) {
@@ -124,9 +155,11 @@ void Runtime::NewAllGlobal(const Plan& plan, size_t total_piece_num, bool is_exp
 #endif
   }
   Global<boxing::collective::CollectiveBoxingExecutor>::New(plan);
+  if (IsNumaAwareCpuPlacementEnabled()) { Global<ThreadPool>::Get()->EnableNumaPartition(); }
   Global<MemoryAllocator>::New();
   Global<RegstMgr>::New(plan);
   Global<ActorMsgBus>::New();
+  dtlb_miss_counter_.reset(new DTlbMissCounter());
   Global<ThreadMgr>::New(plan);
   Global<boxing::collective::CollectiveBoxingDeviceCtxPoller>::New();
   Global<RuntimeJobDescs>::New(plan.job_confs().job_id2job_conf());
@@ -140,6 +173,7 @@ void Runtime::DeleteAllGlobal() {
   Global<ActorMsgBus>::Delete();
   Global<RegstMgr>::Delete();
   Global<MemoryAllocator>::Delete();
+  if (IsNumaAwareCpuPlacementEnabled()) { Global<ThreadPool>::Get()->DisableNumaPartition(); }
   Global<boxing::collective::CollectiveBoxingExecutor>::Delete();
 
   // should be called after Global<Transport>::Delete()
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/job/job_desc.h"
 #include "oneflow/core/job/plan.pb.h"
 #include "oneflow/core/job/runtime_context.h"
+#include "oneflow/core/memory/huge_page_util.h"
 
 namespace oneflow {
 
@@ -33,6 +34,10 @@ class Runtime final {
  private:
   void NewAllGlobal(const Plan& plan, size_t total_piece_num, bool is_experiment_phase);
   void DeleteAllGlobal();
+
+  const int64_t runtime_id_;
+  // counts the actor threads, which exit before it is read
+  std::unique_ptr<DTlbMissCounter> dtlb_miss_counter_;
 };
 
 }  // namespace oneflow
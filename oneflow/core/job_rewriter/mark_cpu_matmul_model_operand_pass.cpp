@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/job_rewriter/job_pass.h"
+
+namespace oneflow {
+
+namespace {
+
+// Sets _b_is_model of the cpu matmul ops in a predict job whose b comes straight from a variable,
+// so that the kernel packs b once and reuses the panels until the model version changes.
+class MarkCpuMatmulModelOperandPass final : public JobPass {
+ public:
+  MarkCpuMatmulModelOperandPass() = default;
+  ~MarkCpuMatmulModelOperandPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return !ctx.job_desc().IsTrain()
+           && ctx.job_desc().job_conf().enable_cpu_matmul_weight_prepacking();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> MarkCpuMatmulModelOperandPass::Apply(const OpGraph& op_graph,
+                                                 JobBuilder* job_builder) const {
+  std::vector<OperatorConf> matmul_op_confs;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (!op_conf.has_user_conf()) { return; }
+    if (op_conf.user_conf().op_type_name() != "matmul") { return; }
+    if (op_node->parallel_desc().device_type() != DeviceType::kCPU) { return; }
+    const user_op::UserOpConfWrapper user_op_conf(op_conf);
+    if (user_op_conf.attr<bool>("_b_is_model")) { return; }
+    const LogicalBlobId b_lbi = GenLogicalBlobId(user_op_conf.input("b", 0));
+    const OpNode* producer = op_graph.OpNode4OpName(b_lbi.op_name());
+    if (!producer->op().op_conf().has_variable_conf()) { return; }
+    OperatorConf new_op_conf = op_conf;
+    (*new_op_conf.mutable_user_conf()->mutable_attr())["_b_is_model"].set_at_bool(true);
+    matmul_op_confs.push_back(new_op_conf);
+  });
+  job_builder->MutOpsOnlyOnce(matmul_op_confs);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("MarkCpuMatmulModelOperandPass", MarkCpuMatmulModelOperandPass);
+
+}  // namespace oneflow
@@ -0,0 +1,150 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+// update op type name -> (multi tensor op type name, inputs taken per model)
+const HashMap<std::string, std::pair<std::string, std::vector<std::string>>>&
+UpdateOpType2MultiTensorOpType() {
+  static const HashMap<std::string, std::pair<std::string, std::vector<std::string>>> map{
+      {"sgd_update", {"multi_tensor_sgd_update", {"model", "model_diff"}}},
+      {"momentum_update", {"multi_tensor_momentum_update", {"model", "model_diff", "momentum"}}},
+      {"adam_update", {"multi_tensor_adam_update", {"model", "model_diff", "m", "v"}}},
+      {"lamb_update",
+       {"multi_tensor_lamb_update", {"model", "model_diff", "m", "v", "beta1_t", "beta2_t"}}},
+      {"lars_update", {"multi_tensor_lars_update", {"model", "model_diff", "momentum"}}},
+  };
+  return map;
+}
+
+// update ops with the same key only differ in the inputs taken per model
+std::string GroupKey4UpdateOp(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  UserOpConf user_conf = op_conf.user_conf();
+  for (const std::string& arg_name :
+       UpdateOpType2MultiTensorOpType().at(user_conf.op_type_name()).second) {
+    user_conf.mutable_input()->erase(arg_name);
+  }
+  const user_op::UserOpConfWrapper user_op_conf(op_conf);
+  const auto DataType4Input = [&](const std::string& arg_name) {
+    return op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(user_op_conf.input(arg_name, 0)))
+        .data_type();
+  };
+  return PbMessage2TxtString(user_conf)
+         + PbMessage2TxtString(op_node->parallel_desc().parallel_conf())
+         + std::to_string(DataType4Input("model")) + std::to_string(DataType4Input("model_diff"))
+         + std::to_string(op_conf.scope_symbol_id());
+}
+
+class MultiTensorModelUpdatePass final : public JobPass {
+ public:
+  MultiTensorModelUpdatePass() = default;
+  ~MultiTensorModelUpdatePass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().enable_multi_tensor_model_update();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> MultiTensorModelUpdatePass::Apply(const OpGraph& op_graph,
+                                              JobBuilder* job_builder) const {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  std::vector<std::string> group_keys;
+  HashMap<std::string, std::vector<const OpNode*>> group_key2op_nodes;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (!op_conf.has_user_conf()) { return; }
+    if (UpdateOpType2MultiTensorOpType().count(op_conf.user_conf().op_type_name()) == 0) {
+      return;
+    }
+    // the multi tensor kernels are cpu only and take broadcast models only
+    if (op_node->parallel_desc().device_type() != DeviceType::kCPU) { return; }
+    if (ctrl_in_op_names.find(op_conf.name()) != ctrl_in_op_names.end()) { return; }
+    const user_op::UserOpConfWrapper user_op_conf(op_conf);
+    for (const std::string& arg_name :
+         UpdateOpType2MultiTensorOpType().at(user_op_conf.op_type_name()).second) {
+      const LogicalBlobId lbi = GenLogicalBlobId(user_op_conf.input(arg_name, 0));
+      if (!op_node->SbpParallel4Lbi(lbi).has_broadcast_parallel()) { return; }
+    }
+    const std::string group_key = GroupKey4UpdateOp(op_node);
+    auto it = group_key2op_nodes.find(group_key);
+    if (it == group_key2op_nodes.end()) {
+      group_keys.push_back(group_key);
+      it = group_key2op_nodes.emplace(group_key, std::vector<const OpNode*>()).first;
+    }
+    it->second.push_back(op_node);
+  });
+  for (const std::string& group_key : group_keys) {
+    // a group of one model is rewritten too, the multi tensor kernel updates it in parallel
+    const std::vector<const OpNode*>& op_nodes = group_key2op_nodes.at(group_key);
+    const OperatorConf& first_op_conf = op_nodes.front()->op().op_conf();
+    const user_op::UserOpConfWrapper first_user_op_conf(first_op_conf);
+    const auto& multi_tensor_op_type =
+        UpdateOpType2MultiTensorOpType().at(first_user_op_conf.op_type_name());
+    // inputs shared by the group and attrs are taken from the first op, they are all the same
+    OperatorConf multi_tensor_op_conf = first_op_conf;
+    multi_tensor_op_conf.set_name("System-MultiTensorModelUpdate-" + multi_tensor_op_type.first
+                                  + "-" + NewUniqueId());
+    multi_tensor_op_conf.clear_ctrl_in_op_name();
+    UserOpConf* user_conf = multi_tensor_op_conf.mutable_user_conf();
+    user_conf->set_op_type_name(multi_tensor_op_type.first);
+    HashSet<std::string> merged_ctrl_in_op_names;
+    std::vector<std::string> del_op_names;
+    for (const std::string& arg_name : multi_tensor_op_type.second) {
+      (*user_conf->mutable_input())[arg_name].clear_s();
+    }
+    for (const OpNode* op_node : op_nodes) {
+      const OperatorConf& op_conf = op_node->op().op_conf();
+      const user_op::UserOpConfWrapper user_op_conf(op_conf);
+      for (const std::string& arg_name : multi_tensor_op_type.second) {
+        *(*user_conf->mutable_input())[arg_name].add_s() = user_op_conf.input(arg_name, 0);
+      }
+      for (const std::string& ctrl_in_op_name : op_conf.ctrl_in_op_name()) {
+        if (merged_ctrl_in_op_names.insert(ctrl_in_op_name).second) {
+          multi_tensor_op_conf.add_ctrl_in_op_name(ctrl_in_op_name);
+        }
+      }
+      del_op_names.push_back(op_conf.name());
+    }
+    job_builder->DelOps(del_op_names);
+    job_builder->AddOps(op_nodes.front()->parallel_desc().parallel_conf(), {multi_tensor_op_conf});
+    LOG(INFO) << multi_tensor_op_conf.name() << " updates " << op_nodes.size() << " models";
+  }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("MultiTensorModelUpdatePass", MultiTensorModelUpdatePass);
+
+}  // namespace oneflow
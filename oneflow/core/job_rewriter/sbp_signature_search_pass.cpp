@@ -0,0 +1,426 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/job/sbp_parallel.h"
+#include "oneflow/core/framework/user_op_registry_manager.h"
+
+namespace oneflow {
+
+namespace {
+
+const double kInfeasibleCost = std::numeric_limits<double>::infinity();
+// A byte crossing devices is weighted against a byte touched by local compute
+const double kTransferCostWeight = 4.0;
+const int32_t kMaxRefineIterNum = 8;
+
+double LogicalBlobBytes(const BlobDesc& blob_desc) {
+  return static_cast<double>(blob_desc.shape().elem_cnt())
+         * GetSizeOfDataType(blob_desc.data_type());
+}
+
+// Bytes of the blob one device holds, which the op reads or writes
+double ComputeBytes(double bytes, const SbpParallel& sbp_parallel, int64_t parallel_num) {
+  return sbp_parallel.has_split_parallel() ? bytes / parallel_num : bytes;
+}
+
+// Estimated bytes crossing devices to turn src into dst, from the textbook volumes of the
+// collective each pair calls for on one placement: all2all for S->S, all gather for S->B, reduce
+// scatter for P->S, all reduce for P->B and nothing for B->S or B->P. Across placements every
+// piece of src is assumed to be sent once, and once more to each extra device for a broadcast.
+// These are approximations for ranking signatures, not the costs of the boxing the sub task
+// graph builders end up choosing, which also depend on the device type and the job config
+double TransferBytes(double bytes, const SbpParallel& src, const ParallelDesc& src_parallel_desc,
+                     const SbpParallel& dst, const ParallelDesc& dst_parallel_desc) {
+  if (dst.has_partial_sum_parallel() && !src.has_partial_sum_parallel()) {
+    if (!src.has_broadcast_parallel()) { return kInfeasibleCost; }
+  }
+  if (src_parallel_desc == dst_parallel_desc) {
+    if (src == dst || src.has_broadcast_parallel()) { return 0; }
+    const int64_t parallel_num = dst_parallel_desc.parallel_num();
+    if (src.has_split_parallel()) {
+      return dst.has_split_parallel() ? bytes * (parallel_num - 1) / parallel_num
+                                      : bytes * (parallel_num - 1);
+    } else {
+      return dst.has_split_parallel() ? bytes * (parallel_num - 1)
+                                      : 2 * bytes * (parallel_num - 1);
+    }
+  } else {
+    const double src_bytes =
+        src.has_partial_sum_parallel() ? bytes * src_parallel_desc.parallel_num() : bytes;
+    const double dst_bytes =
+        dst.has_broadcast_parallel() ? bytes * (dst_parallel_desc.parallel_num() - 1) : 0;
+    return src_bytes + dst_bytes;
+  }
+}
+
+bool IsSbpSearchable(const OpNode* op_node) {
+  if (op_node->parallel_desc().parallel_num() <= 1) { return false; }
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  // ops that infer their own signature would not follow the hint
+  if (!op_conf.has_user_conf()) { return false; }
+  const user_op::OpRegistryResult* val =
+      user_op::UserOpRegistryMgr::Get().GetOpRegistryResult(op_conf.user_conf().op_type_name());
+  if (val == nullptr || val->infer_sbp_signature_fn) { return false; }
+  for (const std::string& ibn : op_node->op().input_bns()) {
+    if (op_node->op().InputBlobModifier4Ibn(ibn).is_mutable()) { return false; }
+    const LogicalBlobId& lbi = op_node->op().BnInOp2Lbi(ibn);
+    if (op_node->LogicalBlobDesc4Lbi(lbi).is_dynamic()) { return false; }
+  }
+  for (const std::string& obn : op_node->op().output_bns()) {
+    const LogicalBlobId& lbi = op_node->op().BnInOp2Lbi(obn);
+    if (op_node->LogicalBlobDesc4Lbi(lbi).is_dynamic()) { return false; }
+  }
+  return true;
+}
+
+struct SearchNode {
+  const OpNode* op_node;
+  // input bns, then output bns
+  std::vector<std::string> bns;
+  std::vector<SbpSignature> candidates;
+  // candidate id -> bn id -> sbp parallel
+  std::vector<std::vector<SbpParallel>> sbp_parallels;
+  std::vector<double> compute_costs;
+  int64_t greedy;
+  int64_t chosen;
+  bool searchable() const { return candidates.size() > 1; }
+};
+
+// A blob consumed by one input of an op
+struct SearchEdge {
+  int64_t producer;
+  int64_t producer_bn;
+  int64_t consumer;
+  int64_t consumer_bn;
+  double bytes;
+};
+
+// Every op has a list of candidate signatures, the fixed ops only have the signature they got.
+// The cost of a plan is the compute cost of the chosen signatures plus the boxing cost of every
+// consumed blob. Starting from the greedy plan, it repeatedly takes each chain of searchable
+// ops, where an op's sole consumer is the next op, and finds the best signatures of the chain
+// with the rest of the plan fixed by dynamic programming. No step raises the cost
+class SbpSignatureSearcher final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SbpSignatureSearcher);
+  SbpSignatureSearcher(const OpGraph& op_graph, const JobParallelViewConf& job_parallel_view_conf);
+  ~SbpSignatureSearcher() = default;
+
+  double GreedyCost() const;
+  double SearchedCost() const;
+  void Search();
+  void ForEachSearchedNode(const std::function<void(const SearchNode&)>& Handler) const;
+
+ private:
+  void InitNode(const OpNode* op_node, const JobParallelViewConf& job_parallel_view_conf,
+                SearchNode* node) const;
+  void InitEdges(const HashMap<const OpNode*, int64_t>& op_node2node_id);
+  void InitChains();
+  double EdgeCost(const SearchEdge& edge, int64_t producer_candidate,
+                  int64_t consumer_candidate) const;
+  double TotalCost(const std::function<int64_t(const SearchNode&)>& Candidate4Node) const;
+  // returns true if the chain got a cheaper assignment
+  bool SearchChain(const std::vector<int64_t>& chain);
+
+  std::vector<SearchNode> nodes_;
+  std::vector<SearchEdge> edges_;
+  std::vector<std::vector<int64_t>> node_id2in_edge_ids_;
+  std::vector<std::vector<int64_t>> node_id2out_edge_ids_;
+  std::vector<std::vector<int64_t>> chains_;
+};
+
+SbpSignatureSearcher::SbpSignatureSearcher(const OpGraph& op_graph,
+                                           const JobParallelViewConf& job_parallel_view_conf) {
+  HashMap<const OpNode*, int64_t> op_node2node_id;
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    op_node2node_id.emplace(op_node, nodes_.size());
+    nodes_.emplace_back();
+    InitNode(op_node, job_parallel_view_conf, &nodes_.back());
+  });
+  InitEdges(op_node2node_id);
+  InitChains();
+}
+
+void SbpSignatureSearcher::InitNode(const OpNode* op_node,
+                                    const JobParallelViewConf& job_parallel_view_conf,
+                                    SearchNode* node) const {
+  const Operator& op = op_node->op();
+  node->op_node = op_node;
+  node->bns.insert(node->bns.end(), op.input_bns().begin(), op.input_bns().end());
+  node->bns.insert(node->bns.end(), op.output_bns().begin(), op.output_bns().end());
+  node->greedy = 0;
+  const SbpSignature& greedy_signature = op_node->sbp_signature();
+  if (IsSbpSearchable(op_node)) {
+    auto LogicalBlobDesc4Ibn = [&](const std::string& ibn) -> Maybe<const BlobDesc&> {
+      return Maybe<const BlobDesc&>(op_node->LogicalBlobDesc4Lbi(op.BnInOp2Lbi(ibn)));
+    };
+    SbpSignatureList sbp_sig_list;
+    CHECK_JUST(op.GetSbpSignaturesIf(LogicalBlobDesc4Ibn, op_node->parallel_desc(), &sbp_sig_list));
+    SbpSignature sbp_sig_conf;
+    const auto& op_name2sbp_sig_conf = job_parallel_view_conf.op_name2sbp_signature_conf();
+    const auto& conf_it = op_name2sbp_sig_conf.find(op.op_name());
+    if (conf_it != op_name2sbp_sig_conf.end()) { sbp_sig_conf = conf_it->second; }
+    SbpSignatureList filtered_sbp_sig_list;
+    FilterSbpSignatureList(sbp_sig_list, sbp_sig_conf, &filtered_sbp_sig_list);
+    HashSet<SbpSignature> visited;
+    for (const SbpSignature& signature : filtered_sbp_sig_list.sbp_signature()) {
+      if (!visited.insert(signature).second) { continue; }
+      if (signature == greedy_signature) { node->greedy = node->candidates.size(); }
+      node->candidates.push_back(signature);
+    }
+    // the greedy signature did not come from the list, keep the op fixed
+    if (visited.find(greedy_signature) == visited.end()) { node->candidates.clear(); }
+  }
+  if (node->candidates.empty()) {
+    node->candidates.push_back(greedy_signature);
+    node->greedy = 0;
+  }
+  node->chosen = node->greedy;
+  const int64_t parallel_num = op_node->parallel_desc().parallel_num();
+  for (const SbpSignature& signature : node->candidates) {
+    const auto& bn2sbp_parallel = signature.bn_in_op2sbp_parallel();
+    std::vector<SbpParallel> sbp_parallels;
+    double compute_cost = 0;
+    for (const std::string& bn : node->bns) {
+      SbpParallel sbp_parallel;
+      const auto& it = bn2sbp_parallel.find(bn);
+      if (it != bn2sbp_parallel.end()) {
+        sbp_parallel = it->second;
+      } else {
+        sbp_parallel.mutable_broadcast_parallel();
+      }
+      const double bytes = LogicalBlobBytes(op_node->LogicalBlobDesc4Lbi(op.BnInOp2Lbi(bn)));
+      compute_cost += ComputeBytes(bytes, sbp_parallel, parallel_num);
+      sbp_parallels.push_back(sbp_parallel);
+    }
+    node->sbp_parallels.push_back(sbp_parallels);
+    node->compute_costs.push_back(compute_cost);
+  }
+}
+
+void SbpSignatureSearcher::InitEdges(const HashMap<const OpNode*, int64_t>& op_node2node_id) {
+  node_id2in_edge_ids_.resize(nodes_.size());
+  node_id2out_edge_ids_.resize(nodes_.size());
+  auto BnId4Bn = [](const SearchNode& node, const std::string& bn) -> int64_t {
+    const auto& it = std::find(node.bns.begin(), node.bns.end(), bn);
+    CHECK(it != node.bns.end());
+    return std::distance(node.bns.begin(), it);
+  };
+  FOR_RANGE(int64_t, consumer, 0, nodes_.size()) {
+    const OpNode* op_node = nodes_.at(consumer).op_node;
+    for (const std::string& ibn : op_node->op().input_bns()) {
+      const LogicalBlobId& lbi = op_node->op().BnInOp2Lbi(ibn);
+      const OpNode& producer_op_node = op_node->SrcNode4Ibn(ibn);
+      const std::string& obn = *CHECK_JUST(producer_op_node.op().obn4lbi(lbi));
+      SearchEdge edge;
+      edge.producer = op_node2node_id.at(&producer_op_node);
+      edge.producer_bn = BnId4Bn(nodes_.at(edge.producer), obn);
+      edge.consumer = consumer;
+      edge.consumer_bn = BnId4Bn(nodes_.at(consumer), ibn);
+      edge.bytes = LogicalBlobBytes(op_node->LogicalBlobDesc4Lbi(lbi));
+      node_id2in_edge_ids_.at(edge.consumer).push_back(edges_.size());
+      node_id2out_edge_ids_.at(edge.producer).push_back(edges_.size());
+      edges_.push_back(edge);
+    }
+  }
+}
+
+void SbpSignatureSearcher::InitChains() {
+  std::vector<int64_t> node_id2next(nodes_.size(), -1);
+  std::vector<bool> has_prev(nodes_.size(), false);
+  FOR_RANGE(int64_t, node_id, 0, nodes_.size()) {
+    if (!nodes_.at(node_id).searchable()) { continue; }
+    HashSet<int64_t> consumers;
+    for (int64_t edge_id : node_id2out_edge_ids_.at(node_id)) {
+      consumers.insert(edges_.at(edge_id).consumer);
+    }
+    if (consumers.size() != 1) { continue; }
+    const int64_t consumer = *consumers.begin();
+    if (!nodes_.at(consumer).searchable() || has_prev.at(consumer)) { continue; }
+    node_id2next.at(node_id) = consumer;
+    has_prev.at(consumer) = true;
+  }
+  FOR_RANGE(int64_t, node_id, 0, nodes_.size()) {
+    if (!nodes_.at(node_id).searchable() || has_prev.at(node_id)) { continue; }
+    std::vector<int64_t> chain;
+    for (int64_t cur = node_id; cur != -1; cur = node_id2next.at(cur)) { chain.push_back(cur); }
+    chains_.push_back(chain);
+  }
+}
+
+double SbpSignatureSearcher::EdgeCost(const SearchEdge& edge, int64_t producer_candidate,
+                                      int64_t consumer_candidate) const {
+  const SearchNode& producer = nodes_.at(edge.producer);
+  const SearchNode& consumer = nodes_.at(edge.consumer);
+  return kTransferCostWeight
+         * TransferBytes(edge.bytes,
+                         producer.sbp_parallels.at(producer_candidate).at(edge.producer_bn),
+                         producer.op_node->parallel_desc(),
+                         consumer.sbp_parallels.at(consumer_candidate).at(edge.consumer_bn),
+                         consumer.op_node->parallel_desc());
+}
+
+double SbpSignatureSearcher::TotalCost(
+    const std::function<int64_t(const SearchNode&)>& Candidate4Node) const {
+  double cost = 0;
+  for (const SearchNode& node : nodes_) { cost += node.compute_costs.at(Candidate4Node(node)); }
+  for (const SearchEdge& edge : edges_) {
+    cost += EdgeCost(edge, Candidate4Node(nodes_.at(edge.producer)),
+                     Candidate4Node(nodes_.at(edge.consumer)));
+  }
+  return cost;
+}
+
+double SbpSignatureSearcher::GreedyCost() const {
+  return TotalCost([](const SearchNode& node) { return node.greedy; });
+}
+
+double SbpSignatureSearcher::SearchedCost() const {
+  return TotalCost([](const SearchNode& node) { return node.chosen; });
+}
+
+bool SbpSignatureSearcher::SearchChain(const std::vector<int64_t>& chain) {
+  const int64_t length = chain.size();
+  auto IsChained = [&](int64_t i, int64_t node_id) {
+    return i >= 0 && i < length && chain.at(i) == node_id;
+  };
+  // cost of chain[i] taking candidate c, with everything off the chain fixed
+  auto UnaryCost = [&](int64_t i, int64_t c) {
+    const int64_t node_id = chain.at(i);
+    double cost = nodes_.at(node_id).compute_costs.at(c);
+    for (int64_t edge_id : node_id2in_edge_ids_.at(node_id)) {
+      const SearchEdge& edge = edges_.at(edge_id);
+      if (IsChained(i - 1, edge.producer)) { continue; }
+      cost += EdgeCost(edge, nodes_.at(edge.producer).chosen, c);
+    }
+    for (int64_t edge_id : node_id2out_edge_ids_.at(node_id)) {
+      const SearchEdge& edge = edges_.at(edge_id);
+      if (IsChained(i + 1, edge.consumer)) { continue; }
+      cost += EdgeCost(edge, c, nodes_.at(edge.consumer).chosen);
+    }
+    return cost;
+  };
+  // cost of the blobs chain[i - 1] passes to chain[i]
+  auto PairCost = [&](int64_t i, int64_t prev_c, int64_t c) {
+    double cost = 0;
+    for (int64_t edge_id : node_id2in_edge_ids_.at(chain.at(i))) {
+      const SearchEdge& edge = edges_.at(edge_id);
+      if (edge.producer == chain.at(i - 1)) { cost += EdgeCost(edge, prev_c, c); }
+    }
+    return cost;
+  };
+  std::vector<std::vector<double>> costs(length);
+  std::vector<std::vector<int64_t>> prev_candidates(length);
+  double current_cost = 0;
+  FOR_RANGE(int64_t, i, 0, length) {
+    const SearchNode& node = nodes_.at(chain.at(i));
+    const int64_t candidate_num = node.candidates.size();
+    costs.at(i).resize(candidate_num);
+    prev_candidates.at(i).resize(candidate_num, -1);
+    FOR_RANGE(int64_t, c, 0, candidate_num) {
+      double cost = UnaryCost(i, c);
+      if (i > 0) {
+        const SearchNode& prev_node = nodes_.at(chain.at(i - 1));
+        double best = kInfeasibleCost;
+        FOR_RANGE(int64_t, prev_c, 0, prev_node.candidates.size()) {
+          const double prev_cost = costs.at(i - 1).at(prev_c) + PairCost(i, prev_c, c);
+          if (prev_candidates.at(i).at(c) == -1 || prev_cost < best) {
+            best = prev_cost;
+            prev_candidates.at(i).at(c) = prev_c;
+          }
+        }
+        cost += best;
+      }
+      costs.at(i).at(c) = cost;
+    }
+    current_cost += UnaryCost(i, node.chosen);
+    if (i > 0) { current_cost += PairCost(i, nodes_.at(chain.at(i - 1)).chosen, node.chosen); }
+  }
+  const std::vector<double>& last_costs = costs.back();
+  const int64_t best_last =
+      std::distance(last_costs.begin(), std::min_element(last_costs.begin(), last_costs.end()));
+  // only move for a strictly cheaper plan, so ties keep the greedy choice and the loop ends
+  if (!(last_costs.at(best_last) < current_cost * (1 - 1e-9))) { return false; }
+  int64_t c = best_last;
+  for (int64_t i = length - 1; i >= 0; --i) {
+    nodes_.at(chain.at(i)).chosen = c;
+    c = prev_candidates.at(i).at(c);
+  }
+  return true;
+}
+
+void SbpSignatureSearcher::Search() {
+  FOR_RANGE(int32_t, iter, 0, kMaxRefineIterNum) {
+    bool improved = false;
+    for (const auto& chain : chains_) { improved = SearchChain(chain) || improved; }
+    if (!improved) { break; }
+  }
+}
+
+void SbpSignatureSearcher::ForEachSearchedNode(
+    const std::function<void(const SearchNode&)>& Handler) const {
+  for (const SearchNode& node : nodes_) {
+    if (node.searchable()) { Handler(node); }
+  }
+}
+
+class SbpSignatureSearchPass final : public JobPass {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SbpSignatureSearchPass);
+  SbpSignatureSearchPass() = default;
+  ~SbpSignatureSearchPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().enable_sbp_signature_search();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> SbpSignatureSearchPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+  SbpSignatureSearcher searcher(op_graph, job_builder->job().job_parallel_view_conf());
+  const double greedy_cost = searcher.GreedyCost();
+  searcher.Search();
+  const double searched_cost = searcher.SearchedCost();
+  int64_t searchable_op_num = 0;
+  int64_t changed_op_num = 0;
+  searcher.ForEachSearchedNode([&](const SearchNode& node) {
+    searchable_op_num += 1;
+    if (node.chosen != node.greedy) { changed_op_num += 1; }
+  });
+  LOG(INFO) << "sbp signature search of job " << job_builder->job().job_conf().job_name()
+            << ": estimated cost " << searched_cost << " versus greedy cost " << greedy_cost
+            << ", " << changed_op_num << " of " << searchable_op_num << " searchable ops changed";
+  if (!(searched_cost < greedy_cost)) { return Maybe<void>::Ok(); }
+  // hint every searched op, the estimate holds only for the plan as a whole
+  searcher.ForEachSearchedNode([&](const SearchNode& node) {
+    job_builder->AddSbpSignature4OpName(node.op_node->op().op_name(),
+                                        node.candidates.at(node.chosen));
+  });
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("SbpSignatureSearchPass", SbpSignatureSearchPass);
+
+}  // namespace oneflow
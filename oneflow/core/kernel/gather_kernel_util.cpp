@@ -14,11 +14,25 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/gather_kernel_util.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
 
 namespace oneflow {
 
 namespace {
 
+// the source rows are random reads, the ones that far ahead of the copied row are prefetched
+constexpr int64_t kGatherPrefetchRowNum = 8;
+// wider rows are read sequentially enough for the hardware prefetcher past their head
+constexpr size_t kGatherPrefetchMaxBytes = 256;
+
+inline void PrefetchRow(const void* row, size_t size) {
+#if defined(__GNUC__)
+  const char* ptr = static_cast<const char*>(row);
+  const size_t prefetch_size = std::min(size, kGatherPrefetchMaxBytes);
+  for (size_t i = 0; i < prefetch_size; i += 64) { __builtin_prefetch(ptr + i); }
+#endif
+}
+
 Shape GetFlatShape(const ShapeView& shape, int64_t axis) {
   CHECK_GT(shape.NumAxes(), 0);
   CHECK_GE(axis, 0);
@@ -76,19 +90,30 @@ void GatherKernelUtilImpl<DeviceType::kCPU, T, K>::Forward(DeviceCtx* ctx, const
   const int64_t outer_dim_size = flat_in_shape.At(0);
   const int64_t gather_dim_size = flat_in_shape.At(1);
   const int64_t inner_dim_size = flat_in_shape.At(2);
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_indices) {
-      CHECK_GE(indices[i], 0);
-      const int64_t idx = indices[i] - offset;
-      T* to = out + outer_idx * num_indices * inner_dim_size + i * inner_dim_size;
-      if (idx >= 0 && idx < gather_dim_size) {
-        const T* from = in + outer_idx * gather_dim_size * inner_dim_size + idx * inner_dim_size;
+  const auto InRow = [&](int64_t out_row) -> const T* {
+    const int64_t idx = indices[out_row % num_indices] - offset;
+    if (idx < 0 || idx >= gather_dim_size) { return nullptr; }
+    return in + ((out_row / num_indices) * gather_dim_size + idx) * inner_dim_size;
+  };
+  const int64_t num_out_rows = outer_dim_size * num_indices;
+  const int64_t grain_rows =
+      std::max<int64_t>(kCpuElementwiseGrainSize / std::max<int64_t>(inner_dim_size, 1), 1);
+  CpuParallelForEachRange(num_out_rows, grain_rows, [&](int64_t begin, int64_t end) {
+    FOR_RANGE(int64_t, out_row, begin, end) {
+      if (out_row + kGatherPrefetchRowNum < end) {
+        const T* next = InRow(out_row + kGatherPrefetchRowNum);
+        if (next != nullptr) { PrefetchRow(next, inner_dim_size * sizeof(T)); }
+      }
+      CHECK_GE(indices[out_row % num_indices], 0);
+      T* to = out + out_row * inner_dim_size;
+      const T* from = InRow(out_row);
+      if (from != nullptr) {
         std::copy(from, from + inner_dim_size, to);
       } else {
-        std::memset(to, 0, inner_dim_size * sizeof(K));
+        std::memset(to, 0, inner_dim_size * sizeof(T));
       }
     }
-  }
+  });
 }
 
 #define INITIATE_GATHER_KERNEL_UTIL_CPU_IMPL(in_type_pair, index_type_pair)              \
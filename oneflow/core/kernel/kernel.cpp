@@ -15,9 +15,11 @@ limitations under the License.
 */
 #include "oneflow/core/kernel/kernel.h"
 #include "oneflow/core/kernel/kernel_helper.h"
+#include "oneflow/core/kernel/model_version.h"
 #include "oneflow/core/kernel/runtime_blob_shape_infer_helper.h"
 #include "oneflow/core/profiler/profiler.h"
 #include "oneflow/core/profiler/kernel.h"
+#include "oneflow/core/profiler/timeline.h"
 
 namespace oneflow {
 
@@ -31,6 +33,10 @@ void Kernel::InitBase(const JobDesc* job_desc, const KernelConf& kernel_conf) {
   kernel_conf_ = kernel_conf;
   shape_infer_helper_ =
       new RuntimeBlobShapeInferHelper(this->op_conf(), this->kernel_conf(), &this->job_desc());
+  for (const auto& pair : op_attribute().arg_modifier_signature().ibn2input_blob_modifier()) {
+    if (pair.second.is_mutable()) { has_mutable_input_ = true; }
+  }
+  timeline_name_id_ = profiler::TimelineNameId(profiler::kTimelineKernel, op_conf().name());
 }
 
 void Kernel::Init(const JobDesc* job_desc, const KernelConf& kernel_conf, DeviceCtx* device_ctx) {
@@ -41,6 +47,7 @@ void Kernel::Init(const JobDesc* job_desc, const KernelConf& kernel_conf, Device
 void Kernel::Launch(const KernelCtx& ctx,
                     std::function<Blob*(const std::string&)> BnInOp2Blob) const {
   Forward(ctx, BnInOp2Blob);
+  if (has_mutable_input_) { IncreaseModelVersion(); }
 }
 
 const LogicalBlobId& Kernel::BnInOp2Lbi(const std::string& bn_in_op) const {
@@ -94,7 +101,10 @@ void Kernel::Forward(const KernelCtx& ctx,
   if (IsAllBlobEmpty(op_attribute().output_bns(), BnInOp2Blob) && IsStateless()) { return; }
   SetOutputBlobProducerComputeAccessChecker(BnInOp2Blob);
   OF_PROFILER_ONLY_CODE(profiler::TraceKernelForwardDataContentStart(this, ctx, BnInOp2Blob));
-  ForwardDataContent(ctx, BnInOp2Blob);
+  {
+    profiler::TimelineEventGuard timeline_event_guard(timeline_name_id_);
+    ForwardDataContent(ctx, BnInOp2Blob);
+  }
   OF_PROFILER_ONLY_CODE(profiler::TraceKernelForwardDataContentEnd(this, ctx, BnInOp2Blob));
   SetOutputBlobConsumerAccessChecker(BnInOp2Blob);
 }
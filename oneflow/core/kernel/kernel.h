@@ -72,11 +72,16 @@ class Kernel {
       std::function<Blob*(const std::string&)> BnInOp2Blob) const;
 
  protected:
-  Kernel() : job_desc_(nullptr), shape_infer_helper_(nullptr) {}
+  Kernel()
+      : job_desc_(nullptr),
+        shape_infer_helper_(nullptr),
+        has_mutable_input_(false),
+        timeline_name_id_(-1) {}
   void InitBase(const JobDesc* job_desc, const KernelConf&);
   virtual void VirtualKernelInit(DeviceCtx* device_ctx) { VirtualKernelInit(); }
   virtual void VirtualKernelInit() {}
   const KernelConf& kernel_conf() const { return kernel_conf_; }
+  bool has_mutable_input() const { return has_mutable_input_; }
 
   template<typename HandlerT>
   void ForEachObnAndIsHeaderInferedBeforeCompute(
@@ -129,6 +134,9 @@ class Kernel {
   const JobDesc* job_desc_;
   RuntimeBlobShapeInferHelper* shape_infer_helper_;
   KernelConf kernel_conf_;
+  // writes one of its inputs in place, e.g. a variable in model update or assign
+  bool has_mutable_input_;
+  int32_t timeline_name_id_;
 };
 
 template<DeviceType device_type>
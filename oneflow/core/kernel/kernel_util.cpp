@@ -17,6 +17,8 @@ limitations under the License.
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/core/register/register_manager.h"
 #include "oneflow/core/kernel/kernel.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
+#include "oneflow/core/kernel/util/cpu_fast_math.h"
 #include "oneflow/core/memory/memory_case.pb.h"
 
 namespace oneflow {
@@ -440,21 +442,22 @@ KU_FLOATING_METHOD Powx(DeviceCtx* ctx, const int64_t n, const T* x, const float
 }
 
 KU_FLOATING_METHOD Sigmoid(DeviceCtx* ctx, const int64_t n, const T* x, T* y) {
-  T half = static_cast<T>(0.5);
-  for (int64_t i = 0; i != n; ++i) { y[i] = half * std::tanh(half * x[i]) + half; }
+  CpuParallelForEachRange(n, kCpuElementwiseGrainSize, [&](int64_t begin, int64_t end) {
+    cpu_fast_math::Sigmoid(x + begin, y + begin, end - begin);
+  });
 }
 KU_FLOATING_METHOD SigmoidBackward(DeviceCtx* ctx, const int64_t n, const T* x, const T* y,
                                    const T* dy, T* dx) {
-  for (int64_t i = 0; i != n; ++i) { dx[i] = y[i] * (1 - y[i]) * dy[i]; }
+  CpuElementwiseBinary(n, y, dy, dx, [](T y_i, T dy_i) { return y_i * (1 - y_i) * dy_i; });
 }
 KU_FLOATING_METHOD Relu(DeviceCtx* ctx, const int64_t n, const T* x, T* y) {
-  T zero = GetZeroVal<T>();
-  for (int64_t i = 0; i != n; ++i) { y[i] = std::max(x[i], zero); }
+  const T zero = GetZeroVal<T>();
+  CpuElementwiseUnary(n, x, y, [zero](T x_i) { return std::max(x_i, zero); });
 }
 KU_FLOATING_METHOD ReluBackward(DeviceCtx* ctx, const int64_t n, const T* x, const T* y,
                                 const T* dy, T* dx) {
-  T zero = GetZeroVal<T>();
-  for (int64_t i = 0; i != n; ++i) { dx[i] = (y[i] > zero) * dy[i]; }
+  const T zero = GetZeroVal<T>();
+  CpuElementwiseBinary(n, y, dy, dx, [zero](T y_i, T dy_i) { return (y_i > zero) * dy_i; });
 }
 KU_FLOATING_METHOD Addition(DeviceCtx* ctx, const int64_t n, T* out, const T* in_0) {
   for (int64_t i = 0; i != n; ++i) { out[i] = in_0[i]; }
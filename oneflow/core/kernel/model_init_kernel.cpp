@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/kernel.h"
+#include "oneflow/core/kernel/model_version.h"
 
 namespace oneflow {
 
@@ -84,6 +85,8 @@ class ModelInitKernel final : public KernelIf<DeviceType::kCPU> {
         UNIMPLEMENTED();
       }
     }
+    // the variables get the new values through the output ops of this job
+    IncreaseModelVersion();
   }
 };
 
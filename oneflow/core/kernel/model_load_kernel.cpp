@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/kernel.h"
+#include "oneflow/core/kernel/model_version.h"
 #include "oneflow/core/common/str_util.h"
 #include <iostream>
 
@@ -70,6 +71,8 @@ class ModelLoadKernel final : public KernelIf<DeviceType::kCPU> {
                                                          random_seed_gen(), out_i);
       }
     }
+    // the variables get the new values through the output ops of this job
+    IncreaseModelVersion();
   }
 };
 
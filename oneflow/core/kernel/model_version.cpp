@@ -0,0 +1,35 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/model_version.h"
+
+#include <atomic>
+
+namespace oneflow {
+
+namespace {
+
+std::atomic<int64_t>* MutModelVersion() {
+  static std::atomic<int64_t> model_version(0);
+  return &model_version;
+}
+
+}  // namespace
+
+int64_t GetModelVersion() { return MutModelVersion()->load(std::memory_order_acquire); }
+
+void IncreaseModelVersion() { MutModelVersion()->fetch_add(1, std::memory_order_acq_rel); }
+
+}  // namespace oneflow
@@ -0,0 +1,31 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_MODEL_VERSION_H_
+#define ONEFLOW_CORE_KERNEL_MODEL_VERSION_H_
+
+#include <cstdint>
+
+namespace oneflow {
+
+// Version of the variables of this process. Every kernel that writes a variable in place (model
+// update, assign, model init and load) increases it after the write, so that data derived from
+// variables and cached across iterations, e.g. prepacked gemm weights, can tell it is stale.
+int64_t GetModelVersion();
+void IncreaseModelVersion();
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_MODEL_VERSION_H_
@@ -0,0 +1,91 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_PHILOX_RANDOM_H_
+#define ONEFLOW_CORE_KERNEL_PHILOX_RANDOM_H_
+
+#include <cstdint>
+
+namespace oneflow {
+
+// Counter-based generator Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as
+// 1, 2, 3", SC11). Block b of the stream is the 4 uint32 Philox(key = seed, counter = b), so any
+// part of the stream can be generated independently of the preceding parts, and a stream split
+// across threads is the same whatever the number of threads.
+class PhiloxRandom final {
+ public:
+  static const int kBlockSize = 4;
+
+  explicit PhiloxRandom(int64_t seed)
+      : key0_(static_cast<uint32_t>(static_cast<uint64_t>(seed))),
+        key1_(static_cast<uint32_t>(static_cast<uint64_t>(seed) >> 32)) {}
+  ~PhiloxRandom() = default;
+
+  void Block(uint64_t block_id, uint32_t* result) const {
+    uint32_t c0 = static_cast<uint32_t>(block_id);
+    uint32_t c1 = static_cast<uint32_t>(block_id >> 32);
+    uint32_t c2 = 0;
+    uint32_t c3 = 0;
+    uint32_t k0 = key0_;
+    uint32_t k1 = key1_;
+    for (int round = 0; round < 10; ++round) {
+      const uint64_t p0 = static_cast<uint64_t>(kMul0) * c0;
+      const uint64_t p1 = static_cast<uint64_t>(kMul1) * c2;
+      const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+      const uint32_t lo0 = static_cast<uint32_t>(p0);
+      const uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+      const uint32_t lo1 = static_cast<uint32_t>(p1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += kWeyl0;
+      k1 += kWeyl1;
+    }
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+  }
+
+  // Calls Handler(i, value) for the elements [begin, end) of the stream, element i being word
+  // i % 4 of block i / 4.
+  template<typename Handler>
+  void ForEachUint32(uint64_t begin, uint64_t end, const Handler& handler) const {
+    uint32_t block[kBlockSize];
+    uint64_t i = begin;
+    while (i < end) {
+      Block(i / kBlockSize, block);
+      const uint64_t block_end = (i / kBlockSize + 1) * kBlockSize;
+      for (; i < block_end && i < end; ++i) { handler(i, block[i % kBlockSize]); }
+    }
+  }
+
+  // uniform in [0, 1), the top 24 bits of x
+  static float ToUniformFloat(uint32_t x) { return (x >> 8) * (1.0f / 16777216.0f); }
+
+ private:
+  static const uint32_t kMul0 = 0xD2511F53;
+  static const uint32_t kMul1 = 0xCD9E8D57;
+  static const uint32_t kWeyl0 = 0x9E3779B9;
+  static const uint32_t kWeyl1 = 0xBB67AE85;
+
+  uint32_t key0_;
+  uint32_t key1_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_PHILOX_RANDOM_H_
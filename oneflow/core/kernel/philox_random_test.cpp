@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/philox_random.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// known answers from the Random123 distribution (kat_vectors, philox4x32_10)
+TEST(PhiloxRandom, known_answer) {
+  uint32_t block[PhiloxRandom::kBlockSize];
+  PhiloxRandom(0).Block(0, block);
+  ASSERT_EQ(block[0], 0x6627e8d5);
+  ASSERT_EQ(block[1], 0xe169c58d);
+  ASSERT_EQ(block[2], 0xbc57ac4c);
+  ASSERT_EQ(block[3], 0x9b00dbd8);
+}
+
+TEST(PhiloxRandom, split_stream) {
+  const PhiloxRandom philox_random(12345);
+  const uint64_t offset = 7;
+  const uint64_t n = 1001;
+  std::vector<uint32_t> whole(n);
+  philox_random.ForEachUint32(offset, offset + n,
+                              [&](uint64_t i, uint32_t value) { whole[i - offset] = value; });
+  FOR_RANGE(uint64_t, part_size, 1, 9) {
+    std::vector<uint32_t> parts(n);
+    for (uint64_t begin = 0; begin < n; begin += part_size) {
+      philox_random.ForEachUint32(offset + begin, offset + std::min(begin + part_size, n),
+                                  [&](uint64_t i, uint32_t value) { parts[i - offset] = value; });
+    }
+    ASSERT_EQ(parts, whole);
+  }
+}
+
+TEST(PhiloxRandom, uniform) {
+  const PhiloxRandom philox_random(-1);
+  const uint64_t n = 1 << 20;
+  double sum = 0;
+  philox_random.ForEachUint32(0, n, [&](uint64_t i, uint32_t value) {
+    const float u = PhiloxRandom::ToUniformFloat(value);
+    ASSERT_GE(u, 0.0f);
+    ASSERT_LT(u, 1.0f);
+    sum += u;
+  });
+  ASSERT_NEAR(sum / n, 0.5, 1e-3);
+}
+
+}  // namespace oneflow
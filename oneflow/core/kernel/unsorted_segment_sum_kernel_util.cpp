@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/unsorted_segment_sum_kernel_util.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
 
 namespace oneflow {
 
@@ -30,18 +31,76 @@ void UnsortedSegmentSumKernelUtil<DeviceType::kCPU, T, K, T>::UnsortedSegmentSum
     DeviceCtx* ctx, const K* segment_ids, const T* data, int64_t num_segment_ids,
     int64_t num_segments, int64_t outer_dim_size, int64_t inner_dim_size, int64_t segment_id_offset,
     T* out) {
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_segment_ids) {
-      CHECK_GE(segment_ids[i], 0);
-      const int64_t idx = segment_ids[i] - segment_id_offset;
-      T* to = out + outer_idx * num_segments * inner_dim_size + idx * inner_dim_size;
-      if (idx >= 0 && idx < num_segments) {
-        const T* from = data + outer_idx * num_segment_ids * inner_dim_size + i * inner_dim_size;
-        std::transform(from, from + inner_dim_size, to, to, std::plus<T>());
-      }
+  // data row r is added to out row OutRow(r), or dropped when OutRow(r) is -1
+  const auto OutRow = [&](int64_t data_row) -> int64_t {
+    const K segment_id = segment_ids[data_row % num_segment_ids];
+    CHECK_GE(segment_id, 0);
+    const int64_t idx = segment_id - segment_id_offset;
+    if (idx < 0 || idx >= num_segments) { return -1; }
+    return (data_row / num_segment_ids) * num_segments + idx;
+  };
+  const auto AddRow = [&](int64_t data_row, int64_t out_row) {
+    const T* from = data + data_row * inner_dim_size;
+    T* to = out + out_row * inner_dim_size;
+    FOR_RANGE(int64_t, j, 0, inner_dim_size) { to[j] += from[j]; }
+  };
+  const int64_t num_data_rows = outer_dim_size * num_segment_ids;
+  const int64_t part_num =
+      CpuParallelPartNum(num_data_rows * inner_dim_size, kCpuElementwiseGrainSize);
+  if (part_num == 1) {
+    FOR_RANGE(int64_t, data_row, 0, num_data_rows) {
+      const int64_t out_row = OutRow(data_row);
+      if (out_row >= 0) { AddRow(data_row, out_row); }
     }
+    return;
   }
+  // Out row o is owned by part o % part_num, the data rows are partitioned by the owner of their
+  // out row and each part accumulates its own rows, so no two threads write the same row. The
+  // partitioning is stable, every out row adds its data rows in the serial order and the result
+  // does not depend on part_num.
+  const BalancedSplitter data_row_splitter(num_data_rows, part_num);
+  std::vector<int64_t> out_rows(num_data_rows);
+  // part_num x part_num counts, row: the data row range, column: the owner
+  std::vector<int64_t> owner_offsets(part_num * part_num, 0);
+  MultiThreadLoop(part_num, [&](size_t range_id) {
+    const Range range = data_row_splitter.At(range_id);
+    int64_t* counts = owner_offsets.data() + range_id * part_num;
+    FOR_RANGE(int64_t, data_row, range.begin(), range.end()) {
+      const int64_t out_row = OutRow(data_row);
+      out_rows[data_row] = out_row;
+      if (out_row >= 0) { counts[out_row % part_num] += 1; }
+    }
+  });
+  // exclusive prefix sum in owner major order, so that each owner gets a contiguous bucket
+  std::vector<int64_t> owner_begins(part_num + 1, 0);
+  int64_t total = 0;
+  FOR_RANGE(int64_t, owner, 0, part_num) {
+    owner_begins[owner] = total;
+    FOR_RANGE(int64_t, range_id, 0, part_num) {
+      int64_t* count = &owner_offsets[range_id * part_num + owner];
+      const int64_t range_count = *count;
+      *count = total;
+      total += range_count;
+    }
+  }
+  owner_begins[part_num] = total;
+  std::vector<int64_t> bucketed_data_rows(total);
+  MultiThreadLoop(part_num, [&](size_t range_id) {
+    const Range range = data_row_splitter.At(range_id);
+    int64_t* offsets = owner_offsets.data() + range_id * part_num;
+    FOR_RANGE(int64_t, data_row, range.begin(), range.end()) {
+      const int64_t out_row = out_rows[data_row];
+      if (out_row >= 0) { bucketed_data_rows[offsets[out_row % part_num]++] = data_row; }
+    }
+  });
+  MultiThreadLoop(part_num, [&](size_t owner) {
+    FOR_RANGE(int64_t, i, owner_begins[owner], owner_begins[owner + 1]) {
+      const int64_t data_row = bucketed_data_rows[i];
+      AddRow(data_row, out_rows[data_row]);
+    }
+  });
 }
+
 #define INITIATE_UNSORTED_SEGMENT_SUM_KERNEL_UTIL_CPU(in_type_pair, index_type_pair)             \
   template struct UnsortedSegmentSumKernelUtil<DeviceType::kCPU, OF_PP_PAIR_FIRST(in_type_pair), \
                                                OF_PP_PAIR_FIRST(index_type_pair),                \
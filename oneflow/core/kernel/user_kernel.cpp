@@ -25,6 +25,7 @@ limitations under the License.
 #include "oneflow/core/kernel/eager_kernel.h"
 #include "oneflow/core/kernel/kernel.h"
 #include "oneflow/core/kernel/kernel_helper.h"
+#include "oneflow/core/kernel/model_version.h"
 
 namespace oneflow {
 
@@ -556,6 +557,8 @@ std::shared_ptr<user_op::OpKernelState> EagerKernel::EagerForward(
   UserKernelComputeContext compute_ctx(device_ctx, kernel_conf(), job_desc());
   compute_ctx.UpdateTensorWithCorrBlob(BnInOp2Blob);
   kernel_->Compute(&compute_ctx, new_opkernel_state.get());
+  // e.g. the slice assign of load_variables
+  if (has_mutable_input()) { IncreaseModelVersion(); }
   return new_opkernel_state;
 }
 
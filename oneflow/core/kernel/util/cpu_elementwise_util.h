@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_UTIL_CPU_ELEMENTWISE_UTIL_H_
+#define ONEFLOW_CORE_KERNEL_UTIL_CPU_ELEMENTWISE_UTIL_H_
+
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+// elements per part below which handing a part to another thread costs more than it saves
+constexpr int64_t kCpuElementwiseGrainSize = 32768;
+
+// number of parts of at least grain_size elements [0, n) is split into, at most one per thread of
+// the thread pool
+inline int64_t CpuParallelPartNum(int64_t n, int64_t grain_size) {
+  const ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  const int64_t max_part_num = thread_pool == nullptr ? 1 : thread_pool->LocalThreadNum();
+  return std::max<int64_t>(std::min<int64_t>(max_part_num, n / std::max<int64_t>(grain_size, 1)),
+                           1);
+}
+
+// Splits [0, n) into parts of at least grain_size elements and calls Handler(begin, end) for each
+// part on the thread pool. Runs inline when there is a single part or no thread pool.
+template<typename Handler>
+void CpuParallelForEachRange(int64_t n, int64_t grain_size, const Handler& handler) {
+  if (n <= 0) { return; }
+  const int64_t part_num = CpuParallelPartNum(n, grain_size);
+  if (part_num == 1) {
+    handler(0, n);
+    return;
+  }
+  const BalancedSplitter bs(n, part_num);
+  MultiThreadLoop(part_num, [&](size_t part_id) {
+    const Range range = bs.At(part_id);
+    handler(range.begin(), range.end());
+  });
+}
+
+template<typename T, typename UnaryFunc>
+void CpuElementwiseUnary(int64_t n, const T* x, T* y, const UnaryFunc& func) {
+  CpuParallelForEachRange(n, kCpuElementwiseGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) { y[i] = func(x[i]); }
+  });
+}
+
+template<typename T, typename BinaryFunc>
+void CpuElementwiseBinary(int64_t n, const T* a, const T* b, T* y, const BinaryFunc& func) {
+  CpuParallelForEachRange(n, kCpuElementwiseGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) { y[i] = func(a[i], b[i]); }
+  });
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_UTIL_CPU_ELEMENTWISE_UTIL_H_
@@ -0,0 +1,327 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/util/cpu_fast_math.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define OF_CPU_FAST_MATH_X86
+#include <immintrin.h>
+#endif
+
+namespace oneflow {
+
+namespace cpu_fast_math {
+
+namespace {
+
+namespace scalar {
+
+struct Ops {
+  typedef float F;
+  typedef int32_t I;
+  typedef bool M;
+  static const int64_t kWidth = 1;
+
+  static F Load(const float* p) { return *p; }
+  static void Store(float* p, F v) { *p = v; }
+  static F Set1(float v) { return v; }
+  static F Add(F a, F b) { return a + b; }
+  static F Sub(F a, F b) { return a - b; }
+  static F Mul(F a, F b) { return a * b; }
+  static F Div(F a, F b) { return a / b; }
+  static F MulAdd(F a, F b, F c) { return a * b + c; }
+  // same nan semantics as minps/maxps: the second operand is returned when either is nan
+  static F Min(F a, F b) { return a < b ? a : b; }
+  static F Max(F a, F b) { return a > b ? a : b; }
+  static M Lt(F a, F b) { return a < b; }
+  static M Gt(F a, F b) { return a > b; }
+  static M Eq(F a, F b) { return a == b; }
+  static M IsNan(F a) { return a != a; }
+  static M Or(M a, M b) { return a || b; }
+  static F Select(M m, F t, F f) { return m ? t : f; }
+  static I AsInt(F a) {
+    I i;
+    std::memcpy(&i, &a, sizeof(i));
+    return i;
+  }
+  static F AsFloat(I i) {
+    F a;
+    std::memcpy(&a, &i, sizeof(a));
+    return a;
+  }
+  static F ToFloat(I i) { return static_cast<F>(i); }
+  static I ISet1(int32_t v) { return v; }
+  static I IAdd(I a, I b) { return a + b; }
+  static I ISub(I a, I b) { return a - b; }
+  static I IAnd(I a, I b) { return a & b; }
+  static I IOr(I a, I b) { return a | b; }
+  static I IShiftLeft(I a, int n) { return static_cast<I>(static_cast<uint32_t>(a) << n); }
+  static I IShiftRightLogical(I a, int n) { return static_cast<I>(static_cast<uint32_t>(a) >> n); }
+  static I IShiftRightArith(I a, int n) { return a >> n; }
+};
+
+typedef Ops::F F;
+typedef Ops::I I;
+typedef Ops::M M;
+#include "oneflow/core/kernel/util/cpu_fast_math_impl.h"
+
+}  // namespace scalar
+
+#ifdef OF_CPU_FAST_MATH_X86
+
+namespace sse2 {
+
+struct Ops {
+  typedef __m128 F;
+  typedef __m128i I;
+  typedef __m128 M;
+  static const int64_t kWidth = 4;
+
+  static F Load(const float* p) { return _mm_loadu_ps(p); }
+  static void Store(float* p, F v) { _mm_storeu_ps(p, v); }
+  static F Set1(float v) { return _mm_set1_ps(v); }
+  static F Add(F a, F b) { return _mm_add_ps(a, b); }
+  static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+  static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+  static F Div(F a, F b) { return _mm_div_ps(a, b); }
+  static F MulAdd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static F Min(F a, F b) { return _mm_min_ps(a, b); }
+  static F Max(F a, F b) { return _mm_max_ps(a, b); }
+  static M Lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+  static M Gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+  static M Eq(F a, F b) { return _mm_cmpeq_ps(a, b); }
+  static M IsNan(F a) { return _mm_cmpunord_ps(a, a); }
+  static M Or(M a, M b) { return _mm_or_ps(a, b); }
+  static F Select(M m, F t, F f) { return _mm_or_ps(_mm_and_ps(m, t), _mm_andnot_ps(m, f)); }
+  static I AsInt(F a) { return _mm_castps_si128(a); }
+  static F AsFloat(I i) { return _mm_castsi128_ps(i); }
+  static F ToFloat(I i) { return _mm_cvtepi32_ps(i); }
+  static I ISet1(int32_t v) { return _mm_set1_epi32(v); }
+  static I IAdd(I a, I b) { return _mm_add_epi32(a, b); }
+  static I ISub(I a, I b) { return _mm_sub_epi32(a, b); }
+  static I IAnd(I a, I b) { return _mm_and_si128(a, b); }
+  static I IOr(I a, I b) { return _mm_or_si128(a, b); }
+  static I IShiftLeft(I a, int n) { return _mm_slli_epi32(a, n); }
+  static I IShiftRightLogical(I a, int n) { return _mm_srli_epi32(a, n); }
+  static I IShiftRightArith(I a, int n) { return _mm_srai_epi32(a, n); }
+};
+
+typedef Ops::F F;
+typedef Ops::I I;
+typedef Ops::M M;
+#include "oneflow/core/kernel/util/cpu_fast_math_impl.h"
+
+}  // namespace sse2
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace avx2 {
+
+struct Ops {
+  typedef __m256 F;
+  typedef __m256i I;
+  typedef __m256 M;
+  static const int64_t kWidth = 8;
+
+  static F Load(const float* p) { return _mm256_loadu_ps(p); }
+  static void Store(float* p, F v) { _mm256_storeu_ps(p, v); }
+  static F Set1(float v) { return _mm256_set1_ps(v); }
+  static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+  static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+  static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+  static F Div(F a, F b) { return _mm256_div_ps(a, b); }
+  static F MulAdd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+  static F Min(F a, F b) { return _mm256_min_ps(a, b); }
+  static F Max(F a, F b) { return _mm256_max_ps(a, b); }
+  static M Lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static M Gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static M Eq(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+  static M IsNan(F a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+  static M Or(M a, M b) { return _mm256_or_ps(a, b); }
+  static F Select(M m, F t, F f) { return _mm256_blendv_ps(f, t, m); }
+  static I AsInt(F a) { return _mm256_castps_si256(a); }
+  static F AsFloat(I i) { return _mm256_castsi256_ps(i); }
+  static F ToFloat(I i) { return _mm256_cvtepi32_ps(i); }
+  static I ISet1(int32_t v) { return _mm256_set1_epi32(v); }
+  static I IAdd(I a, I b) { return _mm256_add_epi32(a, b); }
+  static I ISub(I a, I b) { return _mm256_sub_epi32(a, b); }
+  static I IAnd(I a, I b) { return _mm256_and_si256(a, b); }
+  static I IOr(I a, I b) { return _mm256_or_si256(a, b); }
+  static I IShiftLeft(I a, int n) { return _mm256_slli_epi32(a, n); }
+  static I IShiftRightLogical(I a, int n) { return _mm256_srli_epi32(a, n); }
+  static I IShiftRightArith(I a, int n) { return _mm256_srai_epi32(a, n); }
+};
+
+typedef Ops::F F;
+typedef Ops::I I;
+typedef Ops::M M;
+#include "oneflow/core/kernel/util/cpu_fast_math_impl.h"
+
+}  // namespace avx2
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// the unmasked avx512 intrinsics of gcc 12 pass _mm512_undefined_* as the merge source, which
+// -Wmaybe-uninitialized reports once they are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace avx512 {
+
+struct Ops {
+  typedef __m512 F;
+  typedef __m512i I;
+  typedef __mmask16 M;
+  static const int64_t kWidth = 16;
+
+  static F Load(const float* p) { return _mm512_loadu_ps(p); }
+  static void Store(float* p, F v) { _mm512_storeu_ps(p, v); }
+  static F Set1(float v) { return _mm512_set1_ps(v); }
+  static F Add(F a, F b) { return _mm512_add_ps(a, b); }
+  static F Sub(F a, F b) { return _mm512_sub_ps(a, b); }
+  static F Mul(F a, F b) { return _mm512_mul_ps(a, b); }
+  static F Div(F a, F b) { return _mm512_div_ps(a, b); }
+  static F MulAdd(F a, F b, F c) { return _mm512_fmadd_ps(a, b, c); }
+  static F Min(F a, F b) { return _mm512_min_ps(a, b); }
+  static F Max(F a, F b) { return _mm512_max_ps(a, b); }
+  static M Lt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+  static M Gt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+  static M Eq(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+  static M IsNan(F a) { return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q); }
+  static M Or(M a, M b) { return _mm512_kor(a, b); }
+  static F Select(M m, F t, F f) { return _mm512_mask_blend_ps(m, f, t); }
+  static I AsInt(F a) { return _mm512_castps_si512(a); }
+  static F AsFloat(I i) { return _mm512_castsi512_ps(i); }
+  static F ToFloat(I i) { return _mm512_cvtepi32_ps(i); }
+  static I ISet1(int32_t v) { return _mm512_set1_epi32(v); }
+  static I IAdd(I a, I b) { return _mm512_add_epi32(a, b); }
+  static I ISub(I a, I b) { return _mm512_sub_epi32(a, b); }
+  static I IAnd(I a, I b) { return _mm512_and_si512(a, b); }
+  static I IOr(I a, I b) { return _mm512_or_si512(a, b); }
+  static I IShiftLeft(I a, int n) { return _mm512_slli_epi32(a, n); }
+  static I IShiftRightLogical(I a, int n) { return _mm512_srli_epi32(a, n); }
+  static I IShiftRightArith(I a, int n) { return _mm512_srai_epi32(a, n); }
+};
+
+typedef Ops::F F;
+typedef Ops::I I;
+typedef Ops::M M;
+#include "oneflow/core/kernel/util/cpu_fast_math_impl.h"
+
+}  // namespace avx512
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+#endif  // OF_CPU_FAST_MATH_X86
+
+struct FastMathImpl {
+  const char* isa_name;
+  void (*exp)(const float* x, float* y, int64_t n);
+  void (*log)(const float* x, float* y, int64_t n);
+  void (*tanh)(const float* x, float* y, int64_t n);
+  void (*erf)(const float* x, float* y, int64_t n);
+  void (*sigmoid)(const float* x, float* y, int64_t n);
+  void (*gelu)(const float* x, float* y, int64_t n);
+  void (*gelu_grad)(const float* x, const float* dy, float* dx, int64_t n);
+};
+
+#define MAKE_FAST_MATH_IMPL(isa)                                                       \
+  FastMathImpl {                                                                       \
+    #isa, &isa::Exp, &isa::Log, &isa::Tanh, &isa::Erf, &isa::Sigmoid, &isa::Gelu, \
+        &isa::GeluGrad                                                                 \
+  }
+
+// from the narrowest to the widest
+std::vector<FastMathImpl> SupportedFastMathImpls() {
+  std::vector<FastMathImpl> impls{MAKE_FAST_MATH_IMPL(scalar)};
+#ifdef OF_CPU_FAST_MATH_X86
+  __builtin_cpu_init();
+  impls.push_back(MAKE_FAST_MATH_IMPL(sse2));
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    impls.push_back(MAKE_FAST_MATH_IMPL(avx2));
+  }
+  if (__builtin_cpu_supports("avx512f")) { impls.push_back(MAKE_FAST_MATH_IMPL(avx512)); }
+#endif
+  return impls;
+}
+
+#undef MAKE_FAST_MATH_IMPL
+
+int IsaRank(const std::string& isa_name) {
+  if (isa_name == "scalar") { return 0; }
+  if (isa_name == "sse2") { return 1; }
+  if (isa_name == "avx2") { return 2; }
+  return 3;
+}
+
+FastMathImpl SelectFastMathImpl() {
+  const char* env_isa = std::getenv("ONEFLOW_CPU_FAST_MATH_ISA");
+  const int max_rank = IsaRank(env_isa == nullptr ? "" : env_isa);
+  const std::vector<FastMathImpl> impls = SupportedFastMathImpls();
+  for (auto it = impls.rbegin(); it != impls.rend(); ++it) {
+    if (IsaRank(it->isa_name) <= max_rank) { return *it; }
+  }
+  return impls.front();
+}
+
+FastMathImpl* MutFastMathImpl() {
+  static FastMathImpl impl = SelectFastMathImpl();
+  return &impl;
+}
+
+const FastMathImpl& GetFastMathImpl() { return *MutFastMathImpl(); }
+
+}  // namespace
+
+void Exp(const float* x, float* y, int64_t n) { GetFastMathImpl().exp(x, y, n); }
+void Log(const float* x, float* y, int64_t n) { GetFastMathImpl().log(x, y, n); }
+void Tanh(const float* x, float* y, int64_t n) { GetFastMathImpl().tanh(x, y, n); }
+void Erf(const float* x, float* y, int64_t n) { GetFastMathImpl().erf(x, y, n); }
+void Sigmoid(const float* x, float* y, int64_t n) { GetFastMathImpl().sigmoid(x, y, n); }
+void Gelu(const float* x, float* y, int64_t n) { GetFastMathImpl().gelu(x, y, n); }
+void GeluGrad(const float* x, const float* dy, float* dx, int64_t n) {
+  GetFastMathImpl().gelu_grad(x, dy, dx, n);
+}
+
+const char* ActiveIsaName() { return GetFastMathImpl().isa_name; }
+
+std::vector<std::string> SupportedIsaNames() {
+  std::vector<std::string> isa_names;
+  for (const FastMathImpl& impl : SupportedFastMathImpls()) { isa_names.push_back(impl.isa_name); }
+  return isa_names;
+}
+
+bool SetActiveIsa(const std::string& isa_name) {
+  for (const FastMathImpl& impl : SupportedFastMathImpls()) {
+    if (isa_name == impl.isa_name) {
+      *MutFastMathImpl() = impl;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace cpu_fast_math
+
+}  // namespace oneflow
@@ -0,0 +1,93 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_UTIL_CPU_FAST_MATH_H_
+#define ONEFLOW_CORE_KERNEL_UTIL_CPU_FAST_MATH_H_
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace oneflow {
+
+// Array versions of the transcendental functions used by the cpu activation kernels. The float
+// versions evaluate polynomial approximations on the widest simd instruction set the cpu supports
+// (avx512f, avx2+fma or sse2, selected at the first call), the double versions call libm.
+//
+// Accuracy of the float versions against libm evaluated in double precision:
+//   Exp      max relative error 1.5e-7 on [-87.3, 88.7]; +inf above, 0 below (no denormals)
+//   Log      max relative error 1.5e-7 on (0, +inf), denormal inputs included
+//   Tanh     max relative error 2.0e-7
+//   Erf      max relative error 2.5e-7, max absolute error 2.5e-7
+//   Sigmoid  max relative error 3.0e-7
+// nan and inf inputs follow libm.
+//
+// The instruction set can be lowered with the environment variable ONEFLOW_CPU_FAST_MATH_ISA
+// (one of avx512f, avx2, sse2, scalar), e.g. to compare them in benchmarks.
+namespace cpu_fast_math {
+
+void Exp(const float* x, float* y, int64_t n);
+void Log(const float* x, float* y, int64_t n);
+void Tanh(const float* x, float* y, int64_t n);
+void Erf(const float* x, float* y, int64_t n);
+void Sigmoid(const float* x, float* y, int64_t n);
+// y = 0.5 * x * (1 + erf(x / sqrt(2)))
+void Gelu(const float* x, float* y, int64_t n);
+// dx = dy * d(gelu(x))/dx
+void GeluGrad(const float* x, const float* dy, float* dx, int64_t n);
+
+inline void Exp(const double* x, double* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = std::exp(x[i]); }
+}
+inline void Log(const double* x, double* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = std::log(x[i]); }
+}
+inline void Tanh(const double* x, double* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = std::tanh(x[i]); }
+}
+inline void Erf(const double* x, double* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = std::erf(x[i]); }
+}
+inline void Sigmoid(const double* x, double* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = 1.0 / (1.0 + std::exp(-x[i])); }
+}
+inline void Gelu(const double* x, double* y, int64_t n) {
+  const double inv_sqrt2 = std::sqrt(0.5);
+  for (int64_t i = 0; i < n; ++i) { y[i] = 0.5 * x[i] * (1.0 + std::erf(inv_sqrt2 * x[i])); }
+}
+inline void GeluGrad(const double* x, const double* dy, double* dx, int64_t n) {
+  const double inv_sqrt2 = std::sqrt(0.5);
+  const double coef = std::sqrt(2.0 / std::acos(-1.0));
+  for (int64_t i = 0; i < n; ++i) {
+    dx[i] = 0.5
+            * (1.0 + std::erf(inv_sqrt2 * x[i]) + x[i] * coef * std::exp(-0.5 * x[i] * x[i]))
+            * dy[i];
+  }
+}
+
+// name of the instruction set the float versions run on
+const char* ActiveIsaName();
+// names of the instruction sets this cpu can run the float versions on, e.g. {scalar, sse2, avx2}
+std::vector<std::string> SupportedIsaNames();
+// runs the float versions on a supported instruction set from now on, returns false for an
+// unsupported one; not to be called while other threads use the float versions
+bool SetActiveIsa(const std::string& isa_name);
+
+}  // namespace cpu_fast_math
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_UTIL_CPU_FAST_MATH_H_
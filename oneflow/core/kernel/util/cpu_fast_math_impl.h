@@ -0,0 +1,182 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+// No include guard: cpu_fast_math.cpp includes this file once per instruction set, inside a
+// namespace defining `Ops`, the vector type `F`, the integer vector type `I` and the mask type `M`
+// with their static inline operations. Every function below is compiled for that instruction set.
+
+inline F Set1(float v) { return Ops::Set1(v); }
+
+inline F AbsOf(F x) { return Ops::AsFloat(Ops::IAnd(Ops::AsInt(x), Ops::ISet1(0x7fffffff))); }
+
+inline F NegateIf(M m, F x) { return Ops::Select(m, Ops::Sub(Set1(0.0f), x), x); }
+
+// Cephes expf: exp(x) = 2^n * exp(r), x = n * ln2 + r, |r| <= ln2 / 2
+inline F ExpOf(F x) {
+  const float kMaxArg = 88.72283935546875f;
+  const float kMinArg = -87.33654785156250f;
+  // adding 1.5 * 2^23 rounds |v| < 2^22 to the nearest integer held in the low mantissa bits
+  const F kRoundMagic = Set1(12582912.0f);
+  const F clamped = Ops::Min(Ops::Max(x, Set1(kMinArg)), Set1(kMaxArg));
+  const F t = Ops::Add(Ops::Mul(clamped, Set1(1.44269504088896341f)), kRoundMagic);
+  const F nf = Ops::Sub(t, kRoundMagic);
+  const I n = Ops::ISub(Ops::AsInt(t), Ops::AsInt(kRoundMagic));
+  F r = Ops::Sub(clamped, Ops::Mul(nf, Set1(0.693359375f)));
+  r = Ops::Add(r, Ops::Mul(nf, Set1(2.12194440e-4f)));
+  F p = Set1(1.9875691500e-4f);
+  p = Ops::MulAdd(p, r, Set1(1.3981999507e-3f));
+  p = Ops::MulAdd(p, r, Set1(8.3334519073e-3f));
+  p = Ops::MulAdd(p, r, Set1(4.1665795894e-2f));
+  p = Ops::MulAdd(p, r, Set1(1.6666665459e-1f));
+  p = Ops::MulAdd(p, r, Set1(5.0000001201e-1f));
+  p = Ops::Add(Ops::MulAdd(Ops::Mul(p, r), r, r), Set1(1.0f));
+  // 2^n is applied in two factors since n reaches 128 at kMaxArg
+  const I n1 = Ops::IShiftRightArith(n, 1);
+  const I kBias = Ops::ISet1(127);
+  const F scale1 = Ops::AsFloat(Ops::IShiftLeft(Ops::IAdd(n1, kBias), 23));
+  const F scale2 = Ops::AsFloat(Ops::IShiftLeft(Ops::IAdd(Ops::ISub(n, n1), kBias), 23));
+  F y = Ops::Mul(Ops::Mul(p, scale1), scale2);
+  y = Ops::Select(Ops::Gt(x, Set1(kMaxArg)), Set1(INFINITY), y);
+  y = Ops::Select(Ops::Lt(x, Set1(kMinArg)), Set1(0.0f), y);
+  return Ops::Select(Ops::IsNan(x), x, y);
+}
+
+// Cephes logf: log(x) = e * ln2 + log(1 + m), sqrt(0.5) <= 1 + m < sqrt(2)
+inline F LogOf(F x) {
+  const M denormal = Ops::Lt(x, Set1(1.17549435e-38f));
+  const I bits = Ops::AsInt(Ops::Select(denormal, Ops::Mul(x, Set1(8388608.0f)), x));
+  F e = Ops::ToFloat(
+      Ops::ISub(Ops::IAnd(Ops::IShiftRightLogical(bits, 23), Ops::ISet1(0xff)), Ops::ISet1(126)));
+  e = Ops::Select(denormal, Ops::Sub(e, Set1(23.0f)), e);
+  F m = Ops::AsFloat(Ops::IOr(Ops::IAnd(bits, Ops::ISet1(0x007fffff)), Ops::ISet1(0x3f000000)));
+  const M below_sqrt_half = Ops::Lt(m, Set1(0.707106781186547524f));
+  e = Ops::Select(below_sqrt_half, Ops::Sub(e, Set1(1.0f)), e);
+  m = Ops::Sub(Ops::Select(below_sqrt_half, Ops::Add(m, m), m), Set1(1.0f));
+  const F z = Ops::Mul(m, m);
+  F p = Set1(7.0376836292e-2f);
+  p = Ops::MulAdd(p, m, Set1(-1.1514610310e-1f));
+  p = Ops::MulAdd(p, m, Set1(1.1676998740e-1f));
+  p = Ops::MulAdd(p, m, Set1(-1.2420140846e-1f));
+  p = Ops::MulAdd(p, m, Set1(1.4249322787e-1f));
+  p = Ops::MulAdd(p, m, Set1(-1.6668057665e-1f));
+  p = Ops::MulAdd(p, m, Set1(2.0000714765e-1f));
+  p = Ops::MulAdd(p, m, Set1(-2.4999993993e-1f));
+  p = Ops::MulAdd(p, m, Set1(3.3333331174e-1f));
+  F y = Ops::Mul(Ops::Mul(p, m), z);
+  y = Ops::Sub(y, Ops::Mul(e, Set1(2.12194440e-4f)));
+  y = Ops::Sub(y, Ops::Mul(z, Set1(0.5f)));
+  y = Ops::Add(Ops::Add(m, y), Ops::Mul(e, Set1(0.693359375f)));
+  y = Ops::Select(Ops::Eq(x, Set1(INFINITY)), x, y);
+  y = Ops::Select(Ops::Eq(x, Set1(0.0f)), Set1(-INFINITY), y);
+  return Ops::Select(Ops::Or(Ops::Lt(x, Set1(0.0f)), Ops::IsNan(x)), Set1(NAN), y);
+}
+
+// odd polynomial (Cephes tanhf) for |x| < 0.625, 1 - 2 / (exp(2|x|) + 1) otherwise
+inline F TanhOf(F x) {
+  const F z = Ops::Mul(x, x);
+  F p = Set1(-5.70498872745e-3f);
+  p = Ops::MulAdd(p, z, Set1(2.06390887954e-2f));
+  p = Ops::MulAdd(p, z, Set1(-5.37397155531e-2f));
+  p = Ops::MulAdd(p, z, Set1(1.33314422036e-1f));
+  p = Ops::MulAdd(p, z, Set1(-3.33332819422e-1f));
+  const F small = Ops::MulAdd(Ops::Mul(p, z), x, x);
+  const F ax = AbsOf(x);
+  const F e = ExpOf(Ops::Add(ax, ax));
+  const F large = Ops::Sub(Set1(1.0f), Ops::Div(Set1(2.0f), Ops::Add(e, Set1(1.0f))));
+  return Ops::Select(Ops::Lt(ax, Set1(0.625f)), small, NegateIf(Ops::Lt(x, Set1(0.0f)), large));
+}
+
+// odd polynomial (Cephes erff) for |x| < 1, Abramowitz-Stegun 7.1.26 otherwise
+inline F ErfOf(F x) {
+  const F z = Ops::Mul(x, x);
+  F p = Set1(7.853861353153693e-5f);
+  p = Ops::MulAdd(p, z, Set1(-8.010193625184903e-4f));
+  p = Ops::MulAdd(p, z, Set1(5.188327685732524e-3f));
+  p = Ops::MulAdd(p, z, Set1(-2.685381193529856e-2f));
+  p = Ops::MulAdd(p, z, Set1(1.128358514861418e-1f));
+  p = Ops::MulAdd(p, z, Set1(-3.761262582423300e-1f));
+  p = Ops::MulAdd(p, z, Set1(1.128379165726710e+0f));
+  const F small = Ops::Mul(p, x);
+  const F ax = AbsOf(x);
+  const F t = Ops::Div(Set1(1.0f), Ops::MulAdd(ax, Set1(0.3275911f), Set1(1.0f)));
+  F q = Set1(1.061405429f);
+  q = Ops::MulAdd(q, t, Set1(-1.453152027f));
+  q = Ops::MulAdd(q, t, Set1(1.421413741f));
+  q = Ops::MulAdd(q, t, Set1(-0.284496736f));
+  q = Ops::MulAdd(q, t, Set1(0.254829592f));
+  const F e = ExpOf(Ops::Sub(Set1(0.0f), z));
+  F large = Ops::Sub(Set1(1.0f), Ops::Mul(Ops::Mul(q, t), e));
+  large = Ops::Select(Ops::Gt(ax, Set1(4.0f)), Set1(1.0f), large);
+  return Ops::Select(Ops::Lt(ax, Set1(1.0f)), small, NegateIf(Ops::Lt(x, Set1(0.0f)), large));
+}
+
+inline F SigmoidOf(F x) {
+  const F e = ExpOf(Ops::Sub(Set1(0.0f), x));
+  return Ops::Div(Set1(1.0f), Ops::Add(e, Set1(1.0f)));
+}
+
+inline F GeluOf(F x) {
+  const F erf = ErfOf(Ops::Mul(x, Set1(0.70710678118654752f)));
+  return Ops::Mul(Ops::Mul(x, Set1(0.5f)), Ops::Add(erf, Set1(1.0f)));
+}
+
+inline F GeluGradOf(F x, F dy) {
+  const F erf = ErfOf(Ops::Mul(x, Set1(0.70710678118654752f)));
+  const F e = ExpOf(Ops::Mul(Ops::Mul(x, x), Set1(-0.5f)));
+  const F pdf = Ops::Mul(Ops::Mul(x, Set1(0.79788456080286536f)), e);
+  return Ops::Mul(Ops::Mul(Ops::Add(Ops::Add(erf, Set1(1.0f)), pdf), Set1(0.5f)), dy);
+}
+
+// The tail shorter than a vector goes through a zero padded buffer, so that every element is
+// computed by the same instructions.
+template<F (*Func)(F)>
+void UnaryArray(const float* x, float* y, int64_t n) {
+  int64_t i = 0;
+  for (; i + Ops::kWidth <= n; i += Ops::kWidth) { Ops::Store(y + i, Func(Ops::Load(x + i))); }
+  if (i < n) {
+    float x_buf[Ops::kWidth] = {0};
+    float y_buf[Ops::kWidth];
+    std::copy(x + i, x + n, x_buf);
+    Ops::Store(y_buf, Func(Ops::Load(x_buf)));
+    std::copy(y_buf, y_buf + (n - i), y + i);
+  }
+}
+
+template<F (*Func)(F, F)>
+void BinaryArray(const float* a, const float* b, float* y, int64_t n) {
+  int64_t i = 0;
+  for (; i + Ops::kWidth <= n; i += Ops::kWidth) {
+    Ops::Store(y + i, Func(Ops::Load(a + i), Ops::Load(b + i)));
+  }
+  if (i < n) {
+    float a_buf[Ops::kWidth] = {0};
+    float b_buf[Ops::kWidth] = {0};
+    float y_buf[Ops::kWidth];
+    std::copy(a + i, a + n, a_buf);
+    std::copy(b + i, b + n, b_buf);
+    Ops::Store(y_buf, Func(Ops::Load(a_buf), Ops::Load(b_buf)));
+    std::copy(y_buf, y_buf + (n - i), y + i);
+  }
+}
+
+void Exp(const float* x, float* y, int64_t n) { UnaryArray<ExpOf>(x, y, n); }
+void Log(const float* x, float* y, int64_t n) { UnaryArray<LogOf>(x, y, n); }
+void Tanh(const float* x, float* y, int64_t n) { UnaryArray<TanhOf>(x, y, n); }
+void Erf(const float* x, float* y, int64_t n) { UnaryArray<ErfOf>(x, y, n); }
+void Sigmoid(const float* x, float* y, int64_t n) { UnaryArray<SigmoidOf>(x, y, n); }
+void Gelu(const float* x, float* y, int64_t n) { UnaryArray<GeluOf>(x, y, n); }
+void GeluGrad(const float* x, const float* dy, float* dx, int64_t n) {
+  BinaryArray<GeluGradOf>(x, dy, dx, n);
+}
@@ -0,0 +1,168 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/util/cpu_fast_math.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace cpu_fast_math {
+
+namespace {
+
+// odd length, so that the tail shorter than a simd vector is covered as well
+std::vector<float> LinSpace(float begin, float end, int64_t n) {
+  std::vector<float> x(n);
+  FOR_RANGE(int64_t, i, 0, n) { x[i] = begin + (static_cast<double>(end) - begin) * i / (n - 1); }
+  return x;
+}
+
+void CheckUnary(void (*Func)(const float*, float*, int64_t), double (*Ref)(double),
+                const std::vector<float>& x, double max_rel_err, double max_abs_err) {
+  std::vector<float> y(x.size());
+  Func(x.data(), y.data(), x.size());
+  FOR_RANGE(size_t, i, 0, x.size()) {
+    const double ref = Ref(x[i]);
+    const double abs_err = std::abs(y[i] - ref);
+    ASSERT_TRUE(abs_err <= max_abs_err || abs_err <= max_rel_err * std::abs(ref))
+        << "x: " << x[i] << " y: " << y[i] << " ref: " << ref << " isa: " << ActiveIsaName();
+  }
+}
+
+// runs Check on every instruction set this cpu supports
+void ForEachIsa(const std::function<void()>& Check) {
+  const std::string active_isa = ActiveIsaName();
+  for (const std::string& isa : SupportedIsaNames()) {
+    ASSERT_TRUE(SetActiveIsa(isa));
+    Check();
+  }
+  ASSERT_TRUE(SetActiveIsa(active_isa));
+}
+
+double RefSigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+
+double RefExp(double x) { return std::exp(x); }
+double RefLog(double x) { return std::log(x); }
+double RefTanh(double x) { return std::tanh(x); }
+double RefErf(double x) { return std::erf(x); }
+
+}  // namespace
+
+TEST(CpuFastMath, exp) {
+  ForEachIsa([]() {
+    CheckUnary(Exp, RefExp, LinSpace(-87.3f, 88.7f, 1000003), 1.5e-7, 0);
+    CheckUnary(Exp, RefExp, LinSpace(-1e-3f, 1e-3f, 10007), 1.5e-7, 0);
+  });
+}
+
+TEST(CpuFastMath, log) {
+  ForEachIsa([]() {
+    CheckUnary(Log, RefLog, LinSpace(1e-3f, 10.0f, 1000003), 1.5e-7, 0);
+    CheckUnary(Log, RefLog, LinSpace(0.9f, 1.1f, 100003), 1.5e-7, 0);
+    CheckUnary(Log, RefLog, LinSpace(10.0f, 3e38f, 100003), 1.5e-7, 0);
+    CheckUnary(Log, RefLog, {1e-45f, 1e-40f, 1e-38f, 1.0f}, 1.5e-7, 0);
+  });
+}
+
+TEST(CpuFastMath, tanh) {
+  ForEachIsa([]() {
+    CheckUnary(Tanh, RefTanh, LinSpace(-12.0f, 12.0f, 1000003), 2e-7, 0);
+    CheckUnary(Tanh, RefTanh, LinSpace(-1e-3f, 1e-3f, 10007), 2e-7, 0);
+  });
+}
+
+TEST(CpuFastMath, erf) {
+  ForEachIsa([]() {
+    CheckUnary(Erf, RefErf, LinSpace(-6.0f, 6.0f, 1000003), 2.5e-7, 2.5e-7);
+    CheckUnary(Erf, RefErf, LinSpace(-1e-3f, 1e-3f, 10007), 2.5e-7, 0);
+  });
+}
+
+TEST(CpuFastMath, sigmoid) {
+  ForEachIsa([]() {
+    CheckUnary(Sigmoid, RefSigmoid, LinSpace(-80.0f, 80.0f, 1000003), 3e-7, 0);
+  });
+}
+
+TEST(CpuFastMath, gelu) {
+  ForEachIsa([]() {
+    const std::vector<float> x = LinSpace(-10.0f, 10.0f, 100003);
+    std::vector<float> dy(x.size(), 1.5f);
+    std::vector<float> y(x.size());
+    std::vector<float> dx(x.size());
+    Gelu(x.data(), y.data(), x.size());
+    GeluGrad(x.data(), dy.data(), dx.data(), x.size());
+    std::vector<double> x_d(x.begin(), x.end());
+    std::vector<double> dy_d(dy.begin(), dy.end());
+    std::vector<double> y_d(x.size());
+    std::vector<double> dx_d(x.size());
+    Gelu(x_d.data(), y_d.data(), x.size());
+    GeluGrad(x_d.data(), dy_d.data(), dx_d.data(), x.size());
+    FOR_RANGE(size_t, i, 0, x.size()) {
+      ASSERT_NEAR(y[i], y_d[i], 1e-6 * std::max(1.0, std::abs(y_d[i])));
+      ASSERT_NEAR(dx[i], dx_d[i], 1e-6 * std::max(1.0, std::abs(dx_d[i])));
+    }
+  });
+}
+
+TEST(CpuFastMath, special_values) {
+  ForEachIsa([]() {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<float> x = {inf, -inf, nan, 0.0f, -0.0f, 100.0f, -100.0f, -1.0f};
+    std::vector<float> y(x.size());
+    Exp(x.data(), y.data(), x.size());
+    ASSERT_EQ(y[0], inf);
+    ASSERT_EQ(y[1], 0.0f);
+    ASSERT_TRUE(std::isnan(y[2]));
+    ASSERT_EQ(y[3], 1.0f);
+    ASSERT_EQ(y[5], inf);
+    ASSERT_EQ(y[6], 0.0f);
+    Log(x.data(), y.data(), x.size());
+    ASSERT_EQ(y[0], inf);
+    ASSERT_TRUE(std::isnan(y[1]));
+    ASSERT_TRUE(std::isnan(y[2]));
+    ASSERT_EQ(y[3], -inf);
+    ASSERT_EQ(y[4], -inf);
+    ASSERT_TRUE(std::isnan(y[7]));
+    Tanh(x.data(), y.data(), x.size());
+    ASSERT_EQ(y[0], 1.0f);
+    ASSERT_EQ(y[1], -1.0f);
+    ASSERT_TRUE(std::isnan(y[2]));
+    ASSERT_EQ(y[3], 0.0f);
+    Erf(x.data(), y.data(), x.size());
+    ASSERT_EQ(y[0], 1.0f);
+    ASSERT_EQ(y[1], -1.0f);
+    ASSERT_TRUE(std::isnan(y[2]));
+    Sigmoid(x.data(), y.data(), x.size());
+    ASSERT_EQ(y[0], 1.0f);
+    ASSERT_EQ(y[1], 0.0f);
+    ASSERT_TRUE(std::isnan(y[2]));
+    ASSERT_EQ(y[3], 0.5f);
+  });
+}
+
+TEST(CpuFastMath, set_active_isa) {
+  const std::vector<std::string> isa_names = SupportedIsaNames();
+  ASSERT_EQ(isa_names.front(), "scalar");
+  ASSERT_FALSE(SetActiveIsa("avx1024"));
+  ASSERT_TRUE(SetActiveIsa("scalar"));
+  ASSERT_STREQ(ActiveIsaName(), "scalar");
+  ASSERT_TRUE(SetActiveIsa(isa_names.back()));
+}
+
+}  // namespace cpu_fast_math
+
+}  // namespace oneflow
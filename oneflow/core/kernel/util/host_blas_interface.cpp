@@ -14,21 +14,221 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/util/host_blas_interface.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
+#include "oneflow/core/kernel/model_version.h"
 #include "oneflow/core/register/blob.h"
 
 namespace oneflow {
 
 namespace {
 
+// multiply-adds per part below which handing a gemm tile to another thread costs more than it saves
+constexpr int64_t kCpuGemmGrainSize = 1 << 18;
+// multiply-adds of a gemm from which a multithreaded blas library runs it on several threads
+constexpr int64_t kCpuBlasParallelGemmSize = 1 << 21;
+
+// 0 if the blas library does not tell
+int BlasMaxThreadNum() {
+#if defined(WITH_MKL_THREAD_NUM)
+  return mkl_get_max_threads();
+#elif defined(WITH_OPENBLAS_THREAD_NUM)
+  return openblas_get_num_threads();
+#else
+  return 0;
+#endif
+}
+
+// e.g. the sequential mkl oneflow links by default
+bool IsBlasSequential() {
+  static const bool is_sequential = BlasMaxThreadNum() == 1;
+  return is_sequential;
+}
+
+// Keeps the blas calls of the calling thread on this thread while it lives, so that the gemms run
+// on the workers of the thread pool do not start blas threads of their own. Without a per thread
+// setter, the library is trusted to run the small gemms split here on one thread.
+class BlasSingleThreadGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(BlasSingleThreadGuard);
+#if defined(WITH_MKL_THREAD_NUM)
+  BlasSingleThreadGuard() : prev_thread_num_(mkl_set_num_threads_local(1)) {}
+  ~BlasSingleThreadGuard() { mkl_set_num_threads_local(prev_thread_num_); }
+#elif defined(WITH_OPENBLAS_LOCAL_THREAD_NUM)
+  BlasSingleThreadGuard() : prev_thread_num_(openblas_set_num_threads_local(1)) {}
+  ~BlasSingleThreadGuard() { openblas_set_num_threads_local(prev_thread_num_); }
+#else
+  BlasSingleThreadGuard() : prev_thread_num_(0) {}
+  ~BlasSingleThreadGuard() = default;
+#endif
+
+ private:
+  int prev_thread_num_;
+};
+
+enum class GemmSplitAxis { kAny, kM, kN };
+
+// Splits a batch of m x n x k gemms into tasks and calls
+// TileGemm(batch_id, m_begin, m_end, n_begin, n_end) for every task on the thread pool.
+//
+// A multithreaded blas library parallelizes a large gemm better by itself, and running its
+// threads on every worker would oversubscribe the cores. So such a library gets the gemms one by
+// one unless they are small, and then the tasks are whole gemms of the batch. Only a sequential
+// library gets a single gemm split, into blocks of rows of c (or of columns, when n is the larger
+// dimension or split_axis asks for it) when the batch has fewer gemms than parts.
+template<typename TileGemm>
+void ForEachGemmTile(const int batch_size, const int m, const int n, const int k,
+                     const GemmSplitAxis split_axis, const TileGemm& tile_gemm) {
+  const int64_t gemm_size = static_cast<int64_t>(m) * n * k;
+  const bool is_blas_sequential = IsBlasSequential();
+  int64_t part_num = 1;
+  if (is_blas_sequential) {
+    part_num = CpuParallelPartNum(batch_size * gemm_size, kCpuGemmGrainSize);
+  } else if (gemm_size < kCpuBlasParallelGemmSize) {
+    part_num = std::min<int64_t>(CpuParallelPartNum(batch_size * gemm_size, kCpuGemmGrainSize),
+                                 batch_size);
+  }
+  if (part_num == 1) {
+    FOR_RANGE(int, i, 0, batch_size) { tile_gemm(i, 0, m, 0, n); }
+    return;
+  }
+  if (batch_size >= part_num) {
+    const BalancedSplitter bs(batch_size, part_num);
+    MultiThreadLoop(part_num, [&](size_t part_id) {
+      BlasSingleThreadGuard guard;
+      const Range range = bs.At(part_id);
+      FOR_RANGE(int, i, range.begin(), range.end()) { tile_gemm(i, 0, m, 0, n); }
+    });
+    return;
+  }
+  CHECK(is_blas_sequential);
+  const bool split_m =
+      split_axis == GemmSplitAxis::kM || (split_axis == GemmSplitAxis::kAny && m >= n);
+  const int dim = split_m ? m : n;
+  const int64_t tile_num = std::min<int64_t>((part_num + batch_size - 1) / batch_size, dim);
+  const BalancedSplitter bs(dim, tile_num);
+  MultiThreadLoop(batch_size * tile_num, [&](size_t task_id) {
+    const int i = task_id / tile_num;
+    const Range range = bs.At(task_id % tile_num);
+    if (split_m) {
+      tile_gemm(i, range.begin(), range.end(), 0, n);
+    } else {
+      tile_gemm(i, 0, m, range.begin(), range.end());
+    }
+  });
+}
+
+inline int GetLda(enum CBLAS_TRANSPOSE trans_a, const int m, const int k) {
+  return (trans_a == CblasNoTrans) ? k : m;
+}
+
+inline int GetLdb(enum CBLAS_TRANSPOSE trans_b, const int n, const int k) {
+  return (trans_b == CblasNoTrans) ? n : k;
+}
+
+// rows [m_begin, m_end) of op(a) and columns [n_begin, n_end) of op(b)
+template<typename T>
+const T* GetATile(enum CBLAS_TRANSPOSE trans_a, const int m, const int k, const T* a,
+                  const int m_begin) {
+  return (trans_a == CblasNoTrans) ? a + static_cast<int64_t>(m_begin) * k : a + m_begin;
+}
+
+template<typename T>
+const T* GetBTile(enum CBLAS_TRANSPOSE trans_b, const int n, const int k, const T* b,
+                  const int n_begin) {
+  return (trans_b == CblasNoTrans) ? b + n_begin : b + static_cast<int64_t>(n_begin) * k;
+}
+
+template<typename T>
+void GemmTile(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b, const int m, const int n,
+              const int k, const T alpha, const T* a, const T* b, const T beta, T* c,
+              const int m_begin, const int m_end, const int n_begin, const int n_end) {
+  cblas_gemm<T>(CblasRowMajor, trans_a, trans_b, m_end - m_begin, n_end - n_begin, k, alpha,
+                GetATile(trans_a, m, k, a, m_begin), GetLda(trans_a, m, k),
+                GetBTile(trans_b, n, k, b, n_begin), GetLdb(trans_b, n, k), beta,
+                c + static_cast<int64_t>(m_begin) * n + n_begin, n);
+}
+
 template<typename T>
 static void Gemm(DeviceCtx* ctx, const enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans_a,
                  enum CBLAS_TRANSPOSE trans_b, const int m, const int n, const int k, const T alpha,
                  const T* a, const T* b, const T beta, T* c) {
-  const int lda = (trans_a == CblasNoTrans) ? k : m;
-  const int ldb = (trans_b == CblasNoTrans) ? n : k;
-  const int ldc = n;
+  CHECK_EQ(order, CblasRowMajor);
+  ForEachGemmTile(1, m, n, k, GemmSplitAxis::kAny,
+                  [&](int, int m_begin, int m_end, int n_begin, int n_end) {
+                    GemmTile<T>(trans_a, trans_b, m, n, k, alpha, a, b, beta, c, m_begin, m_end,
+                                n_begin, n_end);
+                  });
+}
+
+#ifdef WITH_BLAS_PACKED_GEMM
+
+template<typename T>
+struct PackedGemm;
+
+template<>
+struct PackedGemm<float> {
+  template<typename... Args>
+  static size_t GetSize(Args&&... args) {
+    return cblas_sgemm_pack_get_size(std::forward<Args>(args)...);
+  }
+  template<typename... Args>
+  static void Pack(Args&&... args) {
+    cblas_sgemm_pack(std::forward<Args>(args)...);
+  }
+  template<typename... Args>
+  static void Compute(Args&&... args) {
+    cblas_sgemm_compute(std::forward<Args>(args)...);
+  }
+};
+
+template<>
+struct PackedGemm<double> {
+  template<typename... Args>
+  static size_t GetSize(Args&&... args) {
+    return cblas_dgemm_pack_get_size(std::forward<Args>(args)...);
+  }
+  template<typename... Args>
+  static void Pack(Args&&... args) {
+    cblas_dgemm_pack(std::forward<Args>(args)...);
+  }
+  template<typename... Args>
+  static void Compute(Args&&... args) {
+    cblas_dgemm_compute(std::forward<Args>(args)...);
+  }
+};
+
+constexpr size_t kPackedPanelAlignment = 64;
 
-  cblas_gemm<T>(order, trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+#endif  // WITH_BLAS_PACKED_GEMM
+
+template<typename T>
+void GemmWithPackCache(DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b,
+                       const int m, const int n, const int k, const T alpha, const T* a,
+                       const T* b, const T beta, T* c, CpuGemmPackCache<T>* cache) {
+  const bool is_a_packed = cache->const_operand() == CpuGemmConstOperand::kA;
+  const T* panels = is_a_packed ? cache->GetOrPack(trans_a, m, n, k, alpha, a)
+                                : cache->GetOrPack(trans_b, m, n, k, alpha, b);
+  if (panels == nullptr) {
+    Gemm<T>(ctx, CblasRowMajor, trans_a, trans_b, m, n, k, alpha, a, b, beta, c);
+    return;
+  }
+#ifdef WITH_BLAS_PACKED_GEMM
+  // the panels hold all of op(a) (or op(b)), so the tiles split the other operand
+  ForEachGemmTile(
+      1, m, n, k, is_a_packed ? GemmSplitAxis::kN : GemmSplitAxis::kM,
+      [&](int, int m_begin, int m_end, int n_begin, int n_end) {
+        T* c_tile = c + static_cast<int64_t>(m_begin) * n + n_begin;
+        if (is_a_packed) {
+          PackedGemm<T>::Compute(CblasRowMajor, CblasPacked, trans_b, m, n_end - n_begin, k,
+                                 panels, GetLda(trans_a, m, k), GetBTile(trans_b, n, k, b, n_begin),
+                                 GetLdb(trans_b, n, k), beta, c_tile, n);
+        } else {
+          PackedGemm<T>::Compute(CblasRowMajor, trans_a, CblasPacked, m_end - m_begin, n, k,
+                                 GetATile(trans_a, m, k, a, m_begin), GetLda(trans_a, m, k), panels,
+                                 GetLdb(trans_b, n, k), beta, c_tile, n);
+        }
+      });
+#endif  // WITH_BLAS_PACKED_GEMM
 }
 
 template<typename T>
@@ -57,17 +257,55 @@ void BatchedGemmImpl(DeviceCtx* ctx, const enum CBLAS_ORDER order,
                      const enum CBLAS_TRANSPOSE trans_a, const enum CBLAS_TRANSPOSE trans_b,
                      int batch_size, int m, int n, int k, const T alpha, const T* a, const T* b,
                      const T beta, T* c, T** buf) {
-  const int a_stride = m * k;
-  const int b_stride = k * n;
-  const int c_stride = m * n;
-  FOR_RANGE(int32_t, i, 0, batch_size) {
-    BlasIf<DeviceType::kCPU>::OFGemm(ctx, trans_a, trans_b, m, n, k, alpha, a + i * a_stride,
-                                     b + i * b_stride, beta, c + i * c_stride);
-  }
+  CHECK_EQ(order, CblasRowMajor);
+  const int64_t a_stride = static_cast<int64_t>(m) * k;
+  const int64_t b_stride = static_cast<int64_t>(k) * n;
+  const int64_t c_stride = static_cast<int64_t>(m) * n;
+  ForEachGemmTile(batch_size, m, n, k, GemmSplitAxis::kAny,
+                  [&](int i, int m_begin, int m_end, int n_begin, int n_end) {
+                    GemmTile<T>(trans_a, trans_b, m, n, k, alpha, a + i * a_stride,
+                                b + i * b_stride, beta, c + i * c_stride, m_begin, m_end, n_begin,
+                                n_end);
+                  });
 }
 
 }  // namespace
 
+template<typename T>
+const T* CpuGemmPackCache<T>::GetOrPack(enum CBLAS_TRANSPOSE trans, int m, int n, int k, T alpha,
+                                        const T* operand) {
+#ifdef WITH_BLAS_PACKED_GEMM
+  const bool is_b = const_operand_ == CpuGemmConstOperand::kB;
+  const int64_t model_version = GetModelVersion();
+  // the panels of b serve any m and the panels of a any n
+  const bool is_shape_same = k_ == k && (is_b ? n_ == n : m_ == m);
+  if (is_valid_ && operand_ == operand && trans_ == trans && is_shape_same && alpha_ == alpha
+      && model_version_ == model_version) {
+    return panels_;
+  }
+  const enum CBLAS_IDENTIFIER identifier = is_b ? CblasBMatrix : CblasAMatrix;
+  buf_.resize(PackedGemm<T>::GetSize(identifier, m, n, k) + kPackedPanelAlignment);
+  panels_ = reinterpret_cast<T*>(RoundUp(reinterpret_cast<uintptr_t>(buf_.data()),
+                                         kPackedPanelAlignment));
+  PackedGemm<T>::Pack(CblasRowMajor, identifier, trans, m, n, k, alpha, operand,
+                      is_b ? GetLdb(trans, n, k) : GetLda(trans, m, k), panels_);
+  is_valid_ = true;
+  operand_ = operand;
+  trans_ = trans;
+  m_ = m;
+  n_ = n;
+  k_ = k;
+  alpha_ = alpha;
+  model_version_ = model_version;
+  return panels_;
+#else
+  return nullptr;
+#endif  // WITH_BLAS_PACKED_GEMM
+}
+
+template class CpuGemmPackCache<float>;
+template class CpuGemmPackCache<double>;
+
 void BlasIf<DeviceType::kCPU>::BlobGemm(DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a,
                                         enum CBLAS_TRANSPOSE trans_b, float alpha, float beta,
                                         const Blob* a, const Blob* b, Blob* c) {
@@ -112,6 +350,20 @@ void BlasIf<DeviceType::kCPU>::OFBatchedGemm(DeviceCtx* ctx, enum CBLAS_TRANSPOS
                           beta, c, buf);
 }
 
+void BlasIf<DeviceType::kCPU>::OFGemmWithPackCache(
+    DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b, const int m,
+    const int n, const int k, const float alpha, const float* a, const float* b, const float beta,
+    float* c, CpuGemmPackCache<float>* cache) {
+  GemmWithPackCache<float>(ctx, trans_a, trans_b, m, n, k, alpha, a, b, beta, c, cache);
+}
+
+void BlasIf<DeviceType::kCPU>::OFGemmWithPackCache(
+    DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b, const int m,
+    const int n, const int k, const double alpha, const double* a, const double* b,
+    const double beta, double* c, CpuGemmPackCache<double>* cache) {
+  GemmWithPackCache<double>(ctx, trans_a, trans_b, m, n, k, alpha, a, b, beta, c, cache);
+}
+
 void BlasIf<DeviceType::kCPU>::Axpy(DeviceCtx* ctx, const int n, const float alpha, const float* x,
                                     const int incx, float* y, const int incy) {
   AxpyImpl<float>(ctx, n, alpha, x, incx, y, incy);
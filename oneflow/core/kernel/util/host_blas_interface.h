@@ -24,6 +24,42 @@ namespace oneflow {
 
 class Blob;
 
+// Which operand of a gemm stays the same across calls, e.g. a weight
+enum class CpuGemmConstOperand { kA, kB };
+
+// Panels of the constant operand of a gemm, packed by the blas library into its internal layout by
+// the first OFGemmWithPackCache call and reused while the operand's address, the gemm shape and the
+// model version (see model_version.h) are unchanged. Without a blas library that packs operands
+// (WITH_BLAS_PACKED_GEMM, defined for mkl) it stays empty and the gemm runs unpacked.
+template<typename T>
+class CpuGemmPackCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CpuGemmPackCache);
+  explicit CpuGemmPackCache(CpuGemmConstOperand const_operand)
+      : const_operand_(const_operand), is_valid_(false) {}
+  ~CpuGemmPackCache() = default;
+
+  CpuGemmConstOperand const_operand() const { return const_operand_; }
+  // drops the panels, e.g. when the operand may have changed since the last call
+  void Invalidate() { is_valid_ = false; }
+  // Returns the panels of operand (op(a) or op(b) of a m x n x k gemm), packing them on a miss.
+  // Returns nullptr when the blas library cannot pack operands.
+  const T* GetOrPack(enum CBLAS_TRANSPOSE trans, int m, int n, int k, T alpha, const T* operand);
+
+ private:
+  CpuGemmConstOperand const_operand_;
+  bool is_valid_;
+  const T* operand_;
+  enum CBLAS_TRANSPOSE trans_;
+  int m_;
+  int n_;
+  int k_;
+  T alpha_;
+  int64_t model_version_;
+  std::vector<char> buf_;
+  T* panels_;
+};
+
 template<>
 struct BlasIf<DeviceType::kCPU> {
   static void BlobGemm(DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b,
@@ -44,6 +80,16 @@ struct BlasIf<DeviceType::kCPU> {
                             enum CBLAS_TRANSPOSE trans_b, const int batch_size, const int m,
                             const int n, const int k, const double alpha, const double* a,
                             const double* b, const double beta, double* c, double** buf);
+  // OFGemm with the constant operand taken from the panels in cache, packed on a miss
+  static void OFGemmWithPackCache(DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a,
+                                  enum CBLAS_TRANSPOSE trans_b, const int m, const int n,
+                                  const int k, const float alpha, const float* a, const float* b,
+                                  const float beta, float* c, CpuGemmPackCache<float>* cache);
+  static void OFGemmWithPackCache(DeviceCtx* ctx, enum CBLAS_TRANSPOSE trans_a,
+                                  enum CBLAS_TRANSPOSE trans_b, const int m, const int n,
+                                  const int k, const double alpha, const double* a,
+                                  const double* b, const double beta, double* c,
+                                  CpuGemmPackCache<double>* cache);
 
   static void Axpy(DeviceCtx* ctx, const int n, const float alpha, const float* x, const int incx,
                    float* y, const int incy);
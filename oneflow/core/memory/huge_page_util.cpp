@@ -0,0 +1,124 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/memory/huge_page_util.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace oneflow {
+
+namespace {
+
+#ifdef __linux__
+const size_t kTransparentHugePageSize = 2 * 1024 * 1024;
+
+// MAP_HUGE_SHIFT is missing in old headers
+const int kMapHugeShift = 26;
+
+bool IsPowerOfTwo(size_t n) { return n > 0 && (n & (n - 1)) == 0; }
+
+int Log2(size_t n) {
+  int log2 = 0;
+  while ((static_cast<size_t>(1) << log2) < n) { ++log2; }
+  return log2;
+}
+#endif  // __linux__
+
+}  // namespace
+
+MappedHostMem MmapHostMem(size_t size, int64_t huge_page_kbyte) {
+  CHECK_GE(huge_page_kbyte, 0);
+  MappedHostMem mem;
+#ifdef __linux__
+  if (huge_page_kbyte > 0 && !IsPowerOfTwo(huge_page_kbyte)) {
+    LOG(WARNING) << "host_regst_huge_page_kbyte " << huge_page_kbyte
+                 << " is not a power of two, regular pages are used";
+  } else if (huge_page_kbyte > 0) {
+    const size_t huge_page_size = huge_page_kbyte * 1024;
+    mem.mapped_size = RoundUp(size, huge_page_size);
+    mem.page_size = huge_page_size;
+    void* ptr = mmap(nullptr, mem.mapped_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB
+                         | (Log2(huge_page_size) << kMapHugeShift),
+                     -1, 0);
+    if (ptr != MAP_FAILED) {
+      mem.ptr = static_cast<char*>(ptr);
+      return mem;
+    }
+    LOG(WARNING) << "failed to map " << mem.mapped_size << " bytes of " << huge_page_kbyte
+                 << "KB huge pages, errno " << errno << ", transparent huge pages are used";
+  }
+  mem.mapped_size = RoundUp(size, kTransparentHugePageSize);
+  mem.page_size = sysconf(_SC_PAGESIZE);
+  void* ptr = mmap(nullptr, mem.mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                   -1, 0);
+  PCHECK(ptr != MAP_FAILED);
+  if (madvise(ptr, mem.mapped_size, MADV_HUGEPAGE) != 0) {
+    LOG(WARNING) << "transparent huge pages unavailable, errno " << errno;
+  }
+  mem.ptr = static_cast<char*>(ptr);
+#else
+  mem.mapped_size = size;
+  mem.page_size = size;
+  mem.ptr = static_cast<char*>(calloc(1, size));
+  CHECK_NOTNULL(mem.ptr);
+#endif  // __linux__
+  return mem;
+}
+
+void MunmapHostMem(const MappedHostMem& mem) {
+#ifdef __linux__
+  PCHECK(munmap(mem.ptr, mem.mapped_size) == 0);
+#else
+  free(mem.ptr);
+#endif  // __linux__
+}
+
+DTlbMissCounter::DTlbMissCounter() : fd_(-1) {
+#ifdef __linux__
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  fd_ = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  if (fd_ < 0) { LOG(INFO) << "dtlb miss counter unavailable, errno " << errno; }
+#endif  // __linux__
+}
+
+DTlbMissCounter::~DTlbMissCounter() {
+#ifdef __linux__
+  if (fd_ >= 0) { close(fd_); }
+#endif  // __linux__
+}
+
+int64_t DTlbMissCounter::Read() const {
+#ifdef __linux__
+  uint64_t cnt = 0;
+  if (fd_ >= 0 && read(fd_, &cnt, sizeof(cnt)) == sizeof(cnt)) { return cnt; }
+#endif  // __linux__
+  return -1;
+}
+
+}  // namespace oneflow
@@ -0,0 +1,54 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_MEMORY_HUGE_PAGE_UTIL_H_
+#define ONEFLOW_CORE_MEMORY_HUGE_PAGE_UTIL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+struct MappedHostMem {
+  char* ptr;
+  size_t mapped_size;
+  // granularity the pages are faulted in
+  size_t page_size;
+};
+
+// anonymous memory mapped with huge pages, the kernel zero-fills every page on its first touch.
+// huge_page_kbyte 0 asks for transparent huge pages, other sizes are mapped from the hugetlb pool
+// and fall back to transparent huge pages when the pool is short. Sizes that are not a power of
+// two are not valid huge page sizes and are mapped like 0 after a warning
+MappedHostMem MmapHostMem(size_t size, int64_t huge_page_kbyte);
+void MunmapHostMem(const MappedHostMem& mem);
+
+// data TLB load misses in user space of the constructing thread and the threads it creates later,
+// counts of a thread are only added once the thread exits
+class DTlbMissCounter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(DTlbMissCounter);
+  DTlbMissCounter();
+  ~DTlbMissCounter();
+
+  // -1 if the counter is not supported or not permitted
+  int64_t Read() const;
+
+ private:
+  int fd_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_MEMORY_HUGE_PAGE_UTIL_H_
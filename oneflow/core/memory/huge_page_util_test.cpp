@@ -0,0 +1,59 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/memory/huge_page_util.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace {
+
+void TestMmapHostMem(int64_t huge_page_kbyte) {
+  const size_t size = 5 * 1024 * 1024 + 3;
+  const MappedHostMem mem = MmapHostMem(size, huge_page_kbyte);
+  ASSERT_GE(mem.mapped_size, size);
+  ASSERT_EQ(mem.mapped_size % mem.page_size, 0);
+  for (size_t i = 0; i < size; i += 4096) { ASSERT_EQ(mem.ptr[i], 0); }
+  ASSERT_EQ(mem.ptr[size - 1], 0);
+  memset(mem.ptr, 1, size);
+  MunmapHostMem(mem);
+}
+
+}  // namespace
+
+TEST(HugePageUtil, transparent_huge_page) { TestMmapHostMem(0); }
+
+TEST(HugePageUtil, hugetlb_page_or_fallback) { TestMmapHostMem(2048); }
+
+TEST(HugePageUtil, invalid_huge_page_size_fallback) { TestMmapHostMem(3000); }
+
+TEST(HugePageUtil, dtlb_miss_counter) {
+  DTlbMissCounter counter;
+  if (counter.Read() < 0) {
+    LOG(WARNING) << "dtlb miss counter unavailable, skipped";
+    return;
+  }
+  const int64_t cnt_before = counter.Read();
+  // one load per page of a buffer larger than what the dtlb covers
+  std::vector<char> buf(256 * 1024 * 1024, 1);
+  int64_t sum = 0;
+  FOR_RANGE(int32_t, pass, 0, 4) {
+    for (size_t i = 0; i < buf.size(); i += 4096) { sum += buf[i]; }
+  }
+  ASSERT_EQ(sum, static_cast<int64_t>(4 * buf.size() / 4096));
+  ASSERT_GT(counter.Read(), cnt_before);
+}
+
+}  // namespace oneflow
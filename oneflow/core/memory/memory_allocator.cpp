@@ -21,9 +21,41 @@ limitations under the License.
 #include "oneflow/core/register/blob.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/record/record.pb.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/memory/huge_page_util.h"
 
 namespace oneflow {
 
+namespace {
+
+// host memory smaller than it is initialized by the caller thread
+const size_t kParallelInitMinSize = 64 * 1024 * 1024;
+
+// Handler is called on [begin, end) parts of [0, size), the parts are multiples of align
+void ParallelForEachPart(size_t size, size_t align,
+                         const std::function<void(size_t, size_t)>& Handler) {
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  if (thread_pool == nullptr || size < kParallelInitMinSize) {
+    Handler(0, size);
+    return;
+  }
+  const int64_t align_num = RoundUp(size, align) / align;
+  const int64_t part_num = std::min<int64_t>(thread_pool->thread_num(), align_num);
+  BalancedSplitter bs(align_num, part_num);
+  BlockingCounter bc(part_num);
+  FOR_RANGE(int64_t, i, 0, part_num) {
+    thread_pool->AddWork([&bc, &bs, &Handler, size, align, i] {
+      Handler(bs.At(i).begin() * align, std::min<size_t>(bs.At(i).end() * align, size));
+      bc.Decrease();
+    });
+  }
+  bc.WaitUntilCntEqualZero();
+}
+
+}  // namespace
+
 void* MemoryAllocatorImpl::Allocate(MemoryCase mem_case, size_t size) {
   void* ptr = nullptr;
   if (mem_case.has_host_mem()) {
@@ -108,6 +140,32 @@ char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size) {
   return dptr;
 }
 
+char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size,
+                                const std::function<void(char*)>& PlaceMem) {
+  if (!mem_case.has_host_mem()) { return Allocate(mem_case, size); }
+  const int64_t huge_page_kbyte =
+      Global<ResourceDesc, ForSession>::Get()->host_regst_huge_page_kbyte();
+  if (huge_page_kbyte >= 0 && !mem_case.host_mem().has_cuda_pinned_mem()) {
+    // pages are zero-filled by the kernel on the first touch, they are faulted in by the thread
+    // pool after being placed
+    const MappedHostMem mem = MmapHostMem(size, huge_page_kbyte);
+    PlaceMem(mem.ptr);
+    ParallelForEachPart(size, mem.page_size, [&mem](size_t begin, size_t end) {
+      for (size_t offset = begin; offset < end; offset += mem.page_size) { mem.ptr[offset] = 0; }
+    });
+    deleters_.push_front([mem] { MunmapHostMem(mem); });
+    return mem.ptr;
+  }
+  const int memset_val = 0;
+  char* dptr = static_cast<char*>(MemoryAllocatorImpl::Allocate(mem_case, size));
+  PlaceMem(dptr);
+  ParallelForEachPart(size, kCudaAlignSize, [dptr, memset_val](size_t begin, size_t end) {
+    memset(dptr + begin, memset_val, end - begin);
+  });
+  deleters_.push_front(std::bind(&MemoryAllocator::Deallocate, this, dptr, mem_case));
+  return dptr;
+}
+
 void MemoryAllocator::Deallocate(char* dptr, MemoryCase mem_case) {
   MemoryAllocatorImpl::Deallocate(static_cast<void*>(dptr), mem_case);
 }
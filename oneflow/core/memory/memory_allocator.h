@@ -28,6 +28,11 @@ class MemoryAllocator final {
   ~MemoryAllocator();
 
   char* Allocate(MemoryCase mem_case, std::size_t size);
+  // for host memory, PlaceMem runs before the first touch, e.g. to bind pages to numa nodes,
+  // and the memory is then zeroed by the thread pool, or mapped with huge pages and faulted in by
+  // the thread pool if resource.host_regst_huge_page_kbyte is set
+  char* Allocate(MemoryCase mem_case, std::size_t size,
+                 const std::function<void(char*)>& PlaceMem);
   template<typename T>
   T* PlacementNew(T* mem_ptr);
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/core/persistence/hadoop/hadoop_file_system.h"
 #include "oneflow/core/persistence/posix/posix_file_system.h"
+#include "oneflow/core/persistence/posix/io_uring_file_system.h"
 #include "oneflow/core/job/job_set.pb.h"
 
 namespace oneflow {
@@ -115,6 +116,18 @@ fs::FileSystem* LocalFS() {
   return fs;
 }
 
+fs::FileSystem* IoUringFS(bool enable_direct_io) {
+#if defined(OF_PLATFORM_POSIX) && defined(WITH_IO_URING)
+  if (fs::IoUringFileSystem::IsAvailable()) {
+    static fs::FileSystem* fs = new fs::IoUringFileSystem(false);
+    static fs::FileSystem* direct_io_fs = new fs::IoUringFileSystem(true);
+    return enable_direct_io ? direct_io_fs : fs;
+  }
+#endif
+  LOG_FIRST_N(WARNING, 1) << "io_uring is unavailable, fall back to posix io for local files";
+  return LocalFS();
+}
+
 fs::FileSystem* NetworkFS() { return LocalFS(); }
 
 fs::FileSystem* HadoopFS(const HdfsConf& hdfs_conf) {
@@ -124,6 +137,8 @@ fs::FileSystem* HadoopFS(const HdfsConf& hdfs_conf) {
 
 fs::FileSystem* GetFS(const FileSystemConf& file_system_conf) {
   if (file_system_conf.has_localfs_conf()) {
+    const LocalFsConf& localfs_conf = file_system_conf.localfs_conf();
+    if (localfs_conf.enable_io_uring()) { return IoUringFS(localfs_conf.enable_direct_io()); }
     return LocalFS();
   } else if (file_system_conf.has_networkfs_conf()) {
     return NetworkFS();
@@ -17,6 +17,8 @@ limitations under the License.
 #include "oneflow/core/common/process_state.h"
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/persistence/posix/posix_file_system.h"
+#include "oneflow/core/persistence/posix/io_uring_file_system.h"
+#include <random>
 
 namespace oneflow {
 
@@ -86,9 +88,46 @@ void TestDirOperation(FileSystem* file_system) {
   ASSERT_TRUE(!file_system->IsDirectory(test_root_path));
 }
 
+// larger than the buffers of io_uring files, read both sequentially and at random
+void TestLargeFileOperation(FileSystem* file_system) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  std::string file_name = JoinPath(current_dir, "/tmp_test_large_file_asdfasdf");
+  std::mt19937 gen(0);
+  std::string content(9 * 1024 * 1024 + 123, '\0');
+  for (char& c : content) { c = static_cast<char>(gen()); }
+  std::unique_ptr<WritableFile> writable_file;
+  file_system->NewWritableFile(file_name, &writable_file);
+  for (size_t pos = 0; pos < content.size();) {
+    size_t n = std::min<size_t>(content.size() - pos, gen() % (512 * 1024));
+    writable_file->Append(content.data() + pos, n);
+    pos += n;
+  }
+  writable_file->Close();
+  ASSERT_EQ(file_system->GetFileSize(file_name), content.size());
+  std::unique_ptr<RandomAccessFile> random_access_file;
+  file_system->NewRandomAccessFile(file_name, &random_access_file);
+  std::string read_content(content.size(), '\0');
+  for (size_t pos = 0; pos < content.size();) {
+    size_t n = std::min<size_t>(content.size() - pos, 1 + gen() % (64 * 1024));
+    random_access_file->Read(pos, n, &read_content[pos]);
+    pos += n;
+  }
+  ASSERT_EQ(content, read_content);
+  for (int i = 0; i < 100; ++i) {
+    size_t offset = gen() % content.size();
+    size_t n = std::min<size_t>(content.size() - offset, gen() % (2 * 1024 * 1024));
+    std::string part(n, '\0');
+    random_access_file->Read(offset, n, &part[0]);
+    ASSERT_EQ(content.substr(offset, n), part);
+  }
+  file_system->DelFile(file_name);
+}
+
 void TestFileSystem(FileSystem* file_system) {
   TestFileOperation(file_system);
   TestDirOperation(file_system);
+  TestLargeFileOperation(file_system);
 }
 
 }  // namespace fs
@@ -100,4 +139,14 @@ TEST(file_system, write_and_read) {
 #endif
 }
 
+TEST(file_system, io_uring_write_and_read) {
+#if defined(OF_PLATFORM_POSIX) && defined(WITH_IO_URING)
+  if (!fs::IoUringFileSystem::IsAvailable()) { return; }
+  for (bool enable_direct_io : {false, true}) {
+    fs::IoUringFileSystem file_system(enable_direct_io);
+    fs::TestFileSystem(&file_system);
+  }
+#endif
+}
+
 }  // namespace oneflow
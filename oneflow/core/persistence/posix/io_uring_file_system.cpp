@@ -0,0 +1,529 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/posix/io_uring_file_system.h"
+
+#if defined(OF_PLATFORM_POSIX) && defined(WITH_IO_URING)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <mutex>
+
+namespace oneflow {
+
+namespace fs {
+
+namespace {
+
+constexpr size_t kReadChunkSize = 512 * 1024;
+constexpr int64_t kReadAheadChunkNum = 8;
+constexpr size_t kWriteBufferSize = 1024 * 1024;
+constexpr int64_t kWriteBufferNum = 4;
+// offsets, sizes and buffers of O_DIRECT reads are multiples of the logical block size
+constexpr size_t kDirectIoAlignment = 4096;
+
+// A minimal io_uring on the raw syscalls, used by one thread at a time. Requests queued by
+// PrepareRead and PrepareWrite go to the kernel together on Submit and complete in any order.
+class IoUring final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(IoUring);
+  ~IoUring();
+
+  // Returns nullptr when the kernel does not support io_uring or does not allow it
+  static std::unique_ptr<IoUring> New(uint32_t entry_num);
+
+  // Registers buffers so that requests on them skip mapping the pages. Returns false when the
+  // kernel refuses, e.g. under a low RLIMIT_MEMLOCK.
+  bool RegisterBuffers(const std::vector<struct iovec>& iovecs);
+
+  // Reads or writes iov, which must live until the request completes. buf_index is the index of
+  // the registered buffer holding iov, or -1.
+  void PrepareRead(int fd, const struct iovec* iov, int64_t buf_index, uint64_t offset,
+                   uint64_t user_data) {
+    Prepare(IORING_OP_READ_FIXED, IORING_OP_READV, fd, iov, buf_index, offset, user_data);
+  }
+  void PrepareWrite(int fd, const struct iovec* iov, int64_t buf_index, uint64_t offset,
+                    uint64_t user_data) {
+    Prepare(IORING_OP_WRITE_FIXED, IORING_OP_WRITEV, fd, iov, buf_index, offset, user_data);
+  }
+  void Submit();
+  // Waits for a request to complete. res is the number of bytes transferred or -errno.
+  void WaitCompletion(uint64_t* user_data, int32_t* res);
+
+ private:
+  IoUring() = default;
+  void Prepare(uint8_t fixed_opcode, uint8_t vec_opcode, int fd, const struct iovec* iov,
+               int64_t buf_index, uint64_t offset, uint64_t user_data);
+
+  int ring_fd_ = -1;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  uint32_t sq_entry_num_ = 0;
+
+  uint32_t* sq_head_ = nullptr;
+  uint32_t* sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t* sq_array_ = nullptr;
+  uint32_t* cq_head_ = nullptr;
+  uint32_t* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  // the tail of the queued requests, published to the kernel on Submit
+  uint32_t local_sq_tail_ = 0;
+  uint32_t to_submit_num_ = 0;
+};
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) { munmap(sqes_, sq_entry_num_ * sizeof(struct io_uring_sqe)); }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) { munmap(cq_ring_, cq_ring_size_); }
+  if (sq_ring_ != nullptr) { munmap(sq_ring_, sq_ring_size_); }
+  if (ring_fd_ >= 0) { close(ring_fd_); }
+}
+
+std::unique_ptr<IoUring> IoUring::New(uint32_t entry_num) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  const int ring_fd = syscall(__NR_io_uring_setup, entry_num, &params);
+  if (ring_fd < 0) { return nullptr; }
+  std::unique_ptr<IoUring> ring(new IoUring());
+  ring->ring_fd_ = ring_fd;
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool is_single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+  is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+  if (is_single_mmap) {
+    ring->sq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+    ring->cq_ring_size_ = ring->sq_ring_size_;
+  }
+  auto MapRing = [ring_fd](size_t size, off_t offset) -> void* {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                     offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  };
+  ring->sq_ring_ = MapRing(ring->sq_ring_size_, IORING_OFF_SQ_RING);
+  if (ring->sq_ring_ == nullptr) { return nullptr; }
+  ring->cq_ring_ =
+      is_single_mmap ? ring->sq_ring_ : MapRing(ring->cq_ring_size_, IORING_OFF_CQ_RING);
+  if (ring->cq_ring_ == nullptr) { return nullptr; }
+  ring->sq_entry_num_ = params.sq_entries;
+  ring->sqes_ = static_cast<struct io_uring_sqe*>(
+      MapRing(params.sq_entries * sizeof(struct io_uring_sqe), IORING_OFF_SQES));
+  if (ring->sqes_ == nullptr) { return nullptr; }
+
+  char* sq_ring = static_cast<char*>(ring->sq_ring_);
+  ring->sq_head_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.head);
+  ring->sq_tail_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.tail);
+  ring->sq_mask_ = *reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.ring_mask);
+  ring->sq_array_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.array);
+  char* cq_ring = static_cast<char*>(ring->cq_ring_);
+  ring->cq_head_ = reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.head);
+  ring->cq_tail_ = reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.tail);
+  ring->cq_mask_ = *reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.ring_mask);
+  ring->cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+  ring->local_sq_tail_ = *ring->sq_tail_;
+  return ring;
+}
+
+bool IoUring::RegisterBuffers(const std::vector<struct iovec>& iovecs) {
+  return syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, iovecs.data(),
+                 iovecs.size())
+         == 0;
+}
+
+void IoUring::Prepare(uint8_t fixed_opcode, uint8_t vec_opcode, int fd, const struct iovec* iov,
+                      int64_t buf_index, uint64_t offset, uint64_t user_data) {
+  CHECK_LT(local_sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE), sq_entry_num_)
+      << "io_uring submission queue is full";
+  const uint32_t index = local_sq_tail_ & sq_mask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  if (buf_index >= 0) {
+    sqe->opcode = fixed_opcode;
+    sqe->addr = reinterpret_cast<uint64_t>(iov->iov_base);
+    sqe->len = iov->iov_len;
+    sqe->buf_index = buf_index;
+  } else {
+    sqe->opcode = vec_opcode;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = 1;
+  }
+  sq_array_[index] = index;
+  local_sq_tail_ += 1;
+  to_submit_num_ += 1;
+}
+
+void IoUring::Submit() {
+  if (to_submit_num_ == 0) { return; }
+  __atomic_store_n(sq_tail_, local_sq_tail_, __ATOMIC_RELEASE);
+  while (to_submit_num_ > 0) {
+    const int ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit_num_, 0, 0, nullptr, 0);
+    if (ret >= 0) {
+      to_submit_num_ -= ret;
+    } else if (errno == EINTR || errno == EAGAIN) {
+      // Retry
+    } else {
+      PLOG(FATAL) << "Fail to submit io_uring requests";
+    }
+  }
+}
+
+void IoUring::WaitCompletion(uint64_t* user_data, int32_t* res) {
+  Submit();
+  while (true) {
+    const uint32_t head = *cq_head_;
+    if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      *user_data = cqe.user_data;
+      *res = cqe.res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      return;
+    }
+    const int ret =
+        syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (ret < 0 && errno != EINTR) { PLOG(FATAL) << "Fail to wait for io_uring completions"; }
+  }
+}
+
+// page aligned, as O_DIRECT and buffer registration want
+char* NewIoBuffers(size_t size) {
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  PCHECK(ptr != MAP_FAILED) << "Fail to allocate io buffers";
+  return static_cast<char*>(ptr);
+}
+
+std::vector<struct iovec> GenIovecs(char* bufs, size_t buf_size, int64_t buf_num) {
+  std::vector<struct iovec> iovecs(buf_num);
+  FOR_RANGE(int64_t, i, 0, buf_num) {
+    iovecs.at(i).iov_base = bufs + i * buf_size;
+    iovecs.at(i).iov_len = buf_size;
+  }
+  return iovecs;
+}
+
+bool IsRetryable(int32_t res) { return res == -EINTR || res == -EAGAIN; }
+
+class IoUringRandomAccessFile final : public RandomAccessFile {
+ public:
+  IoUringRandomAccessFile(const std::string& fname, int fd, bool is_direct, uint64_t file_size,
+                          std::unique_ptr<IoUring>&& ring)
+      : fname_(fname),
+        fd_(fd),
+        is_direct_(is_direct),
+        file_size_(file_size),
+        ring_(std::move(ring)),
+        slots_(kReadAheadChunkNum),
+        last_read_end_(0) {
+    bufs_ = NewIoBuffers(kReadChunkSize * kReadAheadChunkNum);
+    is_buffer_registered_ =
+        ring_->RegisterBuffers(GenIovecs(bufs_, kReadChunkSize, kReadAheadChunkNum));
+  }
+  ~IoUringRandomAccessFile() override {
+    for (ChunkSlot& slot : slots_) {
+      while (slot.is_in_flight) { HandleCompletion(); }
+    }
+    ring_.reset();
+    munmap(bufs_, kReadChunkSize * kReadAheadChunkNum);
+    close(fd_);
+  }
+
+  void Read(uint64_t offset, size_t n, char* result) const override {
+    if (n == 0) { return; }
+    if (offset + n > file_size_) { LOG(FATAL) << "Read EOF"; }
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool is_sequential = offset == last_read_end_;
+    const int64_t last_chunk_id = (file_size_ - 1) / kReadChunkSize;
+    while (n > 0) {
+      const int64_t chunk_id = offset / kReadChunkSize;
+      // the chunks of the rest of this read, and the read-ahead window after them
+      const int64_t window_last_chunk_id =
+          std::min(chunk_id + kReadAheadChunkNum - 1,
+                   is_sequential ? last_chunk_id
+                                 : static_cast<int64_t>((offset + n - 1) / kReadChunkSize));
+      FOR_RANGE(int64_t, i, chunk_id, window_last_chunk_id + 1) { ScheduleChunk(i); }
+      ring_->Submit();
+      const int64_t slot_index = chunk_id % kReadAheadChunkNum;
+      ChunkSlot& slot = slots_.at(slot_index);
+      while (slot.is_in_flight) { HandleCompletion(); }
+      const size_t offset_in_chunk = offset - chunk_id * kReadChunkSize;
+      const size_t copy_size = std::min(n, slot.size - offset_in_chunk);
+      memcpy(result, bufs_ + slot_index * kReadChunkSize + offset_in_chunk, copy_size);
+      result += copy_size;
+      offset += copy_size;
+      n -= copy_size;
+    }
+    last_read_end_ = offset;
+  }
+
+ private:
+  // chunk chunk_id of the file lives in slot chunk_id % kReadAheadChunkNum
+  struct ChunkSlot {
+    int64_t chunk_id = -1;
+    bool is_in_flight = false;
+    // the chunk size, smaller for the last chunk, and the bytes read so far
+    size_t size = 0;
+    size_t done = 0;
+    // the part of the chunk the request in flight reads
+    struct iovec iov;
+  };
+
+  void ScheduleChunk(int64_t chunk_id) const {
+    const int64_t slot_index = chunk_id % kReadAheadChunkNum;
+    ChunkSlot& slot = slots_.at(slot_index);
+    if (slot.chunk_id == chunk_id) { return; }
+    while (slot.is_in_flight) { HandleCompletion(); }
+    slot.chunk_id = chunk_id;
+    slot.is_in_flight = true;
+    slot.size = std::min<uint64_t>(kReadChunkSize, file_size_ - chunk_id * kReadChunkSize);
+    slot.done = 0;
+    PrepareChunkRead(slot_index);
+  }
+
+  void PrepareChunkRead(int64_t slot_index) const {
+    ChunkSlot& slot = slots_.at(slot_index);
+    size_t size = slot.size - slot.done;
+    if (is_direct_) {
+      CHECK_EQ(slot.done % kDirectIoAlignment, 0);
+      size = RoundUp(size, kDirectIoAlignment);
+    }
+    slot.iov.iov_base = bufs_ + slot_index * kReadChunkSize + slot.done;
+    slot.iov.iov_len = size;
+    ring_->PrepareRead(fd_, &slot.iov, is_buffer_registered_ ? slot_index : -1,
+                       slot.chunk_id * kReadChunkSize + slot.done, slot_index);
+  }
+
+  void HandleCompletion() const {
+    uint64_t slot_index = 0;
+    int32_t res = 0;
+    ring_->WaitCompletion(&slot_index, &res);
+    ChunkSlot& slot = slots_.at(slot_index);
+    if (res < 0 && !IsRetryable(res)) {
+      LOG(FATAL) << "Fail to read file " << fname_ << ": " << strerror(-res);
+    }
+    if (res == 0) { LOG(FATAL) << "Read EOF"; }
+    if (res > 0) { slot.done += res; }
+    if (slot.done < slot.size) {
+      // a short read, resubmit the rest
+      PrepareChunkRead(slot_index);
+      ring_->Submit();
+    } else {
+      slot.is_in_flight = false;
+    }
+  }
+
+  std::string fname_;
+  int fd_;
+  bool is_direct_;
+  uint64_t file_size_;
+  mutable std::unique_ptr<IoUring> ring_;
+  char* bufs_;
+  bool is_buffer_registered_;
+  mutable std::mutex mutex_;
+  mutable std::vector<ChunkSlot> slots_;
+  mutable uint64_t last_read_end_;
+};
+
+class IoUringWritableFile final : public WritableFile {
+ public:
+  IoUringWritableFile(const std::string& fname, int fd, uint64_t file_offset,
+                      std::unique_ptr<IoUring>&& ring)
+      : fname_(fname),
+        fd_(fd),
+        file_offset_(file_offset),
+        ring_(std::move(ring)),
+        slots_(kWriteBufferNum),
+        cur_slot_index_(0),
+        cur_buf_size_(0) {
+    bufs_ = NewIoBuffers(kWriteBufferSize * kWriteBufferNum);
+    is_buffer_registered_ =
+        ring_->RegisterBuffers(GenIovecs(bufs_, kWriteBufferSize, kWriteBufferNum));
+  }
+  ~IoUringWritableFile() override {
+    if (fd_ >= 0) { Close(); }
+    ring_.reset();
+    munmap(bufs_, kWriteBufferSize * kWriteBufferNum);
+  }
+
+  void Append(const char* data, size_t n) override {
+    while (n > 0) {
+      const size_t copy_size = std::min(n, kWriteBufferSize - cur_buf_size_);
+      memcpy(bufs_ + cur_slot_index_ * kWriteBufferSize + cur_buf_size_, data, copy_size);
+      cur_buf_size_ += copy_size;
+      data += copy_size;
+      n -= copy_size;
+      if (cur_buf_size_ == kWriteBufferSize) { SubmitCurBuffer(); }
+    }
+  }
+
+  void Close() override {
+    Flush();
+    PCHECK(close(fd_) == 0) << "Fail to close file " << fname_;
+    fd_ = -1;
+  }
+
+  void Flush() override {
+    SubmitCurBuffer();
+    for (BufferSlot& slot : slots_) {
+      while (slot.is_in_flight) { HandleCompletion(); }
+    }
+  }
+
+ private:
+  struct BufferSlot {
+    bool is_in_flight = false;
+    uint64_t file_offset = 0;
+    // the bytes of the buffer and the bytes written so far
+    size_t size = 0;
+    size_t done = 0;
+    struct iovec iov;
+  };
+
+  void SubmitCurBuffer() {
+    if (cur_buf_size_ == 0) { return; }
+    BufferSlot& slot = slots_.at(cur_slot_index_);
+    slot.is_in_flight = true;
+    slot.file_offset = file_offset_;
+    slot.size = cur_buf_size_;
+    slot.done = 0;
+    PrepareBufferWrite(cur_slot_index_);
+    ring_->Submit();
+    file_offset_ += cur_buf_size_;
+    cur_slot_index_ = (cur_slot_index_ + 1) % kWriteBufferNum;
+    cur_buf_size_ = 0;
+    while (slots_.at(cur_slot_index_).is_in_flight) { HandleCompletion(); }
+  }
+
+  void PrepareBufferWrite(int64_t slot_index) {
+    BufferSlot& slot = slots_.at(slot_index);
+    slot.iov.iov_base = bufs_ + slot_index * kWriteBufferSize + slot.done;
+    slot.iov.iov_len = slot.size - slot.done;
+    ring_->PrepareWrite(fd_, &slot.iov, is_buffer_registered_ ? slot_index : -1,
+                        slot.file_offset + slot.done, slot_index);
+  }
+
+  void HandleCompletion() {
+    uint64_t slot_index = 0;
+    int32_t res = 0;
+    ring_->WaitCompletion(&slot_index, &res);
+    BufferSlot& slot = slots_.at(slot_index);
+    if (res < 0 && !IsRetryable(res)) {
+      LOG(FATAL) << "Fail to append to file " << fname_ << ": " << strerror(-res);
+    }
+    if (res > 0) { slot.done += res; }
+    if (slot.done < slot.size) {
+      // a short write, resubmit the rest
+      PrepareBufferWrite(slot_index);
+      ring_->Submit();
+    } else {
+      slot.is_in_flight = false;
+    }
+  }
+
+  std::string fname_;
+  int fd_;
+  uint64_t file_offset_;
+  std::unique_ptr<IoUring> ring_;
+  char* bufs_;
+  bool is_buffer_registered_;
+  std::vector<BufferSlot> slots_;
+  int64_t cur_slot_index_;
+  size_t cur_buf_size_;
+};
+
+}  // namespace
+
+bool IoUringFileSystem::IsAvailable() {
+  static const bool is_available = static_cast<bool>(IoUring::New(1));
+  return is_available;
+}
+
+void IoUringFileSystem::NewRandomAccessFile(const std::string& fname,
+                                            std::unique_ptr<RandomAccessFile>* result) {
+  std::unique_ptr<IoUring> ring = IoUring::New(kReadAheadChunkNum);
+  if (!ring) {
+    posix_fs_.NewRandomAccessFile(fname, result);
+    return;
+  }
+  std::string translated_fname = TranslateName(fname);
+  int fd = -1;
+  bool is_direct = false;
+  if (enable_direct_io_) {
+    fd = open(translated_fname.c_str(), O_RDONLY | O_DIRECT);
+    // e.g. tmpfs does not support O_DIRECT
+    is_direct = fd >= 0;
+  }
+  if (fd < 0) { fd = open(translated_fname.c_str(), O_RDONLY); }
+  PCHECK(fd >= 0) << "Fail to open file " << fname;
+  struct stat sbuf;
+  PCHECK(fstat(fd, &sbuf) == 0) << "Fail to load statistics of " << fname;
+  result->reset(new IoUringRandomAccessFile(fname, fd, is_direct, sbuf.st_size, std::move(ring)));
+  CHECK_NOTNULL(result->get());
+}
+
+void IoUringFileSystem::NewWritableFile(const std::string& fname,
+                                        std::unique_ptr<WritableFile>* result) {
+  OpenWritableFile(fname, false, result);
+}
+
+void IoUringFileSystem::NewAppendableFile(const std::string& fname,
+                                          std::unique_ptr<WritableFile>* result) {
+  OpenWritableFile(fname, true, result);
+}
+
+void IoUringFileSystem::OpenWritableFile(const std::string& fname, bool is_append,
+                                         std::unique_ptr<WritableFile>* result) {
+  std::unique_ptr<IoUring> ring = IoUring::New(kWriteBufferNum);
+  if (!ring) {
+    if (is_append) {
+      posix_fs_.NewAppendableFile(fname, result);
+    } else {
+      posix_fs_.NewWritableFile(fname, result);
+    }
+    return;
+  }
+  std::string translated_fname = TranslateName(fname);
+  const int flags = O_WRONLY | O_CREAT | (is_append ? 0 : O_TRUNC);
+  const int fd = open(translated_fname.c_str(), flags, 0666);
+  PCHECK(fd >= 0) << "Fail to open file " << fname;
+  uint64_t file_offset = 0;
+  if (is_append) {
+    struct stat sbuf;
+    PCHECK(fstat(fd, &sbuf) == 0) << "Fail to load statistics of " << fname;
+    file_offset = sbuf.st_size;
+  }
+  result->reset(new IoUringWritableFile(translated_fname, fd, file_offset, std::move(ring)));
+  CHECK_NOTNULL(result->get());
+}
+
+}  // namespace fs
+
+}  // namespace oneflow
+
+#endif  // defined(OF_PLATFORM_POSIX) && defined(WITH_IO_URING)
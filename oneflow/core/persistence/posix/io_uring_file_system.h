@@ -0,0 +1,90 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_POSIX_IO_URING_FILE_SYSTEM_H_
+#define ONEFLOW_CORE_PERSISTENCE_POSIX_IO_URING_FILE_SYSTEM_H_
+
+#include "oneflow/core/persistence/posix/posix_file_system.h"
+
+#if defined(OF_PLATFORM_POSIX) && defined(WITH_IO_URING)
+
+namespace oneflow {
+
+namespace fs {
+
+// A local file system whose file reads and writes go through an io_uring per file, so that one
+// thread keeps several requests in flight.
+//
+// A RandomAccessFile reads whole chunks into buffers registered with its ring. When a read starts
+// where the last one ended it also submits the chunks after it, up to a read-ahead window, in the
+// same batch, which serves the sequential reads of PersistentInStream. With enable_direct_io the
+// chunks are read with O_DIRECT, bypassing the page cache, on file systems that support it.
+//
+// A WritableFile copies appends into a few registered buffers and submits each full buffer as it
+// goes, so writing one buffer overlaps filling the next. Flush waits for all the writes.
+//
+// Everything else, and any file whose ring cannot be set up, is served by PosixFileSystem.
+class IoUringFileSystem final : public FileSystem {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(IoUringFileSystem);
+  explicit IoUringFileSystem(bool enable_direct_io) : enable_direct_io_(enable_direct_io) {}
+  ~IoUringFileSystem() = default;
+
+  // Whether the kernel lets this process set up an io_uring, which old kernels and seccomp
+  // profiles of containers do not
+  static bool IsAvailable();
+
+  void NewRandomAccessFile(const std::string& fname,
+                           std::unique_ptr<RandomAccessFile>* result) override;
+
+  void NewWritableFile(const std::string& fname, std::unique_ptr<WritableFile>* result) override;
+
+  void NewAppendableFile(const std::string& fname, std::unique_ptr<WritableFile>* result) override;
+
+  bool FileExists(const std::string& fname) override { return posix_fs_.FileExists(fname); }
+
+  std::vector<std::string> ListDir(const std::string& dir) override {
+    return posix_fs_.ListDir(dir);
+  }
+
+  void DelFile(const std::string& fname) override { posix_fs_.DelFile(fname); }
+
+  void CreateDir(const std::string& dirname) override { posix_fs_.CreateDir(dirname); }
+
+  void DeleteDir(const std::string& dirname) override { posix_fs_.DeleteDir(dirname); }
+
+  uint64_t GetFileSize(const std::string& fname) override { return posix_fs_.GetFileSize(fname); }
+
+  void RenameFile(const std::string& old_name, const std::string& new_name) override {
+    posix_fs_.RenameFile(old_name, new_name);
+  }
+
+  bool IsDirectory(const std::string& fname) override { return posix_fs_.IsDirectory(fname); }
+
+ private:
+  void OpenWritableFile(const std::string& fname, bool is_append,
+                        std::unique_ptr<WritableFile>* result);
+
+  bool enable_direct_io_;
+  PosixFileSystem posix_fs_;
+};
+
+}  // namespace fs
+
+}  // namespace oneflow
+
+#endif  // defined(OF_PLATFORM_POSIX) && defined(WITH_IO_URING)
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_POSIX_IO_URING_FILE_SYSTEM_H_
@@ -42,8 +42,10 @@ class RangeGuard final {
   std::shared_ptr<RangeGuardCtx> ctx_;
 };
 
-#ifdef OF_ENABLE_PROFILER
+// names the thread in the timeline too, so it is defined without OF_ENABLE_PROFILER
 #define OF_PROFILER_NAME_THIS_HOST_THREAD(name) ::oneflow::profiler::NameThisHostThread(name)
+
+#ifdef OF_ENABLE_PROFILER
 #define OF_PROFILER_ONLY_CODE(...) __VA_ARGS__
 #define OF_PROFILER_RANGE_PUSH(name) ::oneflow::profiler::RangePush(name)
 #define OF_PROFILER_RANGE_POP() ::oneflow::profiler::RangePop()
@@ -54,7 +56,6 @@ class RangeGuard final {
 #define OF_PROFILER_RANGE_PUSH(name)
 #define OF_PROFILER_RANGE_POP()
 #define OF_PROFILER_RANGE_GUARD(name)
-#define OF_PROFILER_NAME_THIS_HOST_THREAD(name)
 #endif
 
 }  // namespace profiler
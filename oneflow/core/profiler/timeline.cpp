@@ -0,0 +1,436 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/profiler/timeline.h"
+#include "oneflow/core/profiler/profiler.h"
+#include "oneflow/core/persistence/persistent_out_stream.h"
+#include "oneflow/core/persistence/file_system.h"
+#include <unistd.h>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace timeline_internal {
+
+std::atomic<bool> enabled(false);
+
+}  // namespace timeline_internal
+
+namespace {
+
+constexpr int64_t kDefaultTimelineBufferSize = 1 << 16;
+
+const char* CategoryName(TimelineEventCategory category) {
+  switch (category) {
+    case kTimelineKernel: return "kernel";
+    case kTimelineActorAct: return "actor";
+    case kTimelineThreadIdle: return "idle";
+    case kTimelineCommNetRead: return "comm_net";
+    case kTimelineActorWait: return "wait";
+    case kTimelineActorReady: return "ready";
+    default: UNIMPLEMENTED();
+  }
+  return "";
+}
+
+int64_t GetTimelineBufferSize() {
+  const char* env_p = std::getenv("ONEFLOW_TIMELINE_PROFILER_BUFFER_SIZE");
+  if (env_p == nullptr) { return kDefaultTimelineBufferSize; }
+  const int64_t buffer_size = std::stoll(env_p);
+  CHECK_GT(buffer_size, 0);
+  return buffer_size;
+}
+
+struct TimelineEvent {
+  int64_t begin_ns;
+  int64_t end_ns;
+  int32_t name_id;
+};
+
+struct TimelineStat {
+  int64_t count = 0;
+  int64_t total_ns = 0;
+  int64_t min_ns = std::numeric_limits<int64_t>::max();
+  int64_t max_ns = 0;
+};
+
+struct ThreadTimeline {
+  std::mutex mutex;
+  int64_t tid = 0;
+  std::string name;
+  // a ring buffer of the latest events, allocated by the first event of this thread
+  std::vector<TimelineEvent> events;
+  int64_t num_events = 0;
+  std::vector<TimelineStat> name_id2stat;
+};
+
+struct RetiredTimelineEvent {
+  int64_t tid;
+  TimelineEvent event;
+};
+
+struct RetiredThread {
+  std::string name;
+  bool has_idle_event = false;
+  int64_t idle_ns = 0;
+};
+
+// The timeline of a thread is freed when the thread exits. Its events are handed back to a ring
+// buffer shared by the exited threads and its statistics are added to theirs, so that they are
+// still dumped while the buffers of short-lived threads do not pile up.
+class TimelineRegistry final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TimelineRegistry);
+  TimelineRegistry()
+      : buffer_size_(GetTimelineBufferSize()),
+        next_tid_(0),
+        num_retired_events_(0),
+        begin_ns_(0),
+        end_ns_(0) {}
+  ~TimelineRegistry() = default;
+
+  static TimelineRegistry* Get() {
+    // never destructed, threads may record after static destruction has begun
+    static TimelineRegistry* registry = new TimelineRegistry();
+    return registry;
+  }
+
+  // nullptr once the timeline of this thread is retired, i.e. in the thread_local destructors
+  // that run after it
+  ThreadTimeline* ThisThreadTimeline() {
+    thread_local ThreadTimeline* timeline = nullptr;
+    thread_local bool is_retired = false;
+    if (timeline == nullptr && !is_retired) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        timelines_.emplace_back(new ThreadTimeline());
+        timeline = timelines_.back().get();
+        timeline->tid = next_tid_++;
+        timeline->name = "thread " + std::to_string(timeline->tid);
+      }
+      thread_local ThreadTimelineOwner owner(&timeline, &is_retired);
+    }
+    return timeline;
+  }
+
+  int32_t NameId(TimelineEventCategory category, const std::string& name) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = category_and_name2id_.find(std::make_pair(category, name));
+    if (it != category_and_name2id_.end()) { return it->second; }
+    const int32_t name_id = id2category_and_name_.size();
+    id2category_and_name_.emplace_back(category, name);
+    category_and_name2id_.emplace(id2category_and_name_.back(), name_id);
+    return name_id;
+  }
+
+  void Record(int32_t name_id, int64_t begin_ns, int64_t end_ns, bool is_traced) {
+    ThreadTimeline* timeline = ThisThreadTimeline();
+    if (timeline == nullptr) { return; }
+    std::unique_lock<std::mutex> lock(timeline->mutex);
+    if (is_traced) {
+      if (timeline->events.empty()) { timeline->events.resize(buffer_size_); }
+      TimelineEvent* event = &timeline->events[timeline->num_events % buffer_size_];
+      event->begin_ns = begin_ns;
+      event->end_ns = end_ns;
+      event->name_id = name_id;
+      timeline->num_events += 1;
+    }
+    if (name_id >= static_cast<int32_t>(timeline->name_id2stat.size())) {
+      timeline->name_id2stat.resize(name_id + 1);
+    }
+    TimelineStat* stat = &timeline->name_id2stat[name_id];
+    const int64_t duration_ns = end_ns - begin_ns;
+    stat->count += 1;
+    stat->total_ns += duration_ns;
+    stat->min_ns = std::min(stat->min_ns, duration_ns);
+    stat->max_ns = std::max(stat->max_ns, duration_ns);
+  }
+
+  void Start() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& timeline : timelines_) {
+      std::unique_lock<std::mutex> timeline_lock(timeline->mutex);
+      timeline->num_events = 0;
+      timeline->name_id2stat.clear();
+    }
+    num_retired_events_ = 0;
+    retired_name_id2stat_.clear();
+    tid2retired_thread_.clear();
+    begin_ns_ = TimelineNow();
+    end_ns_ = 0;
+  }
+
+  void Stop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    end_ns_ = TimelineNow();
+  }
+
+  void DumpChromeTrace(const std::string& path) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const int64_t pid = getpid();
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool is_first = true;
+    const auto Delimiter = [&]() -> const char* {
+      if (is_first) {
+        is_first = false;
+        return "\n";
+      }
+      return ",\n";
+    };
+    for (const auto& timeline : timelines_) {
+      std::unique_lock<std::mutex> timeline_lock(timeline->mutex);
+      if (timeline->num_events == 0) { continue; }
+      json << Delimiter() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"tid\":" << timeline->tid << ",\"args\":{\"name\":\""
+           << JsonEscaped(timeline->name) << "\"}}";
+      const int64_t buffer_size = timeline->events.size();
+      const int64_t first = std::max<int64_t>(timeline->num_events - buffer_size, 0);
+      for (int64_t i = first; i < timeline->num_events; ++i) {
+        const TimelineEvent& event = timeline->events[i % buffer_size];
+        const auto& category_and_name = id2category_and_name_.at(event.name_id);
+        json << Delimiter() << "{\"name\":\"" << JsonEscaped(category_and_name.second)
+             << "\",\"cat\":\"" << CategoryName(category_and_name.first)
+             << "\",\"ph\":\"X\",\"ts\":" << (event.begin_ns - begin_ns_) / 1000.0
+             << ",\"dur\":" << (event.end_ns - event.begin_ns) / 1000.0 << ",\"pid\":" << pid
+             << ",\"tid\":" << timeline->tid << "}";
+      }
+    }
+    for (const auto& pair : tid2retired_thread_) {
+      json << Delimiter() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"tid\":" << pair.first << ",\"args\":{\"name\":\""
+           << JsonEscaped(pair.second.name) << "\"}}";
+    }
+    const int64_t retired_buffer_size = retired_events_.size();
+    const int64_t first_retired =
+        std::max<int64_t>(num_retired_events_ - retired_buffer_size, 0);
+    for (int64_t i = first_retired; i < num_retired_events_; ++i) {
+      const RetiredTimelineEvent& retired = retired_events_[i % retired_buffer_size];
+      const auto& category_and_name = id2category_and_name_.at(retired.event.name_id);
+      json << Delimiter() << "{\"name\":\"" << JsonEscaped(category_and_name.second)
+           << "\",\"cat\":\"" << CategoryName(category_and_name.first)
+           << "\",\"ph\":\"X\",\"ts\":" << (retired.event.begin_ns - begin_ns_) / 1000.0
+           << ",\"dur\":" << (retired.event.end_ns - retired.event.begin_ns) / 1000.0
+           << ",\"pid\":" << pid << ",\"tid\":" << retired.tid << "}";
+    }
+    json << "\n]}\n";
+    const std::string content = json.str();
+    PersistentOutStream out_stream(LocalFS(), path);
+    out_stream.Write(content.data(), content.size());
+  }
+
+  std::string Statistics() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const int64_t wall_ns = (end_ns_ > 0 ? end_ns_ : TimelineNow()) - begin_ns_;
+    std::vector<TimelineStat> name_id2stat(id2category_and_name_.size());
+    std::vector<std::pair<std::string, double>> thread_utilizations;
+    const auto AddThreadUtilization = [&](const std::string& name, int64_t idle_ns) {
+      if (wall_ns > 0) {
+        thread_utilizations.emplace_back(name, std::max<double>(1.0 - 1.0 * idle_ns / wall_ns, 0));
+      }
+    };
+    for (const auto& timeline : timelines_) {
+      std::unique_lock<std::mutex> timeline_lock(timeline->mutex);
+      RetiredThread thread;
+      AddStats(timeline->name_id2stat, &name_id2stat, &thread);
+      if (thread.has_idle_event) { AddThreadUtilization(timeline->name, thread.idle_ns); }
+    }
+    AddStats(retired_name_id2stat_, &name_id2stat, nullptr);
+    for (const auto& pair : tid2retired_thread_) {
+      if (pair.second.has_idle_event) {
+        AddThreadUtilization(pair.second.name, pair.second.idle_ns);
+      }
+    }
+    std::vector<int32_t> name_ids;
+    FOR_RANGE(int32_t, name_id, 0, name_id2stat.size()) {
+      if (name_id2stat.at(name_id).count > 0) { name_ids.push_back(name_id); }
+    }
+    std::sort(name_ids.begin(), name_ids.end(), [&](int32_t lhs, int32_t rhs) {
+      return name_id2stat.at(lhs).total_ns > name_id2stat.at(rhs).total_ns;
+    });
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << std::left << std::setw(10) << "category" << std::setw(48) << "name" << std::right
+       << std::setw(10) << "count" << std::setw(14) << "total(ms)" << std::setw(12) << "avg(us)"
+       << std::setw(12) << "min(us)" << std::setw(12) << "max(us)"
+       << "\n";
+    for (int32_t name_id : name_ids) {
+      const auto& category_and_name = id2category_and_name_.at(name_id);
+      const TimelineStat& stat = name_id2stat.at(name_id);
+      ss << std::left << std::setw(10) << CategoryName(category_and_name.first) << std::setw(48)
+         << category_and_name.second << std::right << std::setw(10) << stat.count
+         << std::setw(14) << stat.total_ns / 1e6 << std::setw(12)
+         << stat.total_ns / 1e3 / stat.count << std::setw(12) << stat.min_ns / 1e3
+         << std::setw(12) << stat.max_ns / 1e3 << "\n";
+    }
+    for (const auto& pair : thread_utilizations) {
+      ss << pair.first << " utilization " << std::setprecision(1)
+         << pair.second * 100 << "%\n";
+    }
+    return ss.str();
+  }
+
+ private:
+  class ThreadTimelineOwner final {
+   public:
+    OF_DISALLOW_COPY_AND_MOVE(ThreadTimelineOwner);
+    ThreadTimelineOwner(ThreadTimeline** timeline, bool* is_retired)
+        : timeline_(timeline), is_retired_(is_retired) {}
+    ~ThreadTimelineOwner() {
+      TimelineRegistry::Get()->Retire(*timeline_);
+      *timeline_ = nullptr;
+      *is_retired_ = true;
+    }
+
+   private:
+    ThreadTimeline** timeline_;
+    bool* is_retired_;
+  };
+
+  void Retire(ThreadTimeline* timeline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    {
+      std::unique_lock<std::mutex> timeline_lock(timeline->mutex);
+      if (timeline->num_events > 0) {
+        if (retired_events_.empty()) { retired_events_.resize(buffer_size_); }
+        const int64_t buffer_size = timeline->events.size();
+        const int64_t first = std::max<int64_t>(timeline->num_events - buffer_size, 0);
+        for (int64_t i = first; i < timeline->num_events; ++i) {
+          RetiredTimelineEvent* retired = &retired_events_[num_retired_events_ % buffer_size_];
+          retired->tid = timeline->tid;
+          retired->event = timeline->events[i % buffer_size];
+          num_retired_events_ += 1;
+        }
+      }
+      // a thread may have only statistics
+      if (!timeline->name_id2stat.empty()) {
+        RetiredThread* thread = &tid2retired_thread_[timeline->tid];
+        thread->name = timeline->name;
+        AddStats(timeline->name_id2stat, &retired_name_id2stat_, thread);
+      }
+    }
+    auto it = std::find_if(
+        timelines_.begin(), timelines_.end(),
+        [&](const std::unique_ptr<ThreadTimeline>& ptr) { return ptr.get() == timeline; });
+    CHECK(it != timelines_.end());
+    timelines_.erase(it);
+  }
+
+  // Adds stats to sum, and the idle time of the thread stats belongs to to thread unless nullptr
+  void AddStats(const std::vector<TimelineStat>& stats, std::vector<TimelineStat>* sum,
+                RetiredThread* thread) const {
+    if (sum->size() < stats.size()) { sum->resize(stats.size()); }
+    FOR_RANGE(int64_t, name_id, 0, stats.size()) {
+      const TimelineStat& stat = stats.at(name_id);
+      if (stat.count == 0) { continue; }
+      TimelineStat* name_sum = &sum->at(name_id);
+      name_sum->count += stat.count;
+      name_sum->total_ns += stat.total_ns;
+      name_sum->min_ns = std::min(name_sum->min_ns, stat.min_ns);
+      name_sum->max_ns = std::max(name_sum->max_ns, stat.max_ns);
+      if (thread != nullptr && id2category_and_name_.at(name_id).first == kTimelineThreadIdle) {
+        thread->has_idle_event = true;
+        thread->idle_ns += stat.total_ns;
+      }
+    }
+  }
+
+  static std::string JsonEscaped(const std::string& str) {
+    std::string escaped;
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        escaped.push_back('\\');
+        escaped.push_back(c);
+      } else if (static_cast<unsigned char>(c) >= 0x20) {
+        escaped.push_back(c);
+      }
+    }
+    return escaped;
+  }
+
+  const int64_t buffer_size_;
+  std::mutex mutex_;
+  int64_t next_tid_;
+  std::vector<std::unique_ptr<ThreadTimeline>> timelines_;
+  std::vector<RetiredTimelineEvent> retired_events_;
+  int64_t num_retired_events_;
+  std::vector<TimelineStat> retired_name_id2stat_;
+  std::map<int64_t, RetiredThread> tid2retired_thread_;
+  std::vector<std::pair<TimelineEventCategory, std::string>> id2category_and_name_;
+  std::map<std::pair<TimelineEventCategory, std::string>, int32_t> category_and_name2id_;
+  int64_t begin_ns_;
+  int64_t end_ns_;
+};
+
+COMMAND({
+  bool enable_timeline = false;
+  ParseBoolFlagFromEnv("ONEFLOW_TIMELINE_PROFILER", &enable_timeline);
+  if (enable_timeline) { EnableTimeline(); }
+});
+
+}  // namespace
+
+void EnableTimeline() {
+  TimelineRegistry::Get()->Start();
+  timeline_internal::enabled.store(true);
+}
+
+void DisableTimeline() {
+  timeline_internal::enabled.store(false);
+  TimelineRegistry::Get()->Stop();
+}
+
+int64_t TimelineNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int32_t TimelineNameId(TimelineEventCategory category, const std::string& name) {
+  return TimelineRegistry::Get()->NameId(category, name);
+}
+
+void RecordTimelineEvent(int32_t name_id, int64_t begin_ns, int64_t end_ns) {
+  if (!IsTimelineEnabled()) { return; }
+  TimelineRegistry::Get()->Record(name_id, begin_ns, end_ns, true);
+}
+
+void RecordTimelineStatistic(int32_t name_id, int64_t begin_ns, int64_t end_ns) {
+  if (!IsTimelineEnabled()) { return; }
+  TimelineRegistry::Get()->Record(name_id, begin_ns, end_ns, false);
+}
+
+void SetTimelineThreadName(const std::string& name) {
+  ThreadTimeline* timeline = TimelineRegistry::Get()->ThisThreadTimeline();
+  if (timeline == nullptr) { return; }
+  std::unique_lock<std::mutex> lock(timeline->mutex);
+  timeline->name = name;
+}
+
+void DumpTimelineChromeTrace(const std::string& path) {
+  TimelineRegistry::Get()->DumpChromeTrace(path);
+}
+
+std::string TimelineStatistics() { return TimelineRegistry::Get()->Statistics(); }
+
+}  // namespace profiler
+
+}  // namespace oneflow
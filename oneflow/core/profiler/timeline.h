@@ -0,0 +1,102 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_TIMELINE_H_
+#define ONEFLOW_CORE_PROFILER_TIMELINE_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+// A CPU side timeline of kernels, actor acts, thread idle times and comm net reads. It is always
+// compiled in and switched on at runtime, by EnableTimeline or by the env var
+// ONEFLOW_TIMELINE_PROFILER. While it is off, recording an event costs a relaxed atomic load.
+//
+// Each thread records into its own ring buffer, which keeps the latest events for the Chrome
+// trace, and into its own per-name statistics, which count all events since EnableTimeline.
+// When a thread exits, its buffer is freed and its events and statistics are kept with those of
+// the other exited threads.
+// Times of device kernels are the times of launching them.
+//
+// Between two acts, an actor first waits for the msg that makes it ready, from the end of its
+// last act to when that msg is queued to its thread, then waits for its thread to reach it, from
+// then to the start of its act. These two spans are only counted in the statistics, as they
+// overlap the events of the other actors of the thread.
+enum TimelineEventCategory : int32_t {
+  kTimelineKernel = 0,
+  kTimelineActorAct,
+  kTimelineThreadIdle,
+  kTimelineCommNetRead,
+  kTimelineActorWait,
+  kTimelineActorReady,
+  kTimelineEventCategoryNum,
+};
+
+namespace timeline_internal {
+
+extern std::atomic<bool> enabled;
+
+}  // namespace timeline_internal
+
+inline bool IsTimelineEnabled() {
+  return timeline_internal::enabled.load(std::memory_order_relaxed);
+}
+
+// Clears the events and statistics recorded before
+void EnableTimeline();
+
+void DisableTimeline();
+
+int64_t TimelineNow();
+
+// Returns a small integer identifying the pair of category and name. Callers look it up once,
+// e.g. when a kernel is initialized, and record events with it.
+int32_t TimelineNameId(TimelineEventCategory category, const std::string& name);
+
+void RecordTimelineEvent(int32_t name_id, int64_t begin_ns, int64_t end_ns);
+
+// Counts the event in the statistics without putting it in the Chrome trace
+void RecordTimelineStatistic(int32_t name_id, int64_t begin_ns, int64_t end_ns);
+
+void SetTimelineThreadName(const std::string& name);
+
+// Writes the recorded events as Chrome trace JSON, loadable in chrome://tracing and Perfetto.
+void DumpTimelineChromeTrace(const std::string& path);
+
+// Returns a table of the count and time of each kernel, actor and comm net read, from the most
+// time consuming one, followed by the utilization of each thread.
+std::string TimelineStatistics();
+
+class TimelineEventGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TimelineEventGuard);
+  explicit TimelineEventGuard(int32_t name_id)
+      : name_id_(name_id), begin_ns_(IsTimelineEnabled() ? TimelineNow() : -1) {}
+  ~TimelineEventGuard() {
+    if (begin_ns_ >= 0) { RecordTimelineEvent(name_id_, begin_ns_, TimelineNow()); }
+  }
+
+ private:
+  int32_t name_id_;
+  int64_t begin_ns_;
+};
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PROFILER_TIMELINE_H_
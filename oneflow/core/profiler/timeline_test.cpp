@@ -0,0 +1,128 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/core/profiler/timeline.h"
+#include <fstream>
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST(Timeline, record_and_dump) {
+  const int32_t kernel_name_id = TimelineNameId(kTimelineKernel, "conv\"1");
+  const int32_t idle_name_id = TimelineNameId(kTimelineThreadIdle, "idle");
+  ASSERT_EQ(TimelineNameId(kTimelineKernel, "conv\"1"), kernel_name_id);
+  ASSERT_NE(TimelineNameId(kTimelineActorAct, "conv\"1"), kernel_name_id);
+  { TimelineEventGuard guard(kernel_name_id); }
+  EnableTimeline();
+  std::vector<std::thread> threads;
+  FOR_RANGE(int32_t, i, 0, 4) {
+    threads.emplace_back([&, i]() {
+      SetTimelineThreadName("worker " + std::to_string(i));
+      const int64_t now = TimelineNow();
+      FOR_RANGE(int64_t, j, 0, 100) { RecordTimelineEvent(kernel_name_id, now + j, now + j + 10); }
+      RecordTimelineEvent(idle_name_id, now, now + 1000);
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+  DisableTimeline();
+  { TimelineEventGuard guard(kernel_name_id); }
+
+  const std::string statistics = TimelineStatistics();
+  ASSERT_NE(statistics.find("conv\"1"), std::string::npos);
+  ASSERT_NE(statistics.find("400"), std::string::npos);
+  ASSERT_NE(statistics.find("worker 3 utilization"), std::string::npos);
+
+  const std::string path = JoinPath(GetCwd(), "tmp_test_timeline.json");
+  DumpTimelineChromeTrace(path);
+  const std::string chrome_trace = ReadFile(path);
+  LocalFS()->DelFile(path);
+  ASSERT_EQ(chrome_trace.find("{\"traceEvents\":["), 0U);
+  ASSERT_NE(chrome_trace.find("\"name\":\"conv\\\"1\",\"cat\":\"kernel\""), std::string::npos);
+  ASSERT_NE(chrome_trace.find("\"args\":{\"name\":\"worker 0\"}"), std::string::npos);
+  size_t num_kernel_events = 0;
+  for (size_t pos = chrome_trace.find("\"cat\":\"kernel\""); pos != std::string::npos;
+       pos = chrome_trace.find("\"cat\":\"kernel\"", pos + 1)) {
+    num_kernel_events += 1;
+  }
+  ASSERT_EQ(num_kernel_events, 400U);
+}
+
+TEST(Timeline, exited_threads) {
+  const int32_t name_id = TimelineNameId(kTimelineKernel, "short_lived");
+  EnableTimeline();
+  FOR_RANGE(int32_t, i, 0, 256) {
+    std::thread thread([&]() {
+      const int64_t now = TimelineNow();
+      FOR_RANGE(int64_t, j, 0, 10) { RecordTimelineEvent(name_id, now + j, now + j + 10); }
+    });
+    thread.join();
+  }
+  DisableTimeline();
+
+  const std::string statistics = TimelineStatistics();
+  ASSERT_NE(statistics.find("short_lived"), std::string::npos);
+  ASSERT_NE(statistics.find("2560"), std::string::npos);
+
+  const std::string path = JoinPath(GetCwd(), "tmp_test_timeline_exited_threads.json");
+  DumpTimelineChromeTrace(path);
+  const std::string chrome_trace = ReadFile(path);
+  LocalFS()->DelFile(path);
+  size_t num_events = 0;
+  for (size_t pos = chrome_trace.find("\"name\":\"short_lived\""); pos != std::string::npos;
+       pos = chrome_trace.find("\"name\":\"short_lived\"", pos + 1)) {
+    num_events += 1;
+  }
+  ASSERT_EQ(num_events, 2560U);
+}
+
+TEST(Timeline, statistic_only_events) {
+  const int32_t name_id = TimelineNameId(kTimelineActorReady, "not_traced");
+  EnableTimeline();
+  std::thread thread([&]() {
+    const int64_t now = TimelineNow();
+    FOR_RANGE(int64_t, j, 0, 7) { RecordTimelineStatistic(name_id, now + j, now + j + 10); }
+  });
+  thread.join();
+  DisableTimeline();
+
+  const std::string statistics = TimelineStatistics();
+  const size_t pos = statistics.find("not_traced");
+  ASSERT_NE(pos, std::string::npos);
+  ASSERT_EQ(statistics.rfind("ready", pos), statistics.rfind("\n", pos) + 1);
+
+  const std::string path = JoinPath(GetCwd(), "tmp_test_timeline_statistic_only.json");
+  DumpTimelineChromeTrace(path);
+  const std::string chrome_trace = ReadFile(path);
+  LocalFS()->DelFile(path);
+  ASSERT_EQ(chrome_trace.find("not_traced"), std::string::npos);
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
@@ -0,0 +1,107 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_REGISTER_ADAPTIVE_REGST_TEST_UTIL_H_
+#define ONEFLOW_CORE_REGISTER_ADAPTIVE_REGST_TEST_UTIL_H_
+
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/plan.pb.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/memory/memory_allocator.h"
+#include "oneflow/core/register/blob_desc.h"
+#include "oneflow/core/register/register_manager.h"
+#include "oneflow/core/register/runtime_register_desc.h"
+
+namespace oneflow {
+
+namespace test {
+
+const int64_t kAdaptiveRegstTestRegstDescId = 0;
+const int64_t kAdaptiveRegstTestMaxRegisterNum = 3;
+
+// a forward task producing one host regst of 768KB, so that a budget of 1MB holds only one
+// adaptive regst
+inline TaskProto AdaptiveRegstTestTask() {
+  TaskProto task;
+  task.set_task_type(TaskType::kNormalForward);
+  task.set_machine_id(0);
+  task.set_thrd_id(0);
+  task.set_task_id(0);
+  task.set_job_id(0);
+  task.mutable_exec_sequence();
+  task.mutable_parallel_ctx()->set_parallel_id(0);
+  task.mutable_parallel_ctx()->set_parallel_num(1);
+  RegstDescProto* regst_desc = &(*task.mutable_produced_regst_desc())["out"];
+  regst_desc->set_regst_desc_id(kAdaptiveRegstTestRegstDescId);
+  regst_desc->set_producer_task_id(task.task_id());
+  regst_desc->add_consumer_task_id(1);
+  regst_desc->set_min_register_num(1);
+  regst_desc->set_max_register_num(kAdaptiveRegstTestMaxRegisterNum);
+  regst_desc->set_register_num(1);
+  regst_desc->mutable_mem_case()->mutable_host_mem();
+  regst_desc->set_enable_reuse_mem(false);
+  regst_desc->set_mem_block_id(0);
+  regst_desc->set_mem_block_offset(0);
+  DataRegstDesc* data_regst_desc =
+      regst_desc->mutable_regst_desc_type()->mutable_data_regst_desc();
+  LbiBlobDescPair* pair = data_regst_desc->add_lbi2blob_desc();
+  pair->mutable_lbi()->set_op_name("adaptive_regst_test_op");
+  pair->mutable_lbi()->set_blob_name("out");
+  BlobDesc(Shape({192 * 1024}), DataType::kFloat).ToProto(pair->mutable_blob_desc());
+  *data_regst_desc->mutable_packed_blob_desc() = pair->blob_desc();
+  data_regst_desc->mutable_time_shape()->add_dim(1);
+  return task;
+}
+
+inline Plan AdaptiveRegstTestPlan() {
+  Plan plan;
+  *plan.add_task() = AdaptiveRegstTestTask();
+  const RegstDescProto& regst_desc = plan.task(0).produced_regst_desc().at("out");
+  MemBlockProto* mem_block = plan.mutable_block_chunk_list()->add_mem_block();
+  mem_block->set_mem_block_id(regst_desc.mem_block_id());
+  mem_block->set_machine_id(0);
+  *mem_block->mutable_mem_case() = regst_desc.mem_case();
+  mem_block->set_enable_reuse_mem(false);
+  mem_block->set_mem_size(RtRegstDesc(regst_desc).TotalMainByteSize4AllRegst());
+  return plan;
+}
+
+class AdaptiveRegstTestScope final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(AdaptiveRegstTestScope);
+  explicit AdaptiveRegstTestScope(int64_t adaptive_regst_mem_budget_mbyte) {
+    Resource resource;
+    resource.set_machine_num(1);
+    resource.set_cpu_device_num(1);
+    resource.set_adaptive_regst_mem_budget_mbyte(adaptive_regst_mem_budget_mbyte);
+    Global<ResourceDesc, ForSession>::New(resource);
+    Global<MachineCtx>::New(0);
+    Global<MemoryAllocator>::New();
+    Global<RegstMgr>::New(AdaptiveRegstTestPlan());
+  }
+  ~AdaptiveRegstTestScope() {
+    Global<RegstMgr>::Delete();
+    Global<MemoryAllocator>::Delete();
+    Global<MachineCtx>::Delete();
+    Global<ResourceDesc, ForSession>::Delete();
+  }
+};
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_REGISTER_ADAPTIVE_REGST_TEST_UTIL_H_
@@ -62,6 +62,16 @@ class OfBlob final {
   template<typename T>
   void StaticTensorAutoMemCopyFrom(const T* ptr, int64_t len) const;
 
+  // Zero-copy access to the body of a host blob. The returned pointers are only valid while the
+  // kernel owning this OfBlob is inside the foreign callback, which keeps the regst pinned.
+  bool IsHostMemory() const { return blob_->mem_case().has_host_mem(); }
+  template<typename T>
+  const T* CurTensorHostDptr() const;
+  template<typename T>
+  T* CurMutTensorHostDptr() const;
+  template<typename T>
+  T* StaticTensorHostDptr() const;
+
  private:
   void ClearShape(FullyMutTensorView* tensor) const;
 
@@ -157,6 +167,28 @@ void OfBlob::StaticTensorAutoMemCopyFrom(const T* ptr, int64_t len) const {
                  blob_->mem_case(), mem_case_);
 }
 
+template<typename T>
+const T* OfBlob::CurTensorHostDptr() const {
+  CHECK(IsHostMemory());
+  CHECK(cur_tensor_->data_type() == GetDataType<T>::value);
+  return cur_tensor_->dptr<T>();
+}
+
+template<typename T>
+T* OfBlob::CurMutTensorHostDptr() const {
+  CHECK(IsHostMemory());
+  CHECK(tensor_back_inserter_->cur_mut_tensor()->data_type() == GetDataType<T>::value);
+  return tensor_back_inserter_->cur_mut_tensor()->mut_dptr<T>();
+}
+
+template<typename T>
+T* OfBlob::StaticTensorHostDptr() const {
+  CHECK(IsHostMemory());
+  blob_->blob_access_checker()->CheckBodyMutable();
+  CHECK(blob_->sole_tensor().data_type() == GetDataType<T>::value);
+  return blob_->sole_mut_tensor().mut_dptr<T>();
+}
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_REGISTER_OFBLOB_H_
@@ -19,9 +19,17 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/comm_network/comm_network.h"
+#include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/job/machine_context.h"
 #include "oneflow/core/memory/memory_case.pb.h"
 #include "oneflow/core/memory/memory_allocator.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/cost_db.h"
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include "oneflow/core/thread/numa_topology.h"
+#include "oneflow/core/common/range.h"
 
 namespace oneflow {
 
@@ -43,16 +51,48 @@ struct PackedChunkInfo {
   }
 };
 
+char* AllocateZeroedMem(const MemoryCase& mem_case, size_t size) {
+  char* dptr = static_cast<char*>(MemoryAllocatorImpl::Allocate(mem_case, size));
+  if (mem_case.has_host_mem()) {
+    memset(dptr, 0, size);
+  } else if (mem_case.has_device_cuda_mem()) {
+#ifdef WITH_CUDA
+    CudaCurrentDeviceGuard guard(mem_case.device_cuda_mem().device_id());
+    OF_CUDA_CHECK(cudaMemset(dptr, 0, size));
+#else
+    UNIMPLEMENTED();
+#endif
+  } else {
+    UNIMPLEMENTED();
+  }
+  return dptr;
+}
+
+std::string AdaptiveRegstNumKey(int64_t machine_id) {
+  return "adaptive_regst_num_" + std::to_string(machine_id);
+}
+
 }  // namespace
 
-RegstMgr::RegstMgr(const Plan& plan) {
+RegstMgr::RegstMgr(const Plan& plan)
+    : adaptive_regst_mem_budget_(
+        Global<ResourceDesc, ForSession>::Get()->adaptive_regst_mem_budget_byte()) {
   int64_t this_machine_id = Global<MachineCtx>::Get()->this_machine_id();
 
+  const double alloc_start_time = GetCurTime();
+  int64_t host_mem_size = 0;
   HashMap<int64_t, char*> chunk_id2ptr;
   for (const ChunkProto& chunk : plan.block_chunk_list().chunk()) {
     if (chunk.machine_id() != this_machine_id) { continue; }
     if (chunk.mem_size() == 0) { continue; }
-    char* chunk_ptr = Global<MemoryAllocator>::Get()->Allocate(chunk.mem_case(), chunk.mem_size());
+    char* chunk_ptr = nullptr;
+    if (chunk.mem_case().has_host_mem()) {
+      chunk_ptr = Global<MemoryAllocator>::Get()->Allocate(chunk.mem_case(), chunk.mem_size(),
+                                                           [](char*) {});
+      host_mem_size += chunk.mem_size();
+    } else {
+      chunk_ptr = Global<MemoryAllocator>::Get()->Allocate(chunk.mem_case(), chunk.mem_size());
+    }
     CHECK(chunk_id2ptr.emplace(chunk.chunk_id(), chunk_ptr).second);
   }
 
@@ -80,10 +120,9 @@ RegstMgr::RegstMgr(const Plan& plan) {
     }
   }
 
+  const bool is_numa_aware = IsNumaAwareCpuPlacementEnabled();
   for (auto& pair : zone_id2packed_chunk) {
     PackedChunkInfo* packed_chunk = &pair.second;
-    char* ptr =
-        Global<MemoryAllocator>::Get()->Allocate(packed_chunk->mem_case, packed_chunk->size);
     // sort blocks as thrd id
     std::vector<const MemBlockProto*>* blocks = &(packed_chunk->blocks);
     std::sort(blocks->begin(), blocks->end(),
@@ -93,6 +132,47 @@ RegstMgr::RegstMgr(const Plan& plan) {
                 }
                 return lhs->thrd_id_hint() < rhs->thrd_id_hint();
               });
+    char* ptr = nullptr;
+    const MemoryCase& mem_case = packed_chunk->mem_case;
+    if (is_numa_aware && mem_case.has_host_mem()
+        && !mem_case.host_mem().has_cuda_pinned_mem()) {
+      // blocks of the same thrd are contiguous, place each range on the node of its thrd
+      std::vector<std::pair<Range, int32_t>> range2node;
+      int64_t offset = 0;
+      for (const MemBlockProto* block : packed_chunk->blocks) {
+        const int32_t node = NumaNode4ThrdId(block->thrd_id_hint());
+        if (range2node.empty() || range2node.back().second != node) {
+          range2node.emplace_back(Range(offset, offset), node);
+        }
+        offset += block->mem_size();
+        range2node.back().first.mut_end() = offset;
+      }
+      ptr = Global<MemoryAllocator>::Get()->Allocate(
+          mem_case, packed_chunk->size, [&range2node](char* chunk_ptr) {
+            for (const auto& range_node : range2node) {
+              if (range_node.second == -1) { continue; }
+              BindMemToNumaNode(chunk_ptr + range_node.first.begin(), range_node.first.size(),
+                                range_node.second);
+            }
+          });
+      double remote_size = 0;
+      int64_t placed_size = 0;
+      for (const auto& range_node : range2node) {
+        if (range_node.second == -1) { continue; }
+        remote_size += RemotePageRatio(ptr + range_node.first.begin(), range_node.first.size(),
+                                       range_node.second)
+                       * range_node.first.size();
+        placed_size += range_node.first.size();
+      }
+      LOG(INFO) << "numa placed " << placed_size << " of " << packed_chunk->size
+                << " bytes of mem zone " << pair.first << ", remote page ratio "
+                << (placed_size > 0 ? remote_size / placed_size : 0.0);
+    } else if (mem_case.has_host_mem()) {
+      ptr = Global<MemoryAllocator>::Get()->Allocate(mem_case, packed_chunk->size, [](char*) {});
+    } else {
+      ptr = Global<MemoryAllocator>::Get()->Allocate(mem_case, packed_chunk->size);
+    }
+    if (mem_case.has_host_mem()) { host_mem_size += packed_chunk->size; }
     int64_t offset = 0;
     for (const MemBlockProto* block : packed_chunk->blocks) {
       CHECK(mem_block_id2ptr_.emplace(block->mem_block_id(), ptr + offset).second);
@@ -100,6 +180,9 @@ RegstMgr::RegstMgr(const Plan& plan) {
     }
     CHECK_EQ(offset, packed_chunk->size);
   }
+  LOG(INFO) << "regst chunks allocated and initialized in "
+            << (GetCurTime() - alloc_start_time) / 1e6 << " ms, host mem " << host_mem_size
+            << " bytes";
 
   for (int64_t mem_block_id : all_block_ids) {
     CHECK(mem_block_id2ptr_.find(mem_block_id) != mem_block_id2ptr_.end());
@@ -145,7 +228,8 @@ void RegstMgr::NewRegsts(const RegstDescProto& regst_desc_proto,
     Regst* regst = new Regst;
     regst->set_regst_desc(rt_regst_desc);
     if (regst_desc_type.has_data_regst_desc()) {
-      NewBlobsInOneRegst(lbi_pairs, regst, rt_regst_desc, main_mem_ptr, separated_header_mem_ptr);
+      NewBlobsInOneRegst(lbi_pairs, regst, rt_regst_desc, main_mem_ptr, separated_header_mem_ptr,
+                         false);
       if (rt_regst_desc->mem_case().has_host_mem()
           && rt_regst_desc->mem_case().host_mem().used_by_network()) {
         CheckBlobInRegstNotDisabled(regst_desc_proto);
@@ -167,7 +251,7 @@ void RegstMgr::NewRegsts(const RegstDescProto& regst_desc_proto,
 
 void RegstMgr::NewBlobsInOneRegst(const std::vector<LbiBlobDescPair>& lbis, Regst* regst,
                                   const RtRegstDesc* rt_regst_desc, char* main_mem_ptr,
-                                  char* separated_header_mem_ptr) {
+                                  char* separated_header_mem_ptr, bool is_adaptive_regst) {
   size_t separated_header_mem_size = rt_regst_desc->SeparatedHeaderByteSize4OneRegst();
   const RtBlobDesc* packed_blob_desc = rt_regst_desc->packed_blob_desc();
   char* cur_body_pointer = nullptr;
@@ -209,6 +293,8 @@ void RegstMgr::NewBlobsInOneRegst(const std::vector<LbiBlobDescPair>& lbis, Regs
       InitNonPODTypeBlobIfNeed(Global<MemoryAllocator>::Get(), blob_ptr.get());
     }
     regst->SetBlobByOrdinal(ordinal, std::move(blob_ptr));
+    // adaptive regsts may be deleted at runtime, blobs of the planned regsts are looked up only
+    if (is_adaptive_regst) { return; }
     const int64_t regst_desc_id = rt_regst_desc->regst_desc_id();
     const auto& parallel_ctx = regst_desc_id2parallel_ctx_.at(regst_desc_id);
     if (parallel_ctx.has_parallel_id()) {
@@ -235,4 +321,129 @@ Blob* RegstMgr::Blob4LbiAndParallelId(const LogicalBlobId& lbi, const int64_t pa
   return lbi2parallel_id2blob_.at(lbi).at(parallel_id);
 }
 
+RegstMgr::~RegstMgr() {
+  // regsts are deleted by their actors before
+  for (const auto& pair : adaptive_regst2mem_) { FreeAdaptiveRegstMem(pair.second); }
+}
+
+void RegstMgr::RegisterAdaptiveRegstDesc(int64_t regst_desc_id, const std::string& regst_key,
+                                         int64_t register_num) {
+  std::unique_lock<std::mutex> lock(adaptive_regst_mutex_);
+  CHECK(regst_desc_id2adaptive_regst_key_.emplace(regst_desc_id, regst_key).second);
+  regst_desc_id2adaptive_regst_num_[regst_desc_id] = register_num;
+}
+
+Regst* RegstMgr::TryNewAdaptiveRegst(int64_t regst_desc_id) {
+  const RtRegstDesc* rt_regst_desc = regst_desc_id2rt_regst_desc_.at(regst_desc_id).get();
+  CHECK(rt_regst_desc->regst_desc_type().has_data_regst_desc());
+  AdaptiveRegstMem mem;
+  mem.mem_case = rt_regst_desc->mem_case();
+  mem.mem_zone_id = MemoryCaseUtil::GenMemZoneId(mem.mem_case);
+  mem.separated_header_mem_case =
+      MemoryCaseUtil::GetHostPinnedMemoryCaseForRegstSeparatedHeader(mem.mem_case);
+  const size_t main_size = rt_regst_desc->MainByteSize4OneRegst();
+  const size_t separated_header_size = rt_regst_desc->SeparatedHeaderByteSize4OneRegst();
+  mem.size = main_size + separated_header_size;
+  {
+    std::unique_lock<std::mutex> lock(adaptive_regst_mutex_);
+    size_t* used_size = &mem_zone_id2adaptive_regst_mem_size_[mem.mem_zone_id];
+    if (*used_size + mem.size > adaptive_regst_mem_budget_) { return nullptr; }
+    *used_size += mem.size;
+  }
+  mem.main_mem_ptr = main_size > 0 ? AllocateZeroedMem(mem.mem_case, main_size) : nullptr;
+  mem.separated_header_mem_ptr =
+      separated_header_size > 0
+          ? AllocateZeroedMem(mem.separated_header_mem_case, separated_header_size)
+          : nullptr;
+  std::vector<LbiBlobDescPair> lbi_pairs(
+      rt_regst_desc->regst_desc_type().data_regst_desc().lbi2blob_desc().begin(),
+      rt_regst_desc->regst_desc_type().data_regst_desc().lbi2blob_desc().end());
+  std::sort(lbi_pairs.begin(), lbi_pairs.end(), &CompareLbiBlobDescPair);
+  Regst* regst = new Regst;
+  regst->set_regst_desc(rt_regst_desc);
+  NewBlobsInOneRegst(lbi_pairs, regst, rt_regst_desc, mem.main_mem_ptr,
+                     mem.separated_header_mem_ptr, true);
+  {
+    std::unique_lock<std::mutex> lock(adaptive_regst_mutex_);
+    CHECK(adaptive_regst2mem_.emplace(regst, mem).second);
+  }
+  return regst;
+}
+
+void RegstMgr::DeleteAdaptiveRegst(Regst* regst) {
+  AdaptiveRegstMem mem;
+  {
+    std::unique_lock<std::mutex> lock(adaptive_regst_mutex_);
+    auto it = adaptive_regst2mem_.find(regst);
+    CHECK(it != adaptive_regst2mem_.end());
+    mem = it->second;
+    adaptive_regst2mem_.erase(it);
+    mem_zone_id2adaptive_regst_mem_size_.at(mem.mem_zone_id) -= mem.size;
+  }
+  delete regst;
+  FreeAdaptiveRegstMem(mem);
+}
+
+void RegstMgr::FreeAdaptiveRegstMem(const AdaptiveRegstMem& mem) {
+  if (mem.main_mem_ptr != nullptr) {
+    MemoryAllocatorImpl::Deallocate(mem.main_mem_ptr, mem.mem_case);
+  }
+  if (mem.separated_header_mem_ptr != nullptr) {
+    MemoryAllocatorImpl::Deallocate(mem.separated_header_mem_ptr, mem.separated_header_mem_case);
+  }
+}
+
+void RegstMgr::UpdateAdaptiveRegstNum(int64_t regst_desc_id, int64_t register_num) {
+  std::unique_lock<std::mutex> lock(adaptive_regst_mutex_);
+  regst_desc_id2adaptive_regst_num_.at(regst_desc_id) = register_num;
+}
+
+void RegstMgr::ExportAdaptiveRegstNum() const {
+  CostDBProto regst_nums;
+  {
+    std::unique_lock<std::mutex> lock(adaptive_regst_mutex_);
+    for (const auto& pair : regst_desc_id2adaptive_regst_num_) {
+      const RtRegstDesc& regst_desc = RegstDesc4RegstDescId(pair.first);
+      // only the regst descs changed at runtime are exported
+      if (pair.second == regst_desc.register_num()) { continue; }
+      const std::string& regst_key = regst_desc_id2adaptive_regst_key_.at(pair.first);
+      (*regst_nums.mutable_regst_key2register_num())[regst_key] = pair.second;
+    }
+  }
+  if (regst_nums.regst_key2register_num().empty() == false) {
+    TeePersistentLogStream::Create("adaptive_regst_num")->Write(regst_nums);
+  }
+  const std::string& cost_db_path = Global<const ProfilerConf>::Get()->cost_db_path();
+  if (cost_db_path.empty()) { return; }
+  // the cost db is saved by the master, so every machine pushes its regst nums, even empty ones
+  const int64_t this_machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  if (Global<MachineCtx>::Get()->IsThisMachineMaster() == false) {
+    Global<CtrlClient>::Get()->PushKV(AdaptiveRegstNumKey(this_machine_id), regst_nums);
+    return;
+  }
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  FOR_RANGE(int64_t, machine_id, 0, machine_num) {
+    if (machine_id == this_machine_id) { continue; }
+    const std::string key = AdaptiveRegstNumKey(machine_id);
+    CostDBProto machine_regst_nums;
+    Global<CtrlClient>::Get()->PullKV(key, &machine_regst_nums);
+    Global<CtrlClient>::Get()->ClearKV(key);
+    // regsts of the same task key on different machines keep the largest num
+    auto* key2register_num = regst_nums.mutable_regst_key2register_num();
+    for (const auto& pair : machine_regst_nums.regst_key2register_num()) {
+      auto it = key2register_num->find(pair.first);
+      if (it == key2register_num->end()) {
+        (*key2register_num)[pair.first] = pair.second;
+      } else {
+        it->second = std::max(it->second, pair.second);
+      }
+    }
+  }
+  if (regst_nums.regst_key2register_num().empty()) { return; }
+  CostDB cost_db;
+  cost_db.Load(cost_db_path);
+  cost_db.Merge(regst_nums);
+  cost_db.Save(cost_db_path);
+}
+
 }  // namespace oneflow
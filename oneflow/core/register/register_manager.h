@@ -33,24 +33,55 @@ class RegstMgr final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(RegstMgr);
   RegstMgr() = delete;
-  ~RegstMgr() = default;
+  ~RegstMgr();
 
   void NewRegsts(const RegstDescProto& regst_desc_proto, std::function<void(Regst*)> OneRegstDone);
   const RtRegstDesc& RegstDesc4RegstDescId(int64_t regst_desc_id) const;
   bool HasRegstDescId(int64_t regst_desc_id) const;
   Blob* Blob4LbiAndParallelId(const LogicalBlobId& lbi, const int64_t parallel_id);
 
+  // Adaptive regsts are added at runtime by actors stalled on writing, their memory is allocated
+  // apart from the plan within the adaptive regst budget of every memory zone
+  bool IsAdaptiveRegstNumEnabled() const { return adaptive_regst_mem_budget_ > 0; }
+  void RegisterAdaptiveRegstDesc(int64_t regst_desc_id, const std::string& regst_key,
+                                 int64_t register_num);
+  // return nullptr if the budget is exhausted
+  Regst* TryNewAdaptiveRegst(int64_t regst_desc_id);
+  void DeleteAdaptiveRegst(Regst* regst);
+  void UpdateAdaptiveRegstNum(int64_t regst_desc_id, int64_t register_num);
+  // export the regst nums for the next compile, called by every machine as the master gathers
+  // the regst nums of all machines into the cost db
+  void ExportAdaptiveRegstNum() const;
+
  private:
   friend class Global<RegstMgr>;
 
+  struct AdaptiveRegstMem {
+    int64_t mem_zone_id;
+    size_t size;
+    MemoryCase mem_case;
+    char* main_mem_ptr;
+    MemoryCase separated_header_mem_case;
+    char* separated_header_mem_ptr;
+  };
+
   explicit RegstMgr(const Plan& plan);
   void NewBlobsInOneRegst(const std::vector<LbiBlobDescPair>& lbis, Regst*, const RtRegstDesc*,
-                          char* main_mem_ptr, char* separated_header_mem_ptr);
+                          char* main_mem_ptr, char* separated_header_mem_ptr,
+                          bool is_adaptive_regst);
+  void FreeAdaptiveRegstMem(const AdaptiveRegstMem& mem);
   HashMap<int64_t, std::unique_ptr<const RtRegstDesc>> regst_desc_id2rt_regst_desc_;
   HashMap<LogicalBlobId, HashMap<int64_t, Blob*>> lbi2parallel_id2blob_;
   HashMap<int64_t, char*> mem_block_id2ptr_;
   HashMap<int64_t, ParallelContext> regst_desc_id2parallel_ctx_;
   std::mutex mutex_;
+
+  size_t adaptive_regst_mem_budget_;
+  HashMap<int64_t, size_t> mem_zone_id2adaptive_regst_mem_size_;
+  HashMap<Regst*, AdaptiveRegstMem> adaptive_regst2mem_;
+  HashMap<int64_t, std::string> regst_desc_id2adaptive_regst_key_;
+  HashMap<int64_t, int64_t> regst_desc_id2adaptive_regst_num_;
+  mutable std::mutex adaptive_regst_mutex_;
 };
 
 }  // namespace oneflow
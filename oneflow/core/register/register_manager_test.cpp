@@ -0,0 +1,79 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/register/register_manager.h"
+#include "oneflow/core/register/adaptive_regst_test_util.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+bool IsBodyZeroed(Regst* regst) {
+  const Blob* blob = regst->GetBlobByOrdinal(0);
+  const char* dptr = static_cast<const char*>(blob->dptr());
+  return std::all_of(dptr, dptr + blob->ByteSizeOfBlobBody(), [](char c) { return c == 0; });
+}
+
+}  // namespace
+
+TEST(RegstMgr, adaptive_regst_num_disabled_without_budget) {
+  AdaptiveRegstTestScope scope(0);
+  ASSERT_FALSE(Global<RegstMgr>::Get()->IsAdaptiveRegstNumEnabled());
+}
+
+TEST(RegstMgr, try_new_adaptive_regst_within_budget) {
+  AdaptiveRegstTestScope scope(1);
+  RegstMgr* regst_mgr = Global<RegstMgr>::Get();
+  ASSERT_TRUE(regst_mgr->IsAdaptiveRegstNumEnabled());
+  Regst* regst = regst_mgr->TryNewAdaptiveRegst(kAdaptiveRegstTestRegstDescId);
+  ASSERT_TRUE(regst != nullptr);
+  ASSERT_EQ(regst->regst_desc_id(), kAdaptiveRegstTestRegstDescId);
+  ASSERT_TRUE(IsBodyZeroed(regst));
+  // a second regst of 768KB exceeds the budget of 1MB
+  ASSERT_TRUE(regst_mgr->TryNewAdaptiveRegst(kAdaptiveRegstTestRegstDescId) == nullptr);
+  regst_mgr->DeleteAdaptiveRegst(regst);
+}
+
+TEST(RegstMgr, delete_adaptive_regst_returns_budget) {
+  AdaptiveRegstTestScope scope(1);
+  RegstMgr* regst_mgr = Global<RegstMgr>::Get();
+  Regst* regst = regst_mgr->TryNewAdaptiveRegst(kAdaptiveRegstTestRegstDescId);
+  ASSERT_TRUE(regst != nullptr);
+  regst_mgr->DeleteAdaptiveRegst(regst);
+  Regst* renewed_regst = regst_mgr->TryNewAdaptiveRegst(kAdaptiveRegstTestRegstDescId);
+  ASSERT_TRUE(renewed_regst != nullptr);
+  ASSERT_TRUE(IsBodyZeroed(renewed_regst));
+  regst_mgr->DeleteAdaptiveRegst(renewed_regst);
+}
+
+TEST(RegstMgr, adaptive_regst_not_in_planned_blobs) {
+  AdaptiveRegstTestScope scope(1);
+  RegstMgr* regst_mgr = Global<RegstMgr>::Get();
+  LogicalBlobId lbi;
+  lbi.set_op_name("adaptive_regst_test_op");
+  lbi.set_blob_name("out");
+  const Blob* planned_blob = regst_mgr->Blob4LbiAndParallelId(lbi, 0);
+  Regst* regst = regst_mgr->TryNewAdaptiveRegst(kAdaptiveRegstTestRegstDescId);
+  ASSERT_TRUE(regst != nullptr);
+  ASSERT_EQ(regst_mgr->Blob4LbiAndParallelId(lbi, 0), planned_blob);
+  ASSERT_NE(regst->GetBlobByOrdinal(0)->dptr(), planned_blob->dptr());
+  regst_mgr->DeleteAdaptiveRegst(regst);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
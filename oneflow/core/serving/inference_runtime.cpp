@@ -0,0 +1,351 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/serving/inference_runtime.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/common/buffer_manager.h"
+#include "oneflow/core/common/data_type_seq.h"
+#include "oneflow/core/job/foreign_job_instance.h"
+#include "oneflow/core/job/inter_user_job_info.pb.h"
+#include "oneflow/core/job/job_build_and_infer_ctx_mgr.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/register/ofblob.h"
+
+namespace oneflow {
+
+struct InferenceRuntime::Request {
+  Request(const HashMap<std::string, ServingTensor>* inputs, int64_t batch_size,
+          const std::vector<std::string>& output_op_names)
+      : inputs(inputs), batch_size(batch_size), counter(output_op_names.size()) {
+    // the pull callbacks of the outputs run on different threads and only assign to the slots
+    // created here, so that the map is never rehashed concurrently
+    for (const std::string& op_name : output_op_names) { outputs[op_name]; }
+  }
+
+  // the inputs of the caller, or owned_inputs if the caller may stop waiting before they are
+  // pushed
+  const HashMap<std::string, ServingTensor>* inputs;
+  HashMap<std::string, ServingTensor> owned_inputs;
+  HashMap<std::string, ServingTensor> outputs;
+  int64_t batch_size;
+  BlockingCounter counter;
+};
+
+struct InferenceRuntime::Batch {
+  std::vector<std::shared_ptr<Request>> requests;
+  int64_t batch_size = 0;
+};
+
+namespace {
+
+using Request = InferenceRuntime::Request;
+using Batch = InferenceRuntime::Batch;
+
+void StaticTensorCopyFrom(OfBlob* of_blob, const char* ptr, int64_t len) {
+  switch (of_blob->data_type()) {
+#define STATIC_TENSOR_COPY_FROM_ENTRY(type_cpp, type_proto) \
+  case type_proto:                                           \
+    return of_blob->StaticTensorAutoMemCopyFrom<type_cpp>(   \
+        reinterpret_cast<const type_cpp*>(ptr), len);
+    OF_PP_FOR_EACH_TUPLE(STATIC_TENSOR_COPY_FROM_ENTRY, POD_DATA_TYPE_SEQ)
+#undef STATIC_TENSOR_COPY_FROM_ENTRY
+    default: UNIMPLEMENTED();
+  }
+}
+
+void CurMutTensorCopyFrom(OfBlob* of_blob, const char* ptr, int64_t len) {
+  switch (of_blob->data_type()) {
+#define CUR_MUT_TENSOR_COPY_FROM_ENTRY(type_cpp, type_proto) \
+  case type_proto:                                            \
+    return of_blob->CurMutTensorAutoMemCopyFrom<type_cpp>(    \
+        reinterpret_cast<const type_cpp*>(ptr), len);
+    OF_PP_FOR_EACH_TUPLE(CUR_MUT_TENSOR_COPY_FROM_ENTRY, POD_DATA_TYPE_SEQ)
+#undef CUR_MUT_TENSOR_COPY_FROM_ENTRY
+    default: UNIMPLEMENTED();
+  }
+}
+
+void CurTensorCopyTo(OfBlob* of_blob, char* ptr, int64_t len) {
+  switch (of_blob->data_type()) {
+#define CUR_TENSOR_COPY_TO_ENTRY(type_cpp, type_proto) \
+  case type_proto:                                      \
+    return of_blob->CurTensorAutoMemCopyTo<type_cpp>(reinterpret_cast<type_cpp*>(ptr), len);
+    OF_PP_FOR_EACH_TUPLE(CUR_TENSOR_COPY_TO_ENTRY, POD_DATA_TYPE_SEQ)
+#undef CUR_TENSOR_COPY_TO_ENTRY
+    default: UNIMPLEMENTED();
+  }
+}
+
+class BatchJobInstance : public ForeignJobInstance {
+ public:
+  BatchJobInstance(const std::string& job_name, const std::shared_ptr<Batch>& batch)
+      : job_name_(job_name), batch_(batch) {}
+  virtual ~BatchJobInstance() = default;
+
+  std::string job_name() const override { return job_name_; }
+  void Finish() const override {}
+
+ protected:
+  std::string job_name_;
+  std::shared_ptr<Batch> batch_;
+};
+
+// Packs the inputs of all requests of the batch into the input blob, the padding rows of a
+// static blob are zero-filled.
+class BatchPushJobInstance final : public BatchJobInstance {
+ public:
+  BatchPushJobInstance(const std::string& job_name, const std::string& op_name,
+                       const std::shared_ptr<Batch>& batch)
+      : BatchJobInstance(job_name, batch), op_name_(op_name) {}
+
+  std::string sole_input_op_name_in_user_job() const override { return op_name_; }
+
+  void PushBlob(uint64_t ofblob_ptr) const override {
+    auto* of_blob = reinterpret_cast<OfBlob*>(ofblob_ptr);
+    DimVector static_dims(of_blob->NumAxes());
+    of_blob->CopyStaticShapeTo(static_dims.data(), static_dims.size());
+    const Shape static_shape(static_dims);
+    CHECK_LE(batch_->batch_size, static_shape.At(0));
+    const size_t row_size =
+        static_shape.Count(1) * GetSizeOfDataType(static_cast<DataType>(of_blob->data_type()));
+    const int64_t num_rows = of_blob->is_dynamic() ? batch_->batch_size : static_shape.At(0);
+    std::vector<char> buffer(num_rows * row_size, 0);
+    int64_t row_offset = 0;
+    for (const auto& request : batch_->requests) {
+      const ServingTensor& input = request->inputs->at(op_name_);
+      CHECK_EQ(input.data_type(), of_blob->data_type());
+      CHECK_EQ(input.shape().Count(1), static_shape.Count(1));
+      std::memcpy(buffer.data() + row_offset * row_size, input.data(), input.ByteSize());
+      row_offset += request->batch_size;
+    }
+    if (of_blob->is_dynamic()) {
+      DimVector dims = static_dims;
+      dims.at(0) = num_rows;
+      of_blob->ClearTensorLists();
+      of_blob->AddTensorListSlice();
+      of_blob->AddTensor();
+      CHECK(of_blob->CurMutTensorAvailable());
+      of_blob->CurMutTensorCopyShapeFrom(dims.data(), dims.size());
+      CurMutTensorCopyFrom(of_blob, buffer.data(), Shape(dims).elem_cnt());
+    } else {
+      StaticTensorCopyFrom(of_blob, buffer.data(), static_shape.elem_cnt());
+    }
+  }
+
+ private:
+  std::string op_name_;
+};
+
+// Splits the output blob by rows and hands each request its own rows.
+class BatchPullJobInstance final : public BatchJobInstance {
+ public:
+  BatchPullJobInstance(const std::string& job_name, const std::string& op_name,
+                       const std::shared_ptr<Batch>& batch)
+      : BatchJobInstance(job_name, batch), op_name_(op_name) {}
+
+  std::string sole_output_op_name_in_user_job() const override { return op_name_; }
+
+  void PullBlob(uint64_t ofblob_ptr) const override {
+    auto* of_blob = reinterpret_cast<OfBlob*>(ofblob_ptr);
+    of_blob->ResetTensorIterator();
+    CHECK(!of_blob->CurTensorIteratorEqEnd());
+    DimVector dims(of_blob->NumAxes());
+    of_blob->CurTensorCopyShapeTo(dims.data(), dims.size());
+    const Shape shape(dims);
+    CHECK_GE(shape.At(0), batch_->batch_size);
+    const DataType data_type = static_cast<DataType>(of_blob->data_type());
+    std::vector<char> buffer(shape.elem_cnt() * GetSizeOfDataType(data_type));
+    CurTensorCopyTo(of_blob, buffer.data(), shape.elem_cnt());
+    const size_t row_size = buffer.size() / shape.At(0);
+    int64_t row_offset = 0;
+    for (const auto& request : batch_->requests) {
+      dims.at(0) = request->batch_size;
+      ServingTensor output(Shape(dims), data_type);
+      std::memcpy(output.mut_data(), buffer.data() + row_offset * row_size, output.ByteSize());
+      row_offset += request->batch_size;
+      request->outputs.at(op_name_) = std::move(output);
+      request->counter.Decrease();
+    }
+  }
+
+ private:
+  std::string op_name_;
+};
+
+// Same as LaunchJob of the python api.
+void LaunchJobInstance(const std::shared_ptr<ForeignJobInstance>& job_instance) {
+  const std::string& job_name = job_instance->job_name();
+  const InterUserJobInfo& inter_user_job_info = *Global<InterUserJobInfo>::Get();
+  auto* buffer_mgr = Global<BufferMgr<std::shared_ptr<ForeignJobInstance>>>::Get();
+  int64_t job_id = Global<JobName2JobId>::Get()->at(job_name);
+  if (IsPullJob(job_name, inter_user_job_info)) {
+    buffer_mgr->Get(GetForeignOutputBufferName(job_name))->Send(job_instance);
+  }
+  if (IsPushJob(job_name, inter_user_job_info)) {
+    buffer_mgr->Get(GetForeignInputBufferName(job_name))->Send(job_instance);
+  }
+  buffer_mgr->Get(GetCallbackNotifierBufferName(job_name))->Send(job_instance);
+  Global<BufferMgr<int64_t>>::Get()->Get(kBufferNameGlobalWaitJobId)->Send(job_id);
+}
+
+}  // namespace
+
+ServingTensor::ServingTensor(const Shape& shape, DataType data_type)
+    : shape_(shape),
+      data_type_(data_type),
+      buffer_(shape.elem_cnt() * GetSizeOfDataType(data_type)) {}
+
+InferenceRuntime::InferenceRuntime(const std::string& job_name,
+                                   const std::vector<std::string>& input_op_names,
+                                   const std::vector<std::string>& output_op_names,
+                                   int64_t max_batch_size, int64_t batch_timeout_us)
+    : job_name_(job_name),
+      input_op_names_(input_op_names),
+      output_op_names_(output_op_names),
+      max_batch_size_(max_batch_size),
+      batch_timeout_us_(batch_timeout_us),
+      is_closed_(false) {
+  CHECK_GT(max_batch_size_, 0);
+  CHECK_GE(batch_timeout_us_, 0);
+  CHECK_NOTNULL(Global<JobName2JobId>::Get());
+  CHECK_GT(Global<JobName2JobId>::Get()->count(job_name_), 0);
+  const InterUserJobInfo& inter_user_job_info = *Global<InterUserJobInfo>::Get();
+  JobBuildAndInferCtx* ctx =
+      CHECK_JUST(Global<LazyJobBuildAndInferCtxMgr>::Get()->FindJobBuildAndInferCtx(job_name_));
+  for (const std::string& op_name : input_op_names_) {
+    input_op_name2push_job_name_.emplace(
+        op_name, inter_user_job_info.input_or_var_op_name2push_job_name().at(op_name));
+    const std::string lbn = op_name + "/out";
+    const Shape static_shape = *CHECK_JUST(ctx->GetStaticShape(lbn));
+    CHECK_GT(static_shape.NumAxes(), 0);
+    if (max_batch_size_ > static_shape.At(0)) {
+      LOG(WARNING) << "max_batch_size " << max_batch_size_ << " of inference runtime " << job_name_
+                   << " is lowered to the static batch size " << static_shape.At(0) << " of input "
+                   << op_name;
+      max_batch_size_ = static_shape.At(0);
+    }
+    input_op_name2static_shape_.emplace(op_name, static_shape);
+    input_op_name2data_type_.emplace(op_name, CHECK_JUST(ctx->GetDataType(lbn)));
+  }
+  for (const std::string& op_name : output_op_names_) {
+    output_op_name2pull_job_name_.emplace(
+        op_name, inter_user_job_info.output_or_var_op_name2pull_job_name().at(op_name));
+  }
+  batching_thread_ = std::thread([this]() { BatchingLoop(); });
+}
+
+InferenceRuntime::~InferenceRuntime() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    is_closed_ = true;
+  }
+  cond_.notify_all();
+  batching_thread_.join();
+}
+
+Maybe<void> InferenceRuntime::Predict(const HashMap<std::string, ServingTensor>& inputs,
+                                      HashMap<std::string, ServingTensor>* outputs,
+                                      int64_t timeout_us) {
+  CHECK_EQ_OR_RETURN(inputs.size(), input_op_names_.size());
+  int64_t batch_size = -1;
+  for (const std::string& op_name : input_op_names_) {
+    const auto& it = inputs.find(op_name);
+    CHECK_OR_RETURN(it != inputs.end()) << "input " << op_name << " is absent";
+    const Shape& shape = it->second.shape();
+    const Shape& static_shape = input_op_name2static_shape_.at(op_name);
+    CHECK_EQ_OR_RETURN(shape.NumAxes(), static_shape.NumAxes())
+        << "input " << op_name << " should have shape like " << static_shape.ToString();
+    CHECK_EQ_OR_RETURN(shape.Count(1), static_shape.Count(1))
+        << "input " << op_name << " should have shape like " << static_shape.ToString();
+    CHECK_EQ_OR_RETURN(it->second.data_type(), input_op_name2data_type_.at(op_name))
+        << "input " << op_name << " has a wrong data type";
+    if (batch_size == -1) { batch_size = shape.At(0); }
+    CHECK_EQ_OR_RETURN(shape.At(0), batch_size) << "inputs should have the same batch size";
+  }
+  CHECK_GT_OR_RETURN(batch_size, 0);
+  CHECK_LE_OR_RETURN(batch_size, max_batch_size_)
+      << "batch size " << batch_size << " exceeds the max batch size " << max_batch_size_;
+  auto request = std::make_shared<Request>(&inputs, batch_size, output_op_names_);
+  if (timeout_us > 0) {
+    request->owned_inputs = inputs;
+    request->inputs = &request->owned_inputs;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CHECK_OR_RETURN(!is_closed_) << "inference runtime is closed";
+    pending_requests_.push_back(request);
+  }
+  cond_.notify_all();
+  if (timeout_us > 0) {
+    if (!request->counter.WaitUntilCntEqualZero(timeout_us)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto it = std::find(pending_requests_.begin(), pending_requests_.end(), request);
+      if (it != pending_requests_.end()) { pending_requests_.erase(it); }
+      return Error::CheckFailedError() << "request of inference runtime " << job_name_
+                                       << " timed out after " << timeout_us << "us";
+    }
+  } else {
+    request->counter.WaitUntilCntEqualZero();
+  }
+  *outputs = std::move(request->outputs);
+  return Maybe<void>::Ok();
+}
+
+void InferenceRuntime::BatchingLoop() {
+  while (true) {
+    auto batch = std::make_shared<Batch>();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return !pending_requests_.empty() || is_closed_; });
+      if (pending_requests_.empty()) { return; }
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::microseconds(batch_timeout_us_);
+      auto PackPendingRequests = [&]() {
+        while (!pending_requests_.empty()
+               && batch->batch_size + pending_requests_.front()->batch_size <= max_batch_size_) {
+          batch->batch_size += pending_requests_.front()->batch_size;
+          batch->requests.push_back(pending_requests_.front());
+          pending_requests_.pop_front();
+        }
+      };
+      while (true) {
+        PackPendingRequests();
+        // The batch is closed once the next pending request does not fit in
+        if (!pending_requests_.empty() || batch->batch_size == max_batch_size_ || is_closed_) {
+          break;
+        }
+        if (cond_.wait_until(lock, deadline) == std::cv_status::timeout) {
+          PackPendingRequests();
+          break;
+        }
+      }
+    }
+    LaunchBatch(batch);
+  }
+}
+
+void InferenceRuntime::LaunchBatch(const std::shared_ptr<Batch>& batch) const {
+  for (const std::string& op_name : input_op_names_) {
+    LaunchJobInstance(std::make_shared<BatchPushJobInstance>(
+        input_op_name2push_job_name_.at(op_name), op_name, batch));
+  }
+  LaunchJobInstance(std::make_shared<BatchJobInstance>(job_name_, batch));
+  for (const std::string& op_name : output_op_names_) {
+    LaunchJobInstance(std::make_shared<BatchPullJobInstance>(
+        output_op_name2pull_job_name_.at(op_name), op_name, batch));
+  }
+}
+
+}  // namespace oneflow
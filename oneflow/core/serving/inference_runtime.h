@@ -0,0 +1,96 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_SERVING_INFERENCE_RUNTIME_H_
+#define ONEFLOW_CORE_SERVING_INFERENCE_RUNTIME_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/common/data_type.pb.h"
+#include <deque>
+
+namespace oneflow {
+
+// Host tensor passed to and returned from InferenceRuntime::Predict.
+class ServingTensor final {
+ public:
+  ServingTensor() : data_type_(DataType::kInvalidDataType) {}
+  ServingTensor(const Shape& shape, DataType data_type);
+
+  const Shape& shape() const { return shape_; }
+  DataType data_type() const { return data_type_; }
+  const char* data() const { return buffer_.data(); }
+  char* mut_data() { return buffer_.data(); }
+  size_t ByteSize() const { return buffer_.size(); }
+
+ private:
+  Shape shape_;
+  DataType data_type_;
+  std::vector<char> buffer_;
+};
+
+// InferenceRuntime serves an inference job which has already been compiled and launched, by
+// launching its push, user and pull jobs directly instead of going through python job
+// instances. Concurrent Predict calls are packed into batches of at most `max_batch_size` rows
+// along axis 0. A batch is launched when it is full or `batch_timeout_us` after its first
+// request arrived, and batches are launched without waiting for the previous ones to finish, so
+// that they are pipelined through the actor graph. The job is assumed to be row-independent
+// along axis 0 for all inputs and outputs. `max_batch_size` is lowered to the static batch size
+// of the inputs if it is larger.
+class InferenceRuntime final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InferenceRuntime);
+  InferenceRuntime(const std::string& job_name, const std::vector<std::string>& input_op_names,
+                   const std::vector<std::string>& output_op_names, int64_t max_batch_size,
+                   int64_t batch_timeout_us);
+  ~InferenceRuntime();
+
+  const std::vector<std::string>& input_op_names() const { return input_op_names_; }
+  const std::vector<std::string>& output_op_names() const { return output_op_names_; }
+
+  // Thread-safe, blocks until all outputs of this request have been fetched, or returns an error
+  // after `timeout_us` if it is positive. A request timed out after its batch was launched still
+  // runs, and its outputs are dropped.
+  Maybe<void> Predict(const HashMap<std::string, ServingTensor>& inputs,
+                      HashMap<std::string, ServingTensor>* outputs, int64_t timeout_us = 0);
+
+  struct Request;
+  struct Batch;
+
+ private:
+  void BatchingLoop();
+  void LaunchBatch(const std::shared_ptr<Batch>& batch) const;
+
+  std::string job_name_;
+  std::vector<std::string> input_op_names_;
+  std::vector<std::string> output_op_names_;
+  HashMap<std::string, std::string> input_op_name2push_job_name_;
+  HashMap<std::string, std::string> output_op_name2pull_job_name_;
+  HashMap<std::string, Shape> input_op_name2static_shape_;
+  HashMap<std::string, DataType> input_op_name2data_type_;
+  int64_t max_batch_size_;
+  int64_t batch_timeout_us_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::shared_ptr<Request>> pending_requests_;
+  bool is_closed_;
+  std::thread batching_thread_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_SERVING_INFERENCE_RUNTIME_H_
@@ -14,14 +14,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/thread/cpu_thread.h"
+#include "oneflow/core/thread/numa_topology.h"
 #include "oneflow/core/profiler/profiler.h"
 
 namespace oneflow {
 
 CpuThread::CpuThread(int64_t thrd_id) {
   set_thrd_id(thrd_id);
-  mut_actor_thread() = std::thread([this, thrd_id]() {
+  const int32_t numa_node = NumaNode4ThrdId(thrd_id);
+  mut_actor_thread() = std::thread([this, thrd_id, numa_node]() {
     OF_PROFILER_NAME_THIS_HOST_THREAD("CPU Actor : (" + std::to_string(thrd_id) + ")");
+    if (numa_node != -1) { BindThisThreadToNumaNode(numa_node); }
     ThreadCtx ctx;
 #ifdef WITH_CUDA
     ctx.cb_event_chan = nullptr;
@@ -0,0 +1,185 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/thread/numa_topology.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/resource_desc.h"
+
+#include <fstream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif  // __linux__
+
+namespace oneflow {
+
+namespace {
+
+thread_local int32_t this_thread_numa_node = -1;
+
+#ifdef __linux__
+
+const size_t kMaxSampledPageNum = 1024;
+
+bool TryReadFirstLine(const std::string& path, std::string* line) {
+  std::ifstream in_stream(path);
+  if (!in_stream.good()) { return false; }
+  return static_cast<bool>(std::getline(in_stream, *line));
+}
+
+void PageRange(const void* ptr, size_t size, uintptr_t* begin, uintptr_t* end) {
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  *begin = RoundUp(reinterpret_cast<uintptr_t>(ptr), page_size);
+  *end = (reinterpret_cast<uintptr_t>(ptr) + size) / page_size * page_size;
+}
+
+#endif  // __linux__
+
+}  // namespace
+
+NumaTopology::NumaTopology(const std::string& sysfs_node_dir) {
+#ifdef __linux__
+  DIR* dir = opendir(sysfs_node_dir.c_str());
+  if (dir != nullptr) {
+    std::vector<int32_t> node_ids;
+    while (dirent* entry = readdir(dir)) {
+      const std::string name = entry->d_name;
+      if (name.size() > 4 && name.substr(0, 4) == "node" && IsStrInt(name.substr(4))) {
+        node_ids.push_back(oneflow_cast<int32_t>(name.substr(4)));
+      }
+    }
+    closedir(dir);
+    std::sort(node_ids.begin(), node_ids.end());
+    for (int32_t node_id : node_ids) {
+      std::string cpu_list;
+      const std::string node_dir = JoinPath(sysfs_node_dir, "node" + std::to_string(node_id));
+      if (!TryReadFirstLine(JoinPath(node_dir, "cpulist"), &cpu_list)) { continue; }
+      node_ids_.push_back(node_id);
+      node2cpus_.push_back(ParseCpuList(cpu_list));
+    }
+  }
+#endif  // __linux__
+  if (node_ids_.empty()) {
+    node_ids_.push_back(0);
+    node2cpus_.emplace_back();
+  }
+}
+
+const NumaTopology& NumaTopology::Get() {
+  static const NumaTopology topology("/sys/devices/system/node");
+  return topology;
+}
+
+std::vector<int32_t> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int32_t> cpus;
+  Split(cpu_list, ",", [&](std::string&& range) {
+    if (range.empty()) { return; }
+    const size_t dash_pos = range.find('-');
+    if (dash_pos == std::string::npos) {
+      cpus.push_back(oneflow_cast<int32_t>(range));
+    } else {
+      const int32_t first = oneflow_cast<int32_t>(range.substr(0, dash_pos));
+      const int32_t last = oneflow_cast<int32_t>(range.substr(dash_pos + 1));
+      for (int32_t cpu = first; cpu <= last; ++cpu) { cpus.push_back(cpu); }
+    }
+  });
+  return cpus;
+}
+
+bool IsNumaAwareCpuPlacementEnabled() {
+  return Global<ResourceDesc, ForSession>::Get()->enable_numa_aware_cpu_placement()
+         && NumaTopology::Get().node_num() > 1;
+}
+
+int32_t NumaNode4ThrdId(int64_t thrd_id) {
+  if (!IsNumaAwareCpuPlacementEnabled()) { return -1; }
+  const int64_t first_cpu_thrd_id = Global<IDMgr>::Get()->GetCpuDeviceThrdId(0);
+  if (thrd_id < first_cpu_thrd_id) { return -1; }
+  return (thrd_id - first_cpu_thrd_id) % NumaTopology::Get().node_num();
+}
+
+void BindThisThreadToNumaNode(int32_t node) {
+#ifdef __linux__
+  const std::vector<int32_t>& cpus = NumaTopology::Get().cpus(node);
+  if (!cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int32_t cpu : cpus) { CPU_SET(cpu, &cpu_set); }
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &cpu_set) != 0) {
+      LOG(WARNING) << "failed to bind thread to numa node " << node << ", errno " << errno;
+    }
+  }
+#endif  // __linux__
+  this_thread_numa_node = node;
+}
+
+int32_t NumaNode4ThisThread() { return this_thread_numa_node; }
+
+void BindMemToNumaNode(void* ptr, size_t size, int32_t node) {
+#ifdef __linux__
+  uintptr_t begin = 0;
+  uintptr_t end = 0;
+  PageRange(ptr, size, &begin, &end);
+  if (begin >= end) { return; }
+  const int32_t node_id = NumaTopology::Get().node_id(node);
+  const size_t kBitNum = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> node_mask(node_id / kBitNum + 1, 0);
+  node_mask.at(node_id / kBitNum) |= 1UL << (node_id % kBitNum);
+  if (syscall(SYS_mbind, begin, end - begin, MPOL_BIND, node_mask.data(),
+              node_mask.size() * kBitNum + 1, MPOL_MF_MOVE)
+      != 0) {
+    LOG(WARNING) << "failed to bind memory to numa node " << node << ", errno " << errno;
+  }
+#endif  // __linux__
+}
+
+double RemotePageRatio(const void* ptr, size_t size, int32_t node) {
+#ifdef __linux__
+  uintptr_t begin = 0;
+  uintptr_t end = 0;
+  PageRange(ptr, size, &begin, &end);
+  if (begin >= end) { return 0; }
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t page_num = (end - begin) / page_size;
+  const size_t sampled_page_num = std::min(page_num, kMaxSampledPageNum);
+  std::vector<void*> pages(sampled_page_num);
+  FOR_RANGE(size_t, i, 0, sampled_page_num) {
+    pages.at(i) = reinterpret_cast<void*>(begin + i * page_num / sampled_page_num * page_size);
+  }
+  std::vector<int> status(sampled_page_num, 0);
+  if (syscall(SYS_move_pages, 0, sampled_page_num, pages.data(), nullptr, status.data(), 0) != 0) {
+    return 0;
+  }
+  const int32_t node_id = NumaTopology::Get().node_id(node);
+  size_t present_cnt = 0;
+  size_t remote_cnt = 0;
+  for (int page_node_id : status) {
+    if (page_node_id < 0) { continue; }
+    present_cnt += 1;
+    if (page_node_id != node_id) { remote_cnt += 1; }
+  }
+  return present_cnt == 0 ? 0 : 1.0 * remote_cnt / present_cnt;
+#else
+  return 0;
+#endif  // __linux__
+}
+
+}  // namespace oneflow
@@ -0,0 +1,60 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_THREAD_NUMA_TOPOLOGY_H_
+#define ONEFLOW_CORE_THREAD_NUMA_TOPOLOGY_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// NUMA nodes of this machine probed from sysfs. Nodes are indexed from 0 in the order of their
+// sysfs ids, a machine without the sysfs entries has one node with no cpu listed
+class NumaTopology final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(NumaTopology);
+  explicit NumaTopology(const std::string& sysfs_node_dir);
+  ~NumaTopology() = default;
+
+  static const NumaTopology& Get();
+
+  int32_t node_num() const { return node_ids_.size(); }
+  int32_t node_id(int32_t node) const { return node_ids_.at(node); }
+  const std::vector<int32_t>& cpus(int32_t node) const { return node2cpus_.at(node); }
+
+ private:
+  std::vector<int32_t> node_ids_;
+  std::vector<std::vector<int32_t>> node2cpus_;
+};
+
+// parse the sysfs cpu list, e.g. "0-3,8,10-11"
+std::vector<int32_t> ParseCpuList(const std::string& cpu_list);
+
+bool IsNumaAwareCpuPlacementEnabled();
+// -1 if the thread is not placed, gpu threads are left to their devices
+int32_t NumaNode4ThrdId(int64_t thrd_id);
+
+// pin this thread to the cpus of the node, the node is remembered as the home node of the thread
+void BindThisThreadToNumaNode(int32_t node);
+// -1 if this thread is not bound
+int32_t NumaNode4ThisThread();
+// pages of [ptr, ptr + size) not touched yet are allocated on the node, the touched ones are moved
+void BindMemToNumaNode(void* ptr, size_t size, int32_t node);
+// ratio of the pages in [ptr, ptr + size) not on the node, pages are sampled if there are many
+double RemotePageRatio(const void* ptr, size_t size, int32_t node);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_THREAD_NUMA_TOPOLOGY_H_
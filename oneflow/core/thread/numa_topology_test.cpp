@@ -0,0 +1,60 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/thread/numa_topology.h"
+#include "oneflow/core/common/util.h"
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oneflow {
+
+TEST(NumaTopology, parse_cpu_list) {
+  ASSERT_EQ(ParseCpuList("0-3,8,10-11"), (std::vector<int32_t>{0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_EQ(ParseCpuList("5"), std::vector<int32_t>{5});
+  ASSERT_TRUE(ParseCpuList("").empty());
+}
+
+#ifdef __linux__
+TEST(NumaTopology, probe_sysfs) {
+  char dir_template[] = "/tmp/numa_topology_test_XXXXXX";
+  const std::string dir = mkdtemp(dir_template);
+  const auto WriteCpuList = [&](const std::string& node, const std::string& cpu_list) {
+    const std::string node_dir = dir + "/" + node;
+    ASSERT_EQ(mkdir(node_dir.c_str(), 0755), 0);
+    std::ofstream(node_dir + "/cpulist") << cpu_list << "\n";
+  };
+  WriteCpuList("node1", "4-7");
+  WriteCpuList("node0", "0-3");
+  NumaTopology topology(dir);
+  ASSERT_EQ(topology.node_num(), 2);
+  ASSERT_EQ(topology.node_id(0), 0);
+  ASSERT_EQ(topology.node_id(1), 1);
+  ASSERT_EQ(topology.cpus(1), (std::vector<int32_t>{4, 5, 6, 7}));
+  for (const std::string& node : {"node0", "node1"}) {
+    unlink((dir + "/" + node + "/cpulist").c_str());
+    rmdir((dir + "/" + node).c_str());
+  }
+  rmdir(dir.c_str());
+}
+#endif  // __linux__
+
+TEST(NumaTopology, missing_sysfs) {
+  NumaTopology topology("/path/not/exist");
+  ASSERT_EQ(topology.node_num(), 1);
+  ASSERT_TRUE(topology.cpus(0).empty());
+}
+
+}  // namespace oneflow
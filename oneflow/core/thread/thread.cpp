@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/job/runtime_context.h"
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/actor/actor.h"
+#include "oneflow/core/profiler/timeline.h"
 #include "oneflow/core/job/global_for.h"
 
 namespace oneflow {
@@ -32,7 +33,8 @@ void Thread::AddTask(const TaskProto& task) {
   CHECK(id2task_.emplace(task.task_id(), task).second);
 }
 
-void Thread::EnqueueActorMsg(const ActorMsg& msg) {
+void Thread::EnqueueActorMsg(ActorMsg msg) {
+  msg.set_enqueue_ns(profiler::IsTimelineEnabled() ? profiler::TimelineNow() : -1);
   if (Global<ResourceDesc, ForSession>::Get()->thread_enable_local_message_queue()
       && std::this_thread::get_id() == actor_thread_.get_id()) {
     local_msg_queue_.push(msg);
@@ -42,8 +44,11 @@ void Thread::EnqueueActorMsg(const ActorMsg& msg) {
 }
 
 void Thread::PollMsgChannel(const ThreadCtx& thread_ctx) {
+  const int32_t idle_timeline_name_id =
+      profiler::TimelineNameId(profiler::kTimelineThreadIdle, "idle");
   while (true) {
     if (local_msg_queue_.empty()) {
+      profiler::TimelineEventGuard timeline_event_guard(idle_timeline_name_id);
       CHECK_EQ(msg_channel_.ReceiveMany(&local_msg_queue_), kChannelStatusSuccess);
     }
     ActorMsg msg = std::move(local_msg_queue_.front());
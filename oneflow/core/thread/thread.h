@@ -33,7 +33,7 @@ class Thread {
   void AddTask(const TaskProto&);
 
   Channel<ActorMsg>* GetMsgChannelPtr() { return &msg_channel_; }
-  void EnqueueActorMsg(const ActorMsg& msg);
+  void EnqueueActorMsg(ActorMsg msg);
 
   void JoinAllActor() { actor_thread_.join(); }
 
@@ -71,7 +71,7 @@ void SingleThreadLoop(size_t num, std::function<void(size_t i)> Callback) {
 }
 
 void MultiThreadLoop(size_t num, std::function<void(size_t i)> Callback) {
-  size_t thread_num = Global<ThreadPool>::Get()->thread_num();
+  size_t thread_num = Global<ThreadPool>::Get()->LocalThreadNum();
   thread_num = std::min(num, thread_num);
   BalancedSplitter bs(num, thread_num);
   BlockingCounter bc(thread_num);
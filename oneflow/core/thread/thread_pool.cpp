@@ -14,17 +14,43 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/thread/numa_topology.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#endif  // __linux__
 
 namespace oneflow {
 
+namespace {
+
+void SetThreadAffinity(std::thread* thread, const std::vector<int32_t>& cpus) {
+#ifdef __linux__
+  if (cpus.empty()) { return; }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int32_t cpu : cpus) { CPU_SET(cpu, &cpu_set); }
+  if (pthread_setaffinity_np(thread->native_handle(), sizeof(cpu_set_t), &cpu_set) != 0) {
+    LOG(WARNING) << "failed to set the cpu affinity of thread pool worker";
+  }
+#endif  // __linux__
+}
+
+}  // namespace
+
 ThreadPool::ThreadPool(int32_t thread_num)
-    : work_chans_(thread_num), threads_(thread_num), work_cnt_(0) {
+    : work_chans_(thread_num),
+      threads_(thread_num),
+      work_cnt_(0),
+      numa_node2worker_ids_(NumaTopology::Get().node_num()),
+      is_numa_partitioned_(false) {
   FOR_RANGE(int32_t, i, 0, thread_num) {
     Channel<std::function<void()>>* chan = &(work_chans_.at(i));
     threads_[i] = std::thread([chan]() {
       std::function<void()> work;
       while (chan->Receive(&work) == kChannelStatusSuccess) { work(); }
     });
+    numa_node2worker_ids_.at(i % numa_node2worker_ids_.size()).push_back(i);
   }
 }
 
@@ -35,10 +61,44 @@ ThreadPool::~ThreadPool() {
   }
 }
 
+int32_t ThreadPool::LocalThreadNum() const {
+  const std::vector<int32_t>* worker_ids = LocalWorkerIds();
+  return worker_ids == nullptr ? thread_num() : worker_ids->size();
+}
+
 void ThreadPool::AddWork(const std::function<void()>& work) {
-  const size_t cur_chan_idx =
-      work_cnt_.fetch_add(1, std::memory_order_relaxed) % work_chans_.size();
+  const size_t work_cnt = work_cnt_.fetch_add(1, std::memory_order_relaxed);
+  const std::vector<int32_t>* worker_ids = LocalWorkerIds();
+  const size_t cur_chan_idx = worker_ids == nullptr
+                                  ? work_cnt % work_chans_.size()
+                                  : worker_ids->at(work_cnt % worker_ids->size());
   work_chans_.at(cur_chan_idx).Send(work);
 }
 
+void ThreadPool::EnableNumaPartition() {
+  FOR_RANGE(int32_t, node, 0, numa_node2worker_ids_.size()) {
+    for (int32_t worker_id : numa_node2worker_ids_.at(node)) {
+      SetThreadAffinity(&threads_.at(worker_id), NumaTopology::Get().cpus(node));
+    }
+  }
+  is_numa_partitioned_ = true;
+}
+
+void ThreadPool::DisableNumaPartition() {
+  is_numa_partitioned_ = false;
+  std::vector<int32_t> all_cpus;
+  FOR_RANGE(int32_t, node, 0, NumaTopology::Get().node_num()) {
+    const std::vector<int32_t>& cpus = NumaTopology::Get().cpus(node);
+    all_cpus.insert(all_cpus.end(), cpus.begin(), cpus.end());
+  }
+  for (std::thread& thread : threads_) { SetThreadAffinity(&thread, all_cpus); }
+}
+
+const std::vector<int32_t>* ThreadPool::LocalWorkerIds() const {
+  if (!is_numa_partitioned_) { return nullptr; }
+  const int32_t node = NumaNode4ThisThread();
+  if (node == -1 || numa_node2worker_ids_.at(node).empty()) { return nullptr; }
+  return &numa_node2worker_ids_.at(node);
+}
+
 }  // namespace oneflow
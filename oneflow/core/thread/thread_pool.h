@@ -29,13 +29,25 @@ class ThreadPool final {
   ~ThreadPool();
 
   int32_t thread_num() const { return threads_.size(); }
+  // number of the workers running the works added by this thread
+  int32_t LocalThreadNum() const;
   void AddWork(const std::function<void()>& work);
 
+  // Workers are pinned to numa nodes round-robin, the works added by a thread bound to a numa node
+  // run on the workers of the node
+  void EnableNumaPartition();
+  void DisableNumaPartition();
+
  private:
+  // nullptr if the works of this thread are not dispatched to a numa node
+  const std::vector<int32_t>* LocalWorkerIds() const;
+
   std::vector<Channel<std::function<void()>>> work_chans_;
   std::vector<std::thread> threads_;
 
   std::atomic<size_t> work_cnt_;
+  std::vector<std::vector<int32_t>> numa_node2worker_ids_;
+  std::atomic<bool> is_numa_partitioned_;
 };
 
 }  // namespace oneflow
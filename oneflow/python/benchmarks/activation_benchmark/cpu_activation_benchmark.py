@@ -0,0 +1,115 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import math
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for cpu unary elementwise and activation kernels benchmark"
+)
+parser.add_argument("--elem_cnt", type=int, default=16 * 1024 * 1024, required=False)
+# elements compared against the float64 numpy/libm reference
+parser.add_argument("--check_elem_cnt", type=int, default=1024 * 1024, required=False)
+parser.add_argument(
+    "--funcs",
+    type=str,
+    default="exp,log,tanh,erf,sigmoid,gelu,relu,leaky_relu,hardtanh",
+    required=False,
+)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+np_erf = np.vectorize(math.erf)
+
+# name -> (flow function, float64 reference, input range)
+funcs = {
+    "exp": (flow.math.exp, np.exp, (-80.0, 80.0)),
+    "log": (flow.math.log, np.log, (1e-6, 1e6)),
+    "tanh": (flow.math.tanh, np.tanh, (-10.0, 10.0)),
+    "erf": (flow.math.erf, np_erf, (-5.0, 5.0)),
+    "sigmoid": (flow.math.sigmoid, lambda x: 1.0 / (1.0 + np.exp(-x)), (-20.0, 20.0)),
+    "gelu": (
+        flow.math.gelu,
+        lambda x: 0.5 * x * (1.0 + np_erf(x / math.sqrt(2.0))),
+        (-10.0, 10.0),
+    ),
+    "relu": (flow.math.relu, lambda x: np.maximum(x, 0.0), (-10.0, 10.0)),
+    "leaky_relu": (
+        lambda x: flow.nn.leaky_relu(x, alpha=0.2),
+        lambda x: np.where(x > 0, x, x * 0.2),
+        (-10.0, 10.0),
+    ),
+    "hardtanh": (flow.nn.hardtanh, lambda x: np.clip(x, -1.0, 1.0), (-10.0, 10.0)),
+}
+
+
+def make_job(func, elem_cnt):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(function_config=func_config)
+    def job(x: oft.Numpy.Placeholder((elem_cnt,), dtype=flow.float)):
+        with flow.scope.placement("cpu", "0:0"):
+            return func(x)
+
+    return job
+
+
+def check_accuracy(name):
+    func, ref_func, (low, high) = funcs[name]
+    x = np.random.uniform(low, high, size=(args.check_elem_cnt,)).astype(np.float32)
+    y = make_job(func, args.check_elem_cnt)(x).get().numpy().astype(np.float64)
+    ref = ref_func(x.astype(np.float64))
+    abs_err = np.abs(y - ref)
+    rel_err = abs_err / np.maximum(np.abs(ref), np.finfo(np.float32).tiny)
+    return np.max(abs_err), np.max(rel_err)
+
+
+def benchmark(name):
+    func, _, (low, high) = funcs[name]
+    x = np.random.uniform(low, high, size=(args.elem_cnt,)).astype(np.float32)
+    job = make_job(func, args.elem_cnt)
+    for _ in range(args.warmup_iter_num):
+        job(x).get()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job(x).get()
+    duration = (time.perf_counter() - start) / args.iter_num
+    max_abs_err, max_rel_err = check_accuracy(name)
+    print(
+        "{:<10} {:10.3f} ms {:8.3f} Gelem/s abs err {:.3e} rel err {:.3e}".format(
+            name,
+            duration * 1000,
+            args.elem_cnt / duration / 1e9,
+            max_abs_err,
+            max_rel_err,
+        )
+    )
+
+
+if __name__ == "__main__":
+    # ONEFLOW_CPU_FAST_MATH_ISA=avx2|sse2|scalar lowers the simd instruction set
+    for name in args.funcs.split(","):
+        benchmark(name)
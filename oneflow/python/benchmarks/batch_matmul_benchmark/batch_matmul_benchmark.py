@@ -0,0 +1,124 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(description="flags for cpu batch matmul benchmark")
+parser.add_argument("--batch_size", type=int, default=8, required=False)
+parser.add_argument("--num_heads", type=int, default=12, required=False)
+parser.add_argument("--seq_lengths", type=str, default="64,128,384", required=False)
+parser.add_argument("--head_size", type=int, default=64, required=False)
+parser.add_argument("--gemm_sizes", type=str, default="1024,2048,4096", required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def run(name, job, inputs, flop):
+    for _ in range(args.warmup_iter_num):
+        job(*inputs)
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job(*inputs)
+    duration = (time.perf_counter() - start) / args.iter_num
+    print(
+        "{:<32} {:10.3f} ms {:10.1f} GFLOP/s".format(
+            name, duration * 1000, flop / duration / 1e9
+        )
+    )
+
+
+def benchmark_attention(seq_length):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    shape = (args.batch_size, args.num_heads, seq_length, args.head_size)
+
+    # scores = q * k^T and context = probs * v of a self attention layer
+    @flow.global_function(function_config=func_config)
+    def attention_job(
+        q: oft.Numpy.Placeholder(shape),
+        k: oft.Numpy.Placeholder(shape),
+        v: oft.Numpy.Placeholder(shape),
+    ) -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            scores = flow.matmul(q, k, transpose_b=True)
+            return flow.matmul(scores, v)
+
+    inputs = [np.random.rand(*shape).astype(np.float32) for _ in range(3)]
+    flop = 2 * 2 * args.batch_size * args.num_heads * seq_length ** 2 * args.head_size
+    run("attention seq_length {}".format(seq_length), attention_job, inputs, flop)
+
+
+def benchmark_gemm(size):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+
+    # a single large gemm, which the blas library parallelizes by itself
+    @flow.global_function(function_config=func_config)
+    def gemm_job(
+        a: oft.Numpy.Placeholder((size, size)), b: oft.Numpy.Placeholder((size, size))
+    ) -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.matmul(a, b)
+
+    inputs = [np.random.rand(size, size).astype(np.float32) for _ in range(2)]
+    run("gemm {}x{}x{}".format(size, size, size), gemm_job, inputs, 2 * size ** 3)
+
+
+def benchmark_dense(seq_length, enable_prepacking):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.enable_cpu_matmul_weight_prepacking(enable_prepacking)
+    hidden_size = args.num_heads * args.head_size
+    m = args.batch_size * seq_length
+
+    # the qkv projection of the same layer, whose weight is a variable
+    @flow.global_function(type="predict", function_config=func_config)
+    def dense_job(x: oft.Numpy.Placeholder((m, hidden_size))) -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            weight = flow.get_variable(
+                "weight",
+                shape=(hidden_size, 3 * hidden_size),
+                initializer=flow.random_uniform_initializer(),
+            )
+            return flow.matmul(x, weight)
+
+    x = np.random.rand(m, hidden_size).astype(np.float32)
+    flop = 2 * m * hidden_size * 3 * hidden_size
+    run(
+        "qkv dense seq_length {} prepack {}".format(seq_length, int(enable_prepacking)),
+        dense_job,
+        [x],
+        flop,
+    )
+
+
+if __name__ == "__main__":
+    for size in [int(n) for n in args.gemm_sizes.split(",")]:
+        benchmark_gemm(size)
+    for seq_length in [int(n) for n in args.seq_lengths.split(",")]:
+        benchmark_attention(seq_length)
+        benchmark_dense(seq_length, False)
+        benchmark_dense(seq_length, True)
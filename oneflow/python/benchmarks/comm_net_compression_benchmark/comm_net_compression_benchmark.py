@@ -0,0 +1,94 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+# Measures the throughput of sending a sparse relu output from machine 0 to machine 1
+# with and without comm net compression. To benchmark over loopback, run on a host
+# reachable by ssh with the default --node_list, and rate limit the loopback device to
+# emulate a slower link, e.g.
+#   tc qdisc add dev lo root tbf rate 10gbit burst 1mb latency 10ms
+# and remove the limit afterwards with
+#   tc qdisc del dev lo root
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(description="flags for comm net compression benchmark")
+parser.add_argument("--node_list", type=str, default="127.0.0.1,127.0.0.2")
+parser.add_argument("--ctrl_port", type=int, default=12138, required=False)
+parser.add_argument("--elem_num_mega", type=int, default=16, required=False)
+parser.add_argument(
+    "--positive_ratio",
+    type=float,
+    default=0.1,
+    required=False,
+    help="ratio of the relu output that is not zero",
+)
+parser.add_argument(
+    "--compression_threshold_kbyte", type=int, default=1024, required=False
+)
+parser.add_argument("--iter_num", type=int, default=50, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=5, required=False)
+args = parser.parse_args()
+
+
+def make_job(compression_threshold_kbyte):
+    flow.clear_default_session()
+    flow.config.comm_net_compression_threshold_kbyte(compression_threshold_kbyte)
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+    shape = (args.elem_num_mega, 1024 * 1024)
+
+    @flow.global_function(function_config=func_config)
+    def transfer_job(x: oft.Numpy.Placeholder(shape)) -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            y = flow.math.relu(x)
+        with flow.scope.placement("cpu", "1:0"):
+            return flow.math.reduce_sum(y)
+
+    return transfer_job
+
+
+def run(job, x):
+    for _ in range(args.warmup_iter_num):
+        job(x)
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job(x)
+    return (time.perf_counter() - start) / args.iter_num
+
+
+if __name__ == "__main__":
+    flow.env.ctrl_port(args.ctrl_port)
+    flow.env.machine([{"addr": addr} for addr in args.node_list.split(",")])
+    flow.deprecated.init_worker(scp_binary=True, use_uuid=True)
+    x = np.random.randn(args.elem_num_mega, 1024 * 1024).astype(np.float32)
+    # shifts x so that a positive_ratio of the relu output is not zero
+    x -= np.quantile(x[0], 1 - args.positive_ratio)
+    mbyte = x.nbytes / 1024 / 1024
+    # alternate to cancel out drift of the machines
+    off_s = []
+    on_s = []
+    for _ in range(3):
+        off_s.append(run(make_job(0), x))
+        on_s.append(run(make_job(args.compression_threshold_kbyte), x))
+    print("compression off {:10.1f} MB/s".format(mbyte / min(off_s)))
+    print("compression on  {:10.1f} MB/s".format(mbyte / min(on_s)))
+    flow.deprecated.delete_worker()
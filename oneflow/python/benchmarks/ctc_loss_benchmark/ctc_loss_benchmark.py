@@ -0,0 +1,108 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(description="flags for cpu ctc loss benchmark")
+parser.add_argument("--batch_size", type=int, default=32, required=False)
+parser.add_argument("--input_lengths", type=str, default="100,400", required=False)
+parser.add_argument("--target_lengths", type=str, default="20,80", required=False)
+parser.add_argument("--num_classes", type=str, default="32,1000,5000", required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def make_job(input_length, target_length, num_classes):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(type="train", function_config=func_config)
+    def ctc_loss_job(
+        logits: oft.Numpy.Placeholder(
+            (input_length, args.batch_size, num_classes), dtype=flow.float
+        ),
+        targets: oft.Numpy.Placeholder(
+            (args.batch_size, target_length), dtype=flow.int32
+        ),
+        input_lengths: oft.Numpy.Placeholder((args.batch_size,), dtype=flow.int32),
+        target_lengths: oft.Numpy.Placeholder((args.batch_size,), dtype=flow.int32),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            v = flow.get_variable(
+                name="v",
+                shape=(1,),
+                initializer=flow.zeros_initializer(),
+            )
+            log_probs = flow.nn.logsoftmax(logits + v, axis=2)
+            loss = flow.ctc_loss(
+                log_probs, targets, input_lengths, target_lengths, reduction="mean"
+            )
+            flow.optimizer.SGD(
+                flow.optimizer.PiecewiseConstantScheduler([], [1e-3]), momentum=0
+            ).minimize(loss)
+            return loss
+
+    return ctc_loss_job
+
+
+def benchmark(input_length, target_length, num_classes):
+    job = make_job(input_length, target_length, num_classes)
+    logits = np.random.uniform(
+        size=(input_length, args.batch_size, num_classes)
+    ).astype(np.float32)
+    targets = np.random.randint(
+        1, num_classes, size=(args.batch_size, target_length)
+    ).astype(np.int32)
+    # lengths vary across the batch as in real utterances
+    input_lengths = np.random.randint(
+        input_length // 2, input_length + 1, size=(args.batch_size,)
+    ).astype(np.int32)
+    target_lengths = np.random.randint(
+        target_length // 2, target_length + 1, size=(args.batch_size,)
+    ).astype(np.int32)
+    target_lengths = np.minimum(target_lengths, input_lengths // 2)
+
+    def run():
+        job(logits, targets, input_lengths, target_lengths).get()
+
+    for _ in range(args.warmup_iter_num):
+        run()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        run()
+    duration = (time.perf_counter() - start) / args.iter_num
+    print(
+        "input {:<5} target {:<5} classes {:<6}".format(
+            input_length, target_length, num_classes
+        ),
+        "forward+backward {:10.3f} ms".format(duration * 1000),
+    )
+
+
+if __name__ == "__main__":
+    for input_length in [int(s) for s in args.input_lengths.split(",")]:
+        for target_length in [int(s) for s in args.target_lengths.split(",")]:
+            for num_classes in [int(s) for s in args.num_classes.split(",")]:
+                benchmark(input_length, target_length, num_classes)
@@ -0,0 +1,104 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for cpu gather and unsorted segment sum benchmark"
+)
+parser.add_argument("--table_size", type=int, default=100000, required=False)
+parser.add_argument("--embedding_sizes", type=str, default="16,64,256", required=False)
+parser.add_argument("--id_nums", type=str, default="16384,262144", required=False)
+# 0 draws ids uniformly, otherwise ids follow a zipf distribution of the exponent
+parser.add_argument("--skews", type=str, default="0,1.05,1.5", required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def make_jobs(embedding_size, id_num):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(function_config=func_config)
+    def gather_job(ids: oft.Numpy.Placeholder((id_num,), dtype=flow.int32)):
+        with flow.scope.placement("cpu", "0:0"):
+            embedding_table = flow.get_variable(
+                name="embeddings",
+                shape=(args.table_size, embedding_size),
+                initializer=flow.random_uniform_initializer(minval=-0.1, maxval=0.1),
+            )
+            # the reduction keeps fetching the output out of the measurement
+            return flow.math.reduce_sum(flow.gather(embedding_table, ids))
+
+    @flow.global_function(function_config=func_config)
+    def segment_sum_job(
+        data: oft.Numpy.Placeholder((id_num, embedding_size), dtype=flow.float),
+        ids: oft.Numpy.Placeholder((id_num,), dtype=flow.int32),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.math.reduce_sum(
+                flow.math.unsorted_segment_sum(
+                    data=data, segment_ids=ids, num_segments=args.table_size
+                )
+            )
+
+    return gather_job, segment_sum_job
+
+
+def gen_ids(skew, id_num):
+    if skew == 0:
+        ids = np.random.randint(args.table_size, size=(id_num,))
+    else:
+        ids = (np.random.zipf(skew, size=(id_num,)) - 1) % args.table_size
+    return ids.astype(np.int32)
+
+
+def measure(run):
+    for _ in range(args.warmup_iter_num):
+        run()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        run()
+    return (time.perf_counter() - start) / args.iter_num
+
+
+def benchmark(embedding_size, id_num, skew):
+    gather_job, segment_sum_job = make_jobs(embedding_size, id_num)
+    ids = gen_ids(skew, id_num)
+    data = np.random.uniform(-1, 1, size=(id_num, embedding_size)).astype(np.float32)
+    gather_duration = measure(lambda: gather_job(ids).get())
+    segment_sum_duration = measure(lambda: segment_sum_job(data, ids).get())
+    print(
+        "width {:<5} ids {:<8} skew {:<5}".format(embedding_size, id_num, skew),
+        "gather {:10.3f} ms".format(gather_duration * 1000),
+        "segment_sum {:10.3f} ms".format(segment_sum_duration * 1000),
+    )
+
+
+if __name__ == "__main__":
+    for embedding_size in [int(s) for s in args.embedding_sizes.split(",")]:
+        for id_num in [int(s) for s in args.id_nums.split(",")]:
+            for skew in [float(s) for s in args.skews.split(",")]:
+                benchmark(embedding_size, id_num, skew)
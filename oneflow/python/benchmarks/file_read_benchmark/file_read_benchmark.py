@@ -0,0 +1,106 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import os
+import struct
+import subprocess
+import tempfile
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.core.record.record_pb2 as record_pb
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for ofrecord reading through posix pread and io_uring"
+)
+parser.add_argument(
+    "--data_dir", type=str, default="", help="a dir on the disk to test, tmp by default"
+)
+parser.add_argument("--data_part_num", type=int, default=4, required=False)
+parser.add_argument("--part_mbyte", type=int, default=256, required=False)
+parser.add_argument("--record_kbyte", type=int, default=128, required=False)
+parser.add_argument("--batch_size", type=int, default=64, required=False)
+parser.add_argument("--iter_num", type=int, default=50, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+parser.add_argument(
+    "--drop_caches",
+    action="store_true",
+    help="drop the page cache before every run to measure the disk, needs root",
+)
+args = parser.parse_args()
+
+
+def write_data_parts(data_dir):
+    elem_num = args.record_kbyte * 1024 // 4
+    record = record_pb.OFRecord()
+    record.feature["x"].float_list.value.extend(np.random.rand(elem_num).tolist())
+    record_bytes = record.SerializeToString()
+    record_num = args.part_mbyte * 1024 * 1024 // (len(record_bytes) + 8)
+    for i in range(args.data_part_num):
+        with open(os.path.join(data_dir, "part-{}".format(i)), "wb") as f:
+            for _ in range(record_num):
+                f.write(struct.pack("q", len(record_bytes)))
+                f.write(record_bytes)
+    return elem_num
+
+
+def benchmark(name, data_dir, elem_num, io_uring, direct_io):
+    flow.clear_default_session()
+    flow.config.enable_io_uring(io_uring)
+    flow.config.enable_direct_io(direct_io)
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(function_config=func_config)
+    def read_job() -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            record = flow.data.ofrecord_reader(
+                data_dir,
+                batch_size=args.batch_size,
+                data_part_num=args.data_part_num,
+                part_name_suffix_length=-1,
+            )
+            x = flow.data.ofrecord_raw_decoder(
+                record, "x", shape=(elem_num,), dtype=flow.float
+            )
+            return flow.math.reduce_sum(x)
+
+    if args.drop_caches:
+        subprocess.check_call("sync && echo 3 > /proc/sys/vm/drop_caches", shell=True)
+    for _ in range(args.warmup_iter_num):
+        read_job()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        read_job()
+    duration = (time.perf_counter() - start) / args.iter_num
+    batch_mbyte = args.batch_size * elem_num * 4 / 1024 / 1024
+    print(
+        "{:<20} {:10.3f} ms/batch {:10.1f} MB/s".format(
+            name, duration * 1000, batch_mbyte / duration
+        )
+    )
+
+
+if __name__ == "__main__":
+    with tempfile.TemporaryDirectory(dir=args.data_dir or None) as data_dir:
+        elem_num = write_data_parts(data_dir)
+        benchmark("posix pread", data_dir, elem_num, False, False)
+        benchmark("io_uring", data_dir, elem_num, True, False)
+        benchmark("io_uring O_DIRECT", data_dir, elem_num, True, True)
@@ -0,0 +1,115 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import oneflow as flow
+
+parser = argparse.ArgumentParser(description="flags for image decode benchmark")
+parser.add_argument(
+    "--data_dir", type=str, default="/dataset/imagenet_16_same_pics/ofrecord"
+)
+parser.add_argument("--data_part_num", type=int, default=1, required=False)
+parser.add_argument("--batch_size", type=int, default=256, required=False)
+parser.add_argument("--cpu_device_num", type=int, default=1, required=False)
+parser.add_argument("--image_size", type=int, default=224, required=False)
+parser.add_argument("--iter_num", type=int, default=50, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=5, required=False)
+args = parser.parse_args()
+
+rgb_mean = [123.68, 116.779, 103.939]
+rgb_std = [58.393, 57.12, 57.375]
+
+
+def make_func_config():
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+    return func_config
+
+
+def load_ofrecord():
+    return flow.data.ofrecord_reader(
+        args.data_dir,
+        batch_size=args.batch_size,
+        data_part_num=args.data_part_num,
+        part_name_suffix_length=5,
+        random_shuffle=True,
+    )
+
+
+@flow.global_function(function_config=make_func_config())
+def op_chain_job():
+    with flow.scope.placement("cpu", "0:0-{}".format(args.cpu_device_num - 1)):
+        ofrecord = load_ofrecord()
+        image = flow.data.OFRecordImageDecoderRandomCrop(
+            ofrecord, "encoded", color_space="RGB"
+        )
+        image = flow.image.Resize(
+            image,
+            resize_x=args.image_size,
+            resize_y=args.image_size,
+            color_space="RGB",
+        )
+        mirror = flow.random.CoinFlip(batch_size=args.batch_size)
+        normal = flow.image.CropMirrorNormalize(
+            image,
+            mirror_blob=mirror,
+            color_space="RGB",
+            mean=rgb_mean,
+            std=rgb_std,
+            output_dtype=flow.float,
+        )
+    return normal
+
+
+@flow.global_function(function_config=make_func_config())
+def fused_job():
+    with flow.scope.placement("cpu", "0:0-{}".format(args.cpu_device_num - 1)):
+        ofrecord = load_ofrecord()
+        mirror = flow.random.CoinFlip(batch_size=args.batch_size)
+        normal = flow.data.OFRecordImageDecoderRandomCropResizeNormalize(
+            ofrecord,
+            "encoded",
+            target_size=(args.image_size, args.image_size),
+            mirror_blob=mirror,
+            color_space="RGB",
+            mean=rgb_mean,
+            std=rgb_std,
+        )
+    return normal
+
+
+def benchmark(name, job):
+    for _ in range(args.warmup_iter_num):
+        job().get()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job().get()
+    duration = time.perf_counter() - start
+    print(
+        "{:<24} {:10.1f} images/s".format(
+            name, args.iter_num * args.batch_size / duration
+        )
+    )
+
+
+if __name__ == "__main__":
+    flow.config.cpu_device_num(args.cpu_device_num)
+    benchmark("op chain", op_chain_job)
+    benchmark("fused", fused_job)
@@ -0,0 +1,111 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import shutil
+import tempfile
+import time
+
+import oneflow as flow
+
+parser = argparse.ArgumentParser(description="flags for image reader cache benchmark")
+parser.add_argument(
+    "--data_dir", type=str, default="/dataset/imagenet_16_same_pics/ofrecord"
+)
+parser.add_argument("--data_part_num", type=int, default=1, required=False)
+parser.add_argument("--batch_size", type=int, default=256, required=False)
+parser.add_argument("--cpu_device_num", type=int, default=1, required=False)
+parser.add_argument(
+    "--iter_num_per_epoch",
+    type=int,
+    default=50,
+    required=False,
+    help="iterations of one pass over the dataset",
+)
+parser.add_argument("--epoch_num", type=int, default=3, required=False)
+parser.add_argument("--cache_capacity_mb", type=int, default=8192, required=False)
+parser.add_argument(
+    "--cache_dir",
+    type=str,
+    default="",
+    required=False,
+    help="directory of the file cache, a temporary one is used when empty",
+)
+args = parser.parse_args()
+
+
+def make_job(cache_capacity_mb, cache_dir):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(function_config=func_config)
+    def reader_job():
+        with flow.scope.placement("cpu", "0:0-{}".format(args.cpu_device_num - 1)):
+            image, label = flow.data.ofrecord_image_classification_reader(
+                args.data_dir,
+                image_feature_name="encoded",
+                label_feature_name="class/label",
+                batch_size=args.batch_size,
+                data_part_num=args.data_part_num,
+                part_name_suffix_length=5,
+                random_shuffle=True,
+                shuffle_after_epoch=True,
+                color_space="RGB",
+                cache_capacity_mb=cache_capacity_mb,
+                cache_dir=cache_dir,
+                # a fixed name lets later runs find the cache file
+                name="image_classification_reader",
+            )
+        return label
+
+    return reader_job
+
+
+def benchmark(name, cache_capacity_mb=0, cache_dir=""):
+    job = make_job(cache_capacity_mb, cache_dir)
+    for epoch in range(args.epoch_num):
+        start = time.perf_counter()
+        for _ in range(args.iter_num_per_epoch):
+            job().get()
+        duration = time.perf_counter() - start
+        print(
+            "{:<24} epoch {} {:10.1f} images/s".format(
+                name, epoch, args.iter_num_per_epoch * args.batch_size / duration
+            )
+        )
+
+
+if __name__ == "__main__":
+    flow.config.cpu_device_num(args.cpu_device_num)
+    benchmark("no cache")
+    benchmark("memory cache", cache_capacity_mb=args.cache_capacity_mb)
+    cache_dir = args.cache_dir or tempfile.mkdtemp()
+    try:
+        benchmark(
+            "file cache", cache_capacity_mb=args.cache_capacity_mb, cache_dir=cache_dir
+        )
+        # a later run reuses the file written by the previous one from its first epoch
+        benchmark(
+            "file cache reused",
+            cache_capacity_mb=args.cache_capacity_mb,
+            cache_dir=cache_dir,
+        )
+    finally:
+        if not args.cache_dir:
+            shutil.rmtree(cache_dir)
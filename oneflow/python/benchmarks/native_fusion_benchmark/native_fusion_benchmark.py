@@ -0,0 +1,119 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for xrt native fusion of cpu elementwise chains benchmark"
+)
+parser.add_argument("--batch_size", type=int, default=64, required=False)
+parser.add_argument("--seq_length", type=int, default=128, required=False)
+parser.add_argument("--hidden_size", type=int, default=1024, required=False)
+parser.add_argument("--chains", type=str, default="gelu,layer_norm", required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def gelu_chain(x, mean, rstd, gamma, beta):
+    # the feed forward activation of bert, bias_add -> gelu, followed by a scale
+    y = flow.nn.bias_add(x, beta, data_format="NHWC")
+    y = flow.math.gelu(y)
+    return flow.math.multiply(y, gamma)
+
+
+def layer_norm_chain(x, mean, rstd, gamma, beta):
+    # the elementwise part of layer norm, the moments are fed to keep out the reductions
+    y = flow.math.subtract(x, mean)
+    y = flow.math.multiply(y, rstd)
+    y = flow.math.multiply(y, gamma)
+    return flow.math.add(y, beta)
+
+
+chains = {"gelu": gelu_chain, "layer_norm": layer_norm_chain}
+
+
+def make_job(chain, use_native_fusion):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+    func_config.use_xla_jit(False)
+    func_config.use_tensorrt(False)
+    func_config.use_native_fusion(use_native_fusion)
+    shape = (args.batch_size * args.seq_length, args.hidden_size)
+
+    @flow.global_function(function_config=func_config)
+    def job(
+        x: oft.Numpy.Placeholder(shape, dtype=flow.float),
+        mean: oft.Numpy.Placeholder((shape[0], 1), dtype=flow.float),
+        rstd: oft.Numpy.Placeholder((shape[0], 1), dtype=flow.float),
+        gamma: oft.Numpy.Placeholder((shape[1],), dtype=flow.float),
+        beta: oft.Numpy.Placeholder((shape[1],), dtype=flow.float),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            return chain(x, mean, rstd, gamma, beta)
+
+    return job
+
+
+def make_inputs():
+    shape = (args.batch_size * args.seq_length, args.hidden_size)
+    x = np.random.uniform(-3.0, 3.0, size=shape).astype(np.float32)
+    mean = np.mean(x, axis=-1, keepdims=True)
+    rstd = 1.0 / np.sqrt(np.var(x, axis=-1, keepdims=True) + 1e-5)
+    gamma = np.random.uniform(0.5, 1.5, size=shape[-1:]).astype(np.float32)
+    beta = np.random.uniform(-0.5, 0.5, size=shape[-1:]).astype(np.float32)
+    return x, mean, rstd.astype(np.float32), gamma, beta
+
+
+def run(name, use_native_fusion, inputs):
+    job = make_job(chains[name], use_native_fusion)
+    for _ in range(args.warmup_iter_num):
+        job(*inputs).get()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        y = job(*inputs).get().numpy()
+    return (time.perf_counter() - start) / args.iter_num, y
+
+
+def benchmark(name):
+    inputs = make_inputs()
+    unfused_duration, unfused_y = run(name, False, inputs)
+    fused_duration, fused_y = run(name, True, inputs)
+    elem_cnt = inputs[0].size
+    print(
+        "{:<10} unfused {:8.3f} ms fused {:8.3f} ms {:6.2f}x {:8.3f} Gelem/s "
+        "max abs diff {:.3e}".format(
+            name,
+            unfused_duration * 1000,
+            fused_duration * 1000,
+            unfused_duration / fused_duration,
+            elem_cnt / fused_duration / 1e9,
+            np.max(np.abs(fused_y - unfused_y)),
+        )
+    )
+
+
+if __name__ == "__main__":
+    for name in args.chains.split(","):
+        benchmark(name)
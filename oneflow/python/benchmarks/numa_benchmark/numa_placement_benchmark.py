@@ -0,0 +1,78 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for numa aware cpu placement benchmark"
+)
+parser.add_argument("--cpu_device_num", type=int, default=8, required=False)
+parser.add_argument("--elem_cnt", type=int, default=64 * 1024 * 1024, required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def make_job(op, numa_aware):
+    flow.clear_default_session()
+    flow.config.cpu_device_num(args.cpu_device_num)
+    flow.config.enable_numa_aware_cpu_placement(numa_aware)
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(function_config=func_config)
+    def job(x: oft.Numpy.Placeholder((args.elem_cnt,))):
+        with flow.scope.placement("cpu", "0:0-{}".format(args.cpu_device_num - 1)):
+            return flow.math.reduce_sum(op(flow.identity(x)))
+
+    return job
+
+
+def benchmark(name, op, numa_aware):
+    job = make_job(op, numa_aware)
+    x = np.random.rand(args.elem_cnt).astype(np.float32)
+    for _ in range(args.warmup_iter_num):
+        job(x).get()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job(x).get()
+    duration = (time.perf_counter() - start) / args.iter_num
+    print(
+        "{:<8} numa_aware {:<6} {:10.3f} ms {:10.2f} GB/s".format(
+            name,
+            str(numa_aware),
+            duration * 1000,
+            args.elem_cnt * 4 * 2 / duration / 1e9,
+        )
+    )
+
+
+if __name__ == "__main__":
+    ops = [
+        ("add", lambda x: x + x),
+        ("relu", lambda x: flow.math.relu(x)),
+        ("cast", lambda x: flow.cast(flow.cast(x, flow.double), flow.float)),
+    ]
+    for name, op in ops:
+        for numa_aware in [False, True]:
+            benchmark(name, op, numa_aware)
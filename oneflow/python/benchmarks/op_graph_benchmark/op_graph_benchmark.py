@@ -0,0 +1,132 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+import oneflow as flow
+import oneflow_api
+import oneflow.python.framework.session_context as session_ctx
+
+parser = argparse.ArgumentParser(description="flags for op graph benchmark")
+parser.add_argument("--branch_num", type=int, default=64, required=False)
+parser.add_argument("--depth", type=int, default=64, required=False)
+parser.add_argument("--hidden_size", type=int, default=16, required=False)
+parser.add_argument("--cpu_device_num", type=int, default=1, required=False)
+parser.add_argument(
+    "--thread_nums",
+    type=str,
+    default="1,0",
+    required=False,
+    help="graph traversal threads of each run, 1 is serial and 0 one per cpu",
+)
+parser.add_argument("--repeat_num", type=int, default=3, required=False)
+parser.add_argument(
+    "--child", action="store_true", required=False, help="run one measurement"
+)
+args = parser.parse_args()
+
+
+def make_job():
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    # branch_num independent chains of depth ops, so that every level of the op graph
+    # is about branch_num ops wide, plus their backward
+    @flow.global_function(type="train", function_config=func_config)
+    def wide_job():
+        device = "0:0-{}".format(args.cpu_device_num - 1)
+        with flow.scope.placement("cpu", device):
+            outs = []
+            for branch in range(args.branch_num):
+                x = flow.get_variable(
+                    "x_{}".format(branch),
+                    shape=(args.cpu_device_num * 4, args.hidden_size),
+                    dtype=flow.float,
+                    initializer=flow.ones_initializer(),
+                )
+                for _ in range(args.depth):
+                    x = flow.math.tanh(flow.math.multiply(x, x))
+                outs.append(flow.math.reduce_sum(x))
+            loss = flow.math.add_n(outs)
+            flow.optimizer.SGD(
+                flow.optimizer.PiecewiseConstantScheduler([], [1e-4]), momentum=0
+            ).minimize(loss)
+            return loss
+
+
+def run_child():
+    # job completion runs the job passes, each of which builds an OpGraph and infers its
+    # time shapes and logical blob descs
+    complete_seconds = []
+    complete = oneflow_api.CurJobBuildAndInferCtx_Complete
+
+    def timed_complete():
+        start = time.perf_counter()
+        complete()
+        complete_seconds.append(time.perf_counter() - start)
+
+    oneflow_api.CurJobBuildAndInferCtx_Complete = timed_complete
+    make_job()
+    start = time.perf_counter()
+    session_ctx.GetDefaultSession().TryInit()
+    init_seconds = time.perf_counter() - start
+    print("{:.3f} {:.3f}".format(sum(complete_seconds), init_seconds))
+
+
+def run(thread_num):
+    env = dict(os.environ)
+    if thread_num > 0:
+        env["ONEFLOW_GRAPH_TRAVERSAL_THREAD_NUM"] = str(thread_num)
+    else:
+        env.pop("ONEFLOW_GRAPH_TRAVERSAL_THREAD_NUM", None)
+    command = [sys.executable, os.path.abspath(__file__), "--child"] + sys.argv[1:]
+    output = subprocess.check_output(command, env=env).decode().strip().split("\n")
+    complete_seconds, init_seconds = [float(x) for x in output[-1].split()]
+    return complete_seconds, init_seconds
+
+
+def main():
+    print(
+        "{} branches of depth {}, {} cpu devices".format(
+            args.branch_num, args.depth, args.cpu_device_num
+        )
+    )
+    for thread_num in [int(x) for x in args.thread_nums.split(",")]:
+        results = sorted(run(thread_num) for _ in range(args.repeat_num))
+        complete_seconds, init_seconds = results[len(results) // 2]
+        if thread_num == 1:
+            name = "serial"
+        else:
+            name = "threads {}".format(thread_num or "all")
+        print(
+            "{:<16} job completion {:8.3f} s session init {:8.3f} s".format(
+                name, complete_seconds, init_seconds
+            )
+        )
+
+
+if __name__ == "__main__":
+    if args.child:
+        run_child()
+    else:
+        main()
@@ -0,0 +1,107 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for cpu multi tensor model update benchmark"
+)
+parser.add_argument("--var_num", type=int, default=1000, required=False)
+parser.add_argument("--small_var_size", type=int, default=256, required=False)
+parser.add_argument(
+    "--large_var_size", type=int, default=16 * 1024 * 1024, required=False
+)
+parser.add_argument(
+    "--optimizers", type=str, default="sgd,momentum,adam,lamb", required=False
+)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def make_optimizer(name):
+    lr_scheduler = flow.optimizer.PiecewiseConstantScheduler([], [0.01])
+    if name == "sgd":
+        return flow.optimizer.SGD(lr_scheduler, momentum=0.0)
+    elif name == "momentum":
+        return flow.optimizer.SGD(lr_scheduler, momentum=0.9)
+    elif name == "adam":
+        return flow.optimizer.Adam(lr_scheduler)
+    elif name == "lamb":
+        return flow.optimizer.LAMB(lr_scheduler)
+    else:
+        raise NotImplementedError
+
+
+def make_job(optimizer_name, var_sizes, multi_tensor):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+    func_config.enable_multi_tensor_model_update(multi_tensor)
+
+    @flow.global_function(type="train", function_config=func_config)
+    def job(x: oft.Numpy.Placeholder((1,))):
+        with flow.scope.placement("cpu", "0:0"):
+            loss = None
+            for i, var_size in enumerate(var_sizes):
+                var = flow.get_variable(
+                    name="var_{}".format(i),
+                    shape=(var_size,),
+                    dtype=flow.float,
+                    initializer=flow.ones_initializer(),
+                )
+                var_loss = flow.math.reduce_sum(var * x)
+                loss = var_loss if loss is None else loss + var_loss
+            make_optimizer(optimizer_name).minimize(loss)
+            return loss
+
+    return job
+
+
+def benchmark(name, optimizer_name, var_sizes):
+    for multi_tensor in [False, True]:
+        job = make_job(optimizer_name, var_sizes, multi_tensor)
+        x = np.ones((1,), dtype=np.float32)
+        for _ in range(args.warmup_iter_num):
+            job(x).get()
+        start = time.perf_counter()
+        for _ in range(args.iter_num):
+            job(x).get()
+        duration = (time.perf_counter() - start) / args.iter_num
+        print(
+            "{:<10} {:<16} multi_tensor {:<6} {:10.3f} ms".format(
+                optimizer_name, name, str(multi_tensor), duration * 1000
+            )
+        )
+
+
+if __name__ == "__main__":
+    for optimizer_name in args.optimizers.split(","):
+        benchmark(
+            "{}x{}".format(args.var_num, args.small_var_size),
+            optimizer_name,
+            [args.small_var_size] * args.var_num,
+        )
+        benchmark(
+            "1x{}".format(args.large_var_size), optimizer_name, [args.large_var_size]
+        )
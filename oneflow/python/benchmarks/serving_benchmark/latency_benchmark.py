@@ -0,0 +1,157 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import os
+import shutil
+import threading
+import time
+
+import numpy as np
+import google.protobuf.text_format as text_format
+import oneflow as flow
+import oneflow.core.serving.saved_model_pb2 as saved_model_pb
+
+parser = argparse.ArgumentParser(description="flags for serving latency benchmark")
+parser.add_argument("--device_tag", type=str, default="cpu", required=False)
+parser.add_argument("--max_batch_size", type=int, default=32, required=False)
+parser.add_argument("--batch_timeout_us", type=int, default=500, required=False)
+parser.add_argument("--hidden_size", type=int, default=1024, required=False)
+parser.add_argument("--num_layers", type=int, default=4, required=False)
+parser.add_argument("--num_clients", type=int, default=16, required=False)
+parser.add_argument("--requests_per_client", type=int, default=200, required=False)
+parser.add_argument("--request_batch_size", type=int, default=1, required=False)
+parser.add_argument(
+    "--model_dir", type=str, default="./serving_benchmark_model", required=False
+)
+args = parser.parse_args()
+
+
+def make_mlp_func(batch_size, lbns):
+    @flow.global_function(type="predict")
+    def mlp(
+        x: flow.typing.Numpy.Placeholder(
+            (batch_size, args.hidden_size), dtype=flow.float32
+        )
+    ) -> flow.typing.Numpy:
+        lbns["x"] = x.logical_blob_name
+        with flow.scope.placement(args.device_tag, "0:0"):
+            for i in range(args.num_layers):
+                x = flow.layers.dense(
+                    x, args.hidden_size, activation=flow.math.relu, name="fc%d" % i
+                )
+        lbns["y"] = x.logical_blob_name
+        return x
+
+    return mlp
+
+
+def save_model():
+    flow.config.cpu_device_num(1)
+    if os.path.exists(args.model_dir):
+        shutil.rmtree(args.model_dir)
+    lbns = {}
+    mlp = make_mlp_func(args.max_batch_size, lbns)
+    flow.train.CheckPoint().init()
+    builder = flow.saved_model.ModelBuilder(args.model_dir)
+    signature_builder = (
+        builder.ModelName("mlp").Version(1).AddFunction(mlp).AddSignature("regress")
+    )
+    signature_builder.Input("x", lbns["x"], batch_axis=0)
+    signature_builder.Output("y", lbns["y"])
+    builder.Save()
+    flow.clear_default_session()
+
+
+def load_session():
+    saved_model_proto = saved_model_pb.SavedModel()
+    with open(os.path.join(args.model_dir, "1", "saved_model.prototxt"), "rb") as f:
+        text_format.Merge(f.read(), saved_model_proto)
+    option = flow.serving.SessionOption()
+    option.device_tag = args.device_tag
+    sess = flow.serving.InferenceSession(option)
+    sess.set_checkpoint_path(
+        os.path.join(args.model_dir, "1", saved_model_proto.checkpoint_dir)
+    )
+    graph_name = saved_model_proto.default_graph_name
+    graph_def = saved_model_proto.graphs[graph_name]
+    signature_def = graph_def.signatures[graph_def.default_signature_name]
+    with sess.open(graph_name, signature_def, args.max_batch_size):
+        sess.compile(graph_def.op_list)
+    sess.launch()
+    return sess, graph_name
+
+
+def run_load(name, predict_fn):
+    latencies = []
+    lock = threading.Lock()
+
+    def client():
+        x = np.random.rand(args.request_batch_size, args.hidden_size).astype(np.float32)
+        client_latencies = []
+        for _ in range(args.requests_per_client):
+            start = time.perf_counter()
+            predict_fn(x)
+            client_latencies.append(time.perf_counter() - start)
+        with lock:
+            latencies.extend(client_latencies)
+
+    clients = [threading.Thread(target=client) for _ in range(args.num_clients)]
+    start = time.perf_counter()
+    for t in clients:
+        t.start()
+    for t in clients:
+        t.join()
+    duration = time.perf_counter() - start
+    latencies = np.array(latencies) * 1000
+    print(
+        "{:<24} p50: {:8.3f} ms  p99: {:8.3f} ms  QPS: {:10.1f}".format(
+            name,
+            np.percentile(latencies, 50),
+            np.percentile(latencies, 99),
+            len(latencies) / duration,
+        )
+    )
+
+
+def main():
+    save_model()
+    sess, job_name = load_session()
+
+    # baseline: python job instances, one request per job, padded to the compiled batch
+    sess_lock = threading.Lock()
+
+    def session_predict(x):
+        padded = np.zeros((args.max_batch_size, args.hidden_size), dtype=np.float32)
+        padded[: x.shape[0]] = x
+        with sess_lock:
+            return sess.run(job_name, x=padded)
+
+    runtime = sess.make_runtime(
+        job_name, args.max_batch_size, batch_timeout_us=args.batch_timeout_us
+    )
+
+    def runtime_predict(x):
+        return runtime.predict(x=x)
+
+    run_load("InferenceSession.run", session_predict)
+    run_load("InferenceRuntime.predict", runtime_predict)
+    sess.close()
+
+
+if __name__ == "__main__":
+    main()
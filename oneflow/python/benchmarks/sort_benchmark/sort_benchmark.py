@@ -0,0 +1,82 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(description="flags for cpu sort and top_k benchmark")
+parser.add_argument("--batch_size", type=int, default=4, required=False)
+parser.add_argument(
+    "--row_lengths", type=str, default="1000,100000,1000000", required=False
+)
+parser.add_argument("--ks", type=str, default="1,10,100,1000,10000", required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def make_job(row_length, op):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(function_config=func_config)
+    def job(x: oft.Numpy.Placeholder((args.batch_size, row_length))):
+        with flow.scope.placement("cpu", "0:0"):
+            return op(x)
+
+    return job
+
+
+def benchmark(name, row_length, op):
+    job = make_job(row_length, op)
+    x = np.random.rand(args.batch_size, row_length).astype(np.float32)
+    for _ in range(args.warmup_iter_num):
+        job(x).get()
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job(x).get()
+    duration = (time.perf_counter() - start) / args.iter_num
+    print(
+        "{:<16} row_length {:>8} {:10.3f} ms {:10.1f} Melem/s".format(
+            name,
+            row_length,
+            duration * 1000,
+            args.batch_size * row_length / duration / 1e6,
+        )
+    )
+
+
+if __name__ == "__main__":
+    row_lengths = [int(n) for n in args.row_lengths.split(",")]
+    ks = [int(k) for k in args.ks.split(",")]
+    for row_length in row_lengths:
+        benchmark("sort", row_length, lambda x: flow.sort(x))
+        benchmark("argsort", row_length, lambda x: flow.argsort(x))
+        for k in ks:
+            if k > row_length:
+                continue
+            benchmark(
+                "top_k k={}".format(k),
+                row_length,
+                lambda x, k=k: flow.math.top_k(x, k=k),
+            )
@@ -0,0 +1,101 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(
+    description="flags for cpu indexed slices optimizer update benchmark"
+)
+parser.add_argument("--table_size", type=int, default=10000000, required=False)
+parser.add_argument("--embedding_size", type=int, default=64, required=False)
+parser.add_argument("--batch_size", type=int, default=65536, required=False)
+# 0 draws ids uniformly, otherwise ids follow a zipf distribution of the exponent
+parser.add_argument("--skews", type=str, default="0,1.05,1.2,1.5", required=False)
+parser.add_argument("--optimizers", type=str, default="sgd,lazy_adam", required=False)
+parser.add_argument("--iter_num", type=int, default=20, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=3, required=False)
+args = parser.parse_args()
+
+
+def make_optimizer(name):
+    lr_scheduler = flow.optimizer.PiecewiseConstantScheduler([], [0.01])
+    if name == "sgd":
+        return flow.optimizer.SGD(lr_scheduler, momentum=0.0)
+    elif name == "lazy_adam":
+        return flow.optimizer.Adam(lr_scheduler, do_bias_correction=True)
+    else:
+        raise NotImplementedError
+
+
+def make_job(optimizer_name):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+    func_config.indexed_slices_optimizer_conf(
+        dict(include_op_names=dict(op_name=["embeddings"]))
+    )
+
+    @flow.global_function(type="train", function_config=func_config)
+    def job(ids: oft.Numpy.Placeholder((args.batch_size,), dtype=flow.int32)):
+        with flow.scope.placement("cpu", "0:0"):
+            embedding_table = flow.get_variable(
+                name="embeddings",
+                shape=(args.table_size, args.embedding_size),
+                initializer=flow.random_uniform_initializer(minval=-0.1, maxval=0.1),
+            )
+            loss = flow.math.reduce_mean(flow.gather(embedding_table, ids))
+            make_optimizer(optimizer_name).minimize(loss)
+            return loss
+
+    return job
+
+
+def gen_ids(skew):
+    if skew == 0:
+        ids = np.random.randint(args.table_size, size=(args.batch_size,))
+    else:
+        ids = (np.random.zipf(skew, size=(args.batch_size,)) - 1) % args.table_size
+    return ids.astype(np.int32)
+
+
+def benchmark(optimizer_name, skew):
+    job = make_job(optimizer_name)
+    ids_seq = [gen_ids(skew) for _ in range(args.warmup_iter_num + args.iter_num)]
+    for ids in ids_seq[: args.warmup_iter_num]:
+        job(ids).get()
+    start = time.perf_counter()
+    for ids in ids_seq[args.warmup_iter_num :]:
+        job(ids).get()
+    duration = (time.perf_counter() - start) / args.iter_num
+    unique_num = np.mean([len(np.unique(ids)) for ids in ids_seq])
+    print(
+        "{:<10} skew {:<5} unique ids {:>9.0f} {:10.3f} ms".format(
+            optimizer_name, skew, unique_num, duration * 1000
+        )
+    )
+
+
+if __name__ == "__main__":
+    for optimizer_name in args.optimizers.split(","):
+        for skew in [float(s) for s in args.skews.split(",")]:
+            benchmark(optimizer_name, skew)
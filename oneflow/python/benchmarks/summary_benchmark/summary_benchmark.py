@@ -0,0 +1,114 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import tempfile
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(description="flags for summary op latency benchmark")
+parser.add_argument("--logdir", type=str, default=None, required=False)
+parser.add_argument("--histogram_size", type=int, default=100000, required=False)
+parser.add_argument("--iter_num", type=int, default=2000, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=20, required=False)
+args = parser.parse_args()
+
+
+def make_jobs():
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.default_logical_view(flow.scope.mirrored_view())
+
+    @flow.global_function(function_config=func_config)
+    def create_writer_job():
+        flow.summary.create_summary_writer(args.logdir)
+
+    @flow.global_function(function_config=func_config)
+    def scalar_job(
+        value: oft.ListNumpy.Placeholder((1,), dtype=flow.float),
+        step: oft.ListNumpy.Placeholder((1,), dtype=flow.int64),
+        tag: oft.ListNumpy.Placeholder((16,), dtype=flow.int8),
+    ):
+        flow.summary.scalar(value, step, tag)
+
+    @flow.global_function(function_config=func_config)
+    def histogram_job(
+        value: oft.ListNumpy.Placeholder((args.histogram_size,), dtype=flow.float),
+        step: oft.ListNumpy.Placeholder((1,), dtype=flow.int64),
+        tag: oft.ListNumpy.Placeholder((16,), dtype=flow.int8),
+    ):
+        flow.summary.histogram(value, step, tag)
+
+    @flow.global_function(function_config=func_config)
+    def flush_job():
+        flow.summary.flush_summary_writer()
+
+    return create_writer_job, scalar_job, histogram_job, flush_job
+
+
+def encode_tag(name):
+    return [np.array(list(name.encode("ascii")), dtype=np.int8)]
+
+
+def measure(name, run):
+    for i in range(args.warmup_iter_num):
+        run(i)
+    durations = []
+    for i in range(args.iter_num):
+        start = time.perf_counter()
+        run(i)
+        durations.append(time.perf_counter() - start)
+    durations = np.array(durations) * 1000
+    print(
+        "{:<10}".format(name),
+        "p50 {:8.3f} ms".format(np.percentile(durations, 50)),
+        "p99 {:8.3f} ms".format(np.percentile(durations, 99)),
+        "max {:8.3f} ms".format(durations.max()),
+    )
+
+
+def benchmark():
+    create_writer_job, scalar_job, histogram_job, flush_job = make_jobs()
+    create_writer_job().get()
+    scalar_value = [np.array([0.5], dtype=np.float32)]
+    histogram_value = [
+        np.random.normal(size=(args.histogram_size,)).astype(np.float32)
+    ]
+    scalar_tag = encode_tag("scalar")
+    histogram_tag = encode_tag("histogram")
+
+    def step(i):
+        return [np.array([i], dtype=np.int64)]
+
+    measure("scalar", lambda i: scalar_job(scalar_value, step(i), scalar_tag).get())
+    measure(
+        "histogram",
+        lambda i: histogram_job(histogram_value, step(i), histogram_tag).get(),
+    )
+    start = time.perf_counter()
+    flush_job().get()
+    print("flush {:8.3f} ms".format((time.perf_counter() - start) * 1000))
+
+
+if __name__ == "__main__":
+    if args.logdir is None:
+        args.logdir = tempfile.mkdtemp()
+    benchmark()
@@ -0,0 +1,93 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+parser = argparse.ArgumentParser(description="flags for timeline profiler benchmark")
+parser.add_argument("--batch_size", type=int, default=64, required=False)
+parser.add_argument("--hidden_size", type=int, default=512, required=False)
+parser.add_argument("--layer_num", type=int, default=8, required=False)
+parser.add_argument("--cpu_device_num", type=int, default=1, required=False)
+parser.add_argument("--iter_num", type=int, default=200, required=False)
+parser.add_argument("--warmup_iter_num", type=int, default=20, required=False)
+parser.add_argument(
+    "--chrome_trace_path", type=str, default="timeline.json", required=False
+)
+args = parser.parse_args()
+
+
+def make_job():
+    flow.clear_default_session()
+    flow.config.cpu_device_num(args.cpu_device_num)
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(type="train", function_config=func_config)
+    def train_job(
+        x: oft.Numpy.Placeholder((args.batch_size, args.hidden_size))
+    ) -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0-{}".format(args.cpu_device_num - 1)):
+            out = x
+            for i in range(args.layer_num):
+                out = flow.layers.dense(
+                    out,
+                    args.hidden_size,
+                    activation=flow.math.relu,
+                    kernel_initializer=flow.random_normal_initializer(stddev=0.01),
+                    name="dense_{}".format(i),
+                )
+            loss = flow.math.reduce_mean(out)
+            lr_scheduler = flow.optimizer.PiecewiseConstantScheduler([], [0.01])
+            flow.optimizer.SGD(lr_scheduler, momentum=0.9).minimize(loss)
+            return loss
+
+    return train_job
+
+
+def run(job, x):
+    for _ in range(args.warmup_iter_num):
+        job(x)
+    start = time.perf_counter()
+    for _ in range(args.iter_num):
+        job(x)
+    return (time.perf_counter() - start) * 1000 / args.iter_num
+
+
+if __name__ == "__main__":
+    x = np.random.rand(args.batch_size, args.hidden_size).astype(np.float32)
+    job = make_job()
+    # alternate to cancel out drift of the machine
+    off_ms = []
+    on_ms = []
+    for _ in range(3):
+        off_ms.append(run(job, x))
+        flow.profiler.start_timeline()
+        on_ms.append(run(job, x))
+        statistics = flow.profiler.stop_timeline(args.chrome_trace_path)
+    off = min(off_ms)
+    on = min(on_ms)
+    print("timeline off {:8.3f} ms/iter".format(off))
+    print("timeline on  {:8.3f} ms/iter".format(on))
+    print("overhead     {:8.2f} %".format((on - off) / off * 100))
+    print("chrome trace written to {}".format(args.chrome_trace_path))
+    print("\n".join(statistics.splitlines()[:20]))
@@ -167,6 +167,57 @@ def enable_numa_aware_cuda_malloc_host(val):
     sess.config_proto.resource.enable_numa_aware_cuda_malloc_host = val
 
 
+@oneflow_export("config.enable_numa_aware_cpu_placement")
+def api_enable_numa_aware_cpu_placement(val: bool = True) -> None:
+    r"""Whether or not pin cpu actor threads, compute thread pool workers and the register memory of cpu actors to numa nodes.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_numa_aware_cpu_placement, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_numa_aware_cpu_placement(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_numa_aware_cpu_placement = val
+
+
+@oneflow_export("config.host_regst_huge_page_kbyte")
+def api_host_regst_huge_page_kbyte(val: int) -> None:
+    r"""Map the host register memory with huge pages, the kernel zero-fills the pages instead of memset.
+
+    Args:
+        val (int): -1 disables, 0 uses transparent huge pages, 2048 or 1048576 uses hugetlb pages of the size in KB
+    """
+    return enable_if.unique([host_regst_huge_page_kbyte, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def host_regst_huge_page_kbyte(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.host_regst_huge_page_kbyte = val
+
+
+@oneflow_export("config.comm_net_compression_threshold_kbyte")
+def api_comm_net_compression_threshold_kbyte(val: int) -> None:
+    r"""Compress the registers sent to other machines with lz4 when they are large enough.
+
+    Args:
+        val (int): registers of at least so many KB are compressed, 0 disables
+    """
+    return enable_if.unique([comm_net_compression_threshold_kbyte, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_compression_threshold_kbyte(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.comm_net_compression_threshold_kbyte = val
+
+
 @oneflow_export("config.compute_thread_pool_size")
 def api_compute_thread_pool_size(val: int) -> None:
     r"""Set up the size of compute thread pool
@@ -252,6 +303,40 @@ def reserved_device_mem_mbyte(val):
     sess.config_proto.resource.reserved_device_mem_mbyte = val
 
 
+@oneflow_export("config.adaptive_regst_mem_budget_mbyte")
+def api_adaptive_regst_mem_budget_mbyte(val: int) -> None:
+    r"""Set up the memory size of every memory zone reserved for registers added at runtime. Actors stalled by their consumers get more registers within it. 0 disables adaptive register number.
+
+    Args:
+        val (int):  memory size, e.g. 1024(mb)
+    """
+    return enable_if.unique([adaptive_regst_mem_budget_mbyte, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def adaptive_regst_mem_budget_mbyte(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.adaptive_regst_mem_budget_mbyte = val
+
+
+@oneflow_export("config.plan_broadcast_fanout")
+def api_plan_broadcast_fanout(val: int) -> None:
+    r"""Set up the number of machines every machine relays the compiled plan to. The plan is broadcast from the master along a tree of machines.
+
+    Args:
+        val (int): fanout of the tree, e.g. 4
+    """
+    return enable_if.unique([plan_broadcast_fanout, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def plan_broadcast_fanout(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.plan_broadcast_fanout = val
+
+
 @oneflow_export("config.use_rdma")
 def api_use_rdma(val: bool = True) -> None:
     r"""Whether use RDMA to speed up data transmission in cluster nodes or not.
@@ -321,6 +406,56 @@ def save_downloaded_file_to_local_fs(val=True):
     sess.config_proto.io_conf.save_downloaded_file_to_local_fs = val
 
 
+@oneflow_export("config.enable_io_uring")
+def api_enable_io_uring(val: bool = True) -> None:
+    r"""Whether or not read and write local files through io_uring, which keeps several requests in flight per reader and writer. Falls back to posix io where io_uring is unavailable.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_io_uring, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_io_uring(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    _SetLocalFsConf(sess.config_proto.io_conf, "enable_io_uring", val)
+
+
+@oneflow_export("config.enable_direct_io")
+def api_enable_direct_io(val: bool = True) -> None:
+    r"""Whether or not read local files with O_DIRECT, bypassing the page cache. Only takes effect with io_uring enabled.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_direct_io, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_direct_io(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    _SetLocalFsConf(sess.config_proto.io_conf, "enable_direct_io", val)
+
+
+def _SetLocalFsConf(io_conf, field, val):
+    # assigning localfs_conf of a conf of another fs_type would switch its fs_type
+    fs_confs = [
+        fs_conf
+        for fs_conf in [io_conf.data_fs_conf, io_conf.snapshot_fs_conf]
+        if fs_conf.HasField("localfs_conf")
+    ]
+    if len(fs_confs) == 0:
+        raise ValueError(
+            "%s only applies to the local file system, which neither the data nor the "
+            "snapshot file system is" % field
+        )
+    for fs_conf in fs_confs:
+        setattr(fs_conf.localfs_conf, field, val)
+
+
 @oneflow_export("config.persistence_buf_byte")
 def api_persistence_buf_byte(val: int) -> None:
     r"""Set up buffer size for persistence.
@@ -395,6 +530,23 @@ def collect_act_event(val=True):
     sess.config_proto.profile_conf.collect_act_event = val
 
 
+@oneflow_export("config.cost_db_path")
+def api_cost_db_path(val: str) -> None:
+    r"""Set the path of the cost database. Durations of tasks are added to it when act events are collected, and jobs compiled without an experiment run size their registers by it.
+
+    Args:
+        val (str): path of the cost database file
+    """
+    return enable_if.unique([cost_db_path, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def cost_db_path(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is str
+    sess.config_proto.profiler_conf.cost_db_path = val
+
+
 @oneflow_export("config.collective_boxing.enable_fusion")
 def api_enable_fusion(val: bool = True) -> None:
     r"""Whether or not allow fusion the operators
@@ -474,6 +474,18 @@ def set_enable_fuse_cast_scale(func_desc, value=True):
     func_desc.job_config_proto.set_enable_fuse_cast_scale(value)
 
 
+@oneflow_function_config("enable_sbp_signature_search")
+def set_enable_sbp_signature_search(func_desc, value=True):
+    r"""Whether enable sbp signature search.
+            If enabled, choose the sbp signatures of ops by a cost model over the whole job instead of op by op, and use them as sbp hints.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_sbp_signature_search(value)
+
+
 @oneflow_function_config("cudnn_conv_use_deterministic_algo_only")
 def set_cudnn_conv_use_deterministic_algo_only(func_desc, value):
     r"""Set value to cudnn conv_use_deterministic_only algorithm
@@ -807,6 +819,30 @@ def set_enable_fuse_model_update_ops(func_desc, value=True):
     func_desc.job_config_proto.set_enable_fuse_model_update_ops(value)
 
 
+@oneflow_function_config("enable_multi_tensor_model_update")
+def set_enable_multi_tensor_model_update(func_desc, value=True):
+    r"""Whether enable multi_tensor_model_update.
+            If enabled, model update ops on cpu with the same optimizer config are grouped into one multi tensor update op, which updates all the models in parallel by the thread pool.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_multi_tensor_model_update(value)
+
+
+@oneflow_function_config("enable_cpu_matmul_weight_prepacking")
+def set_enable_cpu_matmul_weight_prepacking(func_desc, value=True):
+    r"""Whether enable cpu_matmul_weight_prepacking.
+            If enabled, cpu matmul ops of a predict job whose b is a variable pack b into the blas library's internal layout once and reuse it until the variable changes.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_cpu_matmul_weight_prepacking(value)
+
+
 @oneflow_function_config("enable_gradients_stats_aggregation")
 def set_enable_gradients_stats_aggregation(func_desc, value=True):
     r"""Whether enable gradients_stats_aggregation.
@@ -901,6 +937,17 @@ def set_use_tensorrt(func_desc, value=True):
     func_desc.job_config_proto.mutable_xrt_config().set_use_tensorrt(value)
 
 
+@oneflow_function_config("use_native_fusion")
+def set_use_native_fusion(func_desc, value=True):
+    r"""Whether fuse CPU elementwise ops with the xrt native engine or not
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    func_desc.job_config_proto.mutable_xrt_config().set_use_native_fusion(value)
+
+
 @oneflow_function_config("tensorrt.use_fp16")
 def set_tensorrt_use_fp16(func_desc, value=True):
     r"""Whether use tensorrt fp16  or not
@@ -85,6 +85,69 @@ class OfBlob(object):
     def is_tensor_list(self):
         return oneflow_api.OfBlob_IsTensorList(self.of_blob_ptr_)
 
+    @property
+    def is_host_memory(self):
+        return oneflow_api.OfBlob_IsHostMemory(self.of_blob_ptr_)
+
+    def AsNdarray(self):
+        r"""Returns a read-only ndarray aliasing the regst memory of the sole tensor.
+
+        The regst is pinned only while the callback receiving this OfBlob is running,
+        so the returned ndarray must not be used after the callback returns.
+        """
+        ndarray_lists = self.AsNdarrayLists()
+        assert len(ndarray_lists) == 1
+        assert len(ndarray_lists[0]) == 1
+        return ndarray_lists[0][0]
+
+    def AsNdarrayLists(self):
+        assert self.is_host_memory
+        method_name = oneflow_api.Dtype_GetOfBlobCurTensorAsNumpyFuncName(
+            self.dtype.oneflow_proto_dtype
+        )
+        view_method = getattr(oneflow_api, method_name)
+        tensor_list = []
+        oneflow_api.OfBlob_ResetTensorIterator(self.of_blob_ptr_)
+        while oneflow_api.OfBlob_CurTensorIteratorEqEnd(self.of_blob_ptr_) == False:
+            tensor = view_method(self.of_blob_ptr_)
+            tensor.flags.writeable = False
+            tensor_list.append(tensor)
+            oneflow_api.OfBlob_IncTensorIterator(self.of_blob_ptr_)
+        num_slices = oneflow_api.OfBlob_NumOfTensorListSlices(self.of_blob_ptr_)
+        slice_starts = [
+            oneflow_api.OfBlob_TensorIndex4SliceId(self.of_blob_ptr_, x)
+            for x in range(num_slices)
+        ]
+        slice_ends = slice_starts[1:] + [len(tensor_list)]
+        return [tensor_list[s:e] for s, e in zip(slice_starts, slice_ends)]
+
+    def MutNdarray(self, shape=None):
+        r"""Returns a writable ndarray aliasing the regst memory to be fed, so callers
+        write the input in place instead of copying it from another ndarray.
+
+        For dynamic blobs `shape` is the valid shape of the fed tensor, it defaults to
+        the static shape. The same lifetime rule as `AsNdarray` applies.
+        """
+        assert self.is_host_memory
+        if not self.is_dynamic:
+            assert shape is None or tuple(shape) == self.static_shape
+            method_name = oneflow_api.Dtype_GetOfBlobStaticTensorAsNumpyFuncName(
+                self.dtype.oneflow_proto_dtype
+            )
+            return getattr(oneflow_api, method_name)(self.of_blob_ptr_)
+        if shape is None:
+            shape = self.static_shape
+        method_name = oneflow_api.Dtype_GetOfBlobCurMutTensorAsNumpyFuncName(
+            self.dtype.oneflow_proto_dtype
+        )
+        oneflow_api.OfBlob_ClearTensorLists(self.of_blob_ptr_)
+        oneflow_api.OfBlob_AddTensorListSlice(self.of_blob_ptr_)
+        oneflow_api.OfBlob_AddTensor(self.of_blob_ptr_)
+        assert oneflow_api.OfBlob_CurMutTensorAvailable(self.of_blob_ptr_)
+        return getattr(oneflow_api, method_name)(
+            self.of_blob_ptr_, np.array(shape, dtype=np.int64)
+        )
+
     def CopyToNdarray(self):
         ndarray_lists = self._CopyToNdarrayLists()
         assert len(ndarray_lists) == 1
@@ -0,0 +1,56 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from __future__ import absolute_import
+
+from typing import Optional
+
+from oneflow.python.oneflow_export import oneflow_export
+import oneflow_api
+
+
+@oneflow_export("profiler.start_timeline")
+def start_timeline() -> None:
+    r"""Start recording a CPU side timeline of kernels, actor acts, idle times of actor threads and comm net reads of this process. Events recorded by a previous timeline are cleared.
+
+    The timeline can also be started when the process starts, by setting env var ONEFLOW_TIMELINE_PROFILER=1. It is then dumped when the session closes to the files named by env var ONEFLOW_TIMELINE_PROFILER_OUTPUT, e.g. ONEFLOW_TIMELINE_PROFILER_OUTPUT=/tmp/timeline writes /tmp/timeline-runtime0-0.json and /tmp/timeline-runtime0-0.txt for the first runtime of the process on machine 0.
+
+    For example:
+
+    .. code-block:: python
+
+        flow.profiler.start_timeline()
+        for _ in range(10):
+            train_job().get()
+        print(flow.profiler.stop_timeline("timeline.json"))
+
+    """
+    oneflow_api.EnableTimeline()
+
+
+@oneflow_export("profiler.stop_timeline")
+def stop_timeline(chrome_trace_path: Optional[str] = None) -> str:
+    r"""Stop recording the timeline started by `start_timeline`.
+
+    Args:
+        chrome_trace_path (Optional[str], optional): If not None, the latest events of each thread are written to this path as Chrome trace JSON, which chrome://tracing and Perfetto load. Defaults to None.
+
+    Returns:
+        str: A table of the count and time of each kernel, actor and comm net read, from the most time consuming one, followed by the utilization of each actor thread. For each actor, "wait" is the time from the end of an act until the msg that makes it ready again is queued to its thread, and "ready" the time from then until the act starts. These two are not in the Chrome trace.
+    """
+    oneflow_api.DisableTimeline()
+    if chrome_trace_path is not None:
+        oneflow_api.DumpTimelineChromeTrace(chrome_trace_path)
+    return oneflow_api.TimelineStatistics()
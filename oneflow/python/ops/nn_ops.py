@@ -2546,6 +2546,27 @@ def dropout(
         assert name is not None
     if name is None:
         name = id_util.UniqueStr("Dropout_")
+    if (
+        noise_shape is None
+        and not flow.eager_execution_enabled()
+        and flow.current_scope().device_parallel_desc_symbol.device_tag == "cpu"
+    ):
+        # the cpu kernel generates the mask and applies it in one pass
+        if seed is None:
+            seed = random.randint(-sys.maxsize, sys.maxsize)
+        return (
+            flow.user_op_builder(name)
+            .Op("dropout_with_random_mask")
+            .Input("in", [x])
+            .Output("out")
+            .Output("mask")
+            .Attr("rate", float(rate))
+            .Attr("scale", float(1.0 / (1.0 - rate)))
+            .Attr("seed", seed)
+            .Build()
+            .InferAndTryRun()
+            .RemoteBlobList()[0]
+        )
     mask = random_mask_like(
         x, rate, seed, noise_shape, "%s-dropout_random_mask_like" % name
     )
@@ -203,11 +203,134 @@ class OFRecordImageDecoderRandomCropModule(module_util.Module):
         )
 
 
+@oneflow_export(
+    "data.OFRecordImageDecoderRandomCropResizeNormalize",
+    "data.ofrecord_image_decoder_random_crop_resize_normalize",
+)
+def api_ofrecord_image_decoder_random_crop_resize_normalize(
+    input_blob: oneflow_api.BlobDesc,
+    blob_name: str,
+    target_size: Sequence[int],
+    mirror_blob: Optional[oneflow_api.BlobDesc] = None,
+    color_space: str = "BGR",
+    mean: Sequence[float] = [0.0],
+    std: Sequence[float] = [1.0],
+    output_layout: str = "NCHW",
+    num_attempts: int = 10,
+    seed: Optional[int] = None,
+    random_area: Sequence[float] = [0.08, 1.0],
+    random_aspect_ratio: Sequence[float] = [0.75, 1.333333],
+    name: str = "OFRecordImageDecoderRandomCropResizeNormalize",
+) -> oneflow_api.BlobDesc:
+    """This operator fuses OFRecordImageDecoderRandomCrop, image.Resize and
+    image.CropMirrorNormalize on CPU. JPEG images are decoded at a reduced DCT scale and
+    only the random crop window is decoded, then it is resized and normalized directly
+    into the output.
+
+    Args:
+        input_blob (oneflow_api.BlobDesc): The input Blob
+        blob_name (str): The name of the Blob
+        target_size (Sequence[int]): The (width, height) of the output images
+        mirror_blob (Optional[oneflow_api.BlobDesc], optional): The int8 Blob of whether to mirror each image. Defaults to None.
+        color_space (str, optional): The color space, such as "RGB", "BGR". Defaults to "BGR".
+        mean (Sequence[float], optional): The mean value subtracted from each channel. Defaults to [0.0].
+        std (Sequence[float], optional): The standard deviation dividing each channel. Defaults to [1.0].
+        output_layout (str, optional): "NCHW" or "NHWC". Defaults to "NCHW".
+        num_attempts (int, optional): The maximum number of random cropping attempts. Defaults to 10.
+        seed (Optional[int], optional): The random seed. Defaults to None.
+        random_area (Sequence[float], optional): The random cropping area. Defaults to [0.08, 1.0].
+        random_aspect_ratio (Sequence[float], optional): The random scaled ratio. Defaults to [0.75, 1.333333].
+        name (str, optional): The name for the operation. Defaults to "OFRecordImageDecoderRandomCropResizeNormalize".
+
+    Returns:
+        oneflow_api.BlobDesc: The float Blob of normalized images
+    """
+    assert isinstance(name, str)
+    assert len(target_size) == 2
+    if seed is not None:
+        assert name is not None
+    module = flow.find_or_create_module(
+        name,
+        lambda: OFRecordImageDecoderRandomCropResizeNormalizeModule(
+            blob_name=blob_name,
+            target_size=target_size,
+            has_mirror=mirror_blob is not None,
+            color_space=color_space,
+            mean=mean,
+            std=std,
+            output_layout=output_layout,
+            num_attempts=num_attempts,
+            random_seed=seed,
+            random_area=random_area,
+            random_aspect_ratio=random_aspect_ratio,
+            name=name,
+        ),
+    )
+    return module(input_blob, mirror_blob)
+
+
+class OFRecordImageDecoderRandomCropResizeNormalizeModule(module_util.Module):
+    def __init__(
+        self,
+        blob_name: str,
+        target_size: Sequence[int],
+        has_mirror: bool,
+        color_space: str,
+        mean: Sequence[float],
+        std: Sequence[float],
+        output_layout: str,
+        num_attempts: int,
+        random_seed: Optional[int],
+        random_area: Sequence[float],
+        random_aspect_ratio: Sequence[float],
+        name: str,
+    ):
+        module_util.Module.__init__(self, name)
+        seed, has_seed = flow.random.gen_seed(random_seed)
+        builder = flow.user_op_module_builder(
+            "ofrecord_image_decoder_random_crop_resize_normalize"
+        ).InputSize("in", 1)
+        if has_mirror:
+            builder = builder.InputSize("mirror", 1)
+        self.op_module_builder = (
+            builder.Output("out")
+            .Attr("name", blob_name)
+            .Attr("color_space", color_space)
+            .Attr("target_width", target_size[0])
+            .Attr("target_height", target_size[1])
+            .Attr("mean", mean)
+            .Attr("std", std)
+            .Attr("output_layout", output_layout)
+            .Attr("num_attempts", num_attempts)
+            .Attr("random_area", random_area)
+            .Attr("random_aspect_ratio", random_aspect_ratio)
+            .Attr("has_seed", has_seed)
+            .Attr("seed", seed)
+            .CheckAndComplete()
+        )
+        self.op_module_builder.user_op_module.InitOpKernel()
+
+    def forward(
+        self, input: oneflow_api.BlobDesc, mirror: Optional[oneflow_api.BlobDesc]
+    ):
+        if self.call_seq_no == 0:
+            name = self.module_name
+        else:
+            name = id_util.UniqueStr("OFRecordImageDecoderRandomCropResizeNormalize_")
+
+        builder = self.op_module_builder.OpName(name).Input("in", [input])
+        if mirror is not None:
+            builder = builder.Input("mirror", [mirror])
+        return builder.Build().InferAndTryRun().SoleOutputBlob()
+
+
 @oneflow_export("data.OFRecordImageDecoder", "data.ofrecord_image_decoder")
 def OFRecordImageDecoder(
     input_blob: oneflow_api.BlobDesc,
     blob_name: str,
     color_space: str = "BGR",
+    cache_capacity_mb: int = 0,
+    cache_dir: str = "",
     name: Optional[str] = None,
 ) -> oneflow_api.BlobDesc:
     """This operator is an image decoder. 
@@ -216,6 +339,8 @@ def OFRecordImageDecoder(
         input_blob (oneflow_api.BlobDesc): The input Blob
         blob_name (str): The name of the input Blob
         color_space (str, optional): The color space, such as "RGB", "BGR". Defaults to "BGR".
+        cache_capacity_mb (int, optional): The capacity in MB of the cache of decoded images of each device, keyed by the encoded image bytes, which lets later epochs skip decoding. Defaults to 0, which disables the cache.
+        cache_dir (str, optional): The directory of the cache files, which are reused by later runs of the same decoder. Defaults to "", which keeps the cache in memory.
         name (Optional[str], optional): The name for the operation. Defaults to None.
 
     Returns:
@@ -270,6 +395,8 @@ def OFRecordImageDecoder(
         .Output("out")
         .Attr("name", blob_name)
         .Attr("color_space", color_space)
+        .Attr("cache_dir", cache_dir)
+        .Attr("cache_capacity_mb", cache_capacity_mb)
         .Build()
         .InferAndTryRun()
         .RemoteBlobList()[0]
@@ -2223,6 +2350,8 @@ def ofrecord_image_classification_reader(
     color_space: str = "BGR",
     decode_buffer_size_per_thread: int = 32,
     num_decode_threads_per_machine: Optional[int] = None,
+    cache_capacity_mb: int = 0,
+    cache_dir: str = "",
     name: Optional[str] = None,
 ) -> oneflow_api.BlobDesc:
     """This operator creates a reader for image classification tasks. 
@@ -2241,6 +2370,8 @@ def ofrecord_image_classification_reader(
         color_space (str, optional): The color space. Defaults to "BGR".
         decode_buffer_size_per_thread (int, optional): The decode buffer size for per thread. Defaults to 32.
         num_decode_threads_per_machine (Optional[int], optional): The amounts of decode threads for each machine. Defaults to None.
+        cache_capacity_mb (int, optional): The capacity in MB of the cache of decoded samples of each device, which lets later epochs skip decoding. Defaults to 0, which disables the cache.
+        cache_dir (str, optional): The directory of the cache files, which are reused by later runs of the same reader. Defaults to "", which keeps the cache in memory.
         name (Optional[str], optional): The name for the operation. Defaults to None.
 
     Returns:
@@ -2301,6 +2432,8 @@ def ofrecord_image_classification_reader(
         .Attr("label_feature_name", label_feature_name)
         .Attr("decode_buffer_size_per_thread", decode_buffer_size_per_thread)
         .Attr("num_decode_threads_per_machine", num_decode_threads_per_machine or 0)
+        .Attr("cache_dir", cache_dir)
+        .Attr("cache_capacity_mb", cache_capacity_mb)
         .Build()
         .InferAndTryRun()
         .RemoteBlobList()
@@ -122,6 +122,25 @@ def _inferface_blob_conf_proto_to_cfg(
     )
 
 
+def _make_zero_copy_push_cb(input_name, input):
+    # `input` is either an ndarray or a function filling the writable ndarray which
+    # aliases the input regst. Unlike `_MakePushNdarrayCallback`, an ndarray input is
+    # not copied in advance, it is written into the regst directly, so callers must not
+    # modify it until the job finishes.
+    if not isinstance(input, np.ndarray) and not callable(input):
+        raise ValueError(
+            'input "{}" requires numpy.ndarray or callable'.format(input_name)
+        )
+
+    def push_fn(ofblob):
+        if callable(input):
+            input(ofblob.MutNdarray())
+        else:
+            np.copyto(ofblob.MutNdarray(input.shape), input, casting="same_kind")
+
+    return push_fn
+
+
 @oneflow_export("serving.ModelVersionPolicy")
 class ModelVersionPolicy(enum.Enum):
     LATEST = 1
@@ -133,6 +152,9 @@ class SessionOption(object):
         self.device_tag = "gpu"
         self.device_num = 1
         self.is_mirrored_view = False
+        # feed inputs to and fetch outputs from host regsts in place, see
+        # `InferenceSession.set_output_consumer`
+        self.use_zero_copy = False
 
 
 @oneflow_export("serving.InferenceSession")
@@ -158,6 +180,7 @@ class InferenceSession(object):
         self.inferface_name2lbn_ = {}
         self.inferface_name2info_ = {}
         self.output_name2future_ = {}
+        self.output_consumers_ = {}
         self.job_futures_ = []
         self.status_ = None
 
@@ -466,6 +489,28 @@ class InferenceSession(object):
         output_futures = tuple(self._run_pull_jobs().values())
         return await asyncio.gather(*output_futures)
 
+    def make_runtime(self, job_name, max_batch_size, batch_timeout_us=1000):
+        r"""Returns an InferenceRuntime serving the launched `job_name` from C++.
+
+        The runtime batches concurrent `predict` calls along axis 0 into batches of at
+        most `max_batch_size` rows, which is lowered to the batch size the job is
+        compiled with if it is larger. A batch is launched when it is full or
+        `batch_timeout_us` after its first request. `predict` raises for requests
+        larger than `max_batch_size` or not matching the input shapes of the job.
+        """
+        self._check_status(self.SessionStatus.RUNNING)
+        input_names = list(
+            self.inter_user_job_info_.input_or_var_op_name2push_job_name.keys()
+        )
+        output_names = list(
+            self.inter_user_job_info_.output_or_var_op_name2pull_job_name.keys()
+        )
+        return InferenceRuntime(
+            oneflow_api.InferenceRuntime(
+                job_name, input_names, output_names, max_batch_size, batch_timeout_us
+            )
+        )
+
     def _run_job(self, job_inst):
         loop = asyncio.get_event_loop()
         future = loop.create_future()
@@ -486,10 +531,14 @@ class InferenceSession(object):
                 raise ValueError('input "{}" is absent'.format(input_name))
 
             input_numpy = kwargs[input_name]
-            if not isinstance(input_numpy, np.ndarray):
-                raise ValueError('input "{}" requires numpy.ndarray'.format(input_name))
-
-            push_fn = input_blob_util._MakePushNdarrayCallback(input_numpy)
+            if self.option_.use_zero_copy:
+                push_fn = _make_zero_copy_push_cb(input_name, input_numpy)
+            else:
+                if not isinstance(input_numpy, np.ndarray):
+                    raise ValueError(
+                        'input "{}" requires numpy.ndarray'.format(input_name)
+                    )
+                push_fn = input_blob_util._MakePushNdarrayCallback(input_numpy)
             push_job_inst = job_instance_util.MakePushJobInstance(
                 push_job_name, input_name, push_fn
             )
@@ -531,8 +580,41 @@ class InferenceSession(object):
                 pull_result = np.concatenate(ndarray_list, axis=split_axis)
                 loop.call_soon_threadsafe(future.set_result, pull_result)
 
+        def zero_copy_pull_fn(ofblob):
+            # the regst stays pinned until the consumer returns, so the consumer
+            # reads the output in place and only its result outlives the callback
+            consumer = self.output_consumers_.get(output_name, np.copy)
+            try:
+                ndarray_lists = ofblob.AsNdarrayLists()
+                assert len(ndarray_lists) == 1
+                ndarray_list = ndarray_lists[0]
+                if len(ndarray_list) == 1:
+                    pull_result = consumer(ndarray_list[0])
+                else:
+                    assert split_axis is not None
+                    pull_result = consumer(
+                        np.concatenate(ndarray_list, axis=split_axis)
+                    )
+            except Exception as e:
+                loop.call_soon_threadsafe(future.set_exception, e)
+                return
+            loop.call_soon_threadsafe(future.set_result, pull_result)
+
+        if self.option_.use_zero_copy:
+            return zero_copy_pull_fn
         return pull_fn
 
+    def set_output_consumer(self, output_name, consumer):
+        r"""Sets the function consuming an output when `use_zero_copy` is on.
+
+        `consumer` is called with a read-only ndarray aliasing the output regst and
+        its return value becomes the result of `run` for this output. The ndarray
+        must not be kept after `consumer` returns. By default the output is copied.
+        """
+        if output_name not in self.inferface_name2lbn_:
+            raise ValueError('output "{}" does not exist'.format(output_name))
+        self.output_consumers_[output_name] = consumer
+
     def _run_load_checkpoint_job(self):
         if self.checkpoint_path_ is None:
             raise ValueError("checkpoint path not set")
@@ -553,3 +635,33 @@ class InferenceSession(object):
         if len(self.job_futures_) > 0:
             await asyncio.gather(*self.job_futures_)
             self.job_futures_ = []
+
+
+class InferenceRuntime(object):
+    def __init__(self, runtime):
+        self.runtime_ = runtime
+
+    def predict(self, **kwargs):
+        r"""Thread-safe, runs one request and returns the outputs keyed by output name."""
+        return self.predict_with_timeout(0, **kwargs)
+
+    def predict_with_timeout(self, timeout_us, **kwargs):
+        r"""Same as `predict`, but raises if the outputs are not ready after `timeout_us`,
+        unless it is 0.
+        """
+        inputs = {}
+        for input_name in self.runtime_.input_op_names():
+            if input_name not in kwargs:
+                raise ValueError('input "{}" is absent'.format(input_name))
+            input_numpy = np.ascontiguousarray(kwargs[input_name])
+            dtype = dtype_util.convert_numpy_dtype_to_oneflow_dtype(input_numpy.dtype)
+            inputs[input_name] = (input_numpy, dtype.oneflow_proto_dtype)
+        outputs = {}
+        for output_name, (data, shape, proto_dtype) in self.runtime_.Predict(
+            inputs, timeout_us
+        ).items():
+            dtype = dtype_util.convert_oneflow_dtype_to_numpy_dtype(
+                dtype_util.convert_proto_dtype_to_oneflow_dtype(proto_dtype)
+            )
+            outputs[output_name] = data.view(dtype).reshape(shape)
+        return outputs
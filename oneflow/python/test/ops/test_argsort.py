@@ -76,6 +76,17 @@ def gen_arg_list_for_test_axis():
     return GenArgList(arg_dict)
 
 
+def gen_arg_list_for_test_large_row():
+    arg_dict = OrderedDict()
+    arg_dict["device_type"] = ["cpu"]
+    arg_dict["in_shape"] = [(2, 200000)]
+    arg_dict["axis"] = [-1]
+    arg_dict["direction"] = ["ASCENDING", "DESCENDING"]
+    arg_dict["data_type"] = ["float32", "int64"]
+
+    return GenArgList(arg_dict)
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestArgsort(flow.unittest.TestCase):
     def test_argsort(test_case):
@@ -83,6 +94,8 @@ class TestArgsort(flow.unittest.TestCase):
             compare_with_tensorflow(*arg)
         for arg in gen_arg_list_for_test_axis():
             compare_with_tensorflow(*arg)
+        for arg in gen_arg_list_for_test_large_row():
+            compare_with_tensorflow(*arg)
 
 
 if __name__ == "__main__":
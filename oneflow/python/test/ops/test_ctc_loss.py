@@ -339,6 +339,21 @@ class TestCTCLoss1n1d(flow.unittest.TestCase):
         for arg in gen_arg_list("1n1d"):
             compare_with_np(*arg)
 
+    def test_ctc_loss_cpu_parallel(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device_type"] = ["cpu"]
+        arg_dict["device_num"] = [1]
+        arg_dict["data_type"] = ["float32", "double"]
+        arg_dict["max_input_length"] = [40]
+        arg_dict["batch_size"] = [16]
+        arg_dict["num_classes"] = [37]
+        arg_dict["max_target_length"] = [12]
+        arg_dict["blank"] = [0]
+        arg_dict["reduction"] = ["mean"]
+        arg_dict["zero_infinity"] = [False]
+        for arg in GenArgList(arg_dict):
+            compare_with_np(*arg)
+
 
 @flow.unittest.skip_unless_1n2d()
 class TestCTCLoss1n2d(flow.unittest.TestCase):
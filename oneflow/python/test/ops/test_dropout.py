@@ -115,6 +115,42 @@ def of_run_module(device_type, x_shape, data_type, rate, seed):
     return of_out, of_out2
 
 
+def of_run_add_to_output(x_shape, rate, seed, fuse_add_to_output):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.enable_fuse_add_to_output(fuse_add_to_output)
+
+    @flow.global_function(type="train", function_config=func_config)
+    def DropoutAddJob() -> flow.typing.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            x = flow.get_variable(
+                "x",
+                shape=x_shape,
+                dtype=flow.float,
+                initializer=flow.ones_initializer(),
+                trainable=True,
+            )
+            addend = flow.get_variable(
+                "addend",
+                shape=x_shape,
+                dtype=flow.float,
+                initializer=flow.constant_initializer(3.0),
+                trainable=False,
+            )
+            of_out = flow.math.add_n(
+                [flow.nn.dropout(x, rate=rate, seed=seed, name="dropout"), addend]
+            )
+            loss = flow.math.square(of_out)
+            flow.optimizer.SGD(
+                flow.optimizer.PiecewiseConstantScheduler([], [1e-4]), momentum=0
+            ).minimize(loss)
+            return of_out
+
+    check_point = flow.train.CheckPoint()
+    check_point.init()
+    return DropoutAddJob()
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestDropout(flow.unittest.TestCase):
     def test_dropout(test_case):
@@ -142,21 +178,21 @@ class TestDropout(flow.unittest.TestCase):
                 np.array(
                     [
                         4.0,
+                        0.0,
                         4.0,
+                        4.0,
+                        0.0,
                         0.0,
+                        4.0,
                         0.0,
                         0.0,
                         0.0,
                         0.0,
-                        4.0,
                         0.0,
                         0.0,
                         0.0,
-                        4.0,
-                        4.0,
                         0.0,
                         0.0,
-                        4.0,
                     ]
                 ),
                 np.array(
@@ -164,17 +200,17 @@ class TestDropout(flow.unittest.TestCase):
                         0.0,
                         0.0,
                         0.0,
+                        4.0,
+                        0.0,
+                        0.0,
                         0.0,
                         0.0,
-                        4.0,
-                        4.0,
                         0.0,
                         0.0,
                         0.0,
                         0.0,
                         0.0,
                         0.0,
-                        4.0,
                         0.0,
                         0.0,
                     ]
@@ -233,6 +269,32 @@ class TestDropout(flow.unittest.TestCase):
                 (np.abs(literals[arg[0]][1] - of_out_b.flatten()) < 10e-7).all(), True
             )
 
+    def test_dropout_cpu_reproducible(test_case):
+        # the mask spans several parallel parts and only depends on the seed
+        x_shape = (64, 1000, 20)
+        rate = 0.3
+        of_out_a, of_out_b = of_run_module("cpu", x_shape, "float32", rate, 54321)
+        of_out_c, of_out_d = of_run_module("cpu", x_shape, "float32", rate, 54321)
+        test_case.assertTrue(np.array_equal(of_out_a, of_out_c))
+        test_case.assertTrue(np.array_equal(of_out_b, of_out_d))
+        test_case.assertFalse(np.array_equal(of_out_a, of_out_b))
+        for of_out in [of_out_a, of_out_b]:
+            test_case.assertTrue(
+                np.allclose(
+                    [1 - np.count_nonzero(of_out) / of_out.size], [rate], atol=rate / 50
+                )
+            )
+
+    def test_dropout_cpu_add_to_output(test_case):
+        # the sum is fused into dropout_with_random_mask and must not change
+        x_shape = (64, 1000)
+        rate = 0.4
+        fused = of_run_add_to_output(x_shape, rate, 2021, True)
+        unfused = of_run_add_to_output(x_shape, rate, 2021, False)
+        test_case.assertTrue(np.allclose(fused, unfused))
+        kept = np.isclose(fused, 3.0 + 1.0 / (1.0 - rate), atol=1e-5)
+        test_case.assertTrue(np.all(kept | np.isclose(fused, 3.0)))
+
 
 if __name__ == "__main__":
     unittest.main()
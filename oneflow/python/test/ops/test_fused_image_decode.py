@@ -0,0 +1,111 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+
+import numpy as np
+import oneflow as flow
+
+data_dir = "/dataset/imagenet_16_same_pics/ofrecord"
+batch_size = 16
+image_size = 224
+seed = 1234
+rgb_mean = [123.68, 116.779, 103.939]
+rgb_std = [58.393, 57.12, 57.375]
+
+
+def _make_func_config():
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.default_data_type(flow.float)
+    return func_config
+
+
+def _load_ofrecord():
+    return flow.data.ofrecord_reader(
+        data_dir,
+        batch_size=batch_size,
+        data_part_num=1,
+        part_name_suffix_length=5,
+        random_shuffle=False,
+        shuffle_after_epoch=False,
+    )
+
+
+def _run_op_chain():
+    flow.clear_default_session()
+
+    @flow.global_function(function_config=_make_func_config())
+    def op_chain_job():
+        with flow.scope.placement("cpu", "0:0"):
+            ofrecord = _load_ofrecord()
+            image = flow.data.OFRecordImageDecoderRandomCrop(
+                ofrecord, "encoded", color_space="RGB", seed=seed
+            )
+            image = flow.image.Resize(
+                image,
+                resize_x=image_size,
+                resize_y=image_size,
+                color_space="RGB",
+                interpolation_type="bilinear",
+            )
+            return flow.image.CropMirrorNormalize(
+                image,
+                color_space="RGB",
+                mean=rgb_mean,
+                std=rgb_std,
+                output_dtype=flow.float,
+            )
+
+    return op_chain_job().get().numpy()
+
+
+def _run_fused():
+    flow.clear_default_session()
+
+    @flow.global_function(function_config=_make_func_config())
+    def fused_job():
+        with flow.scope.placement("cpu", "0:0"):
+            ofrecord = _load_ofrecord()
+            return flow.data.OFRecordImageDecoderRandomCropResizeNormalize(
+                ofrecord,
+                "encoded",
+                target_size=(image_size, image_size),
+                color_space="RGB",
+                mean=rgb_mean,
+                std=rgb_std,
+                seed=seed,
+            )
+
+    return fused_job().get().numpy()
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestFusedImageDecode(flow.unittest.TestCase):
+    def test_fused_matches_op_chain(test_case):
+        expected = _run_op_chain()
+        fused = _run_fused()
+        test_case.assertEqual(fused.shape, (batch_size, 3, image_size, image_size))
+        test_case.assertEqual(fused.shape, expected.shape)
+        # the fused op decodes at a reduced DCT scale before resizing, so pixels differ
+        # slightly, while a different crop window would differ by far more
+        abs_diff = np.abs(fused - expected) * np.array(rgb_std).reshape(1, 3, 1, 1)
+        test_case.assertLess(np.mean(abs_diff), 4.0)
+        for i in range(batch_size):
+            test_case.assertLess(np.mean(abs_diff[i]), 8.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
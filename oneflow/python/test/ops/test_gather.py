@@ -179,6 +179,20 @@ class TestGather(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             _compare_gather_with_tf(test_case, *arg)
 
+    def test_gather_cpu_parallel(test_case):
+        # spans several parallel parts in both the gather and its segment-sum backward
+        arg_dict = OrderedDict()
+        arg_dict["device_type"] = ["cpu"]
+        arg_dict["params_shape"] = [(30, 150, 50, 2), (5000, 64)]
+        arg_dict["indices_shape"] = [(20, 15, 45)]
+        arg_dict["axis"] = [0, 1]
+        arg_dict["batch_dims"] = [0]
+        arg_dict["mirrored"] = [True]
+        for arg in GenArgList(arg_dict):
+            if arg[3] == 1 and len(arg[1]) == 2:
+                continue
+            _compare_gather_with_tf(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
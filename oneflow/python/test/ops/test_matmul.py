@@ -19,6 +19,7 @@ from collections import OrderedDict
 
 import numpy as np
 import oneflow as flow
+import oneflow.typing as oft
 import tensorflow as tf
 import test_global_storage
 from test_util import GenArgList, type_name_to_flow_type
@@ -202,6 +203,39 @@ def gen_arg_list():
     return matmul_args + batch_matmul_args
 
 
+def compare_cpu_predict_with_model_b(
+    test_case, m, n, k, transpose_b, enable_prepacking
+):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.enable_cpu_matmul_weight_prepacking(enable_prepacking)
+    b_shape = (n, k) if transpose_b else (k, n)
+
+    @flow.global_function(type="predict", function_config=func_config)
+    def MatmulJob(a: oft.Numpy.Placeholder((m, k))) -> oft.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            b = flow.get_variable(
+                "b",
+                shape=b_shape,
+                dtype=flow.float,
+                initializer=flow.random_uniform_initializer(minval=-1, maxval=1),
+            )
+            return flow.matmul(a, b, transpose_b=transpose_b)
+
+    a = np.random.uniform(-1, 1, (m, k)).astype(np.float32)
+    for _ in range(2):
+        b = flow.get_all_variables()["b"].numpy()
+        np_b = b.T if transpose_b else b
+        # the second run reuses the packed b
+        for _ in range(2):
+            test_case.assertTrue(
+                np.allclose(MatmulJob(a), np.matmul(a, np_b), rtol=1e-4, atol=1e-4)
+            )
+        # loading b again must not leave a stale packed b behind
+        flow.load_variables({"b": np.random.uniform(-1, 1, b_shape).astype(np.float32)})
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestMatmul(flow.unittest.TestCase):
     def test_matmul(test_case):
@@ -212,6 +246,16 @@ class TestMatmul(flow.unittest.TestCase):
                 continue
             compare_with_tensorflow(*arg)
 
+    def test_matmul_cpu_predict_with_model_b(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["m"] = [1, 64, 300]
+        arg_dict["n"] = [256]
+        arg_dict["k"] = [512]
+        arg_dict["transpose_b"] = [True, False]
+        arg_dict["enable_prepacking"] = [True, False]
+        for arg in GenArgList(arg_dict):
+            compare_cpu_predict_with_model_b(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
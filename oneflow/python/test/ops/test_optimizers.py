@@ -16,6 +16,7 @@ limitations under the License.
 import unittest
 import os
 from collections import OrderedDict
+from typing import Tuple
 
 import numpy as np
 import oneflow as flow
@@ -980,6 +981,85 @@ def compare_with_flow_job_fused_adam_model_update(
     assert np.allclose(var1.flatten(), var2.flatten(), rtol=1e-4, atol=1e-4,)
 
 
+def compare_with_flow_job_multi_tensor_model_update(
+    device_type, optimizer_name, x_shapes, learning_rate, train_iters
+):
+    assert device_type in ["cpu"]
+    flow.clear_default_session()
+
+    def make_optimizer():
+        lr_scheduler = flow.optimizer.PiecewiseConstantScheduler([], [learning_rate])
+        if optimizer_name == "sgd":
+            return flow.optimizer.SGD(lr_scheduler, momentum=0.0)
+        elif optimizer_name == "momentum":
+            return flow.optimizer.SGD(lr_scheduler, momentum=0.9)
+        elif optimizer_name == "adam":
+            return flow.optimizer.Adam(lr_scheduler, do_bias_correction=True)
+        elif optimizer_name == "lamb":
+            return flow.optimizer.LAMB(lr_scheduler)
+        elif optimizer_name == "lars":
+            return flow.optimizer.LARS(lr_scheduler)
+        else:
+            raise NotImplementedError
+
+    def flow_net(var_name_prefix, random_masks):
+        with flow.scope.placement(device_type, "0:0-0"):
+            loss = None
+            xs = []
+            for i, (x_shape, random_mask) in enumerate(zip(x_shapes, random_masks)):
+                x = flow.get_variable(
+                    name="{}_{}".format(var_name_prefix, i),
+                    shape=x_shape,
+                    dtype=flow.float32,
+                    initializer=flow.ones_initializer(),
+                    trainable=True,
+                )
+                xs.append(x)
+                x_loss = flow.math.reduce_mean(x * x * random_mask)
+                loss = x_loss if loss is None else loss + x_loss
+            make_optimizer().minimize(loss)
+            return xs
+
+    def make_job(multi_tensor):
+        func_config = flow.FunctionConfig()
+        func_config.default_data_type(flow.float32)
+        func_config.enable_multi_tensor_model_update(multi_tensor)
+
+        @flow.global_function(type="train", function_config=func_config)
+        def testMultiTensorUpdate(
+            random_mask_0: flow.typing.Numpy.Placeholder(x_shapes[0], dtype=flow.float32),
+            random_mask_1: flow.typing.Numpy.Placeholder(x_shapes[1], dtype=flow.float32),
+            random_mask_2: flow.typing.Numpy.Placeholder(x_shapes[2], dtype=flow.float32),
+        ) -> Tuple[flow.typing.Numpy, flow.typing.Numpy, flow.typing.Numpy]:
+            return tuple(
+                flow_net(
+                    "multi_tensor" if multi_tensor else "single_tensor",
+                    [random_mask_0, random_mask_1, random_mask_2],
+                )
+            )
+
+        return testMultiTensorUpdate
+
+    job = make_job(False)
+    multi_tensor_job = make_job(True)
+    checkpoint = flow.train.CheckPoint()
+    checkpoint.init()
+
+    random_masks_seq = []
+    for i in range(train_iters + 1):
+        random_masks_seq.append(
+            [np.random.uniform(size=x_shape).astype(np.float32) for x_shape in x_shapes]
+        )
+
+    for i in range(train_iters + 1):
+        vars1 = job(*random_masks_seq[i])
+
+    for i in range(train_iters + 1):
+        vars2 = multi_tensor_job(*random_masks_seq[i])
+    for var1, var2 in zip(vars1, vars2):
+        assert np.allclose(var1.flatten(), var2.flatten(), rtol=1e-4, atol=1e-4,)
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestOptimizers(flow.unittest.TestCase):
     def test_rmsprop(test_case):
@@ -1094,6 +1174,34 @@ class TestOptimizers(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             compare_with_numpy_indexed_slices_adam(*arg)
 
+    def test_indexed_slices_sgd_parallel_rows(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device_type"] = ["cpu"]
+        arg_dict["model_shape"] = [(20000, 16)]
+        arg_dict["ids"] = [(1000, 4)]
+        arg_dict["grad_shape"] = [(1000, 4, 16)]
+        arg_dict["momentum_beta"] = [0, 0.9]
+        arg_dict["learning_rate"] = [1]
+        arg_dict["train_iters"] = [3]
+        arg_dict["mul_scalar"] = [2]
+        for arg in GenArgList(arg_dict):
+            compare_with_numpy_indexed_slices_sgd(*arg)
+
+    def test_indexed_slices_adam_parallel_rows(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device_type"] = ["cpu"]
+        arg_dict["model_shape"] = [(20000, 16)]
+        arg_dict["ids"] = [(1000, 4)]
+        arg_dict["grad_shape"] = [(1000, 4, 16)]
+        arg_dict["beta1"] = [0.9]
+        arg_dict["beta2"] = [0.99]
+        arg_dict["epsilon"] = [1e-9]
+        arg_dict["learning_rate"] = [1]
+        arg_dict["train_iters"] = [3]
+        arg_dict["mul_scalar"] = [2]
+        for arg in GenArgList(arg_dict):
+            compare_with_numpy_indexed_slices_adam(*arg)
+
     def test_indexed_slices_adamw(test_case):
         arg_dict = OrderedDict()
         arg_dict["device_type"] = ["gpu", "cpu"]
@@ -1132,6 +1240,16 @@ class TestOptimizers(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             compare_with_flow_job_fused_adam_model_update(*arg)
 
+    def test_multi_tensor_model_update(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device_type"] = ["cpu"]
+        arg_dict["optimizer_name"] = ["sgd", "momentum", "adam", "lamb", "lars"]
+        arg_dict["x_shapes"] = [[(10,), (3, 40000), (1,)]]
+        arg_dict["learning_rate"] = [0.1]
+        arg_dict["train_iters"] = [10]
+        for arg in GenArgList(arg_dict):
+            compare_with_flow_job_multi_tensor_model_update(*arg)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,98 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+from oneflow.python.framework import c_api_util
+
+
+def _run_matmul_chain(x_np, w1_np, w2_np, enable_search):
+    flow.clear_default_session()
+    flow.config.gpu_device_num(2)
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.enable_sbp_signature_search(enable_search)
+
+    @flow.global_function(function_config=func_config)
+    def MatmulChainJob(
+        x: oft.Numpy.Placeholder(x_np.shape),
+        w1: oft.Numpy.Placeholder(w1_np.shape),
+        w2: oft.Numpy.Placeholder(w2_np.shape),
+    ):
+        with flow.scope.placement("gpu", "0:0-1"):
+            h = flow.matmul(x, w1)
+            h = flow.math.relu(h)
+            return flow.matmul(h, w2)
+
+    return MatmulChainJob(x_np, w1_np, w2_np).get().numpy()
+
+
+def _run_wide_matmul(x_np, weight_value, enable_search):
+    flow.clear_default_session()
+    flow.config.gpu_device_num(2)
+    func_config = flow.FunctionConfig()
+    func_config.default_logical_view(flow.scope.consistent_view())
+    func_config.enable_sbp_signature_search(enable_search)
+
+    @flow.global_function(function_config=func_config)
+    def WideMatmulJob(x: oft.Numpy.Placeholder(x_np.shape)):
+        with flow.scope.placement("gpu", "0:0-1"):
+            w = flow.get_variable(
+                "w",
+                shape=(x_np.shape[1], 4096),
+                dtype=flow.float,
+                initializer=flow.constant_initializer(weight_value),
+            )
+            return flow.matmul(x, w, name="wide_matmul")
+
+    out = WideMatmulJob(x_np).get().numpy()
+    for job in c_api_util.GetJobSet().job:
+        if job.job_conf.job_name == "WideMatmulJob":
+            sbp_conf = job.job_parallel_view_conf.op_name2sbp_signature_conf
+            return out, sbp_conf["wide_matmul"].bn_in_op2sbp_parallel
+    raise ValueError("WideMatmulJob not found")
+
+
+@flow.unittest.skip_unless_1n2d()
+class TestSbpSignatureSearch(flow.unittest.TestCase):
+    def test_matmul_chain(test_case):
+        x = np.random.randn(64, 32).astype(np.float32)
+        w1 = np.random.randn(32, 256).astype(np.float32)
+        w2 = np.random.randn(256, 16).astype(np.float32)
+        greedy = _run_matmul_chain(x, w1, w2, False)
+        searched = _run_matmul_chain(x, w1, w2, True)
+        test_case.assertTrue(np.allclose(greedy, searched, rtol=1e-4, atol=1e-4))
+        expected = np.matmul(np.maximum(np.matmul(x, w1), 0), w2)
+        test_case.assertTrue(np.allclose(searched, expected, rtol=1e-3, atol=1e-3))
+
+    def test_search_splits_large_weight(test_case):
+        # greedy follows the batch split of x and broadcasts the 64MB weight, the search
+        # splits the weight instead and pays for moving the small x
+        x = np.random.randn(8, 4096).astype(np.float32)
+        greedy, greedy_sbp = _run_wide_matmul(x, 0.01, False)
+        searched, searched_sbp = _run_wide_matmul(x, 0.01, True)
+        test_case.assertTrue(greedy_sbp["a_0"].HasField("split_parallel"))
+        test_case.assertTrue(greedy_sbp["b_0"].HasField("broadcast_parallel"))
+        test_case.assertTrue(searched_sbp["b_0"].HasField("split_parallel"))
+        expected = np.matmul(x, np.full((4096, 4096), 0.01, dtype=np.float32))
+        test_case.assertTrue(np.allclose(greedy, expected, rtol=1e-3, atol=1e-3))
+        test_case.assertTrue(np.allclose(searched, expected, rtol=1e-3, atol=1e-3))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -87,6 +87,18 @@ def gen_arg_list_for_test_axis():
     return GenArgList(arg_dict)
 
 
+def gen_arg_list_for_test_large_row():
+    arg_dict = OrderedDict()
+    arg_dict["device_type"] = ["cpu"]
+    arg_dict["in_shape"] = [(2, 200000), (1, 100000)]
+    arg_dict["axis"] = [-1]
+    arg_dict["k"] = [1, 16, 1000, 60000]
+    arg_dict["data_type"] = ["float32", "int32"]
+    arg_dict["sorted"] = [True]
+
+    return GenArgList(arg_dict)
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestTopK(flow.unittest.TestCase):
     def test_top_k(test_case):
@@ -94,6 +106,8 @@ class TestTopK(flow.unittest.TestCase):
             compare_with_tensorflow(*arg)
         for arg in gen_arg_list_for_test_axis():
             compare_with_tensorflow(*arg)
+        for arg in gen_arg_list_for_test_large_row():
+            compare_with_tensorflow(*arg)
 
 
 if __name__ == "__main__":
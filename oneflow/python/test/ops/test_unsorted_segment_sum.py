@@ -152,6 +152,19 @@ class TestUnsortedSegmentSum(flow.unittest.TestCase):
                 continue
             _run_test(test_case, *arg)
 
+    def test_unsorted_segment_sum_cpu_parallel(test_case):
+        # large enough to be partitioned across threads
+        arg_dict = OrderedDict()
+        arg_dict["device_type"] = ["cpu"]
+        arg_dict["data_type"] = ["float32", "double"]
+        arg_dict["out_shape"] = [(1000, 64), (3, 1000, 32)]
+        arg_dict["axis"] = [0, 1]
+        arg_dict["segment_ids_shape"] = [(8192,)]
+        for arg in GenArgList(arg_dict):
+            if arg[3] >= len(arg[2]):
+                continue
+            _run_test(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
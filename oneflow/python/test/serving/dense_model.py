@@ -0,0 +1,72 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import numpy as np
+import oneflow as flow
+
+IN_DIM = 16
+OUT_DIM = 8
+
+
+def save_dense_model(saved_model_path, batch_size):
+    flow.clear_default_session()
+    flow.config.cpu_device_num(1)
+    flow.config.gpu_device_num(0)
+    input_lbns = {}
+    output_lbns = {}
+
+    @flow.global_function(type="predict")
+    def dense_infer(
+        x: flow.typing.Numpy.Placeholder((batch_size, IN_DIM), dtype=flow.float32)
+    ) -> flow.typing.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            input_lbns["x"] = x.logical_blob_name
+            y = flow.layers.dense(
+                x,
+                OUT_DIM,
+                activation=flow.math.relu,
+                kernel_initializer=flow.random_uniform_initializer(),
+                bias_initializer=flow.random_uniform_initializer(),
+                name="dense",
+            )
+            output_lbns["y"] = y.logical_blob_name
+            return y
+
+    # runs once so that the variables are initialized before they are saved
+    dense_infer(np.zeros((batch_size, IN_DIM), dtype=np.float32))
+    saved_model_builder = flow.saved_model.ModelBuilder(saved_model_path)
+    signature_builder = (
+        saved_model_builder.ModelName("dense")
+        .Version(1)
+        .AddFunction(dense_infer)
+        .AddSignature("regress")
+    )
+    for input_name, lbn in input_lbns.items():
+        signature_builder.Input(input_name, lbn, batch_axis=0)
+    for output_name, lbn in output_lbns.items():
+        signature_builder.Output(output_name, lbn)
+    saved_model_builder.Save()
+    flow.clear_default_session()
+    return dense_infer.__name__
+
+
+def make_session(saved_model_path, use_zero_copy=False):
+    option = flow.serving.SessionOption()
+    option.device_tag = "cpu"
+    option.use_zero_copy = use_zero_copy
+    sess = flow.serving.InferenceSession(option)
+    sess.load_saved_model(saved_model_path)
+    sess.launch()
+    return sess
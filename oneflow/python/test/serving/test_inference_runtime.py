@@ -0,0 +1,105 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import shutil
+import tempfile
+import threading
+import unittest
+
+import numpy as np
+import oneflow as flow
+
+from dense_model import IN_DIM, make_session, save_dense_model
+
+BATCH_SIZE = 8
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestInferenceRuntime(flow.unittest.TestCase):
+    def test_predict(test_case):
+        saved_model_path = tempfile.mkdtemp()
+        try:
+            job_name = save_dense_model(saved_model_path, BATCH_SIZE)
+            sess = make_session(saved_model_path)
+            input_name = sess.list_inputs()[0]
+            output_name = sess.list_outputs()[0]
+            # the dense model is row independent, so a request of n rows gets the same
+            # output rows as a full batch starting with them
+            requests = []
+            for i in range(32):
+                x = np.random.uniform(-1, 1, (BATCH_SIZE, IN_DIM)).astype(np.float32)
+                y = sess.run(job_name, **{input_name: x})[0]
+                num_rows = i % 4 + 1
+                requests.append((x[:num_rows], y[:num_rows]))
+
+            # larger than the static batch size, so it is lowered
+            runtime = sess.make_runtime(
+                job_name, max_batch_size=BATCH_SIZE * 2, batch_timeout_us=2000
+            )
+            errors = []
+
+            def predict(thread_id):
+                try:
+                    for x, y in requests[thread_id::4]:
+                        outputs = runtime.predict(**{input_name: x})
+                        test_case.assertTrue(np.allclose(outputs[output_name], y))
+                except Exception as e:
+                    errors.append(e)
+
+            threads = [threading.Thread(target=predict, args=(i,)) for i in range(4)]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+            test_case.assertEqual(errors, [])
+
+            oversized_x = np.zeros((BATCH_SIZE + 1, IN_DIM), dtype=np.float32)
+            with test_case.assertRaises(Exception):
+                runtime.predict(**{input_name: oversized_x})
+            malformed_x = np.zeros((1, IN_DIM + 1), dtype=np.float32)
+            with test_case.assertRaises(Exception):
+                runtime.predict(**{input_name: malformed_x})
+            # malformed requests reaching the binding raise instead of aborting
+            with test_case.assertRaises(ValueError):
+                runtime.runtime_.Predict(
+                    {input_name: (np.zeros((4, IN_DIM), dtype=np.float32)[::2], 2)}
+                )
+            with test_case.assertRaises(ValueError):
+                runtime.runtime_.Predict(
+                    {input_name: (np.zeros((1, IN_DIM), dtype=np.float32), 1000)}
+                )
+            with test_case.assertRaises(ValueError):
+                runtime.runtime_.Predict(
+                    {input_name: (np.zeros((1, IN_DIM), dtype=np.float64), 2)}
+                )
+            # a lone request waits batch_timeout_us for its batch, longer than this
+            x, y = requests[0]
+            with test_case.assertRaises(Exception):
+                runtime.predict_with_timeout(10, **{input_name: x})
+            outputs = runtime.predict_with_timeout(10 * 1000 * 1000, **{input_name: x})
+            test_case.assertTrue(np.allclose(outputs[output_name], y))
+            # the runtime keeps serving after rejecting requests
+            x, y = requests[0]
+            outputs = runtime.predict(**{input_name: x})
+            test_case.assertTrue(np.allclose(outputs[output_name], y))
+            del runtime
+            sess.close()
+        finally:
+            flow.clear_default_session()
+            shutil.rmtree(saved_model_path)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,75 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+import oneflow as flow
+
+from dense_model import IN_DIM, make_session, save_dense_model
+
+BATCH_SIZE = 4
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestZeroCopyInference(flow.unittest.TestCase):
+    def test_zero_copy_matches_copying(test_case):
+        saved_model_path = tempfile.mkdtemp()
+        try:
+            job_name = save_dense_model(saved_model_path, BATCH_SIZE)
+            inputs = [
+                np.random.uniform(-1, 1, (BATCH_SIZE, IN_DIM)).astype(np.float32)
+                for _ in range(4)
+            ]
+
+            sess = make_session(saved_model_path, use_zero_copy=False)
+            input_name = sess.list_inputs()[0]
+            expected = [sess.run(job_name, **{input_name: x})[0] for x in inputs]
+            sess.close()
+
+            sess = make_session(saved_model_path, use_zero_copy=True)
+            output_name = sess.list_outputs()[0]
+
+            def consume(y):
+                # aliases the output regst instead of being a copy of it
+                test_case.assertFalse(y.flags.owndata)
+                test_case.assertFalse(y.flags.writeable)
+                return np.copy(y)
+
+            sess.set_output_consumer(output_name, consume)
+            for x, y in zip(inputs, expected):
+                x_before_run = np.copy(x)
+                outputs = sess.run(job_name, **{input_name: x})
+                test_case.assertTrue(np.array_equal(outputs[0], y))
+                test_case.assertTrue(np.array_equal(x, x_before_run))
+
+                def fill(regst_x, x=x):
+                    # written in place into the input regst
+                    test_case.assertFalse(regst_x.flags.owndata)
+                    test_case.assertTrue(regst_x.flags.writeable)
+                    regst_x[...] = x
+
+                outputs = sess.run(job_name, **{input_name: fill})
+                test_case.assertTrue(np.array_equal(outputs[0], y))
+            sess.close()
+        finally:
+            flow.clear_default_session()
+            shutil.rmtree(saved_model_path)
+
+
+if __name__ == "__main__":
+    unittest.main()
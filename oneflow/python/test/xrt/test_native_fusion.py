@@ -0,0 +1,128 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+
+import numpy as np
+import oneflow as flow
+
+config = flow.function_config()
+
+
+def set_fusion(use_native_fusion):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(use_native_fusion)
+
+
+def make_gelu_chain_job(input_shape, use_native_fusion):
+    set_fusion(use_native_fusion)
+
+    @flow.global_function(config)
+    def gelu_chain_job(
+        x=flow.FixedTensorDef(input_shape), b=flow.FixedTensorDef(input_shape[-1:])
+    ):
+        y = flow.nn.bias_add(x, b, data_format="NHWC")
+        y = flow.math.gelu(y)
+        return flow.math.multiply(y, y) + 1.0
+
+    return gelu_chain_job
+
+
+def make_normalize_job(input_shape, use_native_fusion):
+    set_fusion(use_native_fusion)
+
+    @flow.global_function(config)
+    def normalize_job(
+        x=flow.FixedTensorDef(input_shape),
+        mean=flow.FixedTensorDef(input_shape[:-1] + (1,)),
+        rstd=flow.FixedTensorDef(input_shape[:-1] + (1,)),
+    ):
+        y = flow.math.subtract(x, mean)
+        y = flow.math.multiply(y, rstd)
+        return flow.math.relu(flow.math.exp(flow.math.negative(flow.math.abs(y))))
+
+    return normalize_job
+
+
+def make_cast_job(input_shape, use_native_fusion):
+    set_fusion(use_native_fusion)
+
+    @flow.global_function(config)
+    def cast_job(x=flow.FixedTensorDef(input_shape)):
+        y = flow.math.square(x) * 3.0
+        return flow.cast(y, dtype=flow.int32)
+
+    return cast_job
+
+
+def make_int64_add_job(input_shape, use_native_fusion):
+    set_fusion(use_native_fusion)
+
+    @flow.global_function(config)
+    def int64_add_job(
+        x=flow.FixedTensorDef(input_shape, dtype=flow.int64),
+        y=flow.FixedTensorDef(input_shape, dtype=flow.int64),
+    ):
+        return flow.math.multiply(flow.math.add(x, y), y)
+
+    return int64_add_job
+
+
+class TestNativeFusion(unittest.TestCase):
+    def _test_body(self, make_job, inputs, shape):
+        f1 = make_job(shape, use_native_fusion=False)
+        f2 = make_job(shape, use_native_fusion=True)
+        a = f1(*inputs).get().numpy()
+        b = f2(*inputs).get().numpy()
+        print("without native fusion: ", a)
+        print("with native fusion: ", b)
+        self.assertTrue(np.allclose(a, b, rtol=1e-03, atol=1e-05))
+
+        flow.clear_default_session()
+
+    def test_gelu_chain(self):
+        for shape in [(1, 10), (4, 300), (2, 5, 1024)]:
+            x = np.random.random(shape).astype(np.float32)
+            b = np.random.random(shape[-1:]).astype(np.float32)
+            self._test_body(make_gelu_chain_job, (x, b), shape)
+
+    def test_broadcast_normalize(self):
+        for shape in [(1, 10), (4, 300), (2, 5, 1024)]:
+            x = np.random.random(shape).astype(np.float32)
+            mean = np.mean(x, axis=-1, keepdims=True)
+            rstd = 1.0 / np.sqrt(np.var(x, axis=-1, keepdims=True) + 1e-5)
+            self._test_body(
+                make_normalize_job, (x, mean, rstd.astype(np.float32)), shape
+            )
+
+    def test_cast(self):
+        for shape in [(1, 10), (4, 300)]:
+            x = np.random.random(shape).astype(np.float32) * 10
+            self._test_body(make_cast_job, (x,), shape)
+
+    def test_int64_not_fused(self):
+        # int64 values above 2**53 are not exact in double, the native engine
+        # must leave them to the int64 kernels
+        shape = (4, 300)
+        x = np.random.randint(2 ** 53, 2 ** 54, size=shape, dtype=np.int64)
+        y = np.random.randint(1, 64, size=shape, dtype=np.int64)
+        b = make_int64_add_job(shape, use_native_fusion=True)(x, y).get().numpy()
+        self.assertTrue(np.array_equal(b, (x + y) * y))
+        flow.clear_default_session()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -25,6 +25,7 @@ limitations under the License.
 #include "oneflow/core/persistence/persistent_in_stream.h"
 #include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/user/data/ofrecord_dataset.h"
+#include "oneflow/user/data/sample_cache.h"
 #include "oneflow/user/image/image_util.h"
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/global_for.h"
@@ -110,22 +111,34 @@ void LoadWorker(BaseDataset* record_dataset,
 }
 
 void DecodeWorker(const std::string image_feature_name, const std::string label_feature_name,
-                  const std::string color_space, Buffer<BaseLoadTargetPtr>* in_buffer,
+                  const std::string color_space, SampleCache* cache,
+                  Buffer<BaseLoadTargetPtr>* in_buffer,
                   Buffer<std::shared_ptr<ImageClassificationDataInstance>>* out_buffer) {
   while (true) {
     BaseLoadTargetPtr serialized_record;
     auto receive_status = in_buffer->Receive(&serialized_record);
     if (receive_status == kBufferStatusErrorClosed) { break; }
     CHECK(receive_status == kBufferStatusSuccess);
-    OFRecord record;
-    CHECK(record.ParseFromArray(serialized_record->data<char>(),
-                                serialized_record->shape().elem_cnt()));
     std::shared_ptr<ImageClassificationDataInstance> instance(
         new ImageClassificationDataInstance());
     instance->image.reset(new TensorBuffer());
-    DecodeImageFromOFRecord(record, image_feature_name, color_space, instance->image.get());
     instance->label.reset(new TensorBuffer());
-    DecodeLabelFromFromOFRecord(record, label_feature_name, instance->label.get());
+    uint64_t cache_key = 0;
+    if (cache != nullptr) {
+      cache_key = SampleCacheKey(serialized_record->data<char>(),
+                                 serialized_record->shape().elem_cnt());
+    }
+    if (cache == nullptr
+        || !cache->Lookup(cache_key, {instance->image.get(), instance->label.get()})) {
+      OFRecord record;
+      CHECK(record.ParseFromArray(serialized_record->data<char>(),
+                                  serialized_record->shape().elem_cnt()));
+      DecodeImageFromOFRecord(record, image_feature_name, color_space, instance->image.get());
+      DecodeLabelFromFromOFRecord(record, label_feature_name, instance->label.get());
+      if (cache != nullptr) {
+        cache->Insert(cache_key, {instance->image.get(), instance->label.get()});
+      }
+    }
     auto send_status = out_buffer->Send(instance);
     if (send_status == kBufferStatusErrorClosed) { break; }
     CHECK(send_status == kBufferStatusSuccess);
@@ -144,6 +157,21 @@ int32_t GetNumLocalDecodeThreads(int32_t num_decode_threads_per_machine,
   return std::max<int32_t>(num_decode_threads_per_machine / parallel_num_on_this_machine, 1);
 }
 
+// Decoded samples depend on where the records come from and on how they are decoded. A cache
+// file written for other values of these attrs is discarded. The key is persisted with the file,
+// so it is hashed with SampleCacheKey, which unlike std::hash is the same across builds.
+uint64_t GetSampleCacheConfigKey(user_op::KernelInitContext* ctx) {
+  std::string config;
+  for (const char* attr_name : {"data_dir", "part_name_prefix", "color_space",
+                                "image_feature_name", "label_feature_name"}) {
+    const std::string& value = ctx->Attr<std::string>(attr_name);
+    config += std::to_string(value.size()) + ":" + value + ";";
+  }
+  config += std::to_string(ctx->Attr<int32_t>("data_part_num")) + ";";
+  config += std::to_string(ctx->Attr<int32_t>("part_name_suffix_length")) + ";";
+  return SampleCacheKey(config.data(), config.size());
+}
+
 }  // namespace
 
 class OFRecordImageClassificationDataset final : public Dataset<ImageClassificationDataInstance> {
@@ -162,6 +190,13 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
     const auto decode_buffer_size_per_thread = ctx->Attr<int32_t>("decode_buffer_size_per_thread");
     const int32_t num_local_decode_threads = GetNumLocalDecodeThreads(
         num_decode_threads_per_machine, ctx->parallel_desc(), ctx->parallel_ctx());
+    const int64_t cache_capacity_mb = ctx->Attr<int64_t>("cache_capacity_mb");
+    if (cache_capacity_mb > 0) {
+      const std::string cache_name = ctx->user_op_conf().op_name() + "-"
+                                     + std::to_string(ctx->parallel_ctx().parallel_id());
+      cache_ = NewSampleCache(ctx->Attr<std::string>("cache_dir"), cache_name,
+                              cache_capacity_mb * 1024 * 1024, GetSampleCacheConfigKey(ctx));
+    }
     decode_in_buffers_.resize(num_local_decode_threads);
     decode_out_buffers_.resize(num_local_decode_threads);
     for (int64_t i = 0; i < num_local_decode_threads; ++i) {
@@ -169,7 +204,8 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
       decode_out_buffers_.at(i).reset(new Buffer<LoadTargetPtr>(decode_buffer_size_per_thread));
       decode_threads_.emplace_back(
           std::thread(&DecodeWorker, image_feature_name, label_feature_name, color_space,
-                      decode_in_buffers_.at(i).get(), decode_out_buffers_.at(i).get()));
+                      cache_.get(), decode_in_buffers_.at(i).get(),
+                      decode_out_buffers_.at(i).get()));
     }
     load_thread_ = std::thread(&LoadWorker, base_.get(), &decode_in_buffers_);
   }
@@ -193,6 +229,7 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
 
  private:
   std::unique_ptr<BaseDataset> base_;
+  std::unique_ptr<SampleCache> cache_;
   std::thread load_thread_;
   std::vector<std::thread> decode_threads_;
   std::vector<std::unique_ptr<Buffer<BaseLoadTargetPtr>>> decode_in_buffers_;
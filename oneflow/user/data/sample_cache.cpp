@@ -0,0 +1,284 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/sample_cache.h"
+#include "oneflow/core/persistence/file_system.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oneflow {
+namespace data {
+
+namespace {
+
+constexpr size_t kSampleCacheAlignment = 8;
+// "OFSC" followed by the version of the file format
+constexpr uint64_t kSampleCacheMagic = 0x4f46534300000001ULL;
+constexpr uint64_t kSampleCacheKeySeed = 0x9e3779b97f4a7c15ULL;
+
+struct SampleCacheFileHeader {
+  uint64_t magic;
+  uint64_t config_key;
+};
+
+struct SampleCacheRecordHeader {
+  uint64_t key;
+  uint64_t payload_size;
+};
+
+// A sample is stored as its tensor count followed by the data type, the shape and the bytes of
+// each tensor, each field padded to kSampleCacheAlignment.
+size_t SerializedSize(const std::vector<const TensorBuffer*>& tensors) {
+  size_t size = sizeof(int64_t);
+  for (const TensorBuffer* tensor : tensors) {
+    size += sizeof(int64_t) * (2 + tensor->shape().NumAxes());
+    size += RoundUp(tensor->nbytes(), kSampleCacheAlignment);
+  }
+  return size;
+}
+
+void Serialize(const std::vector<const TensorBuffer*>& tensors, char* buf) {
+  int64_t* fields = reinterpret_cast<int64_t*>(buf);
+  *fields++ = tensors.size();
+  for (const TensorBuffer* tensor : tensors) {
+    *fields++ = tensor->data_type();
+    *fields++ = tensor->shape().NumAxes();
+    for (int64_t dim : tensor->shape().dim_vec()) { *fields++ = dim; }
+    char* data = reinterpret_cast<char*>(fields);
+    if (tensor->nbytes() > 0) { memcpy(data, tensor->data(), tensor->nbytes()); }
+    fields = reinterpret_cast<int64_t*>(data + RoundUp(tensor->nbytes(), kSampleCacheAlignment));
+  }
+}
+
+void Deserialize(const char* buf, size_t size, const std::vector<TensorBuffer*>& tensors) {
+  const int64_t* fields = reinterpret_cast<const int64_t*>(buf);
+  CHECK_EQ(*fields++, static_cast<int64_t>(tensors.size()));
+  for (TensorBuffer* tensor : tensors) {
+    const DataType data_type = static_cast<DataType>(*fields++);
+    const int64_t num_axes = *fields++;
+    DimVector dim_vec(fields, fields + num_axes);
+    fields += num_axes;
+    const Shape shape(dim_vec);
+    tensor->Resize(shape, data_type);
+    const size_t nbytes = shape.elem_cnt() * GetSizeOfDataType(data_type);
+    const char* data = reinterpret_cast<const char*>(fields);
+    if (nbytes > 0) { memcpy(tensor->mut_data(), data, nbytes); }
+    fields = reinterpret_cast<const int64_t*>(data + RoundUp(nbytes, kSampleCacheAlignment));
+  }
+  CHECK_EQ(reinterpret_cast<const char*>(fields) - buf, static_cast<ptrdiff_t>(size));
+}
+
+class InMemorySampleCache final : public SampleCache {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InMemorySampleCache);
+  explicit InMemorySampleCache(int64_t capacity) : capacity_(capacity), size_(0) {}
+  ~InMemorySampleCache() override = default;
+
+  bool Lookup(uint64_t key, const std::vector<TensorBuffer*>& tensors) override {
+    std::shared_ptr<const std::string> sample;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto it = key2entry_.find(key);
+      if (it == key2entry_.end()) { return false; }
+      lru_.splice(lru_.begin(), lru_, it->second);
+      sample = it->second->second;
+    }
+    Deserialize(sample->data(), sample->size(), tensors);
+    return true;
+  }
+
+  void Insert(uint64_t key, const std::vector<const TensorBuffer*>& tensors) override {
+    const size_t sample_size = SerializedSize(tensors);
+    if (sample_size > capacity_) { return; }
+    std::shared_ptr<std::string> sample(new std::string(sample_size, '\0'));
+    Serialize(tensors, &sample->at(0));
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (key2entry_.find(key) != key2entry_.end()) { return; }
+    while (size_ + sample_size > capacity_) {
+      size_ -= lru_.back().second->size();
+      key2entry_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+    lru_.emplace_front(key, sample);
+    key2entry_.emplace(key, lru_.begin());
+    size_ += sample_size;
+  }
+
+ private:
+  using Entry = std::pair<uint64_t, std::shared_ptr<const std::string>>;
+
+  const size_t capacity_;
+  size_t size_;
+  std::mutex mutex_;
+  std::list<Entry> lru_;
+  HashMap<uint64_t, std::list<Entry>::iterator> key2entry_;
+};
+
+class FileSampleCache final : public SampleCache {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(FileSampleCache);
+  FileSampleCache(const std::string& path, int64_t capacity, uint64_t config_key)
+      : capacity_(capacity), size_(0) {
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    PCHECK(fd_ >= 0) << path;
+    struct stat st {};
+    PCHECK(fstat(fd_, &st) == 0) << path;
+    // The mapping covers the whole capacity up front, so records appended later are readable
+    // through it without remapping. Only the written part of it is ever touched.
+    mapped_size_ = std::max<size_t>(capacity_, st.st_size);
+    void* ptr = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    PCHECK(ptr != MAP_FAILED) << path;
+    mapped_ = static_cast<const char*>(ptr);
+    size_t valid_size = LoadIndex(st.st_size, config_key);
+    if (valid_size == 0) {
+      if (st.st_size > 0) {
+        LOG(INFO) << "sample cache " << path << " was written for another config, discard it";
+      }
+      SampleCacheFileHeader header{kSampleCacheMagic, config_key};
+      PCHECK(pwrite(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)))
+          << path;
+      valid_size = sizeof(header);
+    } else {
+      LOG(INFO) << "sample cache " << path << " reused with " << key2offset_.size()
+                << " samples";
+    }
+    if (valid_size != static_cast<size_t>(st.st_size)) {
+      PCHECK(ftruncate(fd_, valid_size) == 0) << path;
+    }
+    size_ = valid_size;
+  }
+  ~FileSampleCache() override {
+    munmap(const_cast<char*>(mapped_), mapped_size_);
+    close(fd_);
+  }
+
+  bool Lookup(uint64_t key, const std::vector<TensorBuffer*>& tensors) override {
+    size_t offset = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto it = key2offset_.find(key);
+      if (it == key2offset_.end()) { return false; }
+      offset = it->second;
+    }
+    // Records are never modified once written, so they are read without holding the lock.
+    const auto* header = reinterpret_cast<const SampleCacheRecordHeader*>(mapped_ + offset);
+    Deserialize(mapped_ + offset + sizeof(*header), header->payload_size, tensors);
+    return true;
+  }
+
+  void Insert(uint64_t key, const std::vector<const TensorBuffer*>& tensors) override {
+    const size_t payload_size = SerializedSize(tensors);
+    const size_t record_size = sizeof(SampleCacheRecordHeader) + payload_size;
+    std::vector<char> record(record_size);
+    auto* header = reinterpret_cast<SampleCacheRecordHeader*>(record.data());
+    header->key = key;
+    header->payload_size = payload_size;
+    Serialize(tensors, record.data() + sizeof(*header));
+    size_t offset = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (size_ + record_size > capacity_) { return; }
+      if (key2offset_.find(key) != key2offset_.end()) { return; }
+      if (!writing_keys_.insert(key).second) { return; }
+      offset = size_;
+      size_ += record_size;
+    }
+    // The range is reserved, so records are written concurrently and only published to Lookup
+    // once complete.
+    PCHECK(pwrite(fd_, record.data(), record_size, offset) == static_cast<ssize_t>(record_size));
+    std::unique_lock<std::mutex> lock(mutex_);
+    writing_keys_.erase(key);
+    key2offset_.emplace(key, offset);
+  }
+
+ private:
+  // Returns the size of the valid prefix of a file written for config_key, or 0 otherwise. A
+  // record torn or left unwritten by an interrupted run ends the valid prefix.
+  size_t LoadIndex(size_t file_size, uint64_t config_key) {
+    if (file_size < sizeof(SampleCacheFileHeader)) { return 0; }
+    const auto* file_header = reinterpret_cast<const SampleCacheFileHeader*>(mapped_);
+    if (file_header->magic != kSampleCacheMagic || file_header->config_key != config_key) {
+      return 0;
+    }
+    size_t offset = sizeof(SampleCacheFileHeader);
+    while (offset + sizeof(SampleCacheRecordHeader) <= file_size) {
+      const auto* header = reinterpret_cast<const SampleCacheRecordHeader*>(mapped_ + offset);
+      const size_t record_size = sizeof(*header) + header->payload_size;
+      if (header->payload_size == 0 || header->payload_size % kSampleCacheAlignment != 0
+          || offset + record_size > file_size || offset + record_size > capacity_) {
+        break;
+      }
+      key2offset_.emplace(header->key, offset);
+      offset += record_size;
+    }
+    return offset;
+  }
+
+  const size_t capacity_;
+  size_t size_;
+  int fd_;
+  const char* mapped_;
+  size_t mapped_size_;
+  std::mutex mutex_;
+  HashMap<uint64_t, size_t> key2offset_;
+  HashSet<uint64_t> writing_keys_;
+};
+
+}  // namespace
+
+std::unique_ptr<SampleCache> NewSampleCache(const std::string& cache_dir,
+                                            const std::string& cache_name, int64_t capacity,
+                                            uint64_t config_key) {
+  CHECK_GT(capacity, 0);
+  if (cache_dir.empty()) {
+    return std::unique_ptr<SampleCache>(new InMemorySampleCache(capacity));
+  }
+  LocalFS()->RecursivelyCreateDirIfNotExist(cache_dir);
+  return std::unique_ptr<SampleCache>(
+      new FileSampleCache(JoinPath(cache_dir, cache_name), capacity, config_key));
+}
+
+uint64_t SampleCacheKey(const void* data, size_t size) {
+  // MurmurHash64A
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int r = 47;
+  uint64_t h = kSampleCacheKeySeed ^ (size * m);
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  const size_t num_blocks = size / sizeof(uint64_t);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    uint64_t k = 0;
+    memcpy(&k, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+  const unsigned char* tail = bytes + num_blocks * sizeof(uint64_t);
+  const size_t tail_size = size % sizeof(uint64_t);
+  for (size_t i = tail_size; i > 0; --i) {
+    h ^= static_cast<uint64_t>(tail[i - 1]) << (8 * (i - 1));
+  }
+  if (tail_size > 0) { h *= m; }
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+}  // namespace data
+}  // namespace oneflow
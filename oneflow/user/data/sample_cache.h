@@ -0,0 +1,56 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_SAMPLE_CACHE_H_
+#define ONEFLOW_USER_DATA_SAMPLE_CACHE_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/tensor_buffer.h"
+
+namespace oneflow {
+namespace data {
+
+// Keeps the decoded tensors of a sample so that later epochs skip parsing and decoding it again.
+// A sample is identified by a key computed from its serialized bytes, so samples hit the cache
+// whatever order they are read in.
+//
+// The cache either lives in memory and evicts the least recently used sample when it is full, or
+// lives in an append-only file under cache_dir which is mmap'd for lookups and stops growing when
+// full. The file starts with config_key; a file written for another config is discarded, and a
+// file of the same config is reused by later runs.
+class SampleCache {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SampleCache);
+  virtual ~SampleCache() = default;
+
+  // Fills tensors and returns true if the sample of key is cached.
+  virtual bool Lookup(uint64_t key, const std::vector<TensorBuffer*>& tensors) = 0;
+  virtual void Insert(uint64_t key, const std::vector<const TensorBuffer*>& tensors) = 0;
+
+ protected:
+  SampleCache() = default;
+};
+
+// Returns an in-memory cache if cache_dir is empty, otherwise a cache in cache_dir/cache_name.
+std::unique_ptr<SampleCache> NewSampleCache(const std::string& cache_dir,
+                                            const std::string& cache_name, int64_t capacity,
+                                            uint64_t config_key);
+
+uint64_t SampleCacheKey(const void* data, size_t size);
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_SAMPLE_CACHE_H_
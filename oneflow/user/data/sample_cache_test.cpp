@@ -0,0 +1,130 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <thread>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/user/data/sample_cache.h"
+
+namespace oneflow {
+namespace data {
+
+namespace {
+
+void MakeSample(int64_t seed, TensorBuffer* image, TensorBuffer* label) {
+  image->Resize(Shape({seed % 7 + 1, 5, 3}), DataType::kUInt8);
+  FOR_RANGE(int64_t, i, 0, image->elem_cnt()) { image->mut_data<uint8_t>()[i] = seed + i; }
+  label->Resize(Shape({1}), DataType::kInt32);
+  *label->mut_data<int32_t>() = seed;
+}
+
+bool LookupAndCheckSample(SampleCache* cache, int64_t seed) {
+  TensorBuffer expected_image;
+  TensorBuffer expected_label;
+  MakeSample(seed, &expected_image, &expected_label);
+  TensorBuffer image;
+  TensorBuffer label;
+  if (!cache->Lookup(seed, {&image, &label})) { return false; }
+  EXPECT_EQ(image.shape(), expected_image.shape());
+  EXPECT_EQ(image.data_type(), DataType::kUInt8);
+  EXPECT_EQ(memcmp(image.data(), expected_image.data(), image.nbytes()), 0);
+  EXPECT_EQ(label.shape(), expected_label.shape());
+  EXPECT_EQ(*label.data<int32_t>(), seed);
+  return true;
+}
+
+void InsertSample(SampleCache* cache, int64_t seed) {
+  TensorBuffer image;
+  TensorBuffer label;
+  MakeSample(seed, &image, &label);
+  cache->Insert(seed, {&image, &label});
+}
+
+}  // namespace
+
+TEST(SampleCache, in_memory_lru) {
+  // room for the first 3 samples, which take 96, 112 and 128 bytes, but not for the 4th one
+  std::unique_ptr<SampleCache> cache = NewSampleCache("", "", 400, 0);
+  FOR_RANGE(int64_t, seed, 0, 3) { InsertSample(cache.get(), seed); }
+  FOR_RANGE(int64_t, seed, 0, 3) { ASSERT_TRUE(LookupAndCheckSample(cache.get(), seed)); }
+  ASSERT_TRUE(LookupAndCheckSample(cache.get(), 0));
+  InsertSample(cache.get(), 3);
+  ASSERT_TRUE(LookupAndCheckSample(cache.get(), 0));
+  ASSERT_FALSE(LookupAndCheckSample(cache.get(), 1));
+  ASSERT_TRUE(LookupAndCheckSample(cache.get(), 3));
+}
+
+TEST(SampleCache, file) {
+  std::string cache_dir = JoinPath(GetCwd(), "tmp_test_sample_cache_dir");
+  const int64_t capacity = 1 << 20;
+  {
+    std::unique_ptr<SampleCache> cache = NewSampleCache(cache_dir, "cache", capacity, 1);
+    FOR_RANGE(int64_t, seed, 0, 100) { InsertSample(cache.get(), seed); }
+    FOR_RANGE(int64_t, seed, 0, 100) { ASSERT_TRUE(LookupAndCheckSample(cache.get(), seed)); }
+    ASSERT_FALSE(LookupAndCheckSample(cache.get(), 100));
+  }
+  {
+    // reused by a later run of the same config
+    std::unique_ptr<SampleCache> cache = NewSampleCache(cache_dir, "cache", capacity, 1);
+    FOR_RANGE(int64_t, seed, 0, 100) { ASSERT_TRUE(LookupAndCheckSample(cache.get(), seed)); }
+  }
+  {
+    // discarded by a run of another config, and stops growing when full
+    std::unique_ptr<SampleCache> cache = NewSampleCache(cache_dir, "cache", 1024, 2);
+    ASSERT_FALSE(LookupAndCheckSample(cache.get(), 0));
+    FOR_RANGE(int64_t, seed, 0, 100) { InsertSample(cache.get(), seed); }
+    ASSERT_TRUE(LookupAndCheckSample(cache.get(), 0));
+    ASSERT_FALSE(LookupAndCheckSample(cache.get(), 99));
+  }
+  LocalFS()->RecursivelyDeleteDir(cache_dir);
+}
+
+TEST(SampleCache, file_concurrent_insert) {
+  std::string cache_dir = JoinPath(GetCwd(), "tmp_test_sample_cache_concurrent_dir");
+  const int64_t capacity = 1 << 20;
+  {
+    std::unique_ptr<SampleCache> cache = NewSampleCache(cache_dir, "cache", capacity, 1);
+    // threads insert overlapping samples, so some of them race on the same key
+    std::vector<std::thread> threads;
+    FOR_RANGE(int64_t, thread_id, 0, 4) {
+      threads.emplace_back([&cache, thread_id]() {
+        FOR_RANGE(int64_t, seed, thread_id * 50, thread_id * 50 + 100) {
+          InsertSample(cache.get(), seed);
+        }
+      });
+    }
+    for (std::thread& thread : threads) { thread.join(); }
+    FOR_RANGE(int64_t, seed, 0, 250) { ASSERT_TRUE(LookupAndCheckSample(cache.get(), seed)); }
+  }
+  {
+    // the records written concurrently form a valid file
+    std::unique_ptr<SampleCache> cache = NewSampleCache(cache_dir, "cache", capacity, 1);
+    FOR_RANGE(int64_t, seed, 0, 250) { ASSERT_TRUE(LookupAndCheckSample(cache.get(), seed)); }
+  }
+  LocalFS()->RecursivelyDeleteDir(cache_dir);
+}
+
+TEST(SampleCache, key) {
+  std::string data = "oneflow-sample-cache-key";
+  ASSERT_EQ(SampleCacheKey(data.data(), data.size()), SampleCacheKey(data.data(), data.size()));
+  FOR_RANGE(size_t, size, 0, data.size()) {
+    ASSERT_NE(SampleCacheKey(data.data(), size), SampleCacheKey(data.data(), size + 1));
+  }
+}
+
+}  // namespace data
+}  // namespace oneflow
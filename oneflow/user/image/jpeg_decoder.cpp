@@ -0,0 +1,129 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/image/jpeg_decoder.h"
+#include "oneflow/user/image/image_util.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+
+namespace oneflow {
+
+namespace {
+
+struct JpegErrorManager {
+  jpeg_error_mgr pub;
+  std::jmp_buf setjmp_buffer;
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+  auto* err = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+  std::longjmp(err->setjmp_buffer, 1);
+}
+
+void JpegOutputMessage(j_common_ptr cinfo) {
+  // Warnings of corrupted data are not fatal, keep silent like cv::imdecode
+}
+
+// The smallest scale_num / 8 keeping the scaled crop window not smaller than the target
+int GetScaleNum(int64_t crop_h, int64_t crop_w, int64_t target_h, int64_t target_w) {
+  for (int scale_num = 1; scale_num < 8; ++scale_num) {
+    if (crop_h * scale_num >= target_h * 8 && crop_w * scale_num >= target_w * 8) {
+      return scale_num;
+    }
+  }
+  return 8;
+}
+
+}  // namespace
+
+bool JpegPartialDecodeAndResize(const unsigned char* data, size_t length,
+                                const std::string& color_space,
+                                const std::function<void(const Shape&, CropWindow*)>& GenCropWindow,
+                                int64_t target_h, int64_t target_w, cv::Mat* image) {
+  // Objects with destructors are constructed before setjmp, longjmp must not skip any of them
+  const bool is_color = ImageUtil::IsColor(color_space);
+  const int channels = is_color ? 3 : 1;
+  CropWindow crop;
+  cv::Mat scaled;
+  jpeg_decompress_struct cinfo;
+  JpegErrorManager jerr;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = JpegErrorExit;
+  jerr.pub.output_message = JpegOutputMessage;
+  if (setjmp(jerr.setjmp_buffer)) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), length);
+  if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK || cinfo.jpeg_color_space == JCS_CMYK
+      || cinfo.jpeg_color_space == JCS_YCCK) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  if (!is_color) {
+    cinfo.out_color_space = JCS_GRAYSCALE;
+  } else if (color_space == "RGB") {
+    cinfo.out_color_space = JCS_RGB;
+  } else if (color_space == "BGR") {
+    cinfo.out_color_space = JCS_EXT_BGR;
+  } else {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  const int64_t H = cinfo.image_height;
+  const int64_t W = cinfo.image_width;
+  GenCropWindow(Shape({H, W}), &crop);
+  const int64_t crop_y = crop.anchor.At(0);
+  const int64_t crop_x = crop.anchor.At(1);
+  const int64_t crop_h = crop.shape.At(0);
+  const int64_t crop_w = crop.shape.At(1);
+  CHECK(crop_h > 0 && crop_y + crop_h <= H);
+  CHECK(crop_w > 0 && crop_x + crop_w <= W);
+  cinfo.scale_num = GetScaleNum(crop_h, crop_w, target_h, target_w);
+  cinfo.scale_denom = 8;
+  jpeg_start_decompress(&cinfo);
+  CHECK_EQ(cinfo.output_components, channels);
+
+  // The crop window in the scaled image
+  const int64_t out_h = cinfo.output_height;
+  const int64_t out_w = cinfo.output_width;
+  const int64_t y = std::min(crop_y * out_h / H, out_h - 1);
+  const int64_t x = std::min(crop_x * out_w / W, out_w - 1);
+  const int64_t h = std::max<int64_t>(std::min((crop_h * out_h + H - 1) / H, out_h - y), 1);
+  const int64_t w = std::max<int64_t>(std::min((crop_w * out_w + W - 1) / W, out_w - x), 1);
+  // Decode only the iMCU columns covering [x, x + w), which may widen the window to the left
+  JDIMENSION x_offset = x;
+  JDIMENSION width = w;
+  if (w < out_w) { jpeg_crop_scanline(&cinfo, &x_offset, &width); }
+  CHECK_LE(x_offset, x);
+  CHECK_GE(x_offset + width, x + w);
+  if (y > 0) { CHECK_EQ(jpeg_skip_scanlines(&cinfo, y), y); }
+  scaled.create(h, width, CV_8UC(channels));
+  while (cinfo.output_scanline < y + h) {
+    JSAMPROW row = scaled.ptr<JSAMPLE>(cinfo.output_scanline - y);
+    jpeg_read_scanlines(&cinfo, &row, 1);
+  }
+  // The remaining scanlines are not needed, destroying aborts the decompression
+  jpeg_destroy_decompress(&cinfo);
+
+  cv::Mat roi = scaled(cv::Rect(x - x_offset, 0, w, h));
+  cv::resize(roi, *image, cv::Size(target_w, target_h), 0, 0, cv::INTER_LINEAR);
+  return true;
+}
+
+}  // namespace oneflow
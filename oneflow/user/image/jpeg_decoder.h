@@ -0,0 +1,37 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_IMAGE_JPEG_DECODER_H_
+#define ONEFLOW_USER_IMAGE_JPEG_DECODER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/user/image/crop_window.h"
+#include <opencv2/opencv.hpp>
+
+namespace oneflow {
+
+// Decodes the crop window of a JPEG image and resizes it to target_h x target_w into `image`.
+// Only the iMCU columns and scanlines covering the window are decoded, at the smallest DCT
+// scale of libjpeg-turbo that is not smaller than the target size. `GenCropWindow` receives the
+// (H, W) of the full image. Returns false if `data` can not be decoded this way (not a JPEG
+// image, CMYK, corrupted data ...), so that callers may fall back to cv::imdecode.
+bool JpegPartialDecodeAndResize(const unsigned char* data, size_t length,
+                                const std::string& color_space,
+                                const std::function<void(const Shape&, CropWindow*)>& GenCropWindow,
+                                int64_t target_h, int64_t target_w, cv::Mat* image);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_IMAGE_JPEG_DECODER_H_
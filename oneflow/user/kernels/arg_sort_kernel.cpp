@@ -14,7 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
-#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
@@ -28,42 +28,34 @@ class CpuArgSortKernel final : public user_op::OpKernel {
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
 
     const int32_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
     const int32_t instance_num = in->shape().elem_cnt() / instance_size;
     const std::string& direction = ctx->Attr<std::string>("direction");
-    const bool is_ascending = direction == "ASCENDING";
-    const bool is_descending = direction == "DESCENDING";
-    FOR_RANGE(int32_t, i, 0, instance_num) {
-      const T* in_ptr_i = in->dptr<T>() + i * instance_size;
-      int32_t* out_ptr_i = out->mut_dptr<int32_t>() + i * instance_size;
-      std::iota(out_ptr_i, out_ptr_i + instance_size, 0);
-      auto comp = [&](const int32_t lhs, const int32_t rhs) {
-        const T l = in_ptr_i[lhs];
-        const T r = in_ptr_i[rhs];
-        if (l == r) {
-          return lhs < rhs;
-        } else {
-          if (is_ascending) {
-            return l < r;
-          } else if (is_descending) {
-            return l > r;
-          } else {
-            UNIMPLEMENTED();
-          }
-        }
-      };
-      std::sort(out_ptr_i, out_ptr_i + instance_size, comp);
+    bool is_descending = false;
+    if (direction == "DESCENDING") {
+      is_descending = true;
+    } else if (direction != "ASCENDING") {
+      UNIMPLEMENTED();
     }
+    cpu_radix_sort::SortRows(in->dptr<T>(), instance_num, instance_size, is_descending,
+                             nullptr, out->mut_dptr<int32_t>(), tmp_buffer->mut_dptr<char>());
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_CPU_ARG_SORT_KERNEL(dtype)               \
-  REGISTER_USER_KERNEL("arg_sort")                        \
-      .SetCreateFn<CpuArgSortKernel<dtype>>()             \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu") \
-                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value));
+#define REGISTER_CPU_ARG_SORT_KERNEL(dtype)                                                  \
+  REGISTER_USER_KERNEL("arg_sort")                                                           \
+      .SetCreateFn<CpuArgSortKernel<dtype>>()                                                \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                    \
+                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value))       \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                    \
+        const Shape* in_shape = ctx->Shape4ArgNameAndIndex("in", 0);                         \
+        const int64_t instance_size = in_shape->dim_vec().back();                            \
+        const int64_t instance_num = in_shape->elem_cnt() / instance_size;                   \
+        return cpu_radix_sort::InferTmpBufferSize<dtype>(instance_num, instance_size, true); \
+      });
 
 REGISTER_CPU_ARG_SORT_KERNEL(float)
 REGISTER_CPU_ARG_SORT_KERNEL(double)
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/user/ops/nn_util.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/kernel/kernel_util.h"
+#include "oneflow/core/kernel/util/host_blas_interface.h"
 
 namespace oneflow {
 
@@ -39,6 +40,13 @@ using GemmFunc = void (*)(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE tra
                           const int n, const int k, const T alpha, const T* a, const T* b,
                           const T beta, T* c);
 
+// a is the weight, whose panels pack_cache keeps across the images of a batch
+template<typename T>
+using GemmWithPackCacheFunc = void (*)(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b,
+                                       const int m, const int n, const int k, const T alpha,
+                                       const T* a, const T* b, const T beta, T* c,
+                                       CpuGemmPackCache<T>* pack_cache);
+
 template<typename T>
 void Gemm4ChannelFirst(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b, const int m,
                        const int n, const int k, const T alpha, const T* a, const T* b,
@@ -55,6 +63,28 @@ void Gemm4ChannelLast(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b
   NewKernelUtil<DeviceType::kCPU>::OFGemm(nullptr, trans_b, trans_a, n, m, k, alpha, b, a, beta, c);
 }
 
+template<typename T>
+void GemmWithPackCache4ChannelFirst(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b,
+                                    const int m, const int n, const int k, const T alpha,
+                                    const T* a, const T* b, const T beta, T* c,
+                                    CpuGemmPackCache<T>* pack_cache) {
+  CHECK(pack_cache->const_operand() == CpuGemmConstOperand::kA);
+  BlasIf<DeviceType::kCPU>::OFGemmWithPackCache(nullptr, trans_a, trans_b, m, n, k, alpha, a, b,
+                                                beta, c, pack_cache);
+}
+
+template<typename T>
+void GemmWithPackCache4ChannelLast(enum CBLAS_TRANSPOSE trans_a, enum CBLAS_TRANSPOSE trans_b,
+                                   const int m, const int n, const int k, const T alpha,
+                                   const T* a, const T* b, const T beta, T* c,
+                                   CpuGemmPackCache<T>* pack_cache) {
+  CHECK(pack_cache->const_operand() == CpuGemmConstOperand::kB);
+  trans_a = (trans_a == CblasNoTrans) ? CblasTrans : CblasNoTrans;
+  trans_b = (trans_b == CblasNoTrans) ? CblasTrans : CblasNoTrans;
+  BlasIf<DeviceType::kCPU>::OFGemmWithPackCache(nullptr, trans_b, trans_a, n, m, k, alpha, b, a,
+                                                beta, c, pack_cache);
+}
+
 template<typename T>
 T* GetImgMutDptr(user_op::Tensor* tensor, int64_t idx) {
   return tensor->mut_dptr<T>() + tensor->shape().Count(1) * idx;
@@ -296,6 +326,8 @@ struct ConvOpKernelState final : public user_op::OpKernelState {
   Im2ColFunc<T> im2col_func_;
   Col2ImFunc<T> col2im_func_;
   GemmFunc<T> forward_func_;
+  GemmWithPackCacheFunc<T> forward_with_weight_pack_cache_func_;
+  std::unique_ptr<CpuGemmPackCache<T>> weight_pack_cache_;
 
   Shape in_5d_shape_;
   Shape out_5d_shape_;
@@ -337,12 +369,16 @@ std::shared_ptr<user_op::OpKernelState> CreateConvOpKernelState(user_op::KernelI
     state->im2col_func_ = ConvKernelUtil<T>::NCDHWIm2Col;
     state->col2im_func_ = ConvKernelUtil<T>::NCDHWCol2Im;
     state->forward_func_ = Gemm4ChannelFirst;
+    state->forward_with_weight_pack_cache_func_ = GemmWithPackCache4ChannelFirst;
+    state->weight_pack_cache_.reset(new CpuGemmPackCache<T>(CpuGemmConstOperand::kA));
     state->is_out_diff_need_trans_ = CblasNoTrans;
     state->idx_offset_ = 2;
   } else {
     state->im2col_func_ = ConvKernelUtil<T>::NDHWCIm2Col;
     state->col2im_func_ = ConvKernelUtil<T>::NDHWCCol2Im;
     state->forward_func_ = Gemm4ChannelLast;
+    state->forward_with_weight_pack_cache_func_ = GemmWithPackCache4ChannelLast;
+    state->weight_pack_cache_.reset(new CpuGemmPackCache<T>(CpuGemmConstOperand::kB));
     state->is_out_diff_need_trans_ = CblasTrans;
     state->idx_offset_ = 1;
   }
@@ -411,6 +447,8 @@ class ConvCpuKernel final : public user_op::OpKernel {
     auto* conv_state = dynamic_cast<ConvOpKernelState<T>*>(state);
     conv_state->Update(in->shape(), out->shape());
     CHECK_NOTNULL(conv_state);
+    // the weight may have been updated since the last call, so pack it once per call
+    conv_state->weight_pack_cache_->Invalidate();
     bool is_bias_mul_inited = false;
     for (int64_t i = 0; i < in->shape().At(0); ++i) {
       conv_state->im2col_func_(GetImgDptr<T>(in, i), ShapeView(conv_state->in_5d_shape_),
@@ -422,13 +460,13 @@ class ConvCpuKernel final : public user_op::OpKernel {
       // channels first: out = weight * col_buf
       // channels last:  out = (weight * col_buf)(T)
       int32_t idx_offset = conv_state->idx_offset_;
-      conv_state->forward_func_(
+      conv_state->forward_with_weight_pack_cache_func_(
           CblasNoTrans, CblasNoTrans,
           conv_state->weight_5d_shape_.At(0),                           // filter
           conv_state->out_5d_shape_.Count(idx_offset, idx_offset + 3),  // od * oh * ow
           conv_state->weight_5d_shape_.Count(1),                        // ci * kd * kh * kw
           static_cast<T>(1), weight->dptr<T>(), col_buf_dptr, static_cast<T>(0),
-          GetImgMutDptr<T>(out, i));
+          GetImgMutDptr<T>(out, i), conv_state->weight_pack_cache_.get());
 
       const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
       if (bias != nullptr) {
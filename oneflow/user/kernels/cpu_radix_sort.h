@@ -0,0 +1,298 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
+#define ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
+
+#include <array>
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+namespace cpu_radix_sort {
+
+constexpr int32_t kRadixBits = 8;
+constexpr int32_t kRadixSize = 1 << kRadixBits;
+// Rows shorter than this are insertion sorted, the histogram setup of a radix pass dominates
+constexpr int64_t kMinRadixSortSize = 64;
+// Rows at least this long are split across the thread pool when there are too few rows
+constexpr int64_t kMinParallelSortSize = 1 << 16;
+constexpr int64_t kMinElemCntPerPart = 1 << 14;
+
+template<typename K>
+K SignBit() {
+  return static_cast<K>(1) << (sizeof(K) * 8 - 1);
+}
+
+// Maps T to an unsigned key whose unsigned order is the order of T
+template<typename T, typename Enable = void>
+struct RadixKeyTrait;
+
+template<typename T>
+struct RadixKeyTrait<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  using KeyType = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+  static KeyType Encode(T val) {
+    // -0.0 == +0.0, keep them as one key so that ties stay in index order
+    if (val == static_cast<T>(0)) { val = static_cast<T>(0); }
+    KeyType bits;
+    std::memcpy(&bits, &val, sizeof(T));
+    return (bits & SignBit<KeyType>()) ? ~bits : (bits | SignBit<KeyType>());
+  }
+  static T Decode(KeyType key) {
+    const KeyType bits = (key & SignBit<KeyType>()) ? (key ^ SignBit<KeyType>()) : ~key;
+    T val;
+    std::memcpy(&val, &bits, sizeof(T));
+    return val;
+  }
+};
+
+template<typename T>
+struct RadixKeyTrait<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+  using KeyType = typename std::make_unsigned<T>::type;
+  static KeyType Encode(T val) {
+    const KeyType bits = static_cast<KeyType>(val);
+    return std::is_signed<T>::value ? (bits ^ SignBit<KeyType>()) : bits;
+  }
+  static T Decode(KeyType key) {
+    return static_cast<T>(std::is_signed<T>::value ? (key ^ SignBit<KeyType>()) : key);
+  }
+};
+
+template<typename T>
+using RadixKeyType = typename RadixKeyTrait<T>::KeyType;
+
+template<typename T>
+void EncodeKeys(const T* in, int64_t begin, int64_t end, bool descending, RadixKeyType<T>* keys,
+                int32_t* indices) {
+  if (descending) {
+    FOR_RANGE(int64_t, i, begin, end) { keys[i] = ~RadixKeyTrait<T>::Encode(in[i]); }
+  } else {
+    FOR_RANGE(int64_t, i, begin, end) { keys[i] = RadixKeyTrait<T>::Encode(in[i]); }
+  }
+  if (indices) { FOR_RANGE(int64_t, i, begin, end) { indices[i] = static_cast<int32_t>(i); } }
+}
+
+template<typename T>
+void DecodeKeys(const RadixKeyType<T>* keys, int64_t begin, int64_t end, bool descending,
+                T* out) {
+  if (descending) {
+    FOR_RANGE(int64_t, i, begin, end) { out[i] = RadixKeyTrait<T>::Decode(~keys[i]); }
+  } else {
+    FOR_RANGE(int64_t, i, begin, end) { out[i] = RadixKeyTrait<T>::Decode(keys[i]); }
+  }
+}
+
+template<typename K>
+int32_t Digit(K key, int32_t pass) {
+  return static_cast<int32_t>((key >> (pass * kRadixBits)) & (kRadixSize - 1));
+}
+
+// Stable, so equal keys keep their index order. values may be null
+template<typename K>
+void InsertionSortPairs(int64_t n, K* keys, int32_t* values) {
+  FOR_RANGE(int64_t, i, 1, n) {
+    const K key = keys[i];
+    const int32_t value = values ? values[i] : 0;
+    int64_t j = i - 1;
+    for (; j >= 0 && keys[j] > key; --j) {
+      keys[j + 1] = keys[j];
+      if (values) { values[j + 1] = values[j]; }
+    }
+    keys[j + 1] = key;
+    if (values) { values[j + 1] = value; }
+  }
+}
+
+// LSD radix sort, stable. The result is left in keys/values, the buffers are scratch space of
+// the same length. values and values_buf may be null
+template<typename K>
+void RadixSortPairs(int64_t n, K* keys, int32_t* values, K* keys_buf, int32_t* values_buf) {
+  if (n < kMinRadixSortSize) {
+    InsertionSortPairs(n, keys, values);
+    return;
+  }
+  constexpr int32_t kNumPasses = sizeof(K) * 8 / kRadixBits;
+  std::array<int64_t, kNumPasses * kRadixSize> hist;
+  hist.fill(0);
+  FOR_RANGE(int64_t, i, 0, n) {
+    const K key = keys[i];
+    FOR_RANGE(int32_t, pass, 0, kNumPasses) { hist[pass * kRadixSize + Digit(key, pass)] += 1; }
+  }
+  K* src_keys = keys;
+  K* dst_keys = keys_buf;
+  int32_t* src_values = values;
+  int32_t* dst_values = values_buf;
+  FOR_RANGE(int32_t, pass, 0, kNumPasses) {
+    int64_t* offsets = hist.data() + pass * kRadixSize;
+    // every key shares this digit, the pass would be an identity permutation
+    if (offsets[Digit(src_keys[0], pass)] == n) { continue; }
+    int64_t offset = 0;
+    FOR_RANGE(int32_t, digit, 0, kRadixSize) {
+      const int64_t cnt = offsets[digit];
+      offsets[digit] = offset;
+      offset += cnt;
+    }
+    if (src_values) {
+      FOR_RANGE(int64_t, i, 0, n) {
+        const int64_t pos = offsets[Digit(src_keys[i], pass)]++;
+        dst_keys[pos] = src_keys[i];
+        dst_values[pos] = src_values[i];
+      }
+    } else {
+      FOR_RANGE(int64_t, i, 0, n) { dst_keys[offsets[Digit(src_keys[i], pass)]++] = src_keys[i]; }
+    }
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+  if (src_keys != keys) {
+    std::copy(src_keys, src_keys + n, keys);
+    if (values) { std::copy(src_values, src_values + n, values); }
+  }
+}
+
+inline int64_t NumParallelParts(int64_t n) {
+  const int64_t thread_num = Global<ThreadPool>::Get()->thread_num();
+  return std::max<int64_t>(std::min<int64_t>(thread_num, n / kMinElemCntPerPart), 1);
+}
+
+// Same contract as RadixSortPairs, with every pass split into per thread histogram and scatter
+// phases. Offsets are assigned digit-major and part-minor so the sort stays stable
+template<typename K>
+void ParallelRadixSortPairs(int64_t n, K* keys, int32_t* values, K* keys_buf,
+                            int32_t* values_buf) {
+  const int64_t num_parts = NumParallelParts(n);
+  if (num_parts == 1) {
+    RadixSortPairs(n, keys, values, keys_buf, values_buf);
+    return;
+  }
+  constexpr int32_t kNumPasses = sizeof(K) * 8 / kRadixBits;
+  const BalancedSplitter bs(n, num_parts);
+  std::vector<int64_t> hist(num_parts * kRadixSize);
+  K* src_keys = keys;
+  K* dst_keys = keys_buf;
+  int32_t* src_values = values;
+  int32_t* dst_values = values_buf;
+  FOR_RANGE(int32_t, pass, 0, kNumPasses) {
+    MultiThreadLoop(num_parts, [&](size_t part) {
+      int64_t* part_hist = hist.data() + part * kRadixSize;
+      std::fill(part_hist, part_hist + kRadixSize, 0);
+      const Range range = bs.At(part);
+      FOR_RANGE(int64_t, i, range.begin(), range.end()) {
+        part_hist[Digit(src_keys[i], pass)] += 1;
+      }
+    });
+    int64_t offset = 0;
+    bool is_identity = false;
+    FOR_RANGE(int32_t, digit, 0, kRadixSize) {
+      int64_t digit_cnt = 0;
+      FOR_RANGE(int64_t, part, 0, num_parts) {
+        const int64_t cnt = hist[part * kRadixSize + digit];
+        hist[part * kRadixSize + digit] = offset;
+        offset += cnt;
+        digit_cnt += cnt;
+      }
+      if (digit_cnt == n) { is_identity = true; }
+    }
+    if (is_identity) { continue; }
+    MultiThreadLoop(num_parts, [&](size_t part) {
+      int64_t* offsets = hist.data() + part * kRadixSize;
+      const Range range = bs.At(part);
+      FOR_RANGE(int64_t, i, range.begin(), range.end()) {
+        const int64_t pos = offsets[Digit(src_keys[i], pass)]++;
+        dst_keys[pos] = src_keys[i];
+        if (src_values) { dst_values[pos] = src_values[i]; }
+      }
+    });
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+  if (src_keys != keys) {
+    MultiThreadLoop(num_parts, [&](size_t part) {
+      const Range range = bs.At(part);
+      std::copy(src_keys + range.begin(), src_keys + range.end(), keys + range.begin());
+      if (values) {
+        std::copy(src_values + range.begin(), src_values + range.end(), values + range.begin());
+      }
+    });
+  }
+}
+
+template<typename T>
+size_t RowTmpBufferSize(int64_t instance_size, bool with_indices) {
+  const size_t size =
+      instance_size * (2 * sizeof(RadixKeyType<T>) + (with_indices ? sizeof(int32_t) : 0));
+  return RoundUp(size, sizeof(uint64_t));
+}
+
+template<typename T>
+size_t InferTmpBufferSize(int64_t instance_num, int64_t instance_size, bool with_indices) {
+  return instance_num * RowTmpBufferSize<T>(instance_size, with_indices);
+}
+
+// Sorts one row of n elements into out_values and/or out_indices (either may be null). Equal
+// elements keep their original order. tmp_buffer holds RowTmpBufferSize<T>(n, ...) bytes
+template<typename T>
+void SortRow(const T* in, int64_t n, bool descending, T* out_values, int32_t* out_indices,
+             char* tmp_buffer, bool parallel) {
+  using K = RadixKeyType<T>;
+  K* keys = reinterpret_cast<K*>(tmp_buffer);
+  K* keys_buf = keys + n;
+  int32_t* indices_buf = out_indices ? reinterpret_cast<int32_t*>(keys_buf + n) : nullptr;
+  if (parallel && NumParallelParts(n) > 1) {
+    const int64_t num_parts = NumParallelParts(n);
+    const BalancedSplitter bs(n, num_parts);
+    MultiThreadLoop(num_parts, [&](size_t part) {
+      EncodeKeys(in, bs.At(part).begin(), bs.At(part).end(), descending, keys, out_indices);
+    });
+    ParallelRadixSortPairs(n, keys, out_indices, keys_buf, indices_buf);
+    if (out_values) {
+      MultiThreadLoop(num_parts, [&](size_t part) {
+        DecodeKeys(keys, bs.At(part).begin(), bs.At(part).end(), descending, out_values);
+      });
+    }
+  } else {
+    EncodeKeys(in, 0, n, descending, keys, out_indices);
+    RadixSortPairs(n, keys, out_indices, keys_buf, indices_buf);
+    if (out_values) { DecodeKeys(keys, 0, n, descending, out_values); }
+  }
+}
+
+// Rows are spread over the thread pool, or when there are fewer rows than threads and the rows
+// are long, each row is sorted by all threads in turn
+template<typename T>
+void SortRows(const T* in, int64_t instance_num, int64_t instance_size, bool descending,
+              T* out_values, int32_t* out_indices, char* tmp_buffer) {
+  const size_t row_tmp_size = RowTmpBufferSize<T>(instance_size, out_indices != nullptr);
+  auto SortRowI = [&](int64_t i, bool parallel) {
+    const int64_t offset = i * instance_size;
+    SortRow(in + offset, instance_size, descending, out_values ? out_values + offset : nullptr,
+            out_indices ? out_indices + offset : nullptr, tmp_buffer + i * row_tmp_size,
+            parallel);
+  };
+  if (instance_num < Global<ThreadPool>::Get()->thread_num()
+      && instance_size >= kMinParallelSortSize) {
+    FOR_RANGE(int64_t, i, 0, instance_num) { SortRowI(i, true); }
+  } else {
+    MultiThreadLoop(instance_num, [&](size_t i) { SortRowI(i, false); });
+  }
+}
+
+}  // namespace cpu_radix_sort
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
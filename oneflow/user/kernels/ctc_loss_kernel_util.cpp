@@ -14,6 +14,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/kernels/ctc_loss_kernel_util.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
+#include "oneflow/core/kernel/util/cpu_fast_math.h"
+
+#include <atomic>
 
 namespace oneflow {
 
@@ -48,6 +52,79 @@ struct CtcLossKernelUtil<DeviceType::kCPU, T, IDX> final {
                               const int blank, const bool zero_infinity);
 };
 
+namespace {
+
+// lattice cells per part below which handing batch items to other threads costs more than it saves
+constexpr int64_t kCtcLossParallelGrainSize = 4096;
+
+// Calls Handler(b) for every batch item. Items are handed out to the threads of the thread pool one
+// at a time, since their lattice sizes differ with the input and target lengths.
+template<typename IDX, typename Handler>
+void CtcLossForEachBatchItem(const int64_t batch_size, const IDX* input_lengths_ptr,
+                             const IDX* target_lengths_ptr, const Handler& handler) {
+  int64_t cell_cnt = 0;
+  FOR_RANGE(int64_t, b, 0, batch_size) {
+    cell_cnt += static_cast<int64_t>(input_lengths_ptr[b]) * (2 * target_lengths_ptr[b] + 1);
+  }
+  const int64_t part_num =
+      std::min(batch_size, CpuParallelPartNum(cell_cnt, kCtcLossParallelGrainSize));
+  if (part_num <= 1) {
+    FOR_RANGE(int64_t, b, 0, batch_size) { handler(b); }
+    return;
+  }
+  std::atomic<int64_t> next_b(0);
+  MultiThreadLoop(part_num, [&](size_t part_id) {
+    for (int64_t b = next_b++; b < batch_size; b = next_b++) { handler(b); }
+  });
+}
+
+// Extended target l' of batch item b (blanks around and between the labels) and, for every
+// position s, whether the recurrence may skip from s - 2 to s, i.e. l'[s] != l'[s - 2]
+void GetTargetPrimes(const int* targets_ptr, int64_t max_target_length, int64_t b,
+                     int64_t target_length, int blank, std::vector<int>* target_primes,
+                     std::vector<char>* can_skip) {
+  const int64_t s_cnt = 2 * target_length + 1;
+  target_primes->resize(s_cnt);
+  can_skip->resize(s_cnt);
+  FOR_RANGE(int64_t, s, 0, s_cnt) {
+    (*target_primes)[s] = get_target_prime(targets_ptr, max_target_length, b, s, blank);
+    (*can_skip)[s] = s > 1 && (*target_primes)[s] != (*target_primes)[s - 2];
+  }
+}
+
+// One row of the log-space recurrence over s_cnt positions:
+//   y[s] = log(exp(x1[s]) + exp(x2[s]) + exp(x3[s])) + lp[s]
+// where x1[s] = prev[s], x2[s] = prev[s + step] and x3[s] = prev[s + 2 * step] when skip[s] (both
+// -inf when out of the row), evaluated as branch free passes over the row so that the exps and the
+// log run on the simd versions of cpu_fast_math. tmp holds 3 * s_cnt elements.
+template<typename T>
+void LogSumExpRecurrenceRow(const int64_t s_cnt, const int64_t step, const T* prev,
+                            const char* skip, const T* lp, T* tmp, T* y) {
+  constexpr T neginf = -std::numeric_limits<T>::infinity();
+  T* d1 = tmp;
+  T* d2 = tmp + s_cnt;
+  T* d3 = tmp + 2 * s_cnt;
+  FOR_RANGE(int64_t, s, 0, s_cnt) {
+    const int64_t s2 = s + step;
+    const int64_t s3 = s + 2 * step;
+    const T x1 = prev[s];
+    const T x2 = (s2 >= 0 && s2 < s_cnt) ? prev[s2] : neginf;
+    const T x3 = skip[s] ? prev[s3] : neginf;
+    T m = std::max(x1, std::max(x2, x3));
+    if (m == neginf) { m = 0; }
+    d1[s] = x1 - m;
+    d2[s] = x2 - m;
+    d3[s] = x3 - m;
+    y[s] = m;
+  }
+  cpu_fast_math::Exp(tmp, tmp, 3 * s_cnt);
+  FOR_RANGE(int64_t, s, 0, s_cnt) { d1[s] = d1[s] + d2[s] + d3[s]; }
+  cpu_fast_math::Log(d1, d1, s_cnt);
+  FOR_RANGE(int64_t, s, 0, s_cnt) { y[s] = d1[s] + y[s] + lp[s]; }
+}
+
+}  // namespace
+
 template<typename T, typename IDX>
 void CtcLossKernelUtil<DeviceType::kCPU, T, IDX>::CtcLossForward(
     DeviceCtx* ctx, const T* log_probs_ptr, const int* targets_ptr, const IDX* input_lengths_ptr,
@@ -60,44 +137,31 @@ void CtcLossKernelUtil<DeviceType::kCPU, T, IDX>::CtcLossForward(
     CHECK_GE(max_input_length, input_lengths_ptr[b]);
     CHECK_GE(max_target_length, target_lengths_ptr[b]);
   }
-  FOR_RANGE(int32_t, b, 0, batch_size) {
-    IDX input_length = input_lengths_ptr[b];
-    IDX target_length = target_lengths_ptr[b];
+  CtcLossForEachBatchItem(batch_size, input_lengths_ptr, target_lengths_ptr, [&](int64_t b) {
+    const IDX input_length = input_lengths_ptr[b];
+    const IDX target_length = target_lengths_ptr[b];
+    const int64_t s_cnt = 2 * target_length + 1;
+    std::vector<int> target_primes;
+    std::vector<char> can_skip;
+    GetTargetPrimes(targets_ptr, max_target_length, b, target_length, blank, &target_primes,
+                    &can_skip);
+    std::vector<T> lp(s_cnt);
+    std::vector<T> tmp(3 * s_cnt);
 
-    int64_t alpha_idx = alpha_helper.NdIndexToOffset(b, 0, 0);
-    for (IDX s = 0; s < 2 * target_length + 1; s++) { alpha_ptr[alpha_idx + s] = neginf; }
-    alpha_ptr[alpha_idx] = log_probs_ptr[input_helper.NdIndexToOffset(0, b, blank)];
+    T* alpha_row = alpha_ptr + alpha_helper.NdIndexToOffset(b, 0, 0);
+    std::fill(alpha_row, alpha_row + s_cnt, neginf);
+    alpha_row[0] = log_probs_ptr[input_helper.NdIndexToOffset(0, b, blank)];
     if (target_length > 0) {
-      int target = get_target_prime(targets_ptr, max_target_length, b, 1, blank);
-      alpha_ptr[alpha_idx + 1] = log_probs_ptr[input_helper.NdIndexToOffset(0, b, target)];
+      alpha_row[1] = log_probs_ptr[input_helper.NdIndexToOffset(0, b, target_primes[1])];
     }
 
     for (IDX t = 1; t < input_length; t++) {
-      for (IDX s = 0; s < 2 * target_length + 1; s++) {
-        int current_target_prime = get_target_prime(targets_ptr, max_target_length, b, s, blank);
-        T la1 = alpha_ptr[alpha_helper.NdIndexToOffset(b, t - 1, s)];
-        T la2, la3, lamax = la1;
-        if (s > 0) {
-          la2 = alpha_ptr[alpha_helper.NdIndexToOffset(b, t - 1, s - 1)];
-          if (la2 > lamax) lamax = la2;
-        } else {
-          la2 = neginf;
-        }
-        if ((s > 1)
-            && (get_target_prime(targets_ptr, max_target_length, b, s - 2, blank)
-                != current_target_prime)) {
-          la3 = alpha_ptr[alpha_helper.NdIndexToOffset(b, t - 1, s - 2)];
-          if (la3 > lamax) lamax = la3;
-        } else {
-          la3 = neginf;
-        }
-        if (lamax == neginf) lamax = 0;
-
-        int64_t idx_t_s = alpha_helper.NdIndexToOffset(b, t, s);
-        alpha_ptr[idx_t_s] =
-            std::log(std::exp(la1 - lamax) + std::exp(la2 - lamax) + std::exp(la3 - lamax)) + lamax
-            + log_probs_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
-      }
+      const T* log_probs_row = log_probs_ptr + input_helper.NdIndexToOffset(t, b, 0);
+      FOR_RANGE(int64_t, s, 0, s_cnt) { lp[s] = log_probs_row[target_primes[s]]; }
+      const T* prev_row = alpha_ptr + alpha_helper.NdIndexToOffset(b, t - 1, 0);
+      alpha_row = alpha_ptr + alpha_helper.NdIndexToOffset(b, t, 0);
+      LogSumExpRecurrenceRow<T>(s_cnt, -1, prev_row, can_skip.data(), lp.data(), tmp.data(),
+                                alpha_row);
     }
 
     if (target_length == 0) {
@@ -113,7 +177,7 @@ void CtcLossKernelUtil<DeviceType::kCPU, T, IDX>::CtcLossForward(
       T log_likelihood = std::log(std::exp(l1 - m) + std::exp(l2 - m)) + m;
       loss_ptr[b] = -log_likelihood;
     }
-  }
+  });
 }
 
 template<typename T, typename IDX>
@@ -125,99 +189,75 @@ void CtcLossKernelUtil<DeviceType::kCPU, T, IDX>::CtcLossBackward(
     const int64_t batch_size, const int64_t max_input_length, const int64_t max_target_length,
     const int64_t num_labels, const int blank, const bool zero_infinity) {
   constexpr T neginf = -std::numeric_limits<T>::infinity();
-  int64_t elem_cnt = max_input_length * batch_size * num_labels;
-  FOR_RANGE(int64_t, i, 0, elem_cnt) { grad_ptr[i] = neginf; }
-
-  FOR_RANGE(int64_t, b, 0, batch_size) {
-    IDX input_length = input_lengths_ptr[b];
-    IDX target_length = target_lengths_ptr[b];
-    T nll = loss_ptr[b];
+  CtcLossForEachBatchItem(batch_size, input_lengths_ptr, target_lengths_ptr, [&](int64_t b) {
+    const IDX input_length = input_lengths_ptr[b];
+    const IDX target_length = target_lengths_ptr[b];
+    const T nll = loss_ptr[b];
+    auto GradRow = [&](int64_t t) { return grad_ptr + input_helper.NdIndexToOffset(t, b, 0); };
     if (zero_infinity && nll == std::numeric_limits<T>::infinity()) {
-      for (IDX t = 0; t < max_input_length; t++) {
-        for (IDX c = 0; c < num_labels; c++) {
-          grad_ptr[input_helper.NdIndexToOffset(t, b, c)] = 0;
-        }
+      FOR_RANGE(int64_t, t, 0, max_input_length) {
+        std::fill(GradRow(t), GradRow(t) + num_labels, 0);
       }
-      continue;
+      return;
     }
+    const int64_t s_cnt = 2 * target_length + 1;
+    std::vector<int> target_primes;
+    std::vector<char> can_skip;
+    GetTargetPrimes(targets_ptr, max_target_length, b, target_length, blank, &target_primes,
+                    &can_skip);
+    // beta[s] may skip to s + 2 iff alpha[s + 2] may skip to s
+    std::vector<char> can_skip_back(s_cnt, 0);
+    FOR_RANGE(int64_t, s, 0, s_cnt - 2) { can_skip_back[s] = can_skip[s + 2]; }
+    std::vector<T> lp(s_cnt);
+    std::vector<T> tmp(std::max(3 * s_cnt, 2 * num_labels));
+    std::vector<T> lcab(num_labels);
+    const T grad_out = grad_out_ptr[b];
 
-    if (input_length > 0) {
-      int64_t beta_idx = beta_helper.NdIndexToOffset(b, input_length - 1, 0);
-      for (IDX s = 0; s < 2 * target_length + 1; s++) { beta_ptr[beta_idx + s] = neginf; }
-      beta_ptr[beta_idx + 2 * target_length] =
-          log_probs_ptr[input_helper.NdIndexToOffset(input_length - 1, b, blank)];
-      grad_ptr[input_helper.NdIndexToOffset(input_length - 1, b, blank)] =
-          alpha_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length)]
-          + beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length)];
-
-      if (target_length > 0) {
-        int target =
-            get_target_prime(targets_ptr, max_target_length, b, 2 * target_length - 1, blank);
-        beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length - 1)] =
-            log_probs_ptr[input_helper.NdIndexToOffset(input_length - 1, b, target)];
-        grad_ptr[input_helper.NdIndexToOffset(input_length - 1, b, target)] =
-            alpha_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length - 1)]
-            + beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length - 1)];
-      }
-    }
-
-    for (IDX t = input_length - 2; t >= 0; t--) {
-      for (IDX s = 2 * target_length; s >= 0; s--) {
-        int current_target_prime = get_target_prime(targets_ptr, max_target_length, b, s, blank);
-        T lb1 = beta_ptr[beta_helper.NdIndexToOffset(b, t + 1, s)];
-        T lb2, lb3, lbmax = lb1;
-
-        if (s < 2 * target_length) {
-          lb2 = beta_ptr[beta_helper.NdIndexToOffset(b, t + 1, s + 1)];
-          if (lb2 > lbmax) lbmax = lb2;
-        } else {
-          lb2 = neginf;
-        }
-
-        if ((s < 2 * target_length - 1)
-            && (get_target_prime(targets_ptr, max_target_length, b, s + 2, blank)
-                != current_target_prime)) {
-          lb3 = beta_ptr[beta_helper.NdIndexToOffset(b, t + 1, s + 2)];
-          if (lb3 > lbmax) lbmax = lb3;
-        } else {
-          lb3 = neginf;
+    for (IDX t = input_length - 1; t >= 0; t--) {
+      const T* log_probs_row = log_probs_ptr + input_helper.NdIndexToOffset(t, b, 0);
+      const T* alpha_row = alpha_ptr + beta_helper.NdIndexToOffset(b, t, 0);
+      T* beta_row = beta_ptr + beta_helper.NdIndexToOffset(b, t, 0);
+      if (t == input_length - 1) {
+        std::fill(beta_row, beta_row + s_cnt, neginf);
+        beta_row[2 * target_length] = log_probs_row[blank];
+        if (target_length > 0) {
+          beta_row[2 * target_length - 1] = log_probs_row[target_primes[2 * target_length - 1]];
         }
-        if (lbmax == neginf) lbmax = 0;
-
-        int64_t idx_t_s = beta_helper.NdIndexToOffset(b, t, s);
-        beta_ptr[idx_t_s] =
-            std::log(std::exp(lb1 - lbmax) + std::exp(lb2 - lbmax) + std::exp(lb3 - lbmax)) + lbmax
-            + log_probs_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
+      } else {
+        FOR_RANGE(int64_t, s, 0, s_cnt) { lp[s] = log_probs_row[target_primes[s]]; }
+        const T* next_row = beta_ptr + beta_helper.NdIndexToOffset(b, t + 1, 0);
+        LogSumExpRecurrenceRow<T>(s_cnt, 1, next_row, can_skip_back.data(), lp.data(),
+                                  tmp.data(), beta_row);
+      }
 
-        T log_alpha_beta = alpha_ptr[idx_t_s] + beta_ptr[idx_t_s];
-        T& lcab = grad_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
-        if (lcab == neginf) {
-          lcab = log_alpha_beta;
+      // log of the summed alpha * beta of the positions of each label
+      std::fill(lcab.begin(), lcab.end(), neginf);
+      for (int64_t s = s_cnt - 1; s >= 0; s--) {
+        const T log_alpha_beta = alpha_row[s] + beta_row[s];
+        T& res = lcab[target_primes[s]];
+        if (res == neginf) {
+          res = log_alpha_beta;
         } else {
-          T m = std::max(lcab, log_alpha_beta);
-          lcab = std::log(std::exp(lcab - m) + std::exp(log_alpha_beta - m)) + m;
+          T m = std::max(res, log_alpha_beta);
+          res = std::log(std::exp(res - m) + std::exp(log_alpha_beta - m)) + m;
         }
       }
-    }
 
-    for (int32_t t = 0; t < input_length; t++) {
-      for (int64_t c = 0; c < num_labels; c++) {
-        T& res = grad_ptr[input_helper.NdIndexToOffset(t, b, c)];
-        T lp = log_probs_ptr[input_helper.NdIndexToOffset(t, b, c)];
-        res = (std::exp(lp) - std::exp(res + nll - lp)) * grad_out_ptr[b];
-      }
+      // grad = (exp(lp) - exp(lcab + nll - lp)) * grad_out, written once per element
+      T* exp_lp = tmp.data();
+      T* exp_lcab = tmp.data() + num_labels;
+      FOR_RANGE(int64_t, c, 0, num_labels) { exp_lcab[c] = lcab[c] + nll - log_probs_row[c]; }
+      cpu_fast_math::Exp(log_probs_row, exp_lp, num_labels);
+      cpu_fast_math::Exp(exp_lcab, exp_lcab, num_labels);
+      T* grad_row = GradRow(t);
+      FOR_RANGE(int64_t, c, 0, num_labels) { grad_row[c] = (exp_lp[c] - exp_lcab[c]) * grad_out; }
     }
 
     // zero the remainder
-    if (input_length < max_input_length) {
-      for (int64_t t = input_length; t < max_input_length; t++) {
-        for (int64_t c = 0; c < num_labels; c++) {
-          int64_t grad_idx = input_helper.NdIndexToOffset(t, b, c);
-          grad_ptr[grad_idx] = 0;
-        }
-      }
+    FOR_RANGE(int64_t, t, std::max<int64_t>(input_length, 0), max_input_length) {
+      std::fill(GradRow(t), GradRow(t) + num_labels, 0);
     }
-  }
+  });
 }
 
 #define INSTANTIATE_CTC_LOSS_KERNEL_UTIL_CPU(device_type_v, log_probs_dtype_pair,          \
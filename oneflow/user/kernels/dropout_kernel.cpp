@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/user/kernels/op_kernel_state_wrapper.h"
 #include "oneflow/user/kernels/random_mask_generator.h"
 #include "oneflow/core/kernel/kernel_util.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
 
 namespace oneflow {
 
@@ -25,7 +26,9 @@ namespace {
 template<typename T>
 void MaskAndScale(DeviceCtx* ctx, const int64_t n, float scale, const T* x, const int8_t* mask,
                   T* y) {
-  for (int64_t i = 0; i < n; ++i) { y[i] = x[i] * static_cast<T>(mask[i]) * scale; }
+  CpuParallelForEachRange(n, kCpuElementwiseGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) { y[i] = x[i] * static_cast<T>(mask[i]) * scale; }
+  });
 }
 
 template<typename T>
@@ -100,6 +103,55 @@ class DropoutGradKernelCPU final : public user_op::OpKernel {
 REGISTER_DROPOUT_GRAD_KERNEL_CPU(float)
 REGISTER_DROPOUT_GRAD_KERNEL_CPU(double)
 
+template<typename T>
+class DropoutWithRandomMaskKernelCPU final : public user_op::OpKernel {
+ public:
+  DropoutWithRandomMaskKernelCPU() = default;
+  ~DropoutWithRandomMaskKernelCPU() = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    int64_t seed = ctx->Attr<int64_t>("seed");
+    return std::make_shared<OpKernelStateWrapper<RandomMaskGenerator<DeviceType::kCPU>>>(seed);
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* mask = ctx->Tensor4ArgNameAndIndex("mask", 0);
+    auto* random_mask_generator =
+        dynamic_cast<OpKernelStateWrapper<RandomMaskGenerator<DeviceType::kCPU>>*>(state);
+    CHECK_NOTNULL(random_mask_generator);
+    random_mask_generator->Mutable()->GenerateAndMaskScale<T>(
+        ctx->device_ctx(), in->shape().elem_cnt(), ctx->Attr<float>("rate"),
+        ctx->Attr<float>("scale"), in->dptr<T>(), mask->mut_dptr<int8_t>(), out->mut_dptr<T>());
+    if (ctx->user_op_conf().has_input("_add_to_output", 0)) {
+      const user_op::Tensor* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
+      CHECK_EQ(add_to_output->data_type(), out->data_type());
+      CHECK_EQ(add_to_output->shape(), out->shape());
+      KernelUtil<DeviceType::kCPU, T>::Addition(
+          ctx->device_ctx(), add_to_output->shape().elem_cnt(), out->mut_dptr<T>(), out->dptr<T>(),
+          add_to_output->dptr<T>());
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_DROPOUT_WITH_RANDOM_MASK_KERNEL_CPU(dtype)                                     \
+  REGISTER_USER_KERNEL("dropout_with_random_mask")                                              \
+      .SetCreateFn<DropoutWithRandomMaskKernelCPU<dtype>>()                                     \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                       \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value))         \
+      .SetInplaceProposalFn([](const user_op::InferContext&,                                    \
+                               user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
+        OF_RETURN_IF_ERROR(AddInplaceArgPairFn("out", 0, "in", 0, true));                       \
+        return Maybe<void>::Ok();                                                               \
+      });
+
+REGISTER_DROPOUT_WITH_RANDOM_MASK_KERNEL_CPU(float)
+REGISTER_DROPOUT_WITH_RANDOM_MASK_KERNEL_CPU(double)
+
 template<DeviceType device_type>
 class RandomMaskLikeKernel final : public user_op::OpKernel {
  public:
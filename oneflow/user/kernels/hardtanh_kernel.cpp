@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/common/data_type.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
 
 namespace oneflow {
 
@@ -35,16 +36,10 @@ class CpuHardtanhKernel final : public OpKernel {
     const T* in_ptr = in_tensor->dptr<T>();
     T* out_ptr = out_tensor->mut_dptr<T>();
 
-    const int32_t elem_cnt = in_tensor->shape().elem_cnt();
-    FOR_RANGE(int32_t, i, 0, elem_cnt) {
-      if (in_ptr[i] > max_val) {
-        out_ptr[i] = max_val;
-      } else if (in_ptr[i] < min_val) {
-        out_ptr[i] = min_val;
-      } else {
-        out_ptr[i] = in_ptr[i];
-      }
-    }
+    const int64_t elem_cnt = in_tensor->shape().elem_cnt();
+    CpuElementwiseUnary(elem_cnt, in_ptr, out_ptr, [min_val, max_val](T x) {
+      return x > max_val ? max_val : (x < min_val ? min_val : x);
+    });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -82,10 +77,10 @@ class CpuHardtanhGradKernel final : public OpKernel {
     const T max_val = static_cast<T>(ctx->Attr<double>("max_val"));
     const T zero_t = static_cast<T>(0);
 
-    const int32_t elem_cnt = y_tensor->shape().elem_cnt();
-    FOR_RANGE(int32_t, i, 0, elem_cnt) {
-      dx_ptr[i] = (y_ptr[i] != min_val && y_ptr[i] != max_val) ? dy_ptr[i] : zero_t;
-    }
+    const int64_t elem_cnt = y_tensor->shape().elem_cnt();
+    CpuElementwiseBinary(elem_cnt, y_ptr, dy_ptr, dx_ptr, [min_val, max_val, zero_t](T y, T dy) {
+      return (y != min_val && y != max_val) ? dy : zero_t;
+    });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
 
 namespace oneflow {
 
@@ -27,11 +28,12 @@ class CpuLeakyReluKernel final : public user_op::OpKernel {
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
     user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
-    const int32_t elem_cnt = x->shape().elem_cnt();
-    const float alpha = ctx->Attr<float>("alpha");
+    const int64_t elem_cnt = x->shape().elem_cnt();
+    const T alpha = static_cast<T>(ctx->Attr<float>("alpha"));
     const T* x_ptr = x->dptr<T>();
     T* y_ptr = y->mut_dptr<T>();
-    FOR_RANGE(int32_t, i, 0, elem_cnt) { y_ptr[i] = x_ptr[i] > 0 ? x_ptr[i] : x_ptr[i] * alpha; }
+    CpuElementwiseUnary(elem_cnt, x_ptr, y_ptr,
+                        [alpha](T x_i) { return x_i > 0 ? x_i : x_i * alpha; });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -56,12 +58,13 @@ class CpuLeakyReluGradKernel final : public user_op::OpKernel {
     const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
     const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
     user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
-    const int32_t elem_cnt = x->shape().elem_cnt();
-    const float alpha = ctx->Attr<float>("alpha");
+    const int64_t elem_cnt = x->shape().elem_cnt();
+    const T alpha = static_cast<T>(ctx->Attr<float>("alpha"));
     const T* x_ptr = x->dptr<T>();
     const T* dy_ptr = dy->dptr<T>();
     T* dx_ptr = dx->mut_dptr<T>();
-    FOR_RANGE(int32_t, i, 0, elem_cnt) { dx_ptr[i] = x_ptr[i] > 0 ? dy_ptr[i] : dy_ptr[i] * alpha; }
+    CpuElementwiseBinary(elem_cnt, x_ptr, dy_ptr, dx_ptr,
+                         [alpha](T x_i, T dy_i) { return x_i > 0 ? dy_i : dy_i * alpha; });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
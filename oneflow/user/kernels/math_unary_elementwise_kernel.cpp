@@ -15,9 +15,41 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/math_unary_elementwise_func.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
+#include "oneflow/core/kernel/util/cpu_fast_math.h"
 
 namespace oneflow {
 
+namespace {
+
+template<template<typename> class UnaryFunctor, typename T>
+struct CpuMathUnaryElementwiseForward {
+  static void Compute(int64_t n, const T* x, T* y) {
+    CpuElementwiseUnary(n, x, y, [](T v) { return UnaryFunctor<T>::Forward(v); });
+  }
+};
+
+// the functors with a simd counterpart in cpu_fast_math
+#define SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD(functor, fast_math_func)                      \
+  template<typename T>                                                                       \
+  struct CpuMathUnaryElementwiseForward<functor, T> {                                        \
+    static void Compute(int64_t n, const T* x, T* y) {                                       \
+      CpuParallelForEachRange(n, kCpuElementwiseGrainSize, [&](int64_t begin, int64_t end) { \
+        cpu_fast_math::fast_math_func(x + begin, y + begin, end - begin);                    \
+      });                                                                                    \
+    }                                                                                        \
+  };
+
+SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD(ErfFunctor, Erf)
+SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD(ExpFunctor, Exp)
+SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD(LogFunctor, Log)
+SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD(SigmoidFunctor, Sigmoid)
+SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD(TanhFunctor, Tanh)
+
+#undef SPECIALIZE_CPU_FAST_MATH_UNARY_FORWARD
+
+}  // namespace
+
 template<template<typename> class UnaryFunctor, typename T>
 class MathUnaryElementwiseCpuKernel final : public user_op::OpKernel {
  public:
@@ -30,9 +62,8 @@ class MathUnaryElementwiseCpuKernel final : public user_op::OpKernel {
     user_op::Tensor* tensor_y = ctx->Tensor4ArgNameAndIndex("y", 0);
     const T* x = tensor_x->dptr<T>();
     T* y = tensor_y->mut_dptr<T>();
-    int64_t n = tensor_x->shape().elem_cnt();
-    CHECK_LE(n, GetMaxVal<int32_t>() / 2);
-    for (int32_t i = 0; i < n; ++i) { y[i] = UnaryFunctor<T>::Forward(x[i]); }
+    const int64_t n = tensor_x->shape().elem_cnt();
+    CpuMathUnaryElementwiseForward<UnaryFunctor, T>::Compute(n, x, y);
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -52,9 +83,9 @@ class MathUnaryElementwiseGradCpuKernel final : public user_op::OpKernel {
     const T* x = tensor_x->dptr<T>();
     const T* dy = tensor_dy->dptr<T>();
     T* dx = tensor_dx->mut_dptr<T>();
-    int64_t n = tensor_x->shape().elem_cnt();
-    CHECK_LE(n, GetMaxVal<int32_t>() / 2);
-    for (int32_t i = 0; i < n; ++i) { dx[i] = UnaryFunctor<T>::Backward(x[i], dy[i]); }
+    const int64_t n = tensor_x->shape().elem_cnt();
+    CpuElementwiseBinary(n, x, dy, dx,
+                         [](T x_i, T dy_i) { return UnaryFunctor<T>::Backward(x_i, dy_i); });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -17,6 +17,8 @@ limitations under the License.
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/framework/config_def.h"
 #include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/kernel/util/host_blas_interface.h"
+#include "oneflow/user/kernels/op_kernel_state_wrapper.h"
 
 namespace oneflow {
 
@@ -41,8 +43,17 @@ class MatmulFloatingKernel final : public user_op::OpKernel {
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    // b is a variable of a predict job, see MarkCpuMatmulModelOperandPass
+    if (device_type != DeviceType::kCPU || !ctx->Attr<bool>("_b_is_model")) {
+      return std::shared_ptr<user_op::OpKernelState>();
+    }
+    return std::make_shared<OpKernelStateWrapper<CpuGemmPackCache<T>>>(CpuGemmConstOperand::kB);
+  }
+
  private:
-  void Compute(user_op::KernelComputeContext* ctx) const override {
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
     CBLAS_TRANSPOSE trans_a = ctx->Attr<bool>("transpose_a") ? CblasTrans : CblasNoTrans;
     CBLAS_TRANSPOSE trans_b = ctx->Attr<bool>("transpose_b") ? CblasTrans : CblasNoTrans;
     const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
@@ -65,8 +76,16 @@ class MatmulFloatingKernel final : public user_op::OpKernel {
     } else {
       beta = GetZeroVal<T>();
     }
-    NewKernelUtil<device_type>::OFGemm(ctx->device_ctx(), trans_a, trans_b, m, n, k, GetOneVal<T>(),
-                                       a->dptr<T>(), b->dptr<T>(), beta, out->mut_dptr<T>());
+    auto* pack_cache = dynamic_cast<OpKernelStateWrapper<CpuGemmPackCache<T>>*>(state);
+    if (pack_cache != nullptr) {
+      BlasIf<DeviceType::kCPU>::OFGemmWithPackCache(
+          ctx->device_ctx(), trans_a, trans_b, m, n, k, GetOneVal<T>(), a->dptr<T>(), b->dptr<T>(),
+          beta, out->mut_dptr<T>(), pack_cache->Mutable());
+    } else {
+      NewKernelUtil<device_type>::OFGemm(ctx->device_ctx(), trans_a, trans_b, m, n, k,
+                                         GetOneVal<T>(), a->dptr<T>(), b->dptr<T>(), beta,
+                                         out->mut_dptr<T>());
+    }
   }
 };
 
@@ -15,9 +15,50 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/model_update_kernel_util.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
+namespace {
+
+// indexed slices updates smaller than it are done by the caller thread
+constexpr int64_t kIndexedSlicesParallelMinElemCnt = 32768;
+
+// Handler(value_offset, model_offset) is called on every instance in [lower_bound, upper_bound),
+// in the order of model rows. The instances are unique, so the rows are split into disjoint
+// ranges updated by the thread pool without atomics
+template<typename K, typename F>
+void ForEachIndexedSlicesRow(int64_t num_instances, int64_t feature_size, int64_t lower_bound,
+                             int64_t upper_bound, const K* indices, const F& Handler) {
+  // (model row, value row)
+  std::vector<std::pair<int64_t, int64_t>> rows;
+  rows.reserve(num_instances);
+  FOR_RANGE(int64_t, i, 0, num_instances) {
+    const int64_t instance_id = indices[i];
+    if (instance_id >= lower_bound && instance_id < upper_bound) {
+      rows.emplace_back(instance_id - lower_bound, i);
+    }
+  }
+  std::sort(rows.begin(), rows.end());
+  const auto HandleRows = [&](int64_t begin, int64_t end) {
+    FOR_RANGE(int64_t, i, begin, end) {
+      Handler(rows[i].second * feature_size, rows[i].first * feature_size);
+    }
+  };
+  const int64_t row_num = rows.size();
+  if (row_num * feature_size < kIndexedSlicesParallelMinElemCnt
+      || Global<ThreadPool>::Get() == nullptr) {
+    HandleRows(0, row_num);
+    return;
+  }
+  const int64_t part_num = std::min<int64_t>(Global<ThreadPool>::Get()->LocalThreadNum(), row_num);
+  BalancedSplitter bs(row_num, part_num);
+  MultiThreadLoop(part_num, [&](size_t i) { HandleRows(bs.At(i).begin(), bs.At(i).end()); });
+}
+
+}  // namespace
+
 template<typename T, typename G>
 struct SGDUpdateKernelUtil<DeviceType::kCPU, T, G> {
   static void Update(DeviceCtx* ctx, int64_t n, T scale, float l1, float l2, float weight_decay,
@@ -55,18 +96,17 @@ void IndexedSlicesSGDUpdateKernelUtil<DeviceType::kCPU, T, K, IDX>::Update(
     DeviceCtx* ctx, float weight_decay, int64_t num_indices, int64_t feature_size,
     int64_t lower_bound, int64_t upper_bound, const IDX* num_unique_instance,
     const float* learning_rate, const K* indices, const T* values, T* model) {
-  const int64_t n = *num_unique_instance * feature_size;
   const T lr = *learning_rate;
-  FOR_RANGE(int64_t, i, 0, n) {
-    const IDX indices_idx = i / feature_size;
-    const IDX inner_idx = i - indices_idx * feature_size;
-    const IDX instance_id = indices[indices_idx];
-    if (instance_id >= lower_bound && instance_id < upper_bound) {
-      const IDX model_idx = (instance_id - lower_bound) * feature_size + inner_idx;
-      SGDUpdateFunctor<T, T>()(values + i, model + model_idx, static_cast<T>(1), 0.0, 0.0,
-                               weight_decay, lr);
-    }
-  }
+  ForEachIndexedSlicesRow(
+      *num_unique_instance, feature_size, lower_bound, upper_bound, indices,
+      [&](int64_t value_offset, int64_t model_offset) {
+        const T* row_values = values + value_offset;
+        T* row_model = model + model_offset;
+        FOR_RANGE(int64_t, i, 0, feature_size) {
+          SGDUpdateFunctor<T, T>()(row_values + i, row_model + i, static_cast<T>(1), 0.0, 0.0,
+                                   weight_decay, lr);
+        }
+      });
 }
 
 #define INITIATE_INDEXED_SLICES_SGD_UPDATE_KERNEL_UTIL_CPU(val_type_pair, key_type_pair,  \
@@ -115,18 +155,18 @@ void IndexedSlicesMomentumMdUpdateKernelUtil<DeviceType::kCPU, T, K, IDX>::Updat
     DeviceCtx* ctx, T beta, float weight_decay, int64_t num_instance, int64_t feature_size,
     int64_t lower_bound, int64_t upper_bound, const IDX* num_unique_instance,
     const float* learning_rate, const K* indices, const T* values, T* model, T* momentum) {
-  const int64_t n = *num_unique_instance * feature_size;
   const T lr = *learning_rate;
-  for (int64_t i = 0; i != n; ++i) {
-    const IDX indices_idx = i / feature_size;
-    const IDX inner_idx = i - indices_idx * feature_size;
-    const IDX instance_id = indices[indices_idx];
-    if (instance_id >= lower_bound && instance_id < upper_bound) {
-      const IDX model_idx = (instance_id - lower_bound) * feature_size + inner_idx;
-      MomentumUpdateFunctor<T, T>()(values + i, model + model_idx, momentum + model_idx, 1.0, 0.0,
-                                    0.0, beta, weight_decay, lr);
-    }
-  }
+  ForEachIndexedSlicesRow(
+      *num_unique_instance, feature_size, lower_bound, upper_bound, indices,
+      [&](int64_t value_offset, int64_t model_offset) {
+        const T* row_values = values + value_offset;
+        T* row_model = model + model_offset;
+        T* row_momentum = momentum + model_offset;
+        FOR_RANGE(int64_t, i, 0, feature_size) {
+          MomentumUpdateFunctor<T, T>()(row_values + i, row_model + i, row_momentum + i, 1.0, 0.0,
+                                        0.0, beta, weight_decay, lr);
+        }
+      });
 }
 
 #define INSTANTIATE_INDEXED_SLICES_MOMENTUM_MODEL_UPDATE_KERNEL_UTIL_CPU(                 \
@@ -171,17 +211,19 @@ struct IndexedSlicesAdamMdUpdateKernelUtil<DeviceType::kCPU, T, K, IDX> {
                      const float* learning_rate, const K* indices, const T* values, T* model, T* m,
                      T* v) {
     const float lr = *learning_rate;
-    const int64_t n = *num_unique_instance * feature_size;
-    FOR_RANGE(int64_t, i, 0, n) {
-      const IDX indices_idx = i / feature_size;
-      const IDX inner_idx = i - indices_idx * feature_size;
-      const IDX instance_id = indices[indices_idx];
-      if (instance_id >= lower_bound && instance_id < upper_bound) {
-        const IDX model_idx = (instance_id - lower_bound) * feature_size + inner_idx;
-        AdamUpdateFunctor<T, T>()(values + i, model + model_idx, m + model_idx, v + model_idx, 1, 0,
-                                  0, beta1, beta2, epsilon, weight_decay, lr);
-      }
-    }
+    // lazy adam, m and v of the rows not in indices are left as they are
+    ForEachIndexedSlicesRow(
+        *num_unique_instance, feature_size, lower_bound, upper_bound, indices,
+        [&](int64_t value_offset, int64_t model_offset) {
+          const T* row_values = values + value_offset;
+          T* row_model = model + model_offset;
+          T* row_m = m + model_offset;
+          T* row_v = v + model_offset;
+          FOR_RANGE(int64_t, i, 0, feature_size) {
+            AdamUpdateFunctor<T, T>()(row_values + i, row_model + i, row_m + i, row_v + i, 1, 0, 0,
+                                      beta1, beta2, epsilon, weight_decay, lr);
+          }
+        });
   }
 };
 
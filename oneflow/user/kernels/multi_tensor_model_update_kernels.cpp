@@ -0,0 +1,396 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/model_update_kernel_util.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+namespace {
+
+// elements of a model updated by one thread pool work
+constexpr int64_t kChunkElemCnt = 16384;
+
+struct ModelChunk {
+  int32_t model_idx;
+  int64_t begin;
+  int64_t end;
+};
+
+template<typename T, typename G>
+struct MultiTensorUpdateParam {
+  std::vector<const G*> model_diff;
+  std::vector<T*> model;
+  std::vector<int64_t> elem_cnt;
+  std::vector<ModelChunk> chunks;
+  T scale;
+  float l1;
+  float l2;
+  float weight_decay;
+  float learning_rate;
+};
+
+std::vector<ModelChunk> SplitModelsIntoChunks(const std::vector<int64_t>& elem_cnts) {
+  std::vector<ModelChunk> chunks;
+  FOR_RANGE(int32_t, i, 0, elem_cnts.size()) {
+    for (int64_t begin = 0; begin < elem_cnts.at(i); begin += kChunkElemCnt) {
+      chunks.push_back(ModelChunk{i, begin, std::min(begin + kChunkElemCnt, elem_cnts.at(i))});
+    }
+  }
+  return chunks;
+}
+
+void ForEachChunk(const std::vector<ModelChunk>& chunks,
+                  const std::function<void(int64_t chunk_idx, const ModelChunk&)>& Handler) {
+  if (chunks.size() == 1) {
+    Handler(0, chunks.front());
+  } else if (chunks.size() > 1) {
+    MultiThreadLoop(chunks.size(), [&](size_t i) { Handler(i, chunks.at(i)); });
+  }
+}
+
+// false if the update is skipped
+template<typename T, typename G>
+bool InitMultiTensorUpdateParam(user_op::KernelComputeContext* ctx,
+                                MultiTensorUpdateParam<T, G>* param) {
+  if (ctx->user_op_conf().has_input("skip_if", 0)) {
+    const user_op::Tensor* skip_if = ctx->Tensor4ArgNameAndIndex("skip_if", 0);
+    CHECK_EQ(skip_if->shape().elem_cnt(), 1);
+    if (*skip_if->dptr<int64_t>() != 0) { return false; }
+  }
+  param->scale = static_cast<T>(ctx->Attr<double>("scale"));
+  if (ctx->user_op_conf().has_input("scale_by_tensor", 0)) {
+    const user_op::Tensor* scale_by_tensor = ctx->Tensor4ArgNameAndIndex("scale_by_tensor", 0);
+    CHECK_EQ(scale_by_tensor->shape().elem_cnt(), 1);
+    param->scale *= *scale_by_tensor->dptr<T>();
+  }
+  param->l1 = ctx->Attr<float>("l1");
+  param->l2 = ctx->Attr<float>("l2");
+  param->weight_decay = ctx->Attr<float>("weight_decay");
+  param->learning_rate = *ctx->Tensor4ArgNameAndIndex("learning_rate", 0)->dptr<float>();
+  FOR_RANGE(int32_t, i, 0, ctx->user_op_conf().input_size("model")) {
+    const user_op::Tensor* model_diff = ctx->Tensor4ArgNameAndIndex("model_diff", i);
+    user_op::Tensor* model = ctx->Tensor4ArgNameAndIndex("model", i);
+    CHECK_EQ(model_diff->shape().elem_cnt(), model->shape().elem_cnt());
+    param->model_diff.push_back(model_diff->dptr<G>());
+    param->model.push_back(model->mut_dptr<T>());
+    param->elem_cnt.push_back(model->shape().elem_cnt());
+  }
+  param->chunks = SplitModelsIntoChunks(param->elem_cnt);
+  return true;
+}
+
+template<typename T>
+std::vector<T*> MutDptrs(user_op::KernelComputeContext* ctx, const std::string& arg_name) {
+  std::vector<T*> dptrs;
+  FOR_RANGE(int32_t, i, 0, ctx->user_op_conf().input_size(arg_name)) {
+    dptrs.push_back(ctx->Tensor4ArgNameAndIndex(arg_name, i)->mut_dptr<T>());
+  }
+  return dptrs;
+}
+
+// per model buffers of the lamb adam diff or the lars regularized model diff
+template<typename T>
+class MultiTensorTmpBufferManager final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MultiTensorTmpBufferManager);
+  MultiTensorTmpBufferManager(void* ptr, const std::vector<int64_t>& elem_cnts) : ptr_(ptr) {
+    total_buffer_size_ = 0;
+    for (int64_t elem_cnt : elem_cnts) {
+      offsets_.push_back(total_buffer_size_);
+      total_buffer_size_ += GetCudaAlignedSize(elem_cnt * sizeof(T));
+    }
+  }
+  ~MultiTensorTmpBufferManager() = default;
+
+  size_t GetTotalBufferSize() const { return total_buffer_size_; }
+  T* BufferPtr(int32_t model_idx) const {
+    CHECK(ptr_ != nullptr);
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(ptr_) + offsets_.at(model_idx));
+  }
+
+ private:
+  std::vector<size_t> offsets_;
+  size_t total_buffer_size_;
+  void* ptr_;
+};
+
+template<typename T>
+user_op::InferTmpSizeFn MultiTensorGenInferTmpSizeFn() {
+  return [](user_op::InferContext* ctx) {
+    std::vector<int64_t> elem_cnts;
+    FOR_RANGE(int32_t, i, 0, ctx->user_op_conf().input_size("model")) {
+      elem_cnts.push_back(ctx->TensorDesc4ArgNameAndIndex("model", i)->shape().elem_cnt());
+    }
+    MultiTensorTmpBufferManager<T> tbm(nullptr, elem_cnts);
+    return tbm.GetTotalBufferSize();
+  };
+}
+
+// sum of the per chunk partial sums of every model, in chunk order so the result is deterministic
+template<typename T>
+std::vector<T> SumChunkPartials(const std::vector<ModelChunk>& chunks,
+                                const std::vector<T>& chunk_partials, int32_t model_num) {
+  std::vector<T> sums(model_num, 0);
+  FOR_RANGE(int64_t, i, 0, chunks.size()) {
+    sums.at(chunks.at(i).model_idx) += chunk_partials.at(i);
+  }
+  return sums;
+}
+
+template<typename T>
+T SquareSum(const T* x, int64_t n) {
+  T sum = 0;
+  for (int64_t i = 0; i < n; ++i) { sum += x[i] * x[i]; }
+  return sum;
+}
+
+template<typename T, typename G>
+class MultiTensorSGDUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorSGDUpdateKernel() = default;
+  ~MultiTensorSGDUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    MultiTensorUpdateParam<T, G> p;
+    if (!InitMultiTensorUpdateParam(ctx, &p)) { return; }
+    ForEachChunk(p.chunks, [&](int64_t, const ModelChunk& chunk) {
+      const G* model_diff = p.model_diff.at(chunk.model_idx);
+      T* model = p.model.at(chunk.model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        SGDUpdateFunctor<T, G>()(model_diff + i, model + i, p.scale, p.l1, p.l2, p.weight_decay,
+                                 p.learning_rate);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+template<typename T, typename G>
+class MultiTensorMomentumUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorMomentumUpdateKernel() = default;
+  ~MultiTensorMomentumUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    MultiTensorUpdateParam<T, G> p;
+    if (!InitMultiTensorUpdateParam(ctx, &p)) { return; }
+    const auto beta = ctx->Attr<float>("beta");
+    const std::vector<T*> momentums = MutDptrs<T>(ctx, "momentum");
+    ForEachChunk(p.chunks, [&](int64_t, const ModelChunk& chunk) {
+      const G* model_diff = p.model_diff.at(chunk.model_idx);
+      T* model = p.model.at(chunk.model_idx);
+      T* momentum = momentums.at(chunk.model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        MomentumUpdateFunctor<T, G>()(model_diff + i, model + i, momentum + i, p.scale, p.l1, p.l2,
+                                      beta, p.weight_decay, p.learning_rate);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+template<typename T, typename G>
+class MultiTensorAdamUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorAdamUpdateKernel() = default;
+  ~MultiTensorAdamUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    MultiTensorUpdateParam<T, G> p;
+    if (!InitMultiTensorUpdateParam(ctx, &p)) { return; }
+    const auto beta1 = ctx->Attr<float>("beta1");
+    const auto beta2 = ctx->Attr<float>("beta2");
+    const auto epsilon = ctx->Attr<float>("epsilon");
+    const std::vector<T*> ms = MutDptrs<T>(ctx, "m");
+    const std::vector<T*> vs = MutDptrs<T>(ctx, "v");
+    ForEachChunk(p.chunks, [&](int64_t, const ModelChunk& chunk) {
+      const G* model_diff = p.model_diff.at(chunk.model_idx);
+      T* model = p.model.at(chunk.model_idx);
+      T* m = ms.at(chunk.model_idx);
+      T* v = vs.at(chunk.model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        AdamUpdateFunctor<T, G>()(model_diff + i, model + i, m + i, v + i, p.scale, p.l1, p.l2,
+                                  beta1, beta2, epsilon, p.weight_decay, p.learning_rate);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+template<typename T, typename G>
+class MultiTensorLambUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorLambUpdateKernel() = default;
+  ~MultiTensorLambUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    MultiTensorUpdateParam<T, G> p;
+    if (!InitMultiTensorUpdateParam(ctx, &p)) { return; }
+    const auto beta1 = ctx->Attr<float>("beta1");
+    const auto beta2 = ctx->Attr<float>("beta2");
+    const auto epsilon = ctx->Attr<float>("epsilon");
+    const std::vector<T*> ms = MutDptrs<T>(ctx, "m");
+    const std::vector<T*> vs = MutDptrs<T>(ctx, "v");
+    const std::vector<T*> beta1_ts = MutDptrs<T>(ctx, "beta1_t");
+    const std::vector<T*> beta2_ts = MutDptrs<T>(ctx, "beta2_t");
+    MultiTensorTmpBufferManager<T> tbm(ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0)->mut_dptr(),
+                                       p.elem_cnt);
+    const int32_t model_num = p.model.size();
+    FOR_RANGE(int32_t, i, 0, model_num) {
+      *beta1_ts.at(i) *= beta1;
+      *beta2_ts.at(i) *= beta2;
+    }
+    std::vector<T> chunk_w_norms(p.chunks.size());
+    std::vector<T> chunk_g_norms(p.chunks.size());
+    ForEachChunk(p.chunks, [&](int64_t chunk_idx, const ModelChunk& chunk) {
+      const int32_t model_idx = chunk.model_idx;
+      const G* model_diff = p.model_diff.at(model_idx);
+      T* adam_diff = tbm.BufferPtr(model_idx);
+      T* model = p.model.at(model_idx);
+      T* m = ms.at(model_idx);
+      T* v = vs.at(model_idx);
+      // local copies so that the loop does not reload them through pointers maybe aliased
+      const T beta1_t = *beta1_ts.at(model_idx);
+      const T beta2_t = *beta2_ts.at(model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        LambGradFunctor<T, G>()(&beta1_t, &beta2_t, model_diff + i, adam_diff + i, model + i,
+                                m + i, v + i, p.scale, p.l1, p.l2, beta1, beta2, epsilon);
+      }
+      const int64_t n = chunk.end - chunk.begin;
+      chunk_w_norms.at(chunk_idx) = SquareSum(model + chunk.begin, n);
+      chunk_g_norms.at(chunk_idx) = SquareSum(adam_diff + chunk.begin, n);
+    });
+    const std::vector<T> w_norms = SumChunkPartials(p.chunks, chunk_w_norms, model_num);
+    const std::vector<T> g_norms = SumChunkPartials(p.chunks, chunk_g_norms, model_num);
+    std::vector<float> lrs(model_num);
+    FOR_RANGE(int32_t, i, 0, model_num) {
+      const T w_norm = std::sqrt(w_norms.at(i));
+      const T g_norm = std::sqrt(g_norms.at(i));
+      lrs.at(i) = LambLRFunctor<T>()(p.learning_rate, &w_norm, &g_norm);
+    }
+    ForEachChunk(p.chunks, [&](int64_t, const ModelChunk& chunk) {
+      const T* adam_diff = tbm.BufferPtr(chunk.model_idx);
+      T* model = p.model.at(chunk.model_idx);
+      const float lr = lrs.at(chunk.model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        LambUpdateFunctor<T>()(lr, p.weight_decay, adam_diff + i, model + i);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+template<typename T, typename G>
+class MultiTensorLarsUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorLarsUpdateKernel() = default;
+  ~MultiTensorLarsUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    MultiTensorUpdateParam<T, G> p;
+    if (!InitMultiTensorUpdateParam(ctx, &p)) { return; }
+    const auto momentum_beta = ctx->Attr<float>("momentum_beta");
+    const auto epsilon = ctx->Attr<float>("epsilon");
+    const auto lars_coefficient = ctx->Attr<float>("lars_coefficient");
+    const int64_t train_step = *ctx->Tensor4ArgNameAndIndex("train_step", 0)->dptr<int64_t>();
+    const std::vector<T*> momentums = MutDptrs<T>(ctx, "momentum");
+    MultiTensorTmpBufferManager<T> tbm(ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0)->mut_dptr(),
+                                       p.elem_cnt);
+    const int32_t model_num = p.model.size();
+    std::vector<T> chunk_model_norms(p.chunks.size());
+    std::vector<T> chunk_model_diff_norms(p.chunks.size());
+    ForEachChunk(p.chunks, [&](int64_t chunk_idx, const ModelChunk& chunk) {
+      const G* model_diff = p.model_diff.at(chunk.model_idx);
+      T* model_diff_tmp = tbm.BufferPtr(chunk.model_idx);
+      const T* model = p.model.at(chunk.model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        model_diff_tmp[i] = CastScaleRegularizeGradientFunctor<T, G>()(model_diff[i], model[i],
+                                                                       p.scale, p.l1, p.l2);
+      }
+      const int64_t n = chunk.end - chunk.begin;
+      chunk_model_norms.at(chunk_idx) = SquareSum(model + chunk.begin, n);
+      chunk_model_diff_norms.at(chunk_idx) = SquareSum(model_diff_tmp + chunk.begin, n);
+    });
+    const std::vector<T> model_norms = SumChunkPartials(p.chunks, chunk_model_norms, model_num);
+    const std::vector<T> model_diff_norms =
+        SumChunkPartials(p.chunks, chunk_model_diff_norms, model_num);
+    std::vector<T> local_lrs(model_num);
+    FOR_RANGE(int32_t, i, 0, model_num) {
+      const T model_norm = std::sqrt(model_norms.at(i) / p.elem_cnt.at(i));
+      const T model_diff_norm = std::sqrt(model_diff_norms.at(i) / p.elem_cnt.at(i));
+      if (train_step == 0) {
+        local_lrs.at(i) =
+            p.learning_rate * lars_coefficient * model_norm / (epsilon + model_diff_norm);
+      } else {
+        local_lrs.at(i) = p.learning_rate * lars_coefficient * model_norm
+                          / (epsilon + model_diff_norm + p.weight_decay * model_norm);
+      }
+    }
+    ForEachChunk(p.chunks, [&](int64_t, const ModelChunk& chunk) {
+      T* model_diff_tmp = tbm.BufferPtr(chunk.model_idx);
+      T* model = p.model.at(chunk.model_idx);
+      T* momentum = momentums.at(chunk.model_idx);
+      const T local_lr = local_lrs.at(chunk.model_idx);
+      for (int64_t i = chunk.begin; i < chunk.end; ++i) {
+        LarsUpdateFunctor<T>()(model_diff_tmp + i, model + i, momentum_beta, momentum + i,
+                               p.weight_decay, local_lr);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_UPDATE_KERNEL(op_type_name, kernel, dtype, gtype)          \
+  REGISTER_USER_KERNEL(op_type_name)                                                     \
+      .SetCreateFn<kernel<dtype, gtype>>()                                               \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == DeviceType::kCPU)                     \
+                       & (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       & (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value))
+
+#define REGISTER_MULTI_TENSOR_UPDATE_KERNEL_WITH_TMP(op_type_name, kernel, dtype, gtype) \
+  REGISTER_MULTI_TENSOR_UPDATE_KERNEL(op_type_name, kernel, dtype, gtype)                \
+      .SetInferTmpSizeFn(MultiTensorGenInferTmpSizeFn<dtype>())
+
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL("multi_tensor_sgd_update", MultiTensorSGDUpdateKernel, float,
+                                    float);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL("multi_tensor_sgd_update", MultiTensorSGDUpdateKernel, double,
+                                    double);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL("multi_tensor_momentum_update",
+                                    MultiTensorMomentumUpdateKernel, float, float);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL("multi_tensor_momentum_update",
+                                    MultiTensorMomentumUpdateKernel, double, double);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL("multi_tensor_adam_update", MultiTensorAdamUpdateKernel, float,
+                                    float);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL("multi_tensor_adam_update", MultiTensorAdamUpdateKernel,
+                                    double, double);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL_WITH_TMP("multi_tensor_lamb_update",
+                                             MultiTensorLambUpdateKernel, float, float);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL_WITH_TMP("multi_tensor_lamb_update",
+                                             MultiTensorLambUpdateKernel, double, double);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL_WITH_TMP("multi_tensor_lars_update",
+                                             MultiTensorLarsUpdateKernel, float, float);
+REGISTER_MULTI_TENSOR_UPDATE_KERNEL_WITH_TMP("multi_tensor_lars_update",
+                                             MultiTensorLarsUpdateKernel, double, double);
+
+}  // namespace
+
+}  // namespace oneflow
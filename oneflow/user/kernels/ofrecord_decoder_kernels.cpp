@@ -22,9 +22,11 @@ limitations under the License.
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/user/image/random_crop_generator.h"
 #include "oneflow/user/image/image_util.h"
+#include "oneflow/user/image/jpeg_decoder.h"
 #include "oneflow/user/kernels/random_crop_kernel_state.h"
 #include "oneflow/user/kernels/op_kernel_state_wrapper.h"
 #include "oneflow/user/kernels/random_seed_util.h"
+#include "oneflow/user/data/sample_cache.h"
 
 #include <opencv2/opencv.hpp>
 
@@ -258,8 +260,30 @@ class OFRecordImageDecoderKernel final : public user_op::OpKernel {
   OFRecordImageDecoderKernel() = default;
   ~OFRecordImageDecoderKernel() override = default;
 
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    const int64_t cache_capacity_mb = ctx->Attr<int64_t>("cache_capacity_mb");
+    if (cache_capacity_mb <= 0) { return std::shared_ptr<user_op::OpKernelState>(); }
+    // Samples are keyed by the encoded image bytes, so only the decoding attrs make up the config
+    // of the cache file.
+    size_t config_key = 0;
+    HashCombine(&config_key, std::hash<std::string>()(ctx->Attr<std::string>("color_space")));
+    const std::string cache_name =
+        ctx->user_op_conf().op_name() + "-" + std::to_string(ctx->parallel_ctx().parallel_id());
+    return std::make_shared<OpKernelStateWrapper<std::unique_ptr<data::SampleCache>>>(
+        data::NewSampleCache(ctx->Attr<std::string>("cache_dir"), cache_name,
+                             cache_capacity_mb * 1024 * 1024, config_key));
+  }
+
  private:
-  void Compute(user_op::KernelComputeContext* ctx) const override {
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    data::SampleCache* cache = nullptr;
+    if (state != nullptr) {
+      auto* cache_state =
+          dynamic_cast<OpKernelStateWrapper<std::unique_ptr<data::SampleCache>>*>(state);
+      CHECK_NOTNULL(cache_state);
+      cache = cache_state->Mutable()->get();
+    }
     user_op::Tensor* out_blob = ctx->Tensor4ArgNameAndIndex("out", 0);
     int64_t record_num = out_blob->shape().At(0);
     CHECK(record_num > 0);
@@ -273,7 +297,19 @@ class OFRecordImageDecoderKernel final : public user_op::OpKernel {
     MultiThreadLoop(record_num, [&](size_t i) {
       const OFRecord& record = *(records + i);
       TensorBuffer* buffer = buffers + i;
+      if (cache == nullptr) {
+        DecodeRandomCropImageFromOneRecord(record, buffer, name, color_space, nullptr);
+        return;
+      }
+      auto it = record.feature().find(name);
+      CHECK(it != record.feature().end()) << "Field " << name << " not found";
+      CHECK(it->second.has_bytes_list());
+      CHECK_EQ(it->second.bytes_list().value_size(), 1);
+      const std::string& src_data = it->second.bytes_list().value(0);
+      const uint64_t cache_key = data::SampleCacheKey(src_data.data(), src_data.size());
+      if (cache->Lookup(cache_key, {buffer})) { return; }
       DecodeRandomCropImageFromOneRecord(record, buffer, name, color_space, nullptr);
+      cache->Insert(cache_key, {buffer});
     });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -285,4 +321,141 @@ REGISTER_USER_KERNEL("ofrecord_image_decoder")
                      & (user_op::HobDataType("in", 0) == DataType::kOFRecord)
                      & (user_op::HobDataType("out", 0) == DataType::kTensorBuffer));
 
+namespace {
+
+enum TensorLayout {
+  kNCHW = 0,
+  kNHWC = 1,
+};
+
+void DecodeRandomCropResizeImageFromOneRecord(const OFRecord& record, const std::string& name,
+                                              const std::string& color_space,
+                                              RandomCropGenerator* random_crop_gen,
+                                              int64_t target_h, int64_t target_w,
+                                              cv::Mat* image) {
+  CHECK(record.feature().find(name) != record.feature().end()) << "Field " << name << " not found";
+  const Feature& feature = record.feature().at(name);
+  CHECK(feature.has_bytes_list());
+  CHECK(feature.bytes_list().value_size() == 1);
+  const std::string& src_data = feature.bytes_list().value(0);
+  // The window is generated once, the fallback reuses the one of a failed partial decoding to
+  // keep the random sequence of the generator
+  CropWindow crop;
+  Shape crop_image_shape;
+  auto GenCropWindow = [&](const Shape& shape, CropWindow* window) {
+    if (shape != crop_image_shape) {
+      random_crop_gen->GenerateCropWindow(shape, &crop);
+      crop_image_shape = shape;
+    }
+    *window = crop;
+  };
+  if (JpegPartialDecodeAndResize(reinterpret_cast<const unsigned char*>(src_data.data()),
+                                 src_data.size(), color_space, GenCropWindow, target_h, target_w,
+                                 image)) {
+    return;
+  }
+  // Fall back to decoding the full image
+  cv::Mat decoded =
+      cv::imdecode(cv::Mat(1, src_data.size(), CV_8UC1, (void*)(src_data.data())),  // NOLINT
+                   ImageUtil::IsColor(color_space) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
+  CHECK(decoded.data != nullptr);
+  if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
+    ImageUtil::ConvertColor("BGR", decoded, color_space, decoded);
+  }
+  GenCropWindow(Shape({decoded.rows, decoded.cols}), &crop);
+  cv::Rect roi(crop.anchor.At(1), crop.anchor.At(0), crop.shape.At(1), crop.shape.At(0));
+  cv::resize(decoded(roi), *image, cv::Size(target_w, target_h), 0, 0, cv::INTER_LINEAR);
+}
+
+template<TensorLayout layout>
+void NormalizeImage(const cv::Mat& image, bool mirror, const std::vector<float>& mean,
+                    const std::vector<float>& inv_std, float* out) {
+  const int64_t H = image.rows;
+  const int64_t W = image.cols;
+  const int64_t C = image.channels();
+  for (int64_t h = 0; h < H; ++h) {
+    const uint8_t* row = image.ptr<uint8_t>(h);
+    for (int64_t w = 0; w < W; ++w) {
+      const uint8_t* pixel = row + (mirror ? W - 1 - w : w) * C;
+      for (int64_t c = 0; c < C; ++c) {
+        const float value = (static_cast<float>(pixel[c]) - mean[c]) * inv_std[c];
+        if (layout == TensorLayout::kNCHW) {
+          out[(c * H + h) * W + w] = value;
+        } else {
+          out[(h * W + w) * C + c] = value;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+// Fuses ofrecord_image_decoder_random_crop, image_resize and crop_mirror_normalize into one
+// pass over each sample, without materializing the decoded image in a TensorBuffer.
+class OFRecordImageDecoderRandomCropResizeNormalizeKernel final : public user_op::OpKernel {
+ public:
+  OFRecordImageDecoderRandomCropResizeNormalizeKernel() = default;
+  ~OFRecordImageDecoderRandomCropResizeNormalizeKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return CreateRandomCropKernelState(ctx);
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* crop_window_generators = dynamic_cast<RandomCropKernelState*>(state);
+    CHECK_NOTNULL(crop_window_generators);
+    const user_op::Tensor* in_blob = ctx->Tensor4ArgNameAndIndex("in", 0);
+    user_op::Tensor* out_blob = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t record_num = in_blob->shape().At(0);
+    CHECK(record_num > 0);
+    CHECK_EQ(out_blob->shape().At(0), record_num);
+    const user_op::Tensor* mirror_blob = ctx->Tensor4ArgNameAndIndex("mirror", 0);
+    const int8_t* mirror_dptr = mirror_blob ? mirror_blob->dptr<int8_t>() : nullptr;
+    const OFRecord* records = in_blob->dptr<OFRecord>();
+    float* out_dptr = out_blob->mut_dptr<float>();
+    const std::string& name = ctx->Attr<std::string>("name");
+    const std::string& color_space = ctx->Attr<std::string>("color_space");
+    const int64_t target_h = ctx->Attr<int64_t>("target_height");
+    const int64_t target_w = ctx->Attr<int64_t>("target_width");
+    const int64_t C = ImageUtil::IsColor(color_space) ? 3 : 1;
+    const int64_t sample_elem_cnt = out_blob->shape().Count(1);
+    CHECK_EQ(sample_elem_cnt, target_h * target_w * C);
+    const auto& mean_attr = ctx->Attr<std::vector<float>>("mean");
+    const auto& std_attr = ctx->Attr<std::vector<float>>("std");
+    std::vector<float> mean(C);
+    std::vector<float> inv_std(C);
+    FOR_RANGE(int64_t, c, 0, C) {
+      mean[c] = mean_attr.size() == 1 ? mean_attr.at(0) : mean_attr.at(c);
+      inv_std[c] = 1.0f / (std_attr.size() == 1 ? std_attr.at(0) : std_attr.at(c));
+    }
+    const bool is_nchw = ctx->Attr<std::string>("output_layout") == "NCHW";
+
+    MultiThreadLoop(record_num, [&](size_t i) {
+      cv::Mat image;
+      DecodeRandomCropResizeImageFromOneRecord(records[i], name, color_space,
+                                               crop_window_generators->GetGenerator(i), target_h,
+                                               target_w, &image);
+      CHECK(image.isContinuous());
+      CHECK_EQ(image.channels(), C);
+      const bool mirror = mirror_dptr != nullptr && mirror_dptr[i] != 0;
+      float* out = out_dptr + i * sample_elem_cnt;
+      if (is_nchw) {
+        NormalizeImage<TensorLayout::kNCHW>(image, mirror, mean, inv_std, out);
+      } else {
+        NormalizeImage<TensorLayout::kNHWC>(image, mirror, mean, inv_std, out);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+REGISTER_USER_KERNEL("ofrecord_image_decoder_random_crop_resize_normalize")
+    .SetCreateFn<OFRecordImageDecoderRandomCropResizeNormalizeKernel>()
+    .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")
+                     & (user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                     & (user_op::HobDataType("out", 0) == DataType::kFloat));
+
 }  // namespace oneflow
@@ -28,9 +28,10 @@ std::shared_ptr<RandomCropKernelState> CreateRandomCropKernelState(
         && random_aspect_ratio.at(0) <= random_aspect_ratio.at(1));
   const std::vector<float>& random_area = ctx->Attr<std::vector<float>>("random_area");
   CHECK(random_area.size() == 2 && 0 < random_area.at(0) && random_area.at(0) <= random_area.at(1));
-  const user_op::TensorDesc* out_tensor_desc = ctx->TensorDesc4ArgNameAndIndex("out", 0);
+  // One generator for each input sample
+  const user_op::TensorDesc* in_tensor_desc = ctx->TensorDesc4ArgNameAndIndex("in", 0);
   return std::shared_ptr<RandomCropKernelState>(
-      new RandomCropKernelState(out_tensor_desc->shape().elem_cnt(), GetOpKernelRandomSeed(ctx),
+      new RandomCropKernelState(in_tensor_desc->shape().elem_cnt(), GetOpKernelRandomSeed(ctx),
                                 {random_aspect_ratio.at(0), random_aspect_ratio.at(1)},
                                 {random_area.at(0), random_area.at(1)}, num_attempts));
 }
@@ -14,17 +14,48 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/kernels/random_mask_generator.h"
+#include "oneflow/core/kernel/util/cpu_elementwise_util.h"
 
 namespace oneflow {
 
+template<typename Handler>
+void RandomMaskGenerator<DeviceType::kCPU>::ForEachKeepFlag(const int64_t n, const float rate,
+                                                            const Handler& handler) {
+  CHECK_GE(n, 0);
+  const uint64_t offset = offset_;
+  CpuParallelForEachRange(n, kCpuElementwiseGrainSize, [&](int64_t begin, int64_t end) {
+    philox_random_.ForEachUint32(offset + begin, offset + end, [&](uint64_t i, uint32_t value) {
+      handler(static_cast<int64_t>(i - offset), PhiloxRandom::ToUniformFloat(value) > rate);
+    });
+  });
+  offset_ += n;
+}
+
 void RandomMaskGenerator<DeviceType::kCPU>::Generate(DeviceCtx* device_ctx, const int64_t n,
                                                      const float rate, int8_t* mask) {
-  CHECK_GE(n, 0);
-  std::uniform_real_distribution<float> random_distribution(GetZeroVal<float>(),
-                                                            GetOneVal<float>());
-  for (int64_t i = 0; i < n; ++i) { mask[i] = random_distribution(mt19937_generator_) > rate; }
+  ForEachKeepFlag(n, rate, [&](int64_t i, bool keep) { mask[i] = keep; });
 }
 
+template<typename T>
+void RandomMaskGenerator<DeviceType::kCPU>::GenerateAndMaskScale(DeviceCtx* device_ctx,
+                                                                 const int64_t n, const float rate,
+                                                                 const float scale, const T* x,
+                                                                 int8_t* mask, T* y) {
+  const T t_scale = static_cast<T>(scale);
+  ForEachKeepFlag(n, rate, [&](int64_t i, bool keep) {
+    mask[i] = keep;
+    y[i] = x[i] * static_cast<T>(keep) * t_scale;
+  });
+}
+
+#define INSTANTIATE_GENERATE_AND_MASK_SCALE(T)                                                  \
+  template void RandomMaskGenerator<DeviceType::kCPU>::GenerateAndMaskScale<T>(                 \
+      DeviceCtx * device_ctx, const int64_t n, const float rate, const float scale, const T* x, \
+      int8_t* mask, T* y);
+INSTANTIATE_GENERATE_AND_MASK_SCALE(float)
+INSTANTIATE_GENERATE_AND_MASK_SCALE(double)
+#undef INSTANTIATE_GENERATE_AND_MASK_SCALE
+
 template class RandomMaskGenerator<DeviceType::kCPU>;
 
 }  // namespace oneflow
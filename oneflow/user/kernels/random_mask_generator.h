@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/core/common/data_type.h"
 #include "oneflow/core/device/device_context.h"
+#include "oneflow/core/kernel/philox_random.h"
 #ifdef WITH_CUDA
 #include <curand.h>
 #include <curand_kernel.h>
@@ -28,17 +29,28 @@ namespace oneflow {
 template<DeviceType device_type>
 class RandomMaskGenerator;
 
+// Element i of the k-th generated mask is drawn from position (sum of the sizes of the previous
+// masks + i) of a Philox stream, so the masks are split across threads without depending on the
+// number of threads.
 template<>
 class RandomMaskGenerator<DeviceType::kCPU> final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(RandomMaskGenerator);
-  RandomMaskGenerator(int64_t seed) : mt19937_generator_(seed) {}
+  RandomMaskGenerator(int64_t seed) : philox_random_(seed), offset_(0) {}
   ~RandomMaskGenerator() {}
 
   void Generate(DeviceCtx* device_ctx, int64_t n, float rate, int8_t* mask);
+  // Generate, and y = x * mask * scale in the same pass
+  template<typename T>
+  void GenerateAndMaskScale(DeviceCtx* device_ctx, int64_t n, float rate, float scale, const T* x,
+                            int8_t* mask, T* y);
 
  private:
-  std::mt19937 mt19937_generator_;
+  template<typename Handler>
+  void ForEachKeepFlag(int64_t n, float rate, const Handler& handler);
+
+  PhiloxRandom philox_random_;
+  uint64_t offset_;
 };
 
 #ifdef WITH_CUDA
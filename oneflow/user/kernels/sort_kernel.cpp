@@ -14,7 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
-#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
@@ -28,32 +28,34 @@ class CpuSortKernel final : public user_op::OpKernel {
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
 
-    Memcpy<DeviceType::kCPU>(ctx->device_ctx(), out->mut_dptr<T>(), in->dptr<T>(),
-                             in->shape().elem_cnt() * sizeof(T));
     const int32_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
     const int32_t instance_num = in->shape().elem_cnt() / instance_size;
     const std::string& direction = ctx->Attr<std::string>("direction");
-    const bool is_ascending = direction == "ASCENDING";
-    const bool is_descending = direction == "DESCENDING";
-    FOR_RANGE(int32_t, i, 0, instance_num) {
-      T* out_ptr_i = out->mut_dptr<T>() + i * instance_size;
-      if (is_ascending) {
-        std::sort(out_ptr_i, out_ptr_i + instance_size, std::less<T>());
-      } else if (is_descending) {
-        std::sort(out_ptr_i, out_ptr_i + instance_size, std::greater<T>());
-      } else {
-        UNIMPLEMENTED();
-      }
+    bool is_descending = false;
+    if (direction == "DESCENDING") {
+      is_descending = true;
+    } else if (direction != "ASCENDING") {
+      UNIMPLEMENTED();
     }
+    cpu_radix_sort::SortRows(in->dptr<T>(), instance_num, instance_size, is_descending,
+                             out->mut_dptr<T>(), nullptr, tmp_buffer->mut_dptr<char>());
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_CPU_SORT_KERNEL(dtype)                                             \
-  REGISTER_USER_KERNEL("sort").SetCreateFn<CpuSortKernel<dtype>>().SetIsMatchedHob( \
-      (user_op::HobDeviceTag() == "cpu")                                            \
-      & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+#define REGISTER_CPU_SORT_KERNEL(dtype)                                                       \
+  REGISTER_USER_KERNEL("sort")                                                                \
+      .SetCreateFn<CpuSortKernel<dtype>>()                                                    \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                     \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value))       \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                     \
+        const Shape* in_shape = ctx->Shape4ArgNameAndIndex("in", 0);                          \
+        const int64_t instance_size = in_shape->dim_vec().back();                             \
+        const int64_t instance_num = in_shape->elem_cnt() / instance_size;                    \
+        return cpu_radix_sort::InferTmpBufferSize<dtype>(instance_num, instance_size, false); \
+      });
 
 REGISTER_CPU_SORT_KERNEL(float)
 REGISTER_CPU_SORT_KERNEL(double)
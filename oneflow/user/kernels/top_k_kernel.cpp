@@ -16,60 +16,156 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
 namespace {
 
+// kHeapSelect:  O(n log k) single pass, most candidates are rejected by one compare to the heap top
+// kNthElement:  introselect over an index array, for k too large for a heap
+// kRadixSort:   stable radix arg sort of the whole row, when a sorted k is close to the row size
+enum class TopKEngine { kTopOne, kHeapSelect, kNthElement, kRadixSort };
+
+constexpr int32_t kMaxHeapSelectK = 512;
+constexpr int64_t kMinHeapSelectSizePerK = 8;
+// Rows at least this long are split across the thread pool when there are too few rows
+constexpr int64_t kMinParallelTopKSize = 1 << 15;
+constexpr int64_t kMinElemCntPerPart = 1 << 14;
+
+TopKEngine SelectTopKEngine(int64_t instance_size, int32_t k, bool sorted) {
+  if (k == 1) {
+    return TopKEngine::kTopOne;
+  } else if (k <= kMaxHeapSelectK && k * kMinHeapSelectSizePerK <= instance_size) {
+    return TopKEngine::kHeapSelect;
+  } else if (sorted && 2 * k >= instance_size) {
+    return TopKEngine::kRadixSort;
+  } else {
+    return TopKEngine::kNthElement;
+  }
+}
+
 template<typename T>
-void ComputeTopOne(const T* in_ptr, const Range& range, int32_t instance_size, int32_t* out_ptr) {
-  FOR_RANGE(int32_t, i, range.begin(), range.end()) {
-    const T* in_ptr_i = in_ptr + i * instance_size;
-    out_ptr[i] = std::distance(in_ptr_i, std::max_element(in_ptr_i, in_ptr_i + instance_size));
+size_t RowTmpBufferSize(TopKEngine engine, int64_t instance_size) {
+  if (engine == TopKEngine::kNthElement) {
+    return instance_size * sizeof(int32_t);
+  } else if (engine == TopKEngine::kRadixSort) {
+    return cpu_radix_sort::RowTmpBufferSize<T>(instance_size, true)
+           + RoundUp(instance_size * sizeof(int32_t), sizeof(uint64_t));
+  } else {
+    return 0;
   }
 }
 
+// Engines needing scratch space fall back to the heap when the buffer, inferred from the static
+// shape, is too small for the engine picked for the actual shape
 template<typename T>
-void ComputeTopK(const T* in_ptr, int32_t* indices_ptr, const Range& range, int32_t instance_size,
-                 int32_t k, bool sorted, int32_t* out_ptr) {
-  FOR_RANGE(int32_t, i, range.begin(), range.end()) {
-    const int32_t offset = i * instance_size;
-    const T* in_ptr_i = in_ptr + offset;
-    int32_t* indices_ptr_i = indices_ptr + offset;
-    std::iota(indices_ptr_i, indices_ptr_i + instance_size, 0);
-    auto comp = [&](const int32_t lhs, const int32_t rhs) {
-      const T l = in_ptr_i[lhs];
-      const T r = in_ptr_i[rhs];
-      if (l == r) {
-        return lhs < rhs;
-      } else {
-        return l > r;
-      }
-    };
-    std::nth_element(indices_ptr_i, indices_ptr_i + k, indices_ptr_i + instance_size, comp);
-    if (sorted) { std::sort(indices_ptr_i, indices_ptr_i + k, comp); }
-    std::copy(indices_ptr_i, indices_ptr_i + k, out_ptr + i * k);
+TopKEngine FitTopKEngine(TopKEngine engine, int64_t instance_num, int64_t instance_size,
+                         size_t tmp_buffer_size) {
+  if (engine == TopKEngine::kRadixSort
+      && instance_num * RowTmpBufferSize<T>(engine, instance_size) > tmp_buffer_size) {
+    engine = TopKEngine::kNthElement;
+  }
+  if (engine == TopKEngine::kNthElement
+      && instance_num * RowTmpBufferSize<T>(engine, instance_size) > tmp_buffer_size) {
+    engine = TopKEngine::kHeapSelect;
   }
+  return engine;
 }
 
+// A larger value ranks first, equal values rank by index, as a stable descending sort would
 template<typename T>
-void CpuTopK(DeviceCtx* ctx, const T* in_ptr, int32_t* indices_ptr, int32_t instance_num,
-             int32_t instance_size, int32_t k, bool sorted, int32_t* out_ptr) {
-  const int32_t num_thread = std::min(instance_num, Global<ThreadPool>::Get()->thread_num());
-  const BalancedSplitter bs(instance_num, num_thread);
-  BlockingCounter bc(num_thread);
-  FOR_RANGE(int32_t, thread_id, 0, num_thread) {
-    const Range range = bs.At(thread_id);
-    Global<ThreadPool>::Get()->AddWork([=, &bc]() {
-      if (k == 1) {
-        ComputeTopOne(in_ptr, range, instance_size, out_ptr);
-      } else {
-        ComputeTopK(in_ptr, indices_ptr, range, instance_size, k, sorted, out_ptr);
-      }
-      bc.Decrease();
-    });
+class RankBefore final {
+ public:
+  explicit RankBefore(const T* in) : in_(in) {}
+  bool operator()(int32_t lhs, int32_t rhs) const {
+    return in_[lhs] > in_[rhs] || (in_[lhs] == in_[rhs] && lhs < rhs);
+  }
+
+ private:
+  const T* in_;
+};
+
+// Keeps the best k of num candidate indices in a heap whose front is the worst one kept, then
+// writes them to out best first. Returns the number of indices written
+template<typename T, typename GetIndexFn>
+int32_t HeapSelectTopK(const T* in, int64_t num, const GetIndexFn& GetIndex, int32_t k,
+                       int32_t* out) {
+  const RankBefore<T> before(in);
+  int32_t size = 0;
+  FOR_RANGE(int64_t, i, 0, num) {
+    const int32_t index = GetIndex(i);
+    if (size < k) {
+      out[size] = index;
+      size += 1;
+      std::push_heap(out, out + size, before);
+    } else if (before(index, out[0])) {
+      std::pop_heap(out, out + size, before);
+      out[size - 1] = index;
+      std::push_heap(out, out + size, before);
+    }
+  }
+  std::sort_heap(out, out + size, before);
+  return size;
+}
+
+// Every part of the row selects its own top k, the k best of those candidates are the result
+template<typename T>
+void ParallelHeapSelectTopK(const T* in, int64_t instance_size, int32_t k, int32_t* out) {
+  const int64_t elem_cnt_per_part = std::max(kMinElemCntPerPart, k * kMinHeapSelectSizePerK);
+  const int64_t num_parts = std::max<int64_t>(
+      std::min<int64_t>(Global<ThreadPool>::Get()->thread_num(),
+                        instance_size / elem_cnt_per_part),
+      1);
+  const BalancedSplitter bs(instance_size, num_parts);
+  std::vector<int32_t> candidates(num_parts * k);
+  std::vector<int32_t> candidate_cnt(num_parts);
+  MultiThreadLoop(num_parts, [&](size_t part) {
+    const int64_t begin = bs.At(part).begin();
+    candidate_cnt[part] =
+        HeapSelectTopK(in, bs.At(part).size(), [begin](int64_t i) { return begin + i; }, k,
+                       candidates.data() + part * k);
+  });
+  int64_t num_candidates = 0;
+  FOR_RANGE(int64_t, part, 0, num_parts) {
+    std::copy(candidates.begin() + part * k, candidates.begin() + part * k + candidate_cnt[part],
+              candidates.begin() + num_candidates);
+    num_candidates += candidate_cnt[part];
+  }
+  HeapSelectTopK(in, num_candidates, [&candidates](int64_t i) { return candidates[i]; }, k, out);
+}
+
+template<typename T>
+void NthElementTopK(const T* in, int64_t instance_size, int32_t k, bool sorted, int32_t* indices,
+                    int32_t* out) {
+  const RankBefore<T> before(in);
+  std::iota(indices, indices + instance_size, 0);
+  std::nth_element(indices, indices + k, indices + instance_size, before);
+  if (sorted) { std::sort(indices, indices + k, before); }
+  std::copy(indices, indices + k, out);
+}
+
+template<typename T>
+void ComputeTopK(TopKEngine engine, const T* in, int64_t instance_size, int32_t k, bool sorted,
+                 char* tmp_buffer, bool parallel, int32_t* out) {
+  if (engine == TopKEngine::kTopOne && !parallel) {
+    *out = std::distance(in, std::max_element(in, in + instance_size));
+  } else if (engine == TopKEngine::kTopOne || engine == TopKEngine::kHeapSelect) {
+    if (parallel) {
+      ParallelHeapSelectTopK(in, instance_size, k, out);
+    } else {
+      HeapSelectTopK(in, instance_size, [](int64_t i) { return i; }, k, out);
+    }
+  } else if (engine == TopKEngine::kNthElement) {
+    NthElementTopK(in, instance_size, k, sorted, reinterpret_cast<int32_t*>(tmp_buffer), out);
+  } else if (engine == TopKEngine::kRadixSort) {
+    int32_t* indices = reinterpret_cast<int32_t*>(
+        tmp_buffer + cpu_radix_sort::RowTmpBufferSize<T>(instance_size, true));
+    cpu_radix_sort::SortRow<T>(in, instance_size, true, nullptr, indices, tmp_buffer, parallel);
+    std::copy(indices, indices + k, out);
+  } else {
+    UNIMPLEMENTED();
   }
-  bc.WaitUntilCntEqualZero();
 }
 
 }  // namespace
@@ -89,21 +185,40 @@ class TopKCpuKernel final : public user_op::OpKernel {
     const int32_t instance_size = in->shape().At(in->shape().NumAxes() - 1);
     const int32_t instance_num = in->shape().elem_cnt() / instance_size;
     const int32_t k = std::min(ctx->Attr<int32_t>("k"), instance_size);
-    int32_t* indices_ptr = tmp_buffer ? tmp_buffer->mut_dptr<int32_t>() : nullptr;
-    CpuTopK(ctx->device_ctx(), in->dptr<T>(), indices_ptr, instance_num, instance_size, k,
-            ctx->Attr<bool>("sorted"), out->mut_dptr<int32_t>());
+    const bool sorted = ctx->Attr<bool>("sorted");
+    const size_t tmp_buffer_size = tmp_buffer ? tmp_buffer->shape().elem_cnt() : 0;
+    const TopKEngine engine = FitTopKEngine<T>(SelectTopKEngine(instance_size, k, sorted),
+                                               instance_num, instance_size, tmp_buffer_size);
+    const size_t row_tmp_size = RowTmpBufferSize<T>(engine, instance_size);
+    char* tmp_ptr = tmp_buffer ? tmp_buffer->mut_dptr<char>() : nullptr;
+    const T* in_ptr = in->dptr<T>();
+    int32_t* out_ptr = out->mut_dptr<int32_t>();
+    auto ComputeRow = [&](int64_t i, bool parallel) {
+      ComputeTopK(engine, in_ptr + i * instance_size, instance_size, k, sorted,
+                  tmp_ptr + i * row_tmp_size, parallel, out_ptr + i * k);
+    };
+    if (instance_num < Global<ThreadPool>::Get()->thread_num()
+        && instance_size >= kMinParallelTopKSize && engine != TopKEngine::kNthElement) {
+      FOR_RANGE(int64_t, i, 0, instance_num) { ComputeRow(i, true); }
+    } else {
+      MultiThreadLoop(instance_num, [&](size_t i) { ComputeRow(i, false); });
+    }
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_CPU_TOP_K_KERNEL(dtype)                                                 \
-  REGISTER_USER_KERNEL("top_k")                                                          \
-      .SetCreateFn<TopKCpuKernel<dtype>>()                                               \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                \
-                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value))   \
-      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                \
-        const Shape* in_shape = ctx->Shape4ArgNameAndIndex("in", 0);                     \
-        return ctx->Attr<int32_t>("k") > 1 ? in_shape->elem_cnt() * sizeof(int32_t) : 0; \
+#define REGISTER_CPU_TOP_K_KERNEL(dtype)                                                         \
+  REGISTER_USER_KERNEL("top_k")                                                                  \
+      .SetCreateFn<TopKCpuKernel<dtype>>()                                                       \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                        \
+                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value))           \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                        \
+        const Shape* in_shape = ctx->Shape4ArgNameAndIndex("in", 0);                             \
+        const int64_t instance_size = in_shape->dim_vec().back();                                \
+        const int64_t instance_num = in_shape->elem_cnt() / instance_size;                       \
+        const int32_t k = std::min<int64_t>(ctx->Attr<int32_t>("k"), instance_size);             \
+        const TopKEngine engine = SelectTopKEngine(instance_size, k, ctx->Attr<bool>("sorted")); \
+        return instance_num * RowTmpBufferSize<dtype>(engine, instance_size);                    \
       });
 
 REGISTER_CPU_TOP_K_KERNEL(float)
@@ -144,6 +144,60 @@ REGISTER_USER_OP("random_mask_like")
       return Maybe<void>::Ok();
     });
 
+// random_mask_like followed by dropout in one op, so that the kernel generates the mask and
+// applies it in the same pass
+REGISTER_USER_OP("dropout_with_random_mask")
+    .Input("in")
+    .OptionalInput("_add_to_output")
+    .Output("out")
+    .Output("mask")
+    .Attr<float>("rate")
+    .Attr<float>("scale")
+    .Attr<int64_t>("seed")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      *ctx->TensorDesc4ArgNameAndIndex("out", 0) = *ctx->TensorDesc4ArgNameAndIndex("in", 0);
+      *ctx->Shape4ArgNameAndIndex("mask", 0) = *ctx->Shape4ArgNameAndIndex("in", 0);
+      *ctx->Dtype4ArgNameAndIndex("mask", 0) = DataType::kInt8;
+      return Maybe<void>::Ok();
+    })
+    .SetBatchAxisInferFn([](user_op::BatchAxisContext* ctx) -> Maybe<void> {
+      *ctx->BatchAxis4ArgNameAndIndex("out", 0) = *ctx->BatchAxis4ArgNameAndIndex("in", 0);
+      *ctx->BatchAxis4ArgNameAndIndex("mask", 0) = *ctx->BatchAxis4ArgNameAndIndex("in", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& in_tensor = ctx->LogicalTensorDesc4InputArgNameAndIndex("in", 0);
+      FOR_RANGE(int64_t, axis, 0, in_tensor.shape().NumAxes()) {
+        ctx->NewBuilder().Split(ctx->inputs(), axis).Split(ctx->outputs(), axis).Build();
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetCheckAttrFn([](const user_op::UserOpDefWrapper& op_def,
+                       const user_op::UserOpConfWrapper& op_conf) -> Maybe<void> {
+      float rate = op_conf.attr<float>("rate");
+      CHECK_GE_OR_RETURN(rate, 0);
+      CHECK_LT_OR_RETURN(rate, 1);
+      float scale = op_conf.attr<float>("scale");
+      CHECK_GT_OR_RETURN(scale, 1);
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("dropout_with_random_mask")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op, user_op::AddOpFn AddOp) {
+      if (op.NeedGenGradTensor4OpInput("in", 0)) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_grad");
+        user_op::UserOpConfWrapper dropout_grad_op =
+            builder.Op("dropout_grad")
+                .Input("dy", op.GetGradTensorWithOpOutput("out", 0))
+                .Input("mask", op.output("mask", 0))
+                .Output("dx")
+                .Attr("scale", op.attr<float>("scale"))
+                .Build();
+        op.BindGradTensorWithOpInput(dropout_grad_op.output("dx", 0), "in", 0);
+        AddOp(dropout_grad_op);
+      }
+    });
+
 }  // namespace
 
 }  // namespace oneflow
@@ -0,0 +1,190 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+Maybe<void> CheckScalarTensorDesc(const user_op::TensorDesc* tensor_desc,
+                                  const DataType data_type) {
+  CHECK_EQ_OR_RETURN(tensor_desc->shape(), Shape({1}));
+  CHECK_EQ_OR_RETURN(tensor_desc->data_type(), data_type);
+  return Maybe<void>::Ok();
+}
+
+// state_arg_names are lists like model, scalar_state_arg_names are lists of scalars, one per model
+Maybe<void> InferMultiTensorUpdateTensorDesc(
+    user_op::InferContext* ctx, const std::vector<std::string>& state_arg_names,
+    const std::vector<std::string>& scalar_state_arg_names) {
+  const int32_t model_num = ctx->user_op_conf().input_size("model");
+  CHECK_EQ_OR_RETURN(ctx->user_op_conf().input_size("model_diff"), model_num);
+  const DataType data_type = ctx->TensorDesc4ArgNameAndIndex("model", 0)->data_type();
+  const DataType diff_data_type = ctx->TensorDesc4ArgNameAndIndex("model_diff", 0)->data_type();
+  for (const std::string& arg_name : state_arg_names) {
+    CHECK_EQ_OR_RETURN(ctx->user_op_conf().input_size(arg_name), model_num);
+  }
+  for (const std::string& arg_name : scalar_state_arg_names) {
+    CHECK_EQ_OR_RETURN(ctx->user_op_conf().input_size(arg_name), model_num);
+  }
+  FOR_RANGE(int32_t, i, 0, model_num) {
+    const user_op::TensorDesc* model = ctx->TensorDesc4ArgNameAndIndex("model", i);
+    CHECK_EQ_OR_RETURN(model->data_type(), data_type);
+    const user_op::TensorDesc* model_diff = ctx->TensorDesc4ArgNameAndIndex("model_diff", i);
+    CHECK_EQ_OR_RETURN(model_diff->shape(), model->shape());
+    CHECK_EQ_OR_RETURN(model_diff->data_type(), diff_data_type);
+    for (const std::string& arg_name : state_arg_names) {
+      const user_op::TensorDesc* state = ctx->TensorDesc4ArgNameAndIndex(arg_name, i);
+      CHECK_EQ_OR_RETURN(state->shape(), model->shape());
+      CHECK_EQ_OR_RETURN(state->data_type(), data_type);
+    }
+    for (const std::string& arg_name : scalar_state_arg_names) {
+      JUST(CheckScalarTensorDesc(ctx->TensorDesc4ArgNameAndIndex(arg_name, i), data_type));
+    }
+  }
+  JUST(CheckScalarTensorDesc(ctx->TensorDesc4ArgNameAndIndex("learning_rate", 0),
+                             DataType::kFloat));
+  if (ctx->user_op_conf().has_input("scale_by_tensor", 0)) {
+    JUST(CheckScalarTensorDesc(ctx->TensorDesc4ArgNameAndIndex("scale_by_tensor", 0), data_type));
+  }
+  if (ctx->user_op_conf().has_input("skip_if", 0)) {
+    JUST(CheckScalarTensorDesc(ctx->TensorDesc4ArgNameAndIndex("skip_if", 0), DataType::kInt64));
+  }
+  return Maybe<void>::Ok();
+}
+
+user_op::InputArgModifyFn MakeMultiTensorUpdateInputArgModifyFn(
+    const std::vector<std::string>& mutable_arg_names) {
+  return [mutable_arg_names](const user_op::GetInputArgModifier& GetInputArgModifierFn,
+                             const user_op::UserOpConfWrapper& conf) {
+    for (const std::string& arg_name : mutable_arg_names) {
+      FOR_RANGE(int32_t, i, 0, conf.input_size(arg_name)) {
+        user_op::InputArgModifier* arg_modifier = GetInputArgModifierFn(arg_name, i);
+        CHECK_NOTNULL(arg_modifier);
+        arg_modifier->set_is_mutable(true);
+      }
+    }
+  };
+}
+
+}  // namespace
+
+// every multi tensor update op has sbp broadcast signature only, they are generated by
+// MultiTensorModelUpdatePass for broadcast models
+
+REGISTER_USER_OP("multi_tensor_sgd_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .Input("learning_rate")
+    .OptionalInput("scale_by_tensor")
+    .OptionalInput("skip_if")
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {}, {});
+    })
+    .SetBatchAxisInferFn(user_op::BatchAxisInferFnUtil::NaiveInferBatchAxis)
+    .SetInputArgModifyFn(MakeMultiTensorUpdateInputArgModifyFn({"model"}));
+
+REGISTER_USER_OP("multi_tensor_momentum_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .InputWithMinimum("momentum", 1)
+    .Input("learning_rate")
+    .OptionalInput("scale_by_tensor")
+    .OptionalInput("skip_if")
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("beta", 0.9)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {"momentum"}, {});
+    })
+    .SetBatchAxisInferFn(user_op::BatchAxisInferFnUtil::NaiveInferBatchAxis)
+    .SetInputArgModifyFn(MakeMultiTensorUpdateInputArgModifyFn({"model", "momentum"}));
+
+REGISTER_USER_OP("multi_tensor_adam_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .InputWithMinimum("m", 1)
+    .InputWithMinimum("v", 1)
+    .Input("learning_rate")
+    .OptionalInput("scale_by_tensor")
+    .OptionalInput("skip_if")
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("beta1", 0.9)
+    .Attr<float>("beta2", 0.999)
+    .Attr<float>("epsilon", 1e-8)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {"m", "v"}, {});
+    })
+    .SetBatchAxisInferFn(user_op::BatchAxisInferFnUtil::NaiveInferBatchAxis)
+    .SetInputArgModifyFn(MakeMultiTensorUpdateInputArgModifyFn({"model", "m", "v"}));
+
+REGISTER_USER_OP("multi_tensor_lamb_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .InputWithMinimum("m", 1)
+    .InputWithMinimum("v", 1)
+    .InputWithMinimum("beta1_t", 1)
+    .InputWithMinimum("beta2_t", 1)
+    .Input("learning_rate")
+    .OptionalInput("scale_by_tensor")
+    .OptionalInput("skip_if")
+    .Attr<float>("beta1")
+    .Attr<float>("beta2")
+    .Attr<float>("epsilon")
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {"m", "v"}, {"beta1_t", "beta2_t"});
+    })
+    .SetBatchAxisInferFn(user_op::BatchAxisInferFnUtil::NaiveInferBatchAxis)
+    .SetInputArgModifyFn(
+        MakeMultiTensorUpdateInputArgModifyFn({"model", "m", "v", "beta1_t", "beta2_t"}));
+
+REGISTER_USER_OP("multi_tensor_lars_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .InputWithMinimum("momentum", 1)
+    .Input("learning_rate")
+    .Input("train_step")
+    .OptionalInput("scale_by_tensor")
+    .OptionalInput("skip_if")
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("momentum_beta", 0.9)
+    .Attr<float>("epsilon", 1e-9)
+    .Attr<float>("lars_coefficient", 1e-4)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckScalarTensorDesc(ctx->TensorDesc4ArgNameAndIndex("train_step", 0),
+                                 DataType::kInt64));
+      return InferMultiTensorUpdateTensorDesc(ctx, {"momentum"}, {});
+    })
+    .SetBatchAxisInferFn(user_op::BatchAxisInferFnUtil::NaiveInferBatchAxis)
+    .SetInputArgModifyFn(MakeMultiTensorUpdateInputArgModifyFn({"model", "momentum"}));
+
+}  // namespace oneflow
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/user/image/image_util.h"
 
 namespace oneflow {
 
@@ -84,6 +85,8 @@ REGISTER_CPU_ONLY_USER_OP("ofrecord_image_decoder")
     .Output("out")
     .Attr<std::string>("name")
     .Attr<std::string>("color_space", "BGR")
+    .Attr<std::string>("cache_dir", "")
+    .Attr<int64_t>("cache_capacity_mb", 0)
     .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
       user_op::TensorDesc* in_tensor = ctx->TensorDesc4ArgNameAndIndex("in", 0);
       user_op::TensorDesc* out_tensor = ctx->TensorDesc4ArgNameAndIndex("out", 0);
@@ -150,4 +153,68 @@ REGISTER_CPU_ONLY_USER_OP("ofrecord_image_decoder_random_crop")
       return Maybe<void>::Ok();
     });
 
+REGISTER_CPU_ONLY_USER_OP("ofrecord_image_decoder_random_crop_resize_normalize")
+    .Input("in")
+    .OptionalInput("mirror")
+    .Output("out")
+    .Attr<std::string>("name")
+    .Attr<std::string>("color_space", "BGR")
+    .Attr<int32_t>("num_attempts", 10)
+    .Attr<int64_t>("seed", -1)
+    .Attr<bool>("has_seed", false)
+    .Attr<std::vector<float>>("random_area", {0.08, 1.0})
+    .Attr<std::vector<float>>("random_aspect_ratio", {0.75, 1.333333})
+    .Attr<int64_t>("target_width")
+    .Attr<int64_t>("target_height")
+    .Attr<std::vector<float>>("mean", {0.0})
+    .Attr<std::vector<float>>("std", {1.0})
+    .Attr<std::string>("output_layout", "NCHW")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      user_op::TensorDesc* in_tensor = ctx->TensorDesc4ArgNameAndIndex("in", 0);
+      user_op::TensorDesc* out_tensor = ctx->TensorDesc4ArgNameAndIndex("out", 0);
+      CHECK_OR_RETURN(in_tensor->data_type() == DataType::kOFRecord);
+      CHECK_OR_RETURN(in_tensor->shape().NumAxes() == 1 && in_tensor->shape().At(0) >= 1);
+      const int64_t N = in_tensor->shape().At(0);
+      user_op::TensorDesc* mirror_tensor = ctx->TensorDesc4ArgNameAndIndex("mirror", 0);
+      if (mirror_tensor) {
+        CHECK_OR_RETURN(mirror_tensor->shape().NumAxes() == 1
+                        && mirror_tensor->shape().At(0) == N);
+        CHECK_EQ_OR_RETURN(mirror_tensor->data_type(), DataType::kInt8);
+      }
+      const int64_t H = ctx->Attr<int64_t>("target_height");
+      const int64_t W = ctx->Attr<int64_t>("target_width");
+      CHECK_OR_RETURN(H > 0 && W > 0);
+      const int64_t C = ImageUtil::IsColor(ctx->Attr<std::string>("color_space")) ? 3 : 1;
+      const auto& mean = ctx->Attr<std::vector<float>>("mean");
+      const auto& stddev = ctx->Attr<std::vector<float>>("std");
+      CHECK_OR_RETURN(mean.size() == 1 || mean.size() == C);
+      CHECK_OR_RETURN(stddev.size() == 1 || stddev.size() == C);
+      const std::string& output_layout = ctx->Attr<std::string>("output_layout");
+      if (output_layout == "NCHW") {
+        *out_tensor->mut_shape() = Shape({N, C, H, W});
+      } else if (output_layout == "NHWC") {
+        *out_tensor->mut_shape() = Shape({N, H, W, C});
+      } else {
+        return Error::CheckFailedError()
+               << "output_layout: " << output_layout << " is not supported";
+      }
+      *out_tensor->mut_data_type() = DataType::kFloat;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) {
+      user_op::InputArgModifier* in_modifier = GetInputArgModifierFn("in", 0);
+      CHECK_NOTNULL(in_modifier);
+      in_modifier->set_requires_grad(false);
+    })
+    .SetBatchAxisInferFn([](user_op::BatchAxisContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->BatchAxis4ArgNameAndIndex("in", 0)->value(), 0);
+      ctx->BatchAxis4ArgNameAndIndex("out", 0)->set_value(0);
+      return Maybe<void>::Ok();
+    });
+
 }  // namespace oneflow
@@ -34,6 +34,8 @@ REGISTER_CPU_ONLY_USER_OP("ofrecord_image_classification_reader")
     .Attr<std::string>("label_feature_name", "class/label")
     .Attr<int32_t>("decode_buffer_size_per_thread", 8)
     .Attr<int32_t>("num_decode_threads_per_machine", 0)
+    .Attr<std::string>("cache_dir", "")
+    .Attr<int64_t>("cache_capacity_mb", 0)
     .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
       user_op::TensorDesc* image_tensor = ctx->TensorDesc4ArgNameAndIndex("image", 0);
       user_op::TensorDesc* label_tensor = ctx->TensorDesc4ArgNameAndIndex("label", 0);
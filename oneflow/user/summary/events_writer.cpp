@@ -21,17 +21,32 @@ namespace oneflow {
 
 namespace summary {
 
-EventsWriter::EventsWriter() : is_inited_(false) {}
+EventsWriter::EventsWriter()
+    : is_inited_(false),
+      is_closed_(false),
+      flush_requested_(false),
+      drop_when_full_(std::getenv("ONEFLOW_SUMMARY_DROP_WHEN_FULL") != nullptr),
+      appended_cnt_(0),
+      written_cnt_(0),
+      dropped_cnt_(0),
+      blocked_append_cnt_(0),
+      total_append_wait_micros_(0),
+      max_append_wait_micros_(0),
+      batch_cnt_(0),
+      total_batch_write_micros_(0),
+      max_batch_write_micros_(0) {}
 
 EventsWriter::~EventsWriter() { Close(); }
 
 Maybe<void> EventsWriter::Init(const std::string& logdir) {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  if (is_inited_) { return Maybe<void>::Ok(); }
   file_system_ = std::make_unique<fs::PosixFileSystem>();
   log_dir_ = logdir + "/event";
   file_system_->RecursivelyCreateDirIfNotExist(log_dir_);
-  TryToInit();
+  JUST(TryToInit());
   is_inited_ = true;
-  last_flush_time_ = CurrentMircoTime();
+  writer_thread_ = std::thread(&EventsWriter::PollEvents, this);
   return Maybe<void>::Ok();
 }
 
@@ -55,65 +70,132 @@ Maybe<void> EventsWriter::TryToInit() {
     Event event;
     event.set_wall_time(current_time);
     event.set_file_version(FILE_VERSION);
-    WriteEvent(event);
-    Flush();
+    std::string buffer;
+    AppendEventToBuffer(event, &buffer);
+    WriteBuffer(buffer);
   }
   return Maybe<void>::Ok();
 }
 
 void EventsWriter::AppendQueue(std::unique_ptr<Event> event) {
-  queue_mutex.lock();
-  event_queue_.emplace_back(std::move(event));
-  queue_mutex.unlock();
-  if (event_queue_.size() > MAX_QUEUE_NUM || CurrentMircoTime() - last_flush_time_ > FLUSH_TIME) {
-    Flush();
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  if (!is_inited_ || is_closed_) {
+    LOG(WARNING) << "Summary event is discarded because the summary writer is not running";
+    return;
+  }
+  if (event_queue_.size() >= kMaxQueueSize) {
+    if (drop_when_full_) {
+      dropped_cnt_ += 1;
+      return;
+    }
+    const uint64_t start = CurrentMircoTime();
+    queue_not_full_cond_.wait(
+        lock, [this]() { return event_queue_.size() < kMaxQueueSize || is_closed_; });
+    const uint64_t wait_micros = CurrentMircoTime() - start;
+    blocked_append_cnt_ += 1;
+    total_append_wait_micros_ += wait_micros;
+    max_append_wait_micros_ = std::max(max_append_wait_micros_, wait_micros);
+    if (is_closed_) { return; }
   }
+  event_queue_.emplace_back(std::move(event));
+  appended_cnt_ += 1;
+  if (event_queue_.size() >= kMaxBatchSize) { queue_not_empty_cond_.notify_one(); }
 }
 
 void EventsWriter::Flush() {
-  queue_mutex.lock();
-  for (const std::unique_ptr<Event>& e : event_queue_) { WriteEvent(*e); }
-  event_queue_.clear();
-  queue_mutex.unlock();
-  FileFlush();
-  last_flush_time_ = CurrentMircoTime();
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  if (!is_inited_ || is_closed_) { return; }
+  const uint64_t target_cnt = appended_cnt_;
+  flush_requested_ = true;
+  queue_not_empty_cond_.notify_one();
+  written_cond_.wait(lock, [this, target_cnt]() { return written_cnt_ >= target_cnt; });
 }
 
-void EventsWriter::WriteEvent(const Event& event) {
-  std::string event_str;
-  event.AppendToString(&event_str);
+void EventsWriter::PollEvents() {
+  std::vector<std::unique_ptr<Event>> batch;
+  while (true) {
+    bool is_closed = false;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_not_empty_cond_.wait_for(
+          lock, std::chrono::microseconds(kFlushIntervalMicros), [this]() {
+            return event_queue_.size() >= kMaxBatchSize || flush_requested_ || is_closed_;
+          });
+      while (!event_queue_.empty()) {
+        batch.emplace_back(std::move(event_queue_.front()));
+        event_queue_.pop_front();
+      }
+      flush_requested_ = false;
+      is_closed = is_closed_;
+      queue_not_full_cond_.notify_all();
+    }
+    if (!batch.empty()) { WriteBatch(batch); }
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      written_cnt_ += batch.size();
+      written_cond_.notify_all();
+    }
+    batch.clear();
+    if (is_closed) { break; }
+  }
+}
+
+void EventsWriter::WriteBatch(const std::vector<std::unique_ptr<Event>>& batch) {
+  const uint64_t start = CurrentMircoTime();
+  std::string buffer;
+  for (const std::unique_ptr<Event>& e : batch) { AppendEventToBuffer(*e, &buffer); }
   if (!TryToInit().IsOk()) {
     LOG(ERROR) << "Write failed because file could not be opened.";
     return;
   }
+  WriteBuffer(buffer);
+  const uint64_t write_micros = CurrentMircoTime() - start;
+  batch_cnt_ += 1;
+  total_batch_write_micros_ += write_micros;
+  max_batch_write_micros_ = std::max(max_batch_write_micros_, write_micros);
+  VLOG(3) << "Summary writer committed " << batch.size() << " events in " << write_micros << "us";
+}
+
+void EventsWriter::WriteBuffer(const std::string& buffer) {
   if (writable_file_ == nullptr) {
     LOG(WARNING) << "Log file is closed!";
     return;
   }
+  writable_file_->Append(buffer.data(), buffer.size());
+  writable_file_->Flush();
+}
 
+void EventsWriter::AppendEventToBuffer(const Event& event, std::string* buffer) {
+  std::string event_str;
+  event.AppendToString(&event_str);
   char head[kHeadSize];
   char tail[kTailSize];
   EncodeHead(head, event_str.size());
   EncodeTail(tail, event_str.data(), event_str.size());
-  writable_file_->Append(head, sizeof(head));
-  writable_file_->Append(event_str.data(), event_str.size());
-  writable_file_->Append(tail, sizeof(tail));
-  FileFlush();
-}
-
-void EventsWriter::FileFlush() {
-  if (writable_file_ == nullptr) { return; }
-  writable_file_->Flush();
+  buffer->append(head, sizeof(head));
+  buffer->append(event_str);
+  buffer->append(tail, sizeof(tail));
 }
 
 void EventsWriter::Close() {
-  if (!is_inited_) { return; }
-  queue_mutex.unlock();
-  Flush();
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (!is_inited_ || is_closed_) { return; }
+    is_closed_ = true;
+    queue_not_empty_cond_.notify_one();
+    queue_not_full_cond_.notify_all();
+  }
+  writer_thread_.join();
   if (writable_file_ != nullptr) {
     writable_file_->Close();
     writable_file_.reset(nullptr);
   }
+  LOG(INFO) << "Summary writer wrote " << written_cnt_ << " events in " << batch_cnt_
+            << " batches (avg " << (batch_cnt_ > 0 ? total_batch_write_micros_ / batch_cnt_ : 0)
+            << "us, max " << max_batch_write_micros_ << "us), dropped " << dropped_cnt_
+            << " events, blocked summary ops " << blocked_append_cnt_ << " times (avg "
+            << (blocked_append_cnt_ > 0 ? total_append_wait_micros_ / blocked_append_cnt_ : 0)
+            << "us, max " << max_append_wait_micros_ << "us)";
 }
 
 }  // namespace summary
@@ -22,44 +22,73 @@ limitations under the License.
 #include "oneflow/core/summary/event.pb.h"
 
 #include <time.h>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
 
 namespace oneflow {
 
 namespace summary {
 
-#define MAX_QUEUE_NUM 10
-#define FLUSH_TIME 3 * 60 * 1000 * 1000
 #define FILE_VERSION "brain.Event:3"
 const size_t kHeadSize = sizeof(uint64_t) + sizeof(uint32_t);
 const size_t kTailSize = sizeof(uint32_t);
-
+// Events waiting for the writer thread; AppendQueue blocks (or drops) beyond this
+const size_t kMaxQueueSize = 1024;
+// The writer thread commits as soon as this many events are pending ...
+const size_t kMaxBatchSize = 64;
+// ... and at least once per this interval while events are pending
+const uint64_t kFlushIntervalMicros = 1000 * 1000;
+
+// Events are appended by summary kernels and written by a dedicated writer thread, which
+// serializes and checksums a whole batch into one buffer and commits it with a single append and
+// flush. When the queue is full, AppendQueue blocks until the writer catches up, or drops the
+// event if ONEFLOW_SUMMARY_DROP_WHEN_FULL is set.
 class EventsWriter {
  public:
   EventsWriter();
   ~EventsWriter();
 
   Maybe<void> Init(const std::string& logdir);
-  void WriteEvent(const Event& event);
+  void AppendQueue(std::unique_ptr<Event> event);
+  // Waits until every event appended before the call is written and flushed
   void Flush();
   void Close();
 
-  void AppendQueue(std::unique_ptr<Event> event);
-  void FileFlush();
-
  private:
   Maybe<void> TryToInit();
+  void PollEvents();
+  void WriteBatch(const std::vector<std::unique_ptr<Event>>& batch);
+  void WriteBuffer(const std::string& buffer);
+  static void AppendEventToBuffer(const Event& event, std::string* buffer);
   inline static void EncodeHead(char* head, size_t size);
   inline static void EncodeTail(char* tail, const char* data, size_t size);
 
   bool is_inited_;
+  bool is_closed_;
+  bool flush_requested_;
+  bool drop_when_full_;
   std::string log_dir_;
   std::string filename_;
   std::unique_ptr<fs::FileSystem> file_system_;
   std::unique_ptr<fs::WritableFile> writable_file_;
-  uint64_t last_flush_time_;
-  std::vector<std::unique_ptr<Event>> event_queue_;
-  std::mutex queue_mutex;
+  std::deque<std::unique_ptr<Event>> event_queue_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_not_empty_cond_;
+  std::condition_variable queue_not_full_cond_;
+  std::condition_variable written_cond_;
+  std::thread writer_thread_;
+  uint64_t appended_cnt_;
+  uint64_t written_cnt_;
+  uint64_t dropped_cnt_;
+  // latency of the summary kernels (time blocked in AppendQueue) and of the writer thread
+  uint64_t blocked_append_cnt_;
+  uint64_t total_append_wait_micros_;
+  uint64_t max_append_wait_micros_;
+  uint64_t batch_cnt_;
+  uint64_t total_batch_write_micros_;
+  uint64_t max_batch_write_micros_;
   OF_DISALLOW_COPY(EventsWriter);
 };
 
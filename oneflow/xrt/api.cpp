@@ -41,6 +41,8 @@ DEFINE_bool(strict_clustering, EnvToBool(FLAGS_strict_clustering, true),
 //               "valid, Default means using no engine.");
 DEFINE_bool(use_xla_jit, EnvToBool(FLAGS_use_xla_jit, false), "It's optional to use xla jit.");
 DEFINE_bool(use_tensorrt, EnvToBool(FLAGS_use_tensorrt, false), "It's optional to use tensorrt.");
+DEFINE_bool(use_native_fusion, EnvToBool(FLAGS_use_native_fusion, false),
+            "It's optional to fuse CPU elementwise ops with the xrt native engine.");
 
 DEFINE_bool(tensorrt_fp16, EnvToBool(FLAGS_tensorrt_fp16, false),
             "Enable fp16 precision for TENSORRT engine.");
@@ -103,6 +105,36 @@ static std::unordered_map<std::string, std::string> user_op_type_name2string_map
     {"adam_update", "AdamOptimizer"},
     {"rsqrt", "Rsqrt"},
     {"square_sum", "SquareSum"},
+    {"broadcast_sub", "BcastSub"},
+    {"broadcast_minimum", "BcastMin"},
+    {"broadcast_maximum", "BcastMax"},
+    {"sigmoid_v2", "Sigmoid"},
+    {"abs", "Abs"},
+    {"ceil", "Ceil"},
+    {"cos", "Cos"},
+    {"erf", "Erf"},
+    {"erfc", "Erfc"},
+    {"exp", "Exp"},
+    {"expm1", "Expm1"},
+    {"floor", "Floor"},
+    {"log", "Log"},
+    {"log1p", "Log1p"},
+    {"log_sigmoid", "LogSigmoid"},
+    {"negative", "Negative"},
+    {"reciprocal", "Reciprocal"},
+    {"reciprocal_no_nan", "ReciprocalNoNan"},
+    {"rint", "Rint"},
+    {"round", "Round"},
+    {"sign", "Sign"},
+    {"sin", "Sin"},
+    {"softplus", "Softplus"},
+    {"sqrt", "Sqrt"},
+    {"square", "Square"},
+    {"pow", "Pow"},
+    {"atan2", "Atan2"},
+    {"floordiv", "Floordiv"},
+    {"xdivy", "Xdivy"},
+    {"xlogy", "Xlogy"},
 };
 
 std::string ExtractOpTypeAsString(const OperatorConf &conf) {
@@ -157,6 +189,8 @@ XrtEngine StringToXrtEngine(const std::string &engine) {
     return xrt::XrtEngine::XLA;
   } else if (engine == "TENSORRT") {
     return xrt::XrtEngine::TENSORRT;
+  } else if (engine == "NATIVE") {
+    return xrt::XrtEngine::NATIVE;
   } else {
     LOG(FATAL) << "Unknown engine: " << engine;
   }
@@ -190,6 +224,7 @@ std::shared_ptr<XrtGraph> BuildXrtGraph(const XrtLaunchOpConf::Function &functio
 void InitXrtConfigurations(const XrtConfig &config) {
   if (config.has_use_xla_jit()) { FLAGS_use_xla_jit = config.use_xla_jit(); }
   if (config.has_use_tensorrt()) { FLAGS_use_tensorrt = config.use_tensorrt(); }
+  if (config.has_use_native_fusion()) { FLAGS_use_native_fusion = config.use_native_fusion(); }
   // Set xla configurations.
   if (config.has_tensorrt_config()) {
     const XrtConfig::TensorRTConfig &trt_config = config.tensorrt_config();
@@ -203,7 +238,9 @@ void InitXrtConfigurations(const XrtConfig &config) {
   }
 }
 
-bool XrtCompilationEnabled() { return FLAGS_use_xla_jit || FLAGS_use_tensorrt; }
+bool XrtCompilationEnabled() {
+  return FLAGS_use_xla_jit || FLAGS_use_tensorrt || FLAGS_use_native_fusion;
+}
 
 XrtPassOptions CreateDefaultXrtPassOptions(bool train_phase) {
   ClusteringOptions options;
@@ -216,6 +253,7 @@ XrtPassOptions CreateDefaultXrtPassOptions(bool train_phase) {
   options.engine = (1U << XrtEngineOptionBit::kUseDefault);
   if (FLAGS_use_xla_jit) { options.engine |= (1U << XrtEngineOptionBit::kUseXlaJit); }
   if (FLAGS_use_tensorrt) { options.engine |= (1U << XrtEngineOptionBit::kUseTensorRT); }
+  if (FLAGS_use_native_fusion) { options.engine |= (1U << XrtEngineOptionBit::kUseNative); }
 
   XrtPassOptions xrt_options;
   xrt_options.clustering_options = options;
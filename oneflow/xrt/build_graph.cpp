@@ -131,6 +131,8 @@ void GraphBuilder::SetupGraphEdges() {
     sbp_policy.push_back(BlobSbpPolicy(src, name));
     sbp_policy.push_back(BlobSbpPolicy(dst, name));
     edge->Attr("sbp_policy", sbp_policy);
+    // Set data type
+    edge->Attr("data_type", src->LogicalBlobDesc4Lbi(BlobNameToId(name)).data_type());
   }
 }
 
@@ -0,0 +1,59 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_executable.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#include "glog/logging.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+bool NativeExecutable::Run(const std::vector<Parameter> &inputs,
+                           const ExecutableRunOptions &run_options, bool block_until_done) {
+  CHECK_EQ(inputs.size(), entry_names_.size()) << "Size mismatch between input params and entry.";
+  NativeBufferTable buffers;
+  for (int i = 0; i < inputs.size(); ++i) {
+    CHECK_EQ(inputs[i].name(), entry_names_[i]);
+    buffers.entries.push_back(inputs[i].data());
+  }
+  for (const Parameter &param : run_options.return_params) {
+    buffers.returns.push_back(param.data());
+  }
+  const size_t compute_type_size = GetSizeOfDataType(program_->compute_type());
+  std::vector<std::unique_ptr<char[]>> temps;
+  for (int64_t elem_cnt : program_->temp_elem_cnts()) {
+    temps.emplace_back(new char[elem_cnt * compute_type_size]);
+    buffers.temps.push_back(temps.back().get());
+  }
+
+  int32_t max_num_threads = 1;
+  if (Global<ThreadPool>::Get() != nullptr) {
+    max_num_threads = Global<ThreadPool>::Get()->thread_num();
+  }
+  if (run_options.host_num_threads > 0) {
+    max_num_threads = std::min(max_num_threads, run_options.host_num_threads);
+  }
+  program_->Run(buffers, max_num_threads);
+
+  this->results_ = run_options.return_params;
+  return true;
+}
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
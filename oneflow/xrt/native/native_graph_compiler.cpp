@@ -0,0 +1,127 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_graph_compiler.h"
+#include "oneflow/xrt/node_util.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+namespace {
+
+// Values of the fused loops are computed in float unless some argument needs
+// the precision of double, such as double or 32-bit integral blobs. 64-bit
+// integral blobs are not exact in double, so their nodes are never clustered.
+DataType InferComputeType(const XrtGraph *graph) {
+  DataType compute_type = DataType::kFloat;
+  for (const Argument &arg : graph->Arguments()) {
+    const DataType data_type = arg.data_type();
+    CHECK(data_type != DataType::kFloat16) << "Float16 is not supported by the native engine.";
+    CHECK(data_type != DataType::kInt64) << "Int64 is not supported by the native engine.";
+    if (data_type == DataType::kDouble || data_type == DataType::kInt32) {
+      compute_type = DataType::kDouble;
+    }
+  }
+  return compute_type;
+}
+
+}  // namespace
+
+void NativeGraphCompiler::PopulateEntryParams(const std::vector<Parameter> &entry_params) {
+  for (int i = 0; i < entry_params.size(); ++i) {
+    const Parameter &param = entry_params[i];
+    Argument arg = ArgFromParameter(param);
+    operands_[arg] = builder_->Parameter(i, param.shape(), param.data_type());
+  }
+}
+
+Argument NativeGraphCompiler::ArgFromParameter(const Parameter &param) {
+  return Argument(param.name(), param.shape(), param.data_type());
+}
+
+void NativeGraphCompiler::SetupKernelContextParam(const XrtNode *node,
+                                                  NativeOpContext::Param *context_param) {
+  util::Map<Argument, NativeValue> input_ops;
+  util::Map<std::string /* produce/consume key */, Argument> input_output_args;
+  std::vector<std::string> output_names;
+  for (const XrtEdge *edge : node->in_edges()) {
+    if (!edge->IsControlEdge()) {
+      const Argument &arg = edge->argument();
+      CHECK_GT(operands_.count(arg), 0);
+      input_ops.emplace(arg, operands_.at(arg));
+      const std::string &k = arg.meta_data().consume_key;
+      input_output_args.emplace(k, arg);
+    }
+  }
+  for (const XrtEdge *edge : node->out_edges()) {
+    if (!edge->IsControlEdge()) {
+      const Argument &arg = edge->argument();
+      const std::string &k = arg.meta_data().produce_key;
+      input_output_args.emplace(k, arg);
+      output_names.push_back(k);
+    }
+  }
+
+  size_t num_outputs = input_output_args.size() - input_ops.size();
+  CHECK_GE(num_outputs, 0) << "Outputs number should >= 0.";
+  context_param->op_name = node->name();
+  context_param->builder = builder_.get();
+  context_param->message = OpMessage(node);
+  context_param->arguments = std::move(input_output_args);
+  context_param->inputs = std::move(input_ops);
+  context_param->output_names = std::move(output_names);
+  context_param->num_outputs = num_outputs;
+}
+
+std::shared_ptr<Executable> NativeGraphCompiler::Compile(
+    const XrtGraph *graph, const std::vector<Parameter> &entry_params,
+    const std::vector<Parameter> &return_params, const std::vector<InputOutputAlias> &aliases) {
+  CHECK_EQ(device_, XrtDevice::CPU_X86) << "The native engine only supports CPU.";
+  builder_ = std::make_shared<NativeProgramBuilder>(name_, InferComputeType(graph));
+  PopulateEntryParams(entry_params);
+
+  algorithm::TopologyVisit(*graph, [&](const XrtNode *node) {
+    NativeOpContext::Param param;
+    SetupKernelContextParam(node, &param);
+    NativeOpContext op_context(param);
+    // Do compile, append the node to the fused loops.
+    auto op_kernel = BuildOpKernel(node->type());
+    op_kernel->Compile(&op_context);
+
+    // Always insert the new output into `operands_`.
+    const auto &outputs = op_context.outputs();
+    for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+      operands_[it->first] = it->second;
+    }
+  });
+
+  for (int i = 0; i < return_params.size(); ++i) {
+    Argument arg = ArgFromParameter(return_params[i]);
+    CHECK_GT(operands_.count(arg), 0);
+    builder_->Return(operands_.at(arg), i, return_params[i].data_type());
+  }
+
+  std::vector<std::string> entry_names;
+  for (const Parameter &param : entry_params) { entry_names.push_back(param.name()); }
+  return std::make_shared<NativeExecutable>(builder_->name(), entry_names, builder_->Build());
+}
+
+REGISTER_GRAPH_COMPILER(XrtEngine::NATIVE, NativeGraphCompiler);
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
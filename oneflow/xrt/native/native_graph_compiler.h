@@ -0,0 +1,59 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_XRT_NATIVE_NATIVE_GRAPH_COMPILER_H_
+#define ONEFLOW_XRT_NATIVE_NATIVE_GRAPH_COMPILER_H_
+
+#include "oneflow/xrt/graph_compiler.h"
+#include "oneflow/xrt/native/native_executable.h"
+#include "oneflow/xrt/native/native_program.h"
+#include "oneflow/xrt/native/ops/op_context.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+// Compile a cluster of elementwise and broadcast ops into fused loops which
+// are evaluated tile by tile, so intermediate blobs are never written back to
+// memory.
+class NativeGraphCompiler : public GraphCompiler::Impl {
+ public:
+  explicit NativeGraphCompiler(const std::string &name) : GraphCompiler::Impl(name) {}
+
+  virtual ~NativeGraphCompiler() = default;
+
+  std::shared_ptr<Executable> Compile(const XrtGraph *graph,
+                                      const std::vector<Parameter> &entry_params,
+                                      const std::vector<Parameter> &return_params,
+                                      const std::vector<InputOutputAlias> &aliases) override;
+
+ private:
+  void SetupKernelContextParam(const XrtNode *node, NativeOpContext::Param *context_param);
+
+  void PopulateEntryParams(const std::vector<Parameter> &entry_params);
+
+  Argument ArgFromParameter(const Parameter &param);
+
+ private:
+  std::shared_ptr<NativeProgramBuilder> builder_;
+
+  util::Map<Argument, NativeValue> operands_;
+};
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
+
+#endif  // ONEFLOW_XRT_NATIVE_NATIVE_GRAPH_COMPILER_H_
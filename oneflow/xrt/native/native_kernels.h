@@ -0,0 +1,185 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_XRT_NATIVE_NATIVE_KERNELS_H_
+#define ONEFLOW_XRT_NATIVE_NATIVE_KERNELS_H_
+
+#include <cmath>
+
+#include "oneflow/core/common/data_type.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+// Every fused instruction is evaluated over a tile of at most `kNativeTileSize`
+// elements with the signature of `NativeKernel`. Unary kernels ignore `y`,
+// `alpha` carries the scalar operand of scalar and parametric ops.
+template<typename T>
+using NativeKernel = void (*)(int64_t n, const T *x, const T *y, T alpha, T *z);
+
+struct NativeKernelFn {
+  NativeKernel<float> f32 = nullptr;
+  NativeKernel<double> f64 = nullptr;
+
+  template<typename T>
+  NativeKernel<T> Get() const;
+};
+
+template<>
+inline NativeKernel<float> NativeKernelFn::Get<float>() const {
+  return f32;
+}
+
+template<>
+inline NativeKernel<double> NativeKernelFn::Get<double>() const {
+  return f64;
+}
+
+template<typename T, template<typename> class Functor>
+void UnaryKernel(int64_t n, const T *x, const T *y, T alpha, T *z) {
+  for (int64_t i = 0; i < n; ++i) { z[i] = Functor<T>::Forward(x[i]); }
+}
+
+template<typename T, template<typename> class Functor>
+void BinaryKernel(int64_t n, const T *x, const T *y, T alpha, T *z) {
+  for (int64_t i = 0; i < n; ++i) { z[i] = Functor<T>::Forward(x[i], y[i]); }
+}
+
+template<typename T, template<typename> class Functor>
+void ScalarKernel(int64_t n, const T *x, const T *y, T alpha, T *z) {
+  for (int64_t i = 0; i < n; ++i) { z[i] = Functor<T>::Forward(x[i], alpha); }
+}
+
+template<template<typename> class Functor>
+inline NativeKernelFn MakeUnaryKernelFn() {
+  NativeKernelFn fn;
+  fn.f32 = &UnaryKernel<float, Functor>;
+  fn.f64 = &UnaryKernel<double, Functor>;
+  return fn;
+}
+
+template<template<typename> class Functor>
+inline NativeKernelFn MakeBinaryKernelFn() {
+  NativeKernelFn fn;
+  fn.f32 = &BinaryKernel<float, Functor>;
+  fn.f64 = &BinaryKernel<double, Functor>;
+  return fn;
+}
+
+template<template<typename> class Functor>
+inline NativeKernelFn MakeScalarKernelFn() {
+  NativeKernelFn fn;
+  fn.f32 = &ScalarKernel<float, Functor>;
+  fn.f64 = &ScalarKernel<double, Functor>;
+  return fn;
+}
+
+// Functors which are not covered by the math unary/binary elementwise
+// functors of user kernels.
+template<typename T>
+struct IdentityFunctor {
+  static T Forward(const T x) { return x; }
+};
+
+template<typename T>
+struct TruncFunctor {
+  static T Forward(const T x) { return std::trunc(x); }
+};
+
+template<typename T>
+struct RoundToFloatFunctor {
+  static T Forward(const T x) { return static_cast<T>(static_cast<float>(x)); }
+};
+
+template<typename T>
+struct ReluFunctor {
+  static T Forward(const T x) { return x > T(0) ? x : T(0); }
+};
+
+template<typename T>
+struct GeluFunctor {
+  static T Forward(const T x) {
+    const T cdf = std::erf(static_cast<T>(M_SQRT1_2) * x);
+    return static_cast<T>(0.5) * x * (static_cast<T>(1.0) + cdf);
+  }
+};
+
+template<typename T>
+struct AddFunctor {
+  static T Forward(const T x, const T y) { return x + y; }
+};
+
+template<typename T>
+struct SubFunctor {
+  static T Forward(const T x, const T y) { return x - y; }
+};
+
+template<typename T>
+struct MulFunctor {
+  static T Forward(const T x, const T y) { return x * y; }
+};
+
+template<typename T>
+struct DivFunctor {
+  static T Forward(const T x, const T y) { return x / y; }
+};
+
+template<typename T>
+struct MinFunctor {
+  static T Forward(const T x, const T y) { return x < y ? x : y; }
+};
+
+template<typename T>
+struct MaxFunctor {
+  static T Forward(const T x, const T y) { return x > y ? x : y; }
+};
+
+template<typename T>
+struct FloorModFunctor {
+  static T Forward(const T x, const T y) {
+    const T trunc_mod = std::fmod(x, y);
+    return (trunc_mod != T(0)) && ((y < T(0)) != (trunc_mod < T(0))) ? trunc_mod + y : trunc_mod;
+  }
+};
+
+template<typename T>
+struct LeakyReluFunctor {
+  static T Forward(const T x, const T alpha) { return x > T(0) ? x : x * alpha; }
+};
+
+// Conversions between the storage data type of blobs and the compute type of
+// a fused program.
+template<typename T, typename S>
+inline void LoadContiguous(int64_t n, const S *src, T *dst) {
+  for (int64_t i = 0; i < n; ++i) { dst[i] = static_cast<T>(src[i]); }
+}
+
+template<typename T, typename S>
+inline void LoadScalar(int64_t n, const S *src, T *dst) {
+  const T value = static_cast<T>(*src);
+  for (int64_t i = 0; i < n; ++i) { dst[i] = value; }
+}
+
+template<typename T, typename D>
+inline void StoreContiguous(int64_t n, const T *src, D *dst) {
+  for (int64_t i = 0; i < n; ++i) { dst[i] = static_cast<D>(src[i]); }
+}
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
+
+#endif  // ONEFLOW_XRT_NATIVE_NATIVE_KERNELS_H_
@@ -0,0 +1,336 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_program.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/data_type_seq.h"
+#include "oneflow/core/common/shape_view.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+#include "glog/logging.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+namespace {
+
+template<typename T, typename S>
+void LoadTileImpl(const NativeInstruction &instr, const Shape &loop_shape, const S *src,
+                  int64_t offset, int64_t n, int64_t *index, T *dst) {
+  if (instr.is_scalar) {
+    LoadScalar(n, src, dst);
+  } else if (instr.strides.empty()) {
+    LoadContiguous(n, src + offset, dst);
+  } else {
+    // Walk the broadcast index incrementally instead of dividing for every
+    // element.
+    const int64_t num_axes = loop_shape.NumAxes();
+    const std::vector<int64_t> &strides = instr.strides;
+    int64_t remain = offset;
+    int64_t src_offset = 0;
+    for (int64_t d = num_axes - 1; d >= 0; --d) {
+      index[d] = remain % loop_shape.At(d);
+      remain /= loop_shape.At(d);
+      src_offset += index[d] * strides[d];
+    }
+    for (int64_t i = 0; i < n; ++i) {
+      dst[i] = static_cast<T>(src[src_offset]);
+      for (int64_t d = num_axes - 1; d >= 0; --d) {
+        index[d] += 1;
+        src_offset += strides[d];
+        if (index[d] < loop_shape.At(d)) { break; }
+        src_offset -= index[d] * strides[d];
+        index[d] = 0;
+      }
+    }
+  }
+}
+
+template<typename T>
+void LoadTile(const NativeInstruction &instr, const Shape &loop_shape, const void *src,
+              int64_t offset, int64_t n, int64_t *index, T *dst) {
+  switch (instr.buffer.data_type) {
+#define LOAD_TILE_CASE(type_cpp, type_proto)                                                     \
+  case type_proto:                                                                               \
+    LoadTileImpl<T, type_cpp>(instr, loop_shape, reinterpret_cast<const type_cpp *>(src), offset, \
+                              n, index, dst);                                                    \
+    break;
+    OF_PP_FOR_EACH_TUPLE(LOAD_TILE_CASE, POD_DATA_TYPE_SEQ)
+#undef LOAD_TILE_CASE
+    default: LOG(FATAL) << "Unsupported data type " << instr.buffer.data_type;
+  }
+}
+
+template<typename T>
+void StoreTile(const NativeInstruction &instr, const T *src, void *dst, int64_t offset,
+               int64_t n) {
+  switch (instr.buffer.data_type) {
+#define STORE_TILE_CASE(type_cpp, type_proto)                                      \
+  case type_proto:                                                                 \
+    StoreContiguous<T, type_cpp>(n, src, reinterpret_cast<type_cpp *>(dst) + offset); \
+    break;
+    OF_PP_FOR_EACH_TUPLE(STORE_TILE_CASE, POD_DATA_TYPE_SEQ)
+#undef STORE_TILE_CASE
+    default: LOG(FATAL) << "Unsupported data type " << instr.buffer.data_type;
+  }
+}
+
+const void *BufferPtr(const NativeBufferTable &buffers, const NativeBuffer &buffer) {
+  switch (buffer.kind) {
+    case NativeBuffer::kEntry: return buffers.entries.at(buffer.index);
+    case NativeBuffer::kReturn: return buffers.returns.at(buffer.index);
+    case NativeBuffer::kTemp: return buffers.temps.at(buffer.index);
+  }
+  return nullptr;
+}
+
+template<typename T>
+void RunTiles(const NativeLoop &loop, const NativeBufferTable &buffers, int64_t begin_tile,
+              int64_t end_tile) {
+  const int64_t elem_cnt = loop.shape.elem_cnt();
+  std::vector<T> slots(loop.num_slots * kNativeTileSize);
+  std::vector<int64_t> index(std::max<int64_t>(loop.shape.NumAxes(), 1));
+  auto Slot = [&](int32_t slot) -> T * { return slots.data() + slot * kNativeTileSize; };
+  for (int64_t tile = begin_tile; tile < end_tile; ++tile) {
+    const int64_t offset = tile * kNativeTileSize;
+    const int64_t n = std::min(kNativeTileSize, elem_cnt - offset);
+    for (const NativeInstruction &instr : loop.instructions) {
+      switch (instr.kind) {
+        case NativeInstruction::kLoad: {
+          LoadTile<T>(instr, loop.shape, BufferPtr(buffers, instr.buffer), offset, n,
+                      index.data(), Slot(instr.out_slot));
+          break;
+        }
+        case NativeInstruction::kCompute: {
+          const T *y = instr.in_slots[1] >= 0 ? Slot(instr.in_slots[1]) : nullptr;
+          instr.fn.Get<T>()(n, Slot(instr.in_slots[0]), y, static_cast<T>(instr.alpha),
+                            Slot(instr.out_slot));
+          break;
+        }
+        case NativeInstruction::kStore: {
+          StoreTile<T>(instr, Slot(instr.in_slots[0]),
+                       const_cast<void *>(BufferPtr(buffers, instr.buffer)), offset, n);
+          break;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template<typename T>
+void NativeProgram::RunLoop(const NativeLoop &loop, const NativeBufferTable &buffers,
+                            int32_t max_num_threads) const {
+  const int64_t elem_cnt = loop.shape.elem_cnt();
+  const int64_t num_tiles = (elem_cnt + kNativeTileSize - 1) / kNativeTileSize;
+  const int64_t num_chunks = std::min<int64_t>(
+      max_num_threads, (num_tiles + kNativeGrainTiles - 1) / kNativeGrainTiles);
+  if (num_chunks <= 1) {
+    RunTiles<T>(loop, buffers, 0, num_tiles);
+  } else {
+    BalancedSplitter bs(num_tiles, num_chunks);
+    MultiThreadLoop(num_chunks, [&](size_t i) {
+      const Range range = bs.At(i);
+      RunTiles<T>(loop, buffers, range.begin(), range.end());
+    });
+  }
+}
+
+void NativeProgram::Run(const NativeBufferTable &buffers, int32_t max_num_threads) const {
+  for (const NativeLoop &loop : loops_) {
+    if (compute_type_ == DataType::kDouble) {
+      RunLoop<double>(loop, buffers, max_num_threads);
+    } else {
+      CHECK_EQ(compute_type_, DataType::kFloat);
+      RunLoop<float>(loop, buffers, max_num_threads);
+    }
+  }
+}
+
+NativeValue NativeProgramBuilder::AddValue(const ValueInfo &info) {
+  values_.push_back(info);
+  return NativeValue(values_.size() - 1);
+}
+
+NativeValue NativeProgramBuilder::Parameter(int32_t entry_index, const Shape &shape,
+                                            const DataType &data_type) {
+  ValueInfo info;
+  info.shape = shape;
+  info.data_type = data_type;
+  info.in_memory = true;
+  info.buffer.kind = NativeBuffer::kEntry;
+  info.buffer.index = entry_index;
+  info.buffer.data_type = data_type;
+  return AddValue(info);
+}
+
+int32_t NativeProgramBuilder::LoopForShape(const Shape &shape) {
+  for (int32_t i = 0; i < loops_.size(); ++i) {
+    if (loops_[i].shape == shape) { return i; }
+  }
+  NativeLoop loop;
+  loop.shape = shape;
+  loops_.push_back(loop);
+  loop_consumers_.emplace_back();
+  return loops_.size() - 1;
+}
+
+void NativeProgramBuilder::Materialize(int64_t value_id) {
+  ValueInfo &info = values_.at(value_id);
+  CHECK_GE(info.loop, 0);
+  info.in_memory = true;
+  info.producer_loop = info.loop;
+  info.buffer.kind = NativeBuffer::kTemp;
+  info.buffer.index = temp_elem_cnts_.size();
+  info.buffer.data_type = compute_type_;
+  temp_elem_cnts_.push_back(info.shape.elem_cnt());
+
+  NativeInstruction store;
+  store.kind = NativeInstruction::kStore;
+  store.in_slots[0] = info.slot;
+  store.buffer = info.buffer;
+  loops_.at(info.loop).instructions.push_back(store);
+}
+
+int32_t NativeProgramBuilder::SlotInLoop(int64_t value_id, int32_t loop) {
+  if (values_.at(value_id).loop == loop) { return values_.at(value_id).slot; }
+  if (!values_.at(value_id).in_memory) { Materialize(value_id); }
+  auto &loaded = loaded_slots_[value_id];
+  const auto it = loaded.find(loop);
+  if (it != loaded.end()) { return it->second; }
+
+  const ValueInfo &info = values_.at(value_id);
+  const Shape &loop_shape = loops_.at(loop).shape;
+  NativeInstruction load;
+  load.kind = NativeInstruction::kLoad;
+  load.buffer = info.buffer;
+  if (info.shape.elem_cnt() == 1) {
+    load.is_scalar = true;
+  } else if (info.shape.elem_cnt() != loop_shape.elem_cnt()) {
+    const int64_t num_axes = loop_shape.NumAxes();
+    CHECK_LE(info.shape.NumAxes(), num_axes)
+        << name_ << ": can not broadcast " << info.shape.ToString() << " to "
+        << loop_shape.ToString();
+    const Shape extended = CreateLeftExtendedShape(ShapeView(info.shape), num_axes);
+    load.strides.resize(num_axes);
+    int64_t stride = 1;
+    for (int64_t d = num_axes - 1; d >= 0; --d) {
+      if (extended.At(d) == loop_shape.At(d)) {
+        load.strides[d] = stride;
+      } else {
+        CHECK_EQ(extended.At(d), 1) << name_ << ": can not broadcast " << info.shape.ToString()
+                                    << " to " << loop_shape.ToString();
+        load.strides[d] = 0;
+      }
+      stride *= extended.At(d);
+    }
+  }
+  load.out_slot = loops_.at(loop).num_slots++;
+  loops_.at(loop).instructions.push_back(load);
+  if (info.producer_loop >= 0 && info.producer_loop != loop) {
+    loop_consumers_.at(info.producer_loop).insert(loop);
+  }
+  loaded.emplace(loop, load.out_slot);
+  return load.out_slot;
+}
+
+NativeValue NativeProgramBuilder::Compute(const NativeKernelFn &fn,
+                                          const std::vector<NativeValue> &inputs, double alpha,
+                                          const Shape &shape, const DataType &data_type) {
+  CHECK(inputs.size() == 1 || inputs.size() == 2);
+  const int32_t loop = LoopForShape(shape);
+  NativeInstruction instr;
+  instr.kind = NativeInstruction::kCompute;
+  instr.fn = fn;
+  instr.alpha = alpha;
+  for (int i = 0; i < inputs.size(); ++i) {
+    instr.in_slots[i] = SlotInLoop(inputs[i].id(), loop);
+  }
+  instr.out_slot = loops_.at(loop).num_slots++;
+  loops_.at(loop).instructions.push_back(instr);
+  if (IsIntegralDataType(data_type)) {
+    // Integral values are carried in the floating compute type, so round them
+    // toward zero as integer arithmetic does.
+    NativeInstruction trunc;
+    trunc.kind = NativeInstruction::kCompute;
+    trunc.fn = MakeUnaryKernelFn<TruncFunctor>();
+    trunc.in_slots[0] = instr.out_slot;
+    trunc.out_slot = loops_.at(loop).num_slots++;
+    loops_.at(loop).instructions.push_back(trunc);
+    instr.out_slot = trunc.out_slot;
+  }
+
+  ValueInfo info;
+  info.shape = shape;
+  info.data_type = data_type;
+  info.loop = loop;
+  info.slot = instr.out_slot;
+  return AddValue(info);
+}
+
+NativeValue NativeProgramBuilder::Reshape(const NativeValue &value, const Shape &shape) {
+  CHECK_EQ(values_.at(value.id()).shape.elem_cnt(), shape.elem_cnt());
+  if (values_.at(value.id()).shape == shape) { return value; }
+  if (!values_.at(value.id()).in_memory) { Materialize(value.id()); }
+  ValueInfo info = values_.at(value.id());
+  info.shape = shape;
+  info.loop = -1;
+  info.slot = -1;
+  return AddValue(info);
+}
+
+void NativeProgramBuilder::Return(const NativeValue &value, int32_t return_index,
+                                  const DataType &data_type) {
+  const ValueInfo &info = values_.at(value.id());
+  const int32_t loop = info.loop >= 0 ? info.loop : LoopForShape(info.shape);
+  NativeInstruction store;
+  store.kind = NativeInstruction::kStore;
+  store.in_slots[0] = SlotInLoop(value.id(), loop);
+  store.buffer.kind = NativeBuffer::kReturn;
+  store.buffer.index = return_index;
+  store.buffer.data_type = data_type;
+  loops_.at(loop).instructions.push_back(store);
+}
+
+std::shared_ptr<NativeProgram> NativeProgramBuilder::Build() {
+  // Schedule loops so that materialized values are produced before they are
+  // loaded, keeping the creation order otherwise.
+  std::vector<int32_t> num_producers(loops_.size(), 0);
+  for (const auto &consumers : loop_consumers_) {
+    for (int32_t consumer : consumers) { ++num_producers[consumer]; }
+  }
+  std::vector<NativeLoop> scheduled;
+  std::vector<bool> done(loops_.size(), false);
+  while (scheduled.size() < loops_.size()) {
+    int32_t next = -1;
+    for (int32_t i = 0; i < loops_.size(); ++i) {
+      if (!done[i] && num_producers[i] == 0) {
+        next = i;
+        break;
+      }
+    }
+    CHECK_GE(next, 0) << name_ << ": fused loops have cyclic dependencies.";
+    done[next] = true;
+    for (int32_t consumer : loop_consumers_[next]) { --num_producers[consumer]; }
+    scheduled.push_back(loops_[next]);
+  }
+  return std::make_shared<NativeProgram>(compute_type_, std::move(scheduled), temp_elem_cnts_);
+}
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
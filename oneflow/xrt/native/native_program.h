@@ -0,0 +1,180 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_XRT_NATIVE_NATIVE_PROGRAM_H_
+#define ONEFLOW_XRT_NATIVE_NATIVE_PROGRAM_H_
+
+#include <memory>
+#include <vector>
+
+#include "oneflow/core/common/data_type.pb.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/xrt/native/native_kernels.h"
+#include "oneflow/xrt/utility/stl.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+// Elements evaluated by one instruction at a time. Intermediate values of a
+// fused loop only live in per-thread tiles of this size, so they never hit
+// the blob memory.
+constexpr int64_t kNativeTileSize = 256;
+// Tiles handed to each thread at least when a loop is split across the
+// thread pool.
+constexpr int64_t kNativeGrainTiles = 64;
+
+struct NativeBuffer {
+  enum Kind { kEntry = 0, kReturn = 1, kTemp = 2 };
+  Kind kind = kEntry;
+  int32_t index = -1;
+  DataType data_type = DataType::kInvalidDataType;
+};
+
+struct NativeInstruction {
+  enum Kind { kLoad = 0, kCompute = 1, kStore = 2 };
+  Kind kind = kCompute;
+
+  int32_t out_slot = -1;
+  int32_t in_slots[2] = {-1, -1};
+
+  // kCompute
+  NativeKernelFn fn;
+  double alpha = 0.0;
+
+  // kLoad and kStore
+  NativeBuffer buffer;
+  // Strides of the loaded buffer along each axis of the loop shape. Empty
+  // means the buffer is read contiguously, and `is_scalar` means it is a
+  // single element broadcast to the whole loop.
+  bool is_scalar = false;
+  std::vector<int64_t> strides;
+};
+
+// A fused loop evaluates all instructions producing values of the same shape.
+struct NativeLoop {
+  Shape shape;
+  int32_t num_slots = 0;
+  std::vector<NativeInstruction> instructions;
+};
+
+struct NativeBufferTable {
+  std::vector<const void *> entries;
+  std::vector<void *> returns;
+  std::vector<void *> temps;
+};
+
+class NativeProgram {
+ public:
+  NativeProgram(const DataType &compute_type, std::vector<NativeLoop> &&loops,
+                const std::vector<int64_t> &temp_elem_cnts)
+      : compute_type_(compute_type), loops_(std::move(loops)), temp_elem_cnts_(temp_elem_cnts) {}
+
+  const DataType &compute_type() const { return compute_type_; }
+  const std::vector<NativeLoop> &loops() const { return loops_; }
+  const std::vector<int64_t> &temp_elem_cnts() const { return temp_elem_cnts_; }
+
+  // Run all loops in order. Each loop is split into chunks of tiles which run
+  // on the global thread pool if `max_num_threads` allows it.
+  void Run(const NativeBufferTable &buffers, int32_t max_num_threads) const;
+
+ private:
+  template<typename T>
+  void RunLoop(const NativeLoop &loop, const NativeBufferTable &buffers,
+               int32_t max_num_threads) const;
+
+  DataType compute_type_;
+  std::vector<NativeLoop> loops_;
+  std::vector<int64_t> temp_elem_cnts_;
+};
+
+class NativeValue {
+ public:
+  NativeValue() = default;
+  explicit NativeValue(int64_t id) : id_(id) {}
+
+  int64_t id() const { return id_; }
+  bool valid() const { return id_ >= 0; }
+
+ private:
+  int64_t id_ = -1;
+};
+
+// Build a `NativeProgram` from the op kernels of a cluster. Values are either
+// resident in tile slots of the loop which computes them, or in memory (entry
+// parameters and temporary buffers). A value computed by one loop and consumed
+// by a loop of another shape is materialized into a temporary buffer.
+class NativeProgramBuilder {
+ public:
+  NativeProgramBuilder(const std::string &name, const DataType &compute_type)
+      : name_(name), compute_type_(compute_type) {}
+
+  const std::string &name() const { return name_; }
+  const DataType &compute_type() const { return compute_type_; }
+
+  NativeValue Parameter(int32_t entry_index, const Shape &shape, const DataType &data_type);
+
+  // Apply `fn` on `inputs` with numpy-style broadcasting to `shape`.
+  NativeValue Compute(const NativeKernelFn &fn, const std::vector<NativeValue> &inputs,
+                      double alpha, const Shape &shape, const DataType &data_type);
+
+  // View the value with another shape of the same element count.
+  NativeValue Reshape(const NativeValue &value, const Shape &shape);
+
+  void Return(const NativeValue &value, int32_t return_index, const DataType &data_type);
+
+  const Shape &ValueShape(const NativeValue &value) const { return values_.at(value.id()).shape; }
+  const DataType &ValueType(const NativeValue &value) const {
+    return values_.at(value.id()).data_type;
+  }
+
+  std::shared_ptr<NativeProgram> Build();
+
+ private:
+  struct ValueInfo {
+    Shape shape;
+    DataType data_type;
+    // Loop and slot of the value if it is resident in a tile slot.
+    int32_t loop = -1;
+    int32_t slot = -1;
+    // Memory buffer of the value if it is an entry parameter or has been
+    // materialized, and the loop writing the buffer in the latter case.
+    bool in_memory = false;
+    NativeBuffer buffer;
+    int32_t producer_loop = -1;
+  };
+
+  int32_t LoopForShape(const Shape &shape);
+  int32_t SlotInLoop(int64_t value_id, int32_t loop);
+  void Materialize(int64_t value_id);
+  NativeValue AddValue(const ValueInfo &info);
+
+  std::string name_;
+  DataType compute_type_;
+
+  std::vector<ValueInfo> values_;
+  std::vector<NativeLoop> loops_;
+  std::vector<int64_t> temp_elem_cnts_;
+  // Edges between loops which produce and consume materialized values.
+  std::vector<util::Set<int32_t>> loop_consumers_;
+  // Cache of loaded in-memory values, keyed by (value, loop).
+  util::Map<int64_t, util::Map<int32_t, int32_t>> loaded_slots_;
+};
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
+
+#endif  // ONEFLOW_XRT_NATIVE_NATIVE_PROGRAM_H_
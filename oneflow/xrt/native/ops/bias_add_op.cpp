@@ -0,0 +1,51 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_kernels.h"
+#include "oneflow/xrt/native/ops/op_context.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+class BiasAddOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    Shape in_shape = ctx->InputShape("a_0");
+    Shape bias_shape = ctx->InputShape("b_0");
+    CHECK_EQ(bias_shape.NumAxes(), 1);
+    int32_t axis = ctx->Attr<int32_t>("axis");
+    if (axis < 0) { axis += in_shape.NumAxes(); }
+    CHECK_GE(axis, 0);
+    CHECK_LT(axis, in_shape.NumAxes());
+    CHECK_EQ(in_shape.At(axis), bias_shape.At(0));
+
+    // View bias as [1, ..., C, ..., 1] so that it is broadcast along `axis`.
+    DimVector bias_dims(in_shape.NumAxes(), 1);
+    bias_dims[axis] = bias_shape.At(0);
+    NativeValue bias = ctx->builder()->Reshape(ctx->Input("b_0"), Shape(bias_dims));
+    NativeValue out =
+        ctx->builder()->Compute(MakeBinaryKernelFn<AddFunctor>(), {ctx->Input("a_0"), bias}, 0.0,
+                                ctx->SoleOutputShape(), ctx->SoleOutputType());
+    ctx->SetSoleOutput(out);
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(BiasAdd, BiasAddOp).EnableTrainPhase().Finalize();
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
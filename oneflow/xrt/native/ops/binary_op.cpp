@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "absl/strings/str_cat.h"
+#include "oneflow/user/kernels/math_binary_elementwise_func.h"
+#include "oneflow/xrt/native/native_kernels.h"
+#include "oneflow/xrt/native/ops/op_context.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+template<template<typename> class Functor>
+class ApplyBinaryOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    NativeValue x = ctx->Input("x_0");
+    NativeValue y = ctx->Input("y_0");
+    NativeValue out = ctx->builder()->Compute(MakeBinaryKernelFn<Functor>(), {x, y}, 0.0,
+                                              ctx->SoleOutputShape(), ctx->SoleOutputType());
+    ctx->SetSoleOutput(out);
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(BcastAdd, ApplyBinaryOp<AddFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastSub, ApplyBinaryOp<SubFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastMul, ApplyBinaryOp<MulFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastDiv, ApplyBinaryOp<DivFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastMin, ApplyBinaryOp<MinFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastMax, ApplyBinaryOp<MaxFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(Multiply, ApplyBinaryOp<MulFunctor>).EnableTrainPhase().Finalize();
+
+#define REGISTER_MATH_BINARY_NATIVE_OP_KERNEL(op_type_name, func_prefix)      \
+  REGISTER_NATIVE_OP_KERNEL(func_prefix, ApplyBinaryOp<func_prefix##Functor>) \
+      .EnableTrainPhase()                                                     \
+      .Finalize();
+
+OF_PP_FOR_EACH_TUPLE(REGISTER_MATH_BINARY_NATIVE_OP_KERNEL, MATH_BINARY_ELEMENTWISE_FUNC_SEQ)
+
+class AddNOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    const Shape shape = ctx->SoleOutputShape();
+    const DataType data_type = ctx->SoleOutputType();
+    NativeValue sum = ctx->Input("in_0");
+    for (int i = 1; i < ctx->num_inputs(); ++i) {
+      sum = ctx->builder()->Compute(MakeBinaryKernelFn<AddFunctor>(),
+                                    {sum, ctx->Input(absl::StrCat("in_", i))}, 0.0, shape,
+                                    data_type);
+    }
+    ctx->SetSoleOutput(sum);
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(Add, AddNOp).EnableTrainPhase().Finalize();
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
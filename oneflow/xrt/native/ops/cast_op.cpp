@@ -0,0 +1,45 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_kernels.h"
+#include "oneflow/xrt/native/ops/op_context.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+class CastOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    DataType dest_dtype = ctx->Attr<DataType>("dtype");
+    DataType src_dtype = ctx->SoleInputType();
+    NativeValue in = ctx->SoleInput();
+    if (src_dtype == dest_dtype) {
+      ctx->SetSoleOutput(in);
+      return;
+    }
+    // Rounding toward zero of integral destinations is done by the builder.
+    NativeKernelFn fn = (dest_dtype == DataType::kFloat) ? MakeUnaryKernelFn<RoundToFloatFunctor>()
+                                                         : MakeUnaryKernelFn<IdentityFunctor>();
+    ctx->SetSoleOutput(ctx->builder()->Compute(fn, {in}, 0.0, ctx->SoleOutputShape(), dest_dtype));
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(Cast, CastOp).EnableTrainPhase().Finalize();
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
@@ -0,0 +1,48 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/preprocessor.h"
+#include "oneflow/user/kernels/math_unary_elementwise_func.h"
+#include "oneflow/xrt/native/native_kernels.h"
+#include "oneflow/xrt/native/ops/op_context.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+template<template<typename> class Functor>
+class ApplyUnaryOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    NativeValue out = ctx->builder()->Compute(MakeUnaryKernelFn<Functor>(), {ctx->SoleInput()},
+                                              0.0, ctx->SoleOutputShape(), ctx->SoleOutputType());
+    ctx->SetSoleOutput(out);
+  }
+};
+
+#define REGISTER_MATH_UNARY_NATIVE_OP_KERNEL(op_type_name, func_prefix)      \
+  REGISTER_NATIVE_OP_KERNEL(func_prefix, ApplyUnaryOp<func_prefix##Functor>) \
+      .EnableTrainPhase()                                                    \
+      .Finalize();
+
+OF_PP_FOR_EACH_TUPLE(REGISTER_MATH_UNARY_NATIVE_OP_KERNEL, MATH_UNARY_ELEMENTWISE_FUNC_SEQ)
+
+REGISTER_NATIVE_OP_KERNEL(Relu, ApplyUnaryOp<ReluFunctor>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(Gelu, ApplyUnaryOp<GeluFunctor>).EnableTrainPhase().Finalize();
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
@@ -31,10 +31,34 @@ const PbMessage *OpMessage(const XrtNode *node) {
   return message;
 }
 
+namespace {
+
+bool IsInt64Edge(const XrtEdge *edge) {
+  return !edge->IsControlEdge() && edge->HasAttr("data_type")
+         && edge->Attr<DataType>("data_type") == DataType::kInt64;
+}
+
+bool HasInt64Argument(const XrtNode *node) {
+  for (const XrtEdge *edge : node->in_edges()) {
+    if (IsInt64Edge(edge)) { return true; }
+  }
+  for (const XrtEdge *edge : node->out_edges()) {
+    if (IsInt64Edge(edge)) { return true; }
+  }
+  return false;
+}
+
+}  // namespace
+
 bool IsCompiledNode(const XrtNode *node, const XrtEngine &engine, const bool train_phase) {
   auto field = MakeXrtField(node->device(), engine);
-  return OpKernelRegistered(node->type(), field)
-         && (!train_phase || TrainPhaseEnabled(node->type(), field));
+  if (!OpKernelRegistered(node->type(), field)
+      || (train_phase && !TrainPhaseEnabled(node->type(), field))) {
+    return false;
+  }
+  // The native engine computes in float or double, which can not hold every
+  // 64-bit integer exactly.
+  return engine != XrtEngine::NATIVE || !HasInt64Argument(node);
 }
 
 bool IsOptimizerNode(const XrtNode *node, const XrtEngine &engine) {
@@ -203,6 +203,9 @@ void MarkClusterIdPass::Run(XrtGraph *graph, const XrtPassOptions &options) {
     ClusteringSubgraphs(clustering_options, XrtEngine::TENSORRT);
     ClusteringSubgraphs(clustering_options, XrtEngine::XLA);
   }
+  // The native engine only fuses elementwise ops on CPU, so it picks up the
+  // nodes left over by the general-purpose engines.
+  ClusteringSubgraphs(clustering_options, XrtEngine::NATIVE);
 
   RemoveInvalidClusterNodes(clustering_options);
   RerankClusterIds();
@@ -0,0 +1,74 @@
+import argparse
+
+from google.protobuf import text_format
+from oneflow.core.job.cost_db_pb2 import CostDBProto
+
+
+def load(path):
+    cost_db = CostDBProto()
+    with open(path) as f:
+        text_format.Parse(f.read(), cost_db)
+    return cost_db
+
+
+def merge(dst, src):
+    for key, record in src.key2record.items():
+        if key not in dst.key2record:
+            dst.key2record[key].CopyFrom(record)
+            continue
+        dst_record = dst.key2record[key]
+        if not dst_record.desc:
+            dst_record.desc = record.desc
+        dst_record.act_cnt += record.act_cnt
+        dst_record.total_duration += record.total_duration
+    # regst nums of later databases win
+    for key, register_num in src.regst_key2register_num.items():
+        dst.regst_key2register_num[key] = register_num
+
+
+def show(args):
+    cost_db = load(args.db)
+    records = [
+        (key, r.desc, r.act_cnt, r.total_duration / max(r.act_cnt, 1))
+        for key, r in cost_db.key2record.items()
+        if args.filter is None or args.filter in r.desc
+    ]
+    records.sort(key=lambda r: r[3], reverse=True)
+    if args.top > 0:
+        records = records[: args.top]
+    print("{:<18}{:>12}{:>16}  {}".format("key", "act_cnt", "mean_duration", "desc"))
+    for key, desc, act_cnt, mean_duration in records:
+        print("{:<18}{:>12}{:>16.1f}  {}".format(key, act_cnt, mean_duration, desc))
+    if len(cost_db.regst_key2register_num) > 0:
+        print("\n{:<40}{:>14}".format("regst", "register_num"))
+        for key, register_num in sorted(cost_db.regst_key2register_num.items()):
+            print("{:<40}{:>14}".format(key, register_num))
+
+
+def merge_files(args):
+    cost_db = CostDBProto()
+    for path in args.inputs:
+        merge(cost_db, load(path))
+    with open(args.output, "w") as f:
+        f.write(text_format.MessageToString(cost_db))
+    print("merged {} records into {}".format(len(cost_db.key2record), args.output))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="inspect and merge oneflow cost databases")
+    subparsers = parser.add_subparsers(dest="command")
+    subparsers.required = True
+
+    show_parser = subparsers.add_parser("show", help="list records by mean duration")
+    show_parser.add_argument("db", type=str)
+    show_parser.add_argument("--top", type=int, default=0)
+    show_parser.add_argument("--filter", type=str, default=None)
+    show_parser.set_defaults(func=show)
+
+    merge_parser = subparsers.add_parser("merge", help="merge databases into one")
+    merge_parser.add_argument("-o", "--output", type=str, required=True)
+    merge_parser.add_argument("inputs", type=str, nargs="+")
+    merge_parser.set_defaults(func=merge_files)
+
+    args = parser.parse_args()
+    args.func(args)